@@ -0,0 +1,543 @@
+#include <new>
+#include <cmath>
+#include <chrono>
+#include <atomic>
+#include <random>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <miniaudio.h>
+#include <saudio/Context.h>
+#include <saudio/AudioEngine.h>
+#include <saudio/Sound.h>
+#include <saudio/FileDataSource.h>
+#include <saudio/StreamDataSource.h>
+#include "EffectKernels.h"
+
+static std::atomic<std::size_t> sNumAllocations = 0;
+
+void* operator new(std::size_t size)
+{
+	sNumAllocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* ptr = std::malloc(size? size : 1)) {
+		return ptr;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+
+
+enum class SourceType { Decoded, Streamed, Stream };
+enum class KernelType { Biquad, OnePole, Delay };
+
+struct BenchConfig
+{
+	std::string audioFile = "file_example_MP3_1MG.mp3";
+	std::vector<std::size_t> voiceCounts = { 1, 10, 100, 1000, 10000 };
+	std::vector<SourceType> sourceTypes = { SourceType::Decoded, SourceType::Streamed, SourceType::Stream };
+	std::vector<saudio::Format> outputFormats = { saudio::Format::f32, saudio::Format::s16, saudio::Format::s24, saudio::Format::u8 };
+	std::size_t maxStreamedVoices = 500;
+	std::vector<uint32_t> kernelChannels = { 1, 2, 8 };
+	unsigned int numCallbacks = 100;
+	unsigned int periodFrames = 512;
+	uint32_t channels = 2;
+	uint32_t sampleRate = 48000;
+};
+
+struct BenchCase
+{
+	SourceType sourceType;
+	std::size_t numVoices;
+	bool spatialization;
+	saudio::Format outputFormat;
+};
+
+
+static const char* toString(SourceType sourceType)
+{
+	switch (sourceType) {
+		case SourceType::Decoded:	return "decoded";
+		case SourceType::Streamed:	return "streamed";
+		default:					return "stream";
+	}
+}
+
+
+static const char* toString(KernelType kernel)
+{
+	switch (kernel) {
+		case KernelType::Biquad:	return "biquad";
+		case KernelType::OnePole:	return "onePole";
+		default:					return "delay";
+	}
+}
+
+
+static const char* toString(saudio::Format format)
+{
+	switch (format) {
+		case saudio::Format::u8:	return "u8";
+		case saudio::Format::s16:	return "s16";
+		case saudio::Format::s24:	return "s24";
+		case saudio::Format::s32:	return "s32";
+		case saudio::Format::f32:	return "f32";
+		default:					return "unknown";
+	}
+}
+
+
+static ma_format toMAFormat(saudio::Format format)
+{
+	switch (format) {
+		case saudio::Format::u8:	return ma_format_u8;
+		case saudio::Format::s16:	return ma_format_s16;
+		case saudio::Format::s24:	return ma_format_s24;
+		case saudio::Format::s32:	return ma_format_s32;
+		case saudio::Format::f32:	return ma_format_f32;
+		default:					return ma_format_unknown;
+	}
+}
+
+
+static std::vector<std::string> split(const std::string& str)
+{
+	std::vector<std::string> ret;
+	std::stringstream ss(str);
+	std::string token;
+	while (std::getline(ss, token, ',')) {
+		ret.push_back(token);
+	}
+	return ret;
+}
+
+
+static bool parseArgs(int argc, char** argv, BenchConfig& config)
+{
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		if (i + 1 >= argc) {
+			std::cerr << "Missing value for " << arg << std::endl;
+			return false;
+		}
+
+		std::string value = argv[++i];
+		if (arg == "--file") {
+			config.audioFile = value;
+		}
+		else if (arg == "--voices") {
+			config.voiceCounts.clear();
+			for (const auto& token : split(value)) {
+				config.voiceCounts.push_back(std::stoul(token));
+			}
+		}
+		else if (arg == "--sources") {
+			config.sourceTypes.clear();
+			for (const auto& token : split(value)) {
+				if (token == "decoded") { config.sourceTypes.push_back(SourceType::Decoded); }
+				else if (token == "streamed") { config.sourceTypes.push_back(SourceType::Streamed); }
+				else if (token == "stream") { config.sourceTypes.push_back(SourceType::Stream); }
+				else { std::cerr << "Invalid source " << token << std::endl; return false; }
+			}
+		}
+		else if (arg == "--formats") {
+			config.outputFormats.clear();
+			for (const auto& token : split(value)) {
+				if (token == "u8") { config.outputFormats.push_back(saudio::Format::u8); }
+				else if (token == "s16") { config.outputFormats.push_back(saudio::Format::s16); }
+				else if (token == "s24") { config.outputFormats.push_back(saudio::Format::s24); }
+				else if (token == "s32") { config.outputFormats.push_back(saudio::Format::s32); }
+				else if (token == "f32") { config.outputFormats.push_back(saudio::Format::f32); }
+				else { std::cerr << "Invalid format " << token << std::endl; return false; }
+			}
+		}
+		else if (arg == "--kernel-channels") {
+			config.kernelChannels.clear();
+			for (const auto& token : split(value)) {
+				if (token != "none") { config.kernelChannels.push_back(static_cast<uint32_t>(std::stoul(token))); }
+			}
+		}
+		else if (arg == "--max-streamed") {
+			config.maxStreamedVoices = std::stoul(value);
+		}
+		else if (arg == "--callbacks") {
+			config.numCallbacks = static_cast<unsigned int>(std::stoul(value));
+		}
+		else if (arg == "--period") {
+			config.periodFrames = static_cast<unsigned int>(std::stoul(value));
+		}
+		else {
+			std::cerr << "Unknown argument " << arg << std::endl;
+			return false;
+		}
+	}
+
+	return (config.numCallbacks > 0) && (config.periodFrames > 0);
+}
+
+
+static std::uint64_t percentile(const std::vector<std::uint64_t>& sorted, double p)
+{
+	std::size_t index = static_cast<std::size_t>(p * (sorted.size() - 1) + 0.5);
+	return sorted[std::min(index, sorted.size() - 1)];
+}
+
+
+static std::uint64_t countMAAllocations(const saudio::Context& context)
+{
+	std::uint64_t ret = 0;
+	for (std::size_t i = 0; i < saudio::kNumAllocationCategories; ++i) {
+		saudio::AllocationStats stats = context.getAllocationStats(static_cast<saudio::AllocationCategory>(i));
+		ret += stats.numAllocations + stats.numReallocations;
+	}
+	return ret;
+}
+
+
+static bool runCase(saudio::Context& context, const BenchConfig& config, const BenchCase& bCase)
+{
+	saudio::AudioEngine::Config engineConfig;
+	engineConfig.outputChannels = config.channels;
+	engineConfig.outputSampleRate = config.sampleRate;
+	saudio::AudioEngine engine(context, engineConfig);
+	if (!engine.good()) {
+		std::cerr << "Failed to create the AudioEngine" << std::endl;
+		return false;
+	}
+
+	// Create the data sources
+	std::vector<std::unique_ptr<saudio::FileDataSource>> fileSources;
+	std::vector<std::unique_ptr<saudio::StreamDataSource>> streamSources;
+	std::size_t streamBufferFrames = 4 * config.periodFrames;
+	if (bCase.sourceType == SourceType::Decoded) {
+		fileSources.emplace_back(std::make_unique<saudio::FileDataSource>(engine, config.audioFile.c_str()));
+	}
+	else if (bCase.sourceType == SourceType::Streamed) {
+		for (std::size_t i = 0; i < bCase.numVoices; ++i) {
+			fileSources.emplace_back(std::make_unique<saudio::FileDataSource>(engine, config.audioFile.c_str(), true));
+		}
+	}
+	else {
+		saudio::Channel mono = saudio::Channel::Mono;
+		for (std::size_t i = 0; i < bCase.numVoices; ++i) {
+			auto source = std::make_unique<saudio::StreamDataSource>(streamBufferFrames);
+			source->setNumChannels(1)
+				.setChannels(&mono, 1)
+				.setSampleRate(config.sampleRate)
+				.setFormat(saudio::Format::f32);
+			streamSources.emplace_back(std::move(source));
+		}
+	}
+
+	for (const auto& source : fileSources) {
+		if (!source->good()) {
+			std::cerr << "Failed to load " << config.audioFile << std::endl;
+			return false;
+		}
+	}
+
+	// Create the voices
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> posDist(-10.0f, 10.0f);
+	std::uniform_real_distribution<float> pitchDist(0.5f, 2.0f);
+
+	std::vector<std::unique_ptr<saudio::Sound>> sounds;
+	std::vector<float> pitches;
+	sounds.reserve(bCase.numVoices);
+	pitches.reserve(bCase.numVoices);
+	for (std::size_t i = 0; i < bCase.numVoices; ++i) {
+		saudio::IDataSource* source =
+			(bCase.sourceType == SourceType::Decoded)? static_cast<saudio::IDataSource*>(fileSources.front().get()) :
+			(bCase.sourceType == SourceType::Streamed)? static_cast<saudio::IDataSource*>(fileSources[i].get()) :
+			static_cast<saudio::IDataSource*>(streamSources[i].get());
+
+		float pitch = pitchDist(rng);
+		auto sound = std::make_unique<saudio::Sound>(&engine);
+		sound->bind(source)
+			.setLooping(true)
+			.setSpacialization(bCase.spatialization)
+			.setPosition({ posDist(rng), posDist(rng), posDist(rng) })
+			.setPitch(pitch);
+		if (!sound->good()) {
+			std::cerr << "Failed to create the Sound " << i << std::endl;
+			return false;
+		}
+		sound->play();
+
+		sounds.emplace_back(std::move(sound));
+		pitches.push_back(pitch);
+	}
+
+	// Prepare the buffers
+	std::vector<float> renderBuffer(config.periodFrames * config.channels);
+	std::vector<unsigned char> outputBuffer(
+		config.periodFrames * config.channels * ma_get_bytes_per_sample(toMAFormat(bCase.outputFormat))
+	);
+	std::vector<float> streamSamples(2 * config.periodFrames + 1);
+	for (std::size_t i = 0; i < streamSamples.size(); ++i) {
+		streamSamples[i] = 0.25f * std::sin(2.0f * 3.14159265f * 440.0f * i / config.sampleRate);
+	}
+
+	// Render
+	std::vector<std::uint64_t> callbackTimes;
+	callbackTimes.reserve(config.numCallbacks);
+	std::size_t numAllocations = 0;
+	std::uint64_t numMAAllocations = 0;
+	for (unsigned int i = 0; i < config.numCallbacks; ++i) {
+		for (std::size_t j = 0; j < streamSources.size(); ++j) {
+			std::size_t numSamples = static_cast<std::size_t>(std::ceil(config.periodFrames * pitches[j]));
+			streamSources[j]->onNewSamples(reinterpret_cast<const unsigned char*>(streamSamples.data()), numSamples);
+		}
+
+		std::size_t allocationsBefore = sNumAllocations.load(std::memory_order_relaxed);
+		std::uint64_t maAllocationsBefore = countMAAllocations(context);
+		auto start = std::chrono::steady_clock::now();
+
+		engine.render(renderBuffer.data(), config.periodFrames);
+		if (bCase.outputFormat != saudio::Format::f32) {
+			ma_pcm_convert(
+				outputBuffer.data(), toMAFormat(bCase.outputFormat), renderBuffer.data(), ma_format_f32,
+				renderBuffer.size(), ma_dither_mode_none
+			);
+		}
+
+		auto end = std::chrono::steady_clock::now();
+		numAllocations += sNumAllocations.load(std::memory_order_relaxed) - allocationsBefore;
+		numMAAllocations += countMAAllocations(context) - maAllocationsBefore;
+		callbackTimes.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+	}
+
+	// Report
+	std::uint64_t totalTime = 0;
+	for (std::uint64_t time : callbackTimes) {
+		totalTime += time;
+	}
+	std::sort(callbackTimes.begin(), callbackTimes.end());
+
+	double numFrames = static_cast<double>(config.numCallbacks) * config.periodFrames;
+	double budgetNs = 1.0e9 * config.periodFrames / config.sampleRate;
+	std::cout << "{\"source\":\"" << toString(bCase.sourceType) << "\""
+		<< ",\"voices\":" << bCase.numVoices
+		<< ",\"spatialization\":" << (bCase.spatialization? "true" : "false")
+		<< ",\"format\":\"" << toString(bCase.outputFormat) << "\""
+		<< ",\"channels\":" << config.channels
+		<< ",\"sampleRate\":" << config.sampleRate
+		<< ",\"periodFrames\":" << config.periodFrames
+		<< ",\"callbacks\":" << config.numCallbacks
+		<< ",\"nsPerFrame\":" << (totalTime / numFrames)
+		<< ",\"nsPerFramePerVoice\":" << (totalTime / (numFrames * bCase.numVoices))
+		<< ",\"budgetNs\":" << budgetNs
+		<< ",\"callbackNs\":{"
+			<< "\"min\":" << callbackTimes.front()
+			<< ",\"p50\":" << percentile(callbackTimes, 0.5)
+			<< ",\"p90\":" << percentile(callbackTimes, 0.9)
+			<< ",\"p99\":" << percentile(callbackTimes, 0.99)
+			<< ",\"p999\":" << percentile(callbackTimes, 0.999)
+			<< ",\"max\":" << callbackTimes.back()
+		<< "}"
+		<< ",\"allocations\":" << numAllocations
+		<< ",\"maAllocations\":" << numMAAllocations
+		<< "}" << std::endl;
+
+	sounds.clear();
+	fileSources.clear();
+	streamSources.clear();
+	return true;
+}
+
+
+/** Scalar versions of the effect kernels, used as the baseline of the SIMD
+ * ones */
+static void scalarBiquads(
+	float* frames, std::size_t numFrames, std::size_t numChannels,
+	const saudio::BiquadCoefficients* stages, std::size_t numStages, float* state
+) {
+	for (std::size_t f = 0; f < numFrames; ++f) {
+		for (std::size_t c = 0; c < numChannels; ++c) {
+			float x = frames[f * numChannels + c];
+			for (std::size_t s = 0; s < numStages; ++s) {
+				float& z1 = state[(2 * s) * numChannels + c];
+				float& z2 = state[(2 * s + 1) * numChannels + c];
+				float y = stages[s].b0 * x + z1;
+				z1 = stages[s].b1 * x - stages[s].a1 * y + z2;
+				z2 = stages[s].b2 * x - stages[s].a2 * y;
+				x = y;
+			}
+			frames[f * numChannels + c] = x;
+		}
+	}
+}
+
+
+static void scalarOnePole(float* frames, std::size_t numFrames, std::size_t numChannels, float coefficient, float* state)
+{
+	for (std::size_t f = 0; f < numFrames; ++f) {
+		for (std::size_t c = 0; c < numChannels; ++c) {
+			float& sample = frames[f * numChannels + c];
+			state[c] += coefficient * (sample - state[c]);
+			sample = state[c];
+		}
+	}
+}
+
+
+static void scalarDelay(
+	float* frames, std::size_t numFrames, std::size_t numChannels,
+	float* buffer, std::size_t bufferFrames, std::size_t& writeIndex,
+	const saudio::DelayParameters& parameters
+) {
+	for (std::size_t f = 0; f < numFrames; ++f) {
+		float readPosition = static_cast<float>(writeIndex) - parameters.startDelay;
+		if (readPosition < 0.0f) {
+			readPosition += bufferFrames;
+		}
+		std::size_t i0 = static_cast<std::size_t>(readPosition);
+		std::size_t i1 = (i0 + 1) % bufferFrames;
+		float t = readPosition - i0;
+
+		for (std::size_t c = 0; c < numChannels; ++c) {
+			float x = frames[f * numChannels + c];
+			float y = buffer[i0 * numChannels + c] + (buffer[i1 * numChannels + c] - buffer[i0 * numChannels + c]) * t;
+			buffer[writeIndex * numChannels + c] = x + parameters.feedback * y;
+			frames[f * numChannels + c] = parameters.startDryGain * x + parameters.startWetGain * y;
+		}
+
+		writeIndex = (writeIndex + 1) % bufferFrames;
+	}
+}
+
+
+static void runKernelCase(const BenchConfig& config, KernelType kernel, uint32_t channels)
+{
+	saudio::BiquadCoefficients stages[4];
+	for (std::size_t s = 0; s < 4; ++s) {
+		float w0 = 2.0f * 3.14159265f * (500.0f + 2000.0f * s) / config.sampleRate;
+		float alpha = std::sin(w0) / (2.0f * 0.707f), cosW0 = std::cos(w0), a0 = 1.0f + alpha;
+		stages[s].b0 = 0.5f * (1.0f - cosW0) / a0;
+		stages[s].b1 = (1.0f - cosW0) / a0;
+		stages[s].b2 = stages[s].b0;
+		stages[s].a1 = -2.0f * cosW0 / a0;
+		stages[s].a2 = (1.0f - alpha) / a0;
+	}
+
+	saudio::DelayParameters delayParameters;
+	delayParameters.startDelay = delayParameters.endDelay = 0.25f * config.sampleRate + 0.5f;
+	delayParameters.feedback = 0.5f;
+	delayParameters.startWetGain = delayParameters.endWetGain = 0.5f;
+	delayParameters.startDryGain = delayParameters.endDryGain = 1.0f;
+	std::size_t bufferFrames = static_cast<std::size_t>(delayParameters.startDelay) + 2;
+
+	std::vector<float> input(config.periodFrames * channels);
+	for (std::size_t i = 0; i < input.size(); ++i) {
+		input[i] = 0.25f * std::sin(2.0f * 3.14159265f * 440.0f * (i / channels) / config.sampleRate + i % channels);
+	}
+
+	// Both versions process the same input with their own state, the
+	// time of each callback only includes the kernel
+	std::vector<float> frames[2], states[2], buffers[2];
+	std::size_t writeIndices[2] = {};
+	std::uint64_t totalTimes[2] = {};
+	for (int simd = 0; simd < 2; ++simd) {
+		states[simd].resize(2 * 4 * channels, 0.0f);
+		buffers[simd].resize((kernel == KernelType::Delay)? bufferFrames * channels : 0, 0.0f);
+
+		for (unsigned int i = 0; i < config.numCallbacks; ++i) {
+			frames[simd] = input;
+			float* data = frames[simd].data();
+			auto start = std::chrono::steady_clock::now();
+
+			switch (kernel) {
+				case KernelType::Biquad:
+					if (simd) { saudio::processBiquads(data, config.periodFrames, channels, stages, 4, states[simd].data()); }
+					else { scalarBiquads(data, config.periodFrames, channels, stages, 4, states[simd].data()); }
+					break;
+				case KernelType::OnePole:
+					if (simd) { saudio::processOnePole(data, config.periodFrames, channels, 0.1f, false, states[simd].data()); }
+					else { scalarOnePole(data, config.periodFrames, channels, 0.1f, states[simd].data()); }
+					break;
+				default:
+					if (simd) { saudio::processDelay(data, config.periodFrames, channels, buffers[simd].data(), bufferFrames, writeIndices[simd], delayParameters); }
+					else { scalarDelay(data, config.periodFrames, channels, buffers[simd].data(), bufferFrames, writeIndices[simd], delayParameters); }
+					break;
+			}
+
+			auto end = std::chrono::steady_clock::now();
+			totalTimes[simd] += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+		}
+	}
+
+	// The difference between the last outputs validates the SIMD version
+	float maxDifference = 0.0f;
+	for (std::size_t i = 0; i < input.size(); ++i) {
+		maxDifference = std::max(maxDifference, std::fabs(frames[0][i] - frames[1][i]));
+	}
+
+	double numFrames = static_cast<double>(config.numCallbacks) * config.periodFrames;
+	std::cout << "{\"kernel\":\"" << toString(kernel) << "\""
+		<< ",\"channels\":" << channels
+		<< ",\"periodFrames\":" << config.periodFrames
+		<< ",\"callbacks\":" << config.numCallbacks
+		<< ",\"scalarNsPerFrame\":" << (totalTimes[0] / numFrames)
+		<< ",\"simdNsPerFrame\":" << (totalTimes[1] / numFrames)
+		<< ",\"speedup\":" << (static_cast<double>(totalTimes[0]) / std::max<std::uint64_t>(totalTimes[1], 1))
+		<< ",\"maxDifference\":" << maxDifference
+		<< "}" << std::endl;
+}
+
+
+int main(int argc, char** argv)
+{
+	BenchConfig config;
+	if (!parseArgs(argc, argv, config)) {
+		std::cerr << "Usage: " << argv[0] << " [--file path] [--voices 1,10,...]"
+			<< " [--sources decoded,streamed,stream] [--formats f32,s16,s24,s32,u8]"
+			<< " [--max-streamed N] [--callbacks N] [--period frames]"
+			<< " [--kernel-channels 1,2,8|none]" << std::endl;
+		return -1;
+	}
+
+	// The Null backend is enough for the headless AudioEngines, the
+	// Context is only used for counting the miniaudio allocations
+	saudio::Context::Config contextConfig;
+	contextConfig.backends = { saudio::Context::Backend::Null };
+	saudio::Context context(contextConfig);
+	if (!context.good()) {
+		std::cerr << "Failed to create the Context" << std::endl;
+		return -1;
+	}
+
+	for (uint32_t channels : config.kernelChannels) {
+		for (KernelType kernel : { KernelType::Biquad, KernelType::OnePole, KernelType::Delay }) {
+			runKernelCase(config, kernel, channels);
+		}
+	}
+
+	bool success = true;
+	for (SourceType sourceType : config.sourceTypes) {
+		for (std::size_t numVoices : config.voiceCounts) {
+			if ((sourceType == SourceType::Streamed) && (numVoices > config.maxStreamedVoices)) {
+				continue;
+			}
+
+			for (bool spatialization : { false, true }) {
+				for (saudio::Format outputFormat : config.outputFormats) {
+					success &= runCase(context, config, { sourceType, numVoices, spatialization, outputFormat });
+				}
+			}
+		}
+	}
+
+	return success? 0 : -1;
+}
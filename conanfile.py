@@ -11,14 +11,16 @@ class SombraAudioConan(ConanFile):
 	options = {
 		"shared" : [True, False],
 		"fPIC" : [True, False],
-		"test" : [True, False]
+		"test" : [True, False],
+		"bench" : [True, False],
+		"rt_check" : [True, False]
 	}
-	default_options = {"shared": False, "fPIC": True, "test" : False}
+	default_options = {"shared": False, "fPIC": True, "test" : False, "bench" : False, "rt_check" : False}
 
 	def requirements(self):
 		self.requires("glm/0.9.9.8", transitive_headers=True)
 		self.requires("stdext/v1.0.0")
-		self.requires("miniaudio/0.11.11")
+		self.requires("miniaudio/0.11.21")
 
 	def config_options(self):
 		if self.settings.os == "Windows":
@@ -39,6 +41,8 @@ class SombraAudioConan(ConanFile):
 		tc = CMakeToolchain(self)
 		tc.variables["SOMBRA_AUDIO_BUILD_DOC"] = False
 		tc.variables["SOMBRA_AUDIO_BUILD_TEST"] = self.options.test
+		tc.variables["SOMBRA_AUDIO_BUILD_BENCH"] = self.options.bench
+		tc.variables["SOMBRA_AUDIO_RT_CHECK"] = self.options.rt_check
 		tc.generate()
 		deps = CMakeDeps(self)
 		deps.generate()
@@ -0,0 +1,112 @@
+#ifndef SAUDIO_ALLOCATOR_H
+#define SAUDIO_ALLOCATOR_H
+
+#include <cstdint>
+#include <cstdlib>
+
+namespace saudio {
+
+	class Context;
+
+
+	/** The kinds of memory allocations done by the library, each one can
+	 * use a different Allocator */
+	enum class AllocationCategory : unsigned char
+	{
+		Object = 0,		///< The fixed size miniaudio objects (sounds...)
+		Engine,			///< The engine node graph and converters
+		Decoding,		///< The decoders and decoded audio buffers
+		Device,			///< The context, logs and devices
+		NumCategories
+	};
+
+
+	/** The number of AllocationCategories */
+	constexpr std::size_t kNumAllocationCategories =
+		static_cast<std::size_t>(AllocationCategory::NumCategories);
+
+
+	/** Holds the number of allocations done by a Context in an
+	 * AllocationCategory */
+	struct AllocationStats
+	{
+		/** The number of allocations */
+		uint64_t numAllocations = 0;
+
+		/** The number of reallocations */
+		uint64_t numReallocations = 0;
+
+		/** The number of deallocations */
+		uint64_t numDeallocations = 0;
+
+		/** The total number of bytes requested by the allocations and
+		 * reallocations */
+		uint64_t bytesRequested = 0;
+	};
+
+
+	/**
+	 * Class Allocator, it's the class that must be inherited from if someone
+	 * wants to control the memory allocations of the library. The default
+	 * behavior is to use the C allocation functions. The memory returned
+	 * must be aligned to at least 16 bytes.
+	 */
+	class Allocator
+	{
+	public:		// Functions
+		/** Class destructor */
+		virtual ~Allocator() = default;
+
+		/** Allocates memory
+		 *
+		 * @param	size the number of bytes to allocate
+		 * @return	a pointer to the allocated memory, nullptr on failure */
+		virtual void* allocate(std::size_t size)
+		{ return std::malloc(size); };
+
+		/** Changes the size of the given allocated memory
+		 *
+		 * @param	ptr a pointer to the memory to reallocate, it can be
+		 *			nullptr
+		 * @param	size the new number of bytes
+		 * @return	a pointer to the reallocated memory, nullptr on failure */
+		virtual void* reallocate(void* ptr, std::size_t size)
+		{ return std::realloc(ptr, size); };
+
+		/** Releases the given allocated memory
+		 *
+		 * @param	ptr a pointer to the memory to release, it can be
+		 *			nullptr */
+		virtual void deallocate(void* ptr)
+		{ std::free(ptr); };
+	};
+
+
+	/**
+	 * Struct ObjectDeleter, used for releasing the objects allocated with
+	 * the Allocator of a Context
+	 */
+	struct ObjectDeleter
+	{
+		/** A pointer to the Context used for allocating the object, if it's
+		 * nullptr the object was allocated with the C allocation
+		 * functions */
+		const Context* context = nullptr;
+
+		/** The AllocationCategory of the object */
+		AllocationCategory category = AllocationCategory::Object;
+
+		/** The function that destroys the object before releasing its
+		 * memory, nullptr for the miniaudio objects, that are released
+		 * without calling their destructors */
+		void (*destroy)(void* ptr) = nullptr;
+
+		/** Releases the given object
+		 *
+		 * @param	ptr a pointer to the object to release */
+		void operator()(void* ptr) const;
+	};
+
+}
+
+#endif		// SAUDIO_ALLOCATOR_H
@@ -0,0 +1,121 @@
+#ifndef SAUDIO_ARENA_ALLOCATOR_H
+#define SAUDIO_ARENA_ALLOCATOR_H
+
+#include <mutex>
+#include <vector>
+#include "Allocator.h"
+
+namespace saudio {
+
+	/**
+	 * Class ArenaAllocator, it's an Allocator that carves the allocations
+	 * out of big chunks of memory. The released memory isn't reused until
+	 * all the allocations of the arena are released, then all the chunks
+	 * but the first one are freed and the arena starts again from the
+	 * beginning. It's intended for the decoded audio buffers
+	 * (@see AllocationCategory::Decoding), that are usually allocated and
+	 * released together, ie. when a level is loaded and unloaded.
+	 *
+	 * @note	the allocations are protected by a mutex, the ArenaAllocator
+	 *			must not be used from the audio threads
+	 */
+	class ArenaAllocator : public Allocator
+	{
+	public:		// Nested types
+		/** Struct Config, holds all the parameters needed for creating the
+		 * ArenaAllocator */
+		struct Config
+		{
+			/** The number of bytes of each chunk. The allocations bigger
+			 * than it get their own chunk */
+			std::size_t chunkSize = 4 * 1024 * 1024;
+
+			/** The Allocator used for allocating the chunks, nullptr for
+			 * the C allocation functions */
+			Allocator* upstream = nullptr;
+		};
+
+	private:	// Nested types
+		/** Holds a chunk of memory */
+		struct Chunk
+		{
+			/** A pointer to the memory of the chunk */
+			unsigned char* data;
+
+			/** The number of bytes of the chunk */
+			std::size_t size;
+		};
+
+	private:	// Attributes
+		/** The Allocator used for allocating the chunks */
+		Allocator* mUpstream;
+
+		/** The number of bytes of each chunk */
+		std::size_t mChunkSize;
+
+		/** The mutex used for protecting the arena */
+		std::mutex mMutex;
+
+		/** The chunks of the arena, the last one is the one used for the
+		 * new allocations */
+		std::vector<Chunk> mChunks;
+
+		/** The number of bytes used of the last chunk */
+		std::size_t mChunkOffset;
+
+		/** The last allocation done, it can grow in place */
+		unsigned char* mLastAllocation;
+
+		/** The number of allocations not released yet */
+		std::size_t mNumLiveAllocations;
+
+		/** The number of bytes of all the chunks */
+		std::size_t mReservedBytes;
+
+	public:		// Functions
+		/** Creates a new ArenaAllocator
+		 *
+		 * @param	config the parameters of the ArenaAllocator */
+		ArenaAllocator(const Config& config);
+		ArenaAllocator(const ArenaAllocator& other) = delete;
+		ArenaAllocator(ArenaAllocator&& other) = delete;
+
+		/** Class destructor. All the allocated memory must be released
+		 * before calling it */
+		~ArenaAllocator();
+
+		/** Assignment operator */
+		ArenaAllocator& operator=(const ArenaAllocator& other) = delete;
+		ArenaAllocator& operator=(ArenaAllocator&& other) = delete;
+
+		/** @return	the number of allocations not released yet */
+		std::size_t getNumLiveAllocations();
+
+		/** @return	the number of bytes reserved by the arena */
+		std::size_t getReservedBytes();
+
+		/** @copydoc Allocator::allocate() */
+		virtual void* allocate(std::size_t size) override;
+
+		/** @copydoc Allocator::reallocate() */
+		virtual void* reallocate(void* ptr, std::size_t size) override;
+
+		/** @copydoc Allocator::deallocate() */
+		virtual void deallocate(void* ptr) override;
+	private:
+		/** Allocates memory from the arena
+		 *
+		 * @param	size the number of bytes to allocate
+		 * @return	a pointer to the allocated memory, nullptr on failure
+		 * @note	@see mMutex must be locked */
+		void* allocateInternal(std::size_t size);
+
+		/** Releases all the chunks but the first one and resets the arena
+		 *
+		 * @note	@see mMutex must be locked */
+		void rewind();
+	};
+
+}
+
+#endif		// SAUDIO_ARENA_ALLOCATOR_H
@@ -1,21 +1,38 @@
 #ifndef SAUDIO_AUDIO_ENGINE_H
 #define SAUDIO_AUDIO_ENGINE_H
 
+#include <atomic>
+#include <vector>
 #include <glm/glm.hpp>
 #include "Device.h"
+#include "CallbackStats.h"
+#include "Allocator.h"
+#include "SoundEvent.h"
+#include "Automation.h"
 
 struct ma_resource_manager;
 struct ma_engine;
+struct ma_sound;
 
 namespace saudio {
 
+	class CallbackProfiler;
+	class SoundEventQueue;
+	class SoundScheduler;
+	class BatchSpatializer;
+	class ParallelRenderer;
+	class EffectChain;
+	class IEffect;
+	class Hrtf;
+
+
 	/**
 	 * Class AudioEngine, It's the class used to prepare the audio devices for
 	 * playing sounds, and to set the properties of the Listener of the Sounds.
 	 * The properties of this Listener can be used to control from where we are
 	 * going to be listening the Sounds in this 3D audio scene.
 	 */
-	class AudioEngine : public Device::IDeviceDataListener
+	class AudioEngine
 	{
 	public:		// Nested Types
 		friend class Sound;
@@ -45,33 +62,279 @@ namespace saudio {
 			Format decodeFormat = Format::f32;
 			uint32_t decodeChannels = 0;
 			uint32_t decodeSampleRate = 48000;
+
+			/** The number of channels of the rendered audio. It's only used
+			 * if the AudioEngine is created without a Device, otherwise the
+			 * Device ones are used */
+			uint32_t outputChannels = 2;
+
+			/** The sample rate of the rendered audio. It's only used if the
+			 * AudioEngine is created without a Device, otherwise the Device
+			 * one is used */
+			uint32_t outputSampleRate = 48000;
+
+			/** The maximum number of SoundEvents waiting to be polled, the
+			 * events that don't fit are dropped */
+			std::size_t soundEventQueueSize = 1024;
+
+			/** The maximum number of scheduled commands waiting to be read
+			 * by the audio thread */
+			std::size_t scheduleQueueSize = 256;
+
+			/** The maximum number of automations running at the same time,
+			 * the ones that don't fit are ignored. It's also the number of
+			 * committed automations that can wait to be read by the audio
+			 * thread */
+			std::size_t maxAutomations = 256;
+
+			/** The number of PCM frames between each evaluation of the
+			 * running automations */
+			uint32_t automationBlockSize = 32;
+
+			/** If the 3D Sounds must be spatialized all together with SIMD
+			 * instructions instead of one by one by miniaudio. It's faster
+			 * with large numbers of Sounds */
+			bool batchSpatialization = false;
+
+			/** The maximum number of Sounds spatialized in batch, the ones
+			 * that don't fit are spatialized by miniaudio */
+			std::size_t maxBatchVoices = 4096;
+
+			/** If it's greater than 0, the spatialized Sounds are encoded to
+			 * an ambisonic bus of the given order (up to 3) that is decoded
+			 * once to the output channels, so the cost doesn't grow with the
+			 * number of Sounds times the number of channels. It uses the
+			 * batch spatialization even if @see batchSpatialization is
+			 * false */
+			std::size_t ambisonicOrder = 0;
+
+			/** If it isn't nullptr, the spatialized Sounds are rendered
+			 * binaurally by convolving them with the HRIRs of the given
+			 * Hrtf. It's only used with stereo outputs and it has priority
+			 * over @see ambisonicOrder. It uses the batch spatialization
+			 * even if @see batchSpatialization is false. The Hrtf must
+			 * outlive the AudioEngine */
+			const Hrtf* hrtf = nullptr;
+
+			/** The maximum number of Sounds rendered binaurally, the ones
+			 * that don't fit are spatialized by miniaudio */
+			std::size_t maxHrtfVoices = 64;
+
+			/** The number of frames of the HRTF convolution blocks, it
+			 * must be a power of two. The binaural Sounds are delayed by
+			 * it */
+			std::size_t hrtfBlockSize = 128;
+
+			/** The number of worker threads used for rendering the Sounds
+			 * in parallel with the audio thread, 0 to render them only
+			 * with the audio thread */
+			std::size_t numRenderThreads = 0;
+
+			/** The number of groups in which the Sounds are distributed
+			 * when they are rendered in parallel. Using more lanes than
+			 * threads balances better the work between the threads */
+			std::size_t numRenderLanes = 16;
+		};
+
+		/**
+		 * Class ScheduleBatch, it holds a group of Sound commands scheduled
+		 * at PCM frames of the Engine, that are committed atomically with
+		 * @see AudioEngine::commit. The Engine applies them at their exact
+		 * frame inside the rendered blocks
+		 *
+		 * @note	the Sounds are identified by their handles, so a batch can
+		 *			outlive the Sounds of its commands. The commands of the
+		 *			Sounds destroyed or binded to an IDataSource with another
+		 *			format are cancelled, including the ones of batches
+		 *			committed after that
+		 */
+		class ScheduleBatch
+		{
+		public:		// Nested types
+			friend class AudioEngine;
+
+			/** A scheduled command of a Sound */
+			struct Command
+			{
+				enum class Type : int { Start, Stop, Seek, Automate };
+
+				/** The type of the command */
+				Type type = Type::Start;
+
+				/** The handle of the Sound to apply the command to */
+				Sound::Handle soundHandle = 0;
+
+				/** The sound to apply the command to, resolved from
+				 * @see soundHandle by the Engine when it's committed */
+				ma_sound* sound = nullptr;
+
+				/** The index of the miniaudio engine that renders
+				 * @see sound, resolved with it */
+				std::size_t engineIndex = 0;
+
+				/** The time of the Engine in PCM frames when the command
+				 * must be applied */
+				uint64_t frame = 0;
+
+				/** The PCM frame of the Sound to move to (Seek only) */
+				uint64_t seekFrame = 0;
+
+				/** The parameter to automate (Automate only) */
+				AutomationParameter parameter = AutomationParameter::Volume;
+			};
+
+			/** The curve followed by the parameter of an Automate command.
+			 * The curves are stored apart from the commands, in the same
+			 * order than the Automate commands */
+			struct AutomationCurve
+			{
+				AutomationPoint points[kMaxAutomationPoints];
+				std::size_t numPoints = 0;
+			};
+
+		private:	// Attributes
+			/** The commands of the batch */
+			std::vector<Command> mCommands;
+
+			/** The curves of the Automate commands of the batch */
+			std::vector<AutomationCurve> mCurves;
+
+		public:		// Functions
+			/** Schedules the start of the given Sound
+			 *
+			 * @param	sound the Sound to start
+			 * @param	frame the time of the Engine in PCM frames when the
+			 *			Sound must start
+			 * @return	a reference to the current ScheduleBatch */
+			ScheduleBatch& play(const Sound& sound, uint64_t frame);
+
+			/** Schedules the stop of the given Sound
+			 *
+			 * @param	sound the Sound to stop, it must be started before
+			 *			reaching the frame
+			 * @param	frame the time of the Engine in PCM frames when the
+			 *			Sound must stop
+			 * @return	a reference to the current ScheduleBatch */
+			ScheduleBatch& stop(const Sound& sound, uint64_t frame);
+
+			/** Schedules the move of the given Sound to another frame
+			 *
+			 * @param	sound the Sound to move
+			 * @param	frame the time of the Engine in PCM frames when the
+			 *			Sound must be moved
+			 * @param	seekFrame the frame of the Sound to move to
+			 * @return	a reference to the current ScheduleBatch */
+			ScheduleBatch& setToPCMFrame(
+				const Sound& sound, uint64_t frame, uint64_t seekFrame
+			);
+
+			/** Schedules an automation of a parameter of the given Sound.
+			 * The parameter will follow the given curve starting from its
+			 * value at the start frame. It replaces any other automation
+			 * of the same parameter
+			 *
+			 * @param	sound the Sound to automate
+			 * @param	parameter the parameter to automate
+			 * @param	frame the time of the Engine in PCM frames when the
+			 *			automation must start
+			 * @param	points a pointer to the AutomationPoints of the
+			 *			curve, sorted by frame
+			 * @param	numPoints the number of AutomationPoints, at most
+			 *			@see kMaxAutomationPoints
+			 * @return	a reference to the current ScheduleBatch */
+			ScheduleBatch& automate(
+				const Sound& sound, AutomationParameter parameter, uint64_t frame,
+				const AutomationPoint* points, std::size_t numPoints
+			);
+
+			/** Removes all the commands of the ScheduleBatch */
+			void clear();
 		};
 	private:
 		struct MaVFS;
+		struct OutputConverter;
+		struct DeviceOutput;
 
 	private:	// Attributes
 		/** The id of the single listener in @see mEngine */
 		static constexpr unsigned int kListenerIndex = 0;
 
-		/** The device used by the engine */
-		Device& mDevice;
+		/** The index of @see mEngine in @see mEngines, the lane engines of
+		 * @see mRenderer follow it */
+		static constexpr std::size_t kMainEngineIndex = 0;
+
+		/** A pointer to the Context of the engine, it can be nullptr if the
+		 * engine renders offline */
+		Context* mContext;
+
+		/** A pointer to the device used by the engine, nullptr if the engine
+		 * renders offline */
+		Device* mDevice;
 
 		/** A pointer to the ResourceManager */
-		std::unique_ptr<ma_resource_manager> mResourceManager;
+		std::unique_ptr<ma_resource_manager, ObjectDeleter> mResourceManager;
 
 		/** A pointer to the Engine */
-		std::unique_ptr<ma_engine> mEngine;
+		std::unique_ptr<ma_engine, ObjectDeleter> mEngine;
 
 		/** The virtual file system to use (the actual OS FS by default) */
 		std::unique_ptr<MaVFS> mVFS;
 
+		/** The profiler used for measuring the render times of the Engine */
+		std::unique_ptr<CallbackProfiler> mCallbackProfiler;
+
+		/** Sends the Engine output to @see mDevice, nullptr if the engine
+		 * renders offline */
+		std::unique_ptr<DeviceOutput> mOutput;
+
+		/** The SoundEvents generated by the audio thread, waiting to be
+		 * polled */
+		std::unique_ptr<SoundEventQueue> mSoundEvents;
+
+		/** The Handle that will be assigned to the next Sound */
+		std::atomic<uint64_t> mNextSoundHandle;
+
+		/** Applies the scheduled commands in the audio thread */
+		std::unique_ptr<SoundScheduler> mScheduler;
+
+		/** Spatializes the Sounds in batch, nullptr if the batch
+		 * spatialization is disabled */
+		std::unique_ptr<BatchSpatializer> mBatchSpatializer;
+
+		/** Renders the Sounds with multiple threads, nullptr if the
+		 * parallel render is disabled */
+		std::unique_ptr<ParallelRenderer> mRenderer;
+
+		/** All the miniaudio engines that render the Sounds, the Listener
+		 * properties are set in all of them */
+		std::vector<ma_engine*> mEngines;
+
+		/** The IEffects applied to the Engine output */
+		std::unique_ptr<EffectChain> mMasterEffects;
+
 	public:		// Functions
 		/** Creates a new AudioEngine
 		 *
-		 * @param	device the device that will be used by the AudioEngine
+		 * @param	device the device that will be used by the AudioEngine,
+		 *			the AudioEngine will use its Context
 		 * @param	config the parameters of the new AudioEngine */
 		AudioEngine(Device& device, const Config& config);
 
+		/** Creates a new AudioEngine without any Device. The audio must be
+		 * pulled manually with @see render, so it can be rendered as fast
+		 * as the CPU allows
+		 *
+		 * @param	context the Context used for logging
+		 * @param	config the parameters of the new AudioEngine */
+		AudioEngine(Context& context, const Config& config);
+
+		/** Creates a new AudioEngine without any Device that uses the
+		 * default Context, if it was started
+		 * @see AudioEngine(Context&, const Config&)
+		 *
+		 * @param	config the parameters of the new AudioEngine */
+		AudioEngine(const Config& config);
+
 		/** Class destructor */
 		~AudioEngine();
 
@@ -79,12 +342,67 @@ namespace saudio {
 		 *			false otherwise */
 		bool good();
 
-		/** @return	the Device used by the Engine */
-		Device& getDevice() const;
+		/** @return	a pointer to the Context of the Engine, it can be
+		 *			nullptr if it was created without a Device */
+		Context* getContext() const;
+
+		/** @return	a pointer to the Device used by the Engine, nullptr if
+		 *			it was created without a Device */
+		Device* getDevice() const;
+
+		/** Changes the Device used by the Engine. The output is crossfaded
+		 * between the old Device and the new one, the loaded resources and
+		 * the playing Sounds are preserved
+		 *
+		 * @param	device the new Device of the Engine, it must have been
+		 *			created with the Context of the Engine. If its channels
+		 *			or sample rate don't match the Engine ones, the output
+		 *			will be converted
+		 * @return	true on success, false otherwise. On failure the Engine
+		 *			keeps using the old Device
+		 * @note	it blocks until the crossfade finishes. The new Device
+		 *			starts fading in once it has buffered enough frames from
+		 *			the old one, so its output is delayed by about one fade
+		 *			plus one of its periods
+		 * @note	the Engine channels and sample rate can't change, they are
+		 *			the ones of the first Device (or the Config ones if it was
+		 *			created without a Device) */
+		bool setDevice(Device& device);
 
 		/** @return	a pointer to the miniaudio engine of the AudioEngine */
 		ma_engine* getMAEngine() const;
 
+		/** @return	the number of channels of the audio rendered by the
+		 *			Engine */
+		uint32_t getChannels() const;
+
+		/** @return	the sample rate of the audio rendered by the Engine */
+		uint32_t getSampleRate() const;
+
+		/** @return	the time of the Engine in PCM frames, it's the number of
+		 *			frames rendered since its creation */
+		uint64_t getTimeInPCMFrames() const;
+
+		/** Converts the given time to PCM frames of the Engine
+		 *
+		 * @param	milliseconds the time to convert
+		 * @return	the number of frames of the time */
+		uint64_t millisecondsToPCMFrames(uint64_t milliseconds) const;
+
+		/** Commits the given ScheduleBatch, the audio thread will see all
+		 * its commands at once. The commands whose frame has already passed
+		 * are applied at the start of the next block
+		 *
+		 * @param	batch the ScheduleBatch to commit
+		 * @return	true on success, false if there isn't enough space for
+		 *			the commands
+		 * @note	the commands are passed to the audio thread through a
+		 *			single consumer queue whose producers are serialized
+		 *			with a mutex, so it can be called from any thread but it
+		 *			can block while other thread commits or a Sound is
+		 *			destroyed */
+		bool commit(const ScheduleBatch& batch);
+
 		/** @return	the 3D position of the current Listener */
 		glm::vec3 getListenerPosition() const;
 
@@ -153,10 +471,111 @@ namespace saudio {
 		 * @return	a reference to the current AudioEngine object */
 		AudioEngine& setListenerVelocity(const glm::vec3& velocity);
 
-		/** @copydoc saudio::AudioEngine::onDeviceData() */
-		virtual void onDeviceData(
-			void* output, const void* input, unsigned int frameCount
-		) override;
+		/** @return	a snapshot of the render times of the Engine against the
+		 *			duration of the rendered frames. It can be called from
+		 *			any thread */
+		CallbackStats getCallbackStats() const;
+
+		/** Clears the render times of the Engine */
+		void resetCallbackStats();
+
+		/** Pops the oldest SoundEvent generated by the Sounds of the Engine.
+		 * It's meant to be called in a loop once per frame, so the cost
+		 * depends on the number of events instead of the number of Sounds
+		 *
+		 * @param	event a reference to the SoundEvent where the event will
+		 *			be stored
+		 * @return	true if an event was popped, false if there are no more
+		 *			events
+		 * @note	it must be called always from the same thread */
+		bool pollSoundEvent(SoundEvent& event);
+
+		/** @return	the number of SoundEvents dropped because the queue was
+		 *			full since the last call */
+		uint64_t takeNumDroppedSoundEvents();
+
+		/** Appends the given IEffect to the end of the chain applied to the
+		 * output of the Engine, after all the Sounds and render lanes are
+		 * mixed, ie. a PeakLimiter
+		 *
+		 * @param	effect the IEffect to add, it must outlive the
+		 *			AudioEngine or be removed from it before being destroyed
+		 * @return	true on success, false if the chain is full */
+		bool addMasterEffect(IEffect& effect);
+
+		/** Removes the given IEffect from the output of the Engine. Once it
+		 * returns the audio thread doesn't use the IEffect anymore
+		 *
+		 * @param	effect the IEffect to remove
+		 * @return	true if the IEffect was removed, false if it wasn't
+		 *			found */
+		bool removeMasterEffect(IEffect& effect);
+
+		/** Renders the next audio frames of the Engine
+		 *
+		 * @param	output a pointer to the buffer where the interleaved f32
+		 *			frames will be written. It must have space for at least
+		 *			frameCount * @see getChannels samples
+		 * @param	frameCount the number of frames to render
+		 * @return	the number of frames rendered
+		 * @note	it can only be used if the AudioEngine was created without
+		 *			a Device */
+		unsigned int render(float* output, unsigned int frameCount);
+	private:
+		/** Creates the miniaudio ResourceManager and Engine
+		 *
+		 * @param	config the parameters of the AudioEngine
+		 * @return	true on success, false otherwise */
+		bool initInternal(const Config& config);
+
+		/** Commits the given scheduled commands
+		 * @see commit(const ScheduleBatch&)
+		 *
+		 * @param	commands a pointer to the commands
+		 * @param	count the number of commands
+		 * @param	curves a pointer to the curves of the Automate commands
+		 * @param	numCurves the number of curves, it must be the number of
+		 *			Automate commands
+		 * @return	true on success, false otherwise */
+		bool commit(
+			const ScheduleBatch::Command* commands, std::size_t count,
+			const ScheduleBatch::AutomationCurve* curves, std::size_t numCurves
+		);
+
+		/** Reads the given number of frames from the Engine, applying the
+		 * scheduled commands at their frame
+		 *
+		 * @param	output a pointer to the buffer where the frames will be
+		 *			written
+		 * @param	frameCount the number of frames to read */
+		void readEngineFrames(float* output, uint64_t frameCount);
+
+		/** @return	the miniaudio engine used for creating a new Sound, if
+		 *			the parallel render is enabled it's the one of the
+		 *			lane with less Sounds */
+		ma_engine* selectSoundEngine() const;
+
+		/** Returns the batch spatializer of the given engine
+		 *
+		 * @param	engine a pointer to one of the miniaudio engines of
+		 *			@see mEngines
+		 * @return	the spatializer, nullptr if the batch spatialization is
+		 *			disabled */
+		BatchSpatializer* getBatchSpatializer(ma_engine* engine) const;
+
+		/** Returns the index of the given engine
+		 *
+		 * @param	engine a pointer to one of the miniaudio engines of
+		 *			@see mEngines
+		 * @return	the index of the engine in @see mEngines */
+		std::size_t getEngineIndex(ma_engine* engine) const;
+
+		/** The callback called by miniaudio when a Sound reaches its end
+		 *
+		 * @param	pUserData a pointer to the Sound::EndCallbackData of the
+		 *			Sound
+		 * @param	pSound a pointer to the sound that reached its end */
+		static void onMASoundEnd(void* pUserData, ma_sound* pSound);
 	};
 
 }
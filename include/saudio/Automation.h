@@ -0,0 +1,40 @@
+#ifndef SAUDIO_AUTOMATION_H
+#define SAUDIO_AUTOMATION_H
+
+#include <cstdint>
+#include <glm/glm.hpp>
+
+namespace saudio {
+
+	/** The Sound parameters that can be automated */
+	enum class AutomationParameter : int
+	{
+		Volume,
+		Pitch,
+		Position
+	};
+
+
+	/** The maximum number of AutomationPoints of each automation */
+	static constexpr std::size_t kMaxAutomationPoints = 8;
+
+
+	/**
+	 * Struct AutomationPoint, it's a breakpoint of the curve followed by an
+	 * automated Sound parameter. The parameter is linearly interpolated
+	 * between the consecutive AutomationPoints
+	 */
+	struct AutomationPoint
+	{
+		/** The number of PCM frames from the start of the automation until
+		 * the parameter reaches the value */
+		uint64_t frame = 0;
+
+		/** The value of the parameter. The scalar parameters only use its
+		 * first component */
+		glm::vec3 value = glm::vec3(0.0f);
+	};
+
+}
+
+#endif		// SAUDIO_AUTOMATION_H
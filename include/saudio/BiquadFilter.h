@@ -0,0 +1,120 @@
+#ifndef SAUDIO_BIQUAD_FILTER_H
+#define SAUDIO_BIQUAD_FILTER_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include "IEffect.h"
+
+namespace saudio {
+
+	class AudioEngine;
+	struct BiquadCoefficients;
+
+
+	/**
+	 * Class BiquadFilter, it's an IEffect that filters the frames with a
+	 * cascade of biquad stages, ie. for building an equalizer or steep
+	 * lowpass and highpass filters. The frames are filtered with SIMD
+	 * instructions, several channels or several frames at the same time
+	 * depending on the number of channels. The stages can be changed from
+	 * any thread, their coefficients are recomputed by the audio thread
+	 * before the next processed frames.
+	 */
+	class BiquadFilter : public IEffect
+	{
+	public:		// Nested types
+		/** The maximum number of stages of a BiquadFilter */
+		static constexpr std::size_t kMaxStages = 8;
+
+		/** The response of a stage */
+		enum class Type : int
+		{
+			LowPass, HighPass, BandPass, Notch, Peaking, LowShelf, HighShelf
+		};
+
+	private:
+		/** The parameters of a stage */
+		struct Stage
+		{
+			std::atomic<int> type;
+			std::atomic<float> frequency, q, gainDB;
+		};
+
+	private:	// Attributes
+		/** The sample rate of the filtered frames */
+		float mSampleRate;
+
+		/** The maximum number of channels that can be filtered */
+		std::size_t mNumChannels;
+
+		/** The number of stages of the filter */
+		std::size_t mNumStages;
+
+		/** The parameters of each stage */
+		Stage mStages[kMaxStages];
+
+		/** Incremented each time that the parameters of a stage change */
+		std::atomic<uint32_t> mVersion;
+
+		/** The version of the parameters used for computing
+		 * @see mCoefficients, only used by the audio thread */
+		uint32_t mAppliedVersion;
+
+		/** The coefficients of each stage */
+		std::unique_ptr<BiquadCoefficients[]> mCoefficients;
+
+		/** The state of each stage and channel */
+		std::vector<float> mState;
+
+	public:		// Functions
+		/** Creates a new BiquadFilter, all its stages pass the frames
+		 * unmodified until they are set with @see setStage
+		 *
+		 * @param	engine the AudioEngine whose sample rate and channels will
+		 *			be used
+		 * @param	numStages the number of stages of the filter, up to
+		 *			@see kMaxStages */
+		BiquadFilter(AudioEngine& engine, std::size_t numStages = 1);
+		BiquadFilter(const BiquadFilter& other) = delete;
+		BiquadFilter(BiquadFilter&& other) = delete;
+
+		/** Class destructor */
+		~BiquadFilter();
+
+		/** Assignment operator */
+		BiquadFilter& operator=(const BiquadFilter& other) = delete;
+		BiquadFilter& operator=(BiquadFilter&& other) = delete;
+
+		/** @return	the number of stages of the filter */
+		std::size_t getNumStages() const;
+
+		/** Sets the response of the given stage
+		 *
+		 * @param	stage the index of the stage
+		 * @param	type the response of the stage
+		 * @param	frequency the cutoff or center frequency in Hz, it's
+		 *			clamped below the Nyquist frequency
+		 * @param	q the quality factor of the stage, 0.7071 for a
+		 *			Butterworth response
+		 * @param	gainDB the gain in decibels, only used by the Peaking,
+		 *			LowShelf and HighShelf types
+		 * @return	true on success, false if the stage doesn't exist */
+		bool setStage(
+			std::size_t stage, Type type, float frequency,
+			float q = 0.7071f, float gainDB = 0.0f
+		);
+
+		/** @copydoc IEffect::process()
+		 * @note	the frames are left unmodified if they have more channels
+		 *			than the AudioEngine */
+		virtual void process(float* frames, std::size_t numFrames, std::size_t numChannels) override;
+	private:
+		/** Computes @see mCoefficients from the parameters of the stages */
+		void updateCoefficients();
+	};
+
+}
+
+#endif		// SAUDIO_BIQUAD_FILTER_H
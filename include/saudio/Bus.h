@@ -0,0 +1,125 @@
+#ifndef SAUDIO_BUS_H
+#define SAUDIO_BUS_H
+
+#include <memory>
+#include "Allocator.h"
+
+struct ma_engine;
+
+namespace saudio {
+
+	class Context;
+	class IEffect;
+	class AudioEngine;
+	class EffectChain;
+	struct BusNode;
+
+
+	/**
+	 * Class Bus, it mixes the Sounds attached to it and processes the
+	 * result with a chain of IEffects, before sending it to the output of
+	 * the AudioEngine or to another Bus. The IEffects can be added and
+	 * removed while the AudioEngine is playing.
+	 *
+	 * @note	the Bus is rendered by the audio thread, so with parallel
+	 *			rendering the Sounds must be created with the Bus constructor
+	 *			of the Sound to be attached to it. The Bus must outlive the
+	 *			Sounds and Buses attached to it
+	 */
+	class Bus
+	{
+	public:		// Nested types
+		friend class Sound;
+		friend struct BusNode;
+
+	private:	// Attributes
+		/** A pointer to the Context of the AudioEngine, used for logging
+		 * and for allocating the node */
+		const Context* mContext;
+
+		/** The AudioEngine that renders the Bus */
+		AudioEngine* mAudioEngine;
+
+		/** The miniaudio engine where the node of the Bus is added */
+		ma_engine* mEngine;
+
+		/** The number of channels of the Bus */
+		std::size_t mNumChannels;
+
+		/** The miniaudio node of the Bus */
+		std::unique_ptr<BusNode, ObjectDeleter> mNode;
+
+		/** If @see mNode was initialized */
+		bool mNodeInitialized;
+
+		/** The IEffects that process the mixed frames */
+		std::unique_ptr<EffectChain> mEffectChain;
+
+	public:		// Functions
+		/** Creates a new Bus and attaches it to the output of the given
+		 * AudioEngine
+		 *
+		 * @param	audioEngine the AudioEngine that will render the Bus */
+		Bus(AudioEngine& audioEngine);
+		Bus(const Bus& other) = delete;
+		Bus(Bus&& other) = delete;
+
+		/** Class destructor */
+		~Bus();
+
+		/** Assignment operator */
+		Bus& operator=(const Bus& other) = delete;
+		Bus& operator=(Bus&& other) = delete;
+
+		/** @return	true if the Bus was created successfully, false
+		 *			otherwise */
+		bool good() const;
+
+		/** @return	the number of channels of the Bus */
+		std::size_t getChannels() const;
+
+		/** @return	the volume of the Bus */
+		float getVolume() const;
+
+		/** Sets the volume of the Bus
+		 *
+		 * @param	volume the new volume of the Bus
+		 * @return	a reference to the current Bus object */
+		Bus& setVolume(float volume);
+
+		/** Sends the output of the Bus to the given one
+		 *
+		 * @param	output a pointer to the Bus where the output will be
+		 *			sent, nullptr for sending it to the AudioEngine output.
+		 *			It must be rendered by the same AudioEngine
+		 * @return	true on success, false otherwise */
+		bool setOutput(Bus* output);
+
+		/** Appends the given IEffect to the end of the chain of the Bus
+		 *
+		 * @param	effect the IEffect to add, it must outlive the Bus or be
+		 *			removed from it before being destroyed
+		 * @return	true on success, false if the chain is full (see
+		 *			EffectChain::kMaxEffects) */
+		bool addEffect(IEffect& effect);
+
+		/** Removes the given IEffect from the chain of the Bus. Once it
+		 * returns the audio thread doesn't use the IEffect anymore
+		 *
+		 * @param	effect the IEffect to remove
+		 * @return	true if the IEffect was removed, false if it wasn't
+		 *			found */
+		bool removeEffect(IEffect& effect);
+	private:
+		/** Creates a new Bus in the given miniaudio engine and attaches it
+		 * to its endpoint
+		 *
+		 * @param	audioEngine the AudioEngine that will render the Bus
+		 * @param	engine the miniaudio engine of the AudioEngine where the
+		 *			Bus will be added, ie. the one of a render lane */
+		Bus(AudioEngine& audioEngine, ma_engine* engine);
+	};
+
+}
+
+#endif		// SAUDIO_BUS_H
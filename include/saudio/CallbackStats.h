@@ -0,0 +1,49 @@
+#ifndef SAUDIO_CALLBACK_STATS_H
+#define SAUDIO_CALLBACK_STATS_H
+
+#include <array>
+#include <cstdint>
+
+namespace saudio {
+
+	/**
+	 * Struct CallbackStats, holds a snapshot of the timings of an audio
+	 * callback measured against its period budget (the time that the
+	 * frames requested by the callback last when they are played)
+	 */
+	struct CallbackStats
+	{
+		/** The number of buckets of the load histogram */
+		static constexpr std::size_t kNumBuckets = 16;
+
+		/** The load range covered by each bucket of the load histogram, the
+		 * last bucket also stores all the loads above its range */
+		static constexpr float kBucketLoad = 0.125f;
+
+		/** The number of callbacks measured since the last reset */
+		uint64_t numCallbacks = 0;
+
+		/** The number of callbacks that took longer than their budget */
+		uint64_t numDeadlineMisses = 0;
+
+		/** The duration in nanoseconds of the last callback */
+		uint64_t lastDurationNs = 0;
+
+		/** The budget in nanoseconds of the last callback */
+		uint64_t lastBudgetNs = 0;
+
+		/** The duration in nanoseconds of the slowest callback */
+		uint64_t worstDurationNs = 0;
+
+		/** The highest duration/budget ratio of all the callbacks */
+		float worstLoad = 0.0f;
+
+		/** The number of callbacks in each load range, where the load is the
+		 * duration/budget ratio of the callback. Bucket i holds the loads in
+		 * [i * kBucketLoad, (i + 1) * kBucketLoad) */
+		std::array<uint64_t, kNumBuckets> loadHistogram = {};
+	};
+
+}
+
+#endif		// SAUDIO_CALLBACK_STATS_H
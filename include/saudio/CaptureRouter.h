@@ -0,0 +1,76 @@
+#ifndef SAUDIO_CAPTURE_ROUTER_H
+#define SAUDIO_CAPTURE_ROUTER_H
+
+#include "Device.h"
+
+namespace saudio {
+
+	class StreamDataSource;
+
+
+	/**
+	 * Class CaptureRouter, it pushes the frames captured by a capture or
+	 * duplex Device to a StreamDataSource, so they can be played with a
+	 * Sound. The frames are copied from the Device buffer directly to the
+	 * StreamDataSource ring buffer in the audio thread.
+	 *
+	 * @note	with duplex Devices, if the CaptureRouter is added before the
+	 *			AudioEngines of the Device, the captured frames can be played
+	 *			in the same Device callback
+	 */
+	class CaptureRouter : public Device::IDeviceDataListener
+	{
+	private:	// Attributes
+		/** The Device that captures the frames */
+		Device& mDevice;
+
+		/** The StreamDataSource where the captured frames will be pushed */
+		StreamDataSource& mStreamDataSource;
+
+		/** If the CaptureRouter was added to @see mDevice */
+		bool mGood;
+
+	public:		// Functions
+		/** Creates a new CaptureRouter. The StreamDataSource must already
+		 * have the capture format of the Device, @see configure
+		 *
+		 * @param	device the capture or duplex Device that captures the
+		 *			frames
+		 * @param	streamDataSource the StreamDataSource where the captured
+		 *			frames will be pushed. It must be created with enough
+		 *			buffered samples for holding a couple of Device periods */
+		CaptureRouter(Device& device, StreamDataSource& streamDataSource);
+		CaptureRouter(const CaptureRouter& other) = delete;
+		CaptureRouter(CaptureRouter&& other) = delete;
+
+		/** Class destructor */
+		~CaptureRouter();
+
+		/** Assignment operator */
+		CaptureRouter& operator=(const CaptureRouter& other) = delete;
+		CaptureRouter& operator=(CaptureRouter&& other) = delete;
+
+		/** @return	true if the CaptureRouter was created successfully,
+		 *			false otherwise */
+		bool good() const;
+
+		/** Changes the format of the given StreamDataSource to the capture
+		 * one of the given Device
+		 *
+		 * @param	device the capture or duplex Device
+		 * @param	streamDataSource the StreamDataSource to configure
+		 * @return	true on success, false otherwise
+		 * @note	the format setters clear the StreamDataSource ring buffer,
+		 *			so it must be called before binding the StreamDataSource
+		 *			to any Sound */
+		static bool configure(Device& device, StreamDataSource& streamDataSource);
+
+		/** @copydoc Device::IDeviceDataListener::onDeviceData() */
+		virtual void onDeviceData(
+			void* output, const void* input, unsigned int frameCount
+		) override;
+	};
+
+}
+
+#endif		// SAUDIO_CAPTURE_ROUTER_H
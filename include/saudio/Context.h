@@ -1,16 +1,33 @@
 #ifndef SAUDIO_CONTEXT_H
 #define SAUDIO_CONTEXT_H
 
+#include <vector>
+#include <memory>
 #include "Constants.h"
+#include "Allocator.h"
 
 struct ma_context;
 
 namespace saudio {
 
+	class DeviceRegistry;
+
+
+	/** The different log levels, each one includes the previous ones */
+	enum class LogLevel : int { Error = 0, Warning, Info, Debug };
+
+
 	/**
 	 * Class LogHandler, it's the class that must be inherited from if someone
 	 * wants to print the audio traces. The default behavior is to
 	 * not do anything with the traces.
+	 *
+	 * @note	the traces generated inside the audio callbacks and by
+	 *			miniaudio are passed to the LogHandler from a background
+	 *			thread of the Context, the other ones from the thread that
+	 *			generates them. The Context serializes the calls, so the
+	 *			functions are never called concurrently, and the queued
+	 *			traces are passed before any newer one
 	 */
 	class LogHandler
 	{
@@ -47,6 +64,25 @@ namespace saudio {
 	class Context
 	{
 	public:		// Nested types
+		/** The audio backends that the Context can use */
+		enum class Backend
+		{
+			WASAPI,
+			DirectSound,
+			WinMM,
+			CoreAudio,
+			sndio,
+			audio4,
+			OSS,
+			PulseAudio,
+			ALSA,
+			JACK,
+			AAudio,
+			OpenSL,
+			WebAudio,
+			Null
+		};
+
 		/** Struct Config, holds all the parameters needed for
 		 * initializing the Context */
 		struct Config
@@ -57,37 +93,146 @@ namespace saudio {
 			/** A pointer to the LogHandler that will be used for printing logs
 			 * by the Context */
 			LogHandler* logHandler = &sDefaultLogHandler;
+
+			/** The maximum level of the logs passed to @see logHandler, the
+			 * messages of the other levels aren't even formatted */
+			LogLevel logLevel = LogLevel::Debug;
+
+			/** The maximum number of traces that can be waiting to be
+			 * passed to @see logHandler from the background thread */
+			std::size_t logQueueSize = 256;
+
+			/** The default Allocator */
+			static Allocator sDefaultAllocator;
+
+			/** The Allocators used for each AllocationCategory, indexed by
+			 * the category */
+			Allocator* allocators[kNumAllocationCategories] = {
+				&sDefaultAllocator, &sDefaultAllocator,
+				&sDefaultAllocator, &sDefaultAllocator
+			};
+
+			/** The backends to try in order of preference. If it's empty all
+			 * the backends will be tried in the default order. Limiting it
+			 * to the backends the application needs reduces the startup
+			 * time */
+			std::vector<Backend> backends;
 		};
 	private:
 		struct Impl;
 
 	private:	// Attributes
-		/** A pointer to the single instance that holds all the implementation
-		 * details of the Context */
-		static Impl* sImpl;
+		/** A pointer to the Context created with @see start */
+		static Context* sDefault;
+
+		/** The object that holds all the implementation details of the
+		 * Context */
+		std::unique_ptr<Impl> mImpl;
 
 	public:		// Functions
-		/** @return	true if the Context was successfully started with
-		 *			@see start, false otherwise */
-		static bool good();
+		/** Creates a new Context. Each Context has its own devices and logs,
+		 * so multiple independent Contexts can be used at the same time from
+		 * different threads
+		 *
+		 * @param	config the parameters of the Context */
+		Context(const Config& config);
+		Context(const Context& other) = delete;
+		Context(Context&& other) = delete;
+
+		/** Class destructor. All the Devices and AudioEngines created with
+		 * the Context must be destroyed before it */
+		~Context();
+
+		/** Assignment operator */
+		Context& operator=(const Context& other) = delete;
+		Context& operator=(Context&& other) = delete;
+
+		/** @return	true if the Context was successfully created, false
+		 *			otherwise */
+		bool good() const;
 
 		/** @return	a pointer to the LogHandler of the Context, if available */
-		static LogHandler* getLogHandler();
+		LogHandler* getLogHandler() const;
+
+		/** @return	the maximum level of the logs passed to the
+		 *			LogHandler */
+		LogLevel getLogLevel() const;
+
+		/** Sets the maximum level of the logs passed to the LogHandler. It
+		 * can be called from any thread
+		 *
+		 * @param	logLevel the new maximum log level */
+		void setLogLevel(LogLevel logLevel);
+
+		/** @param	logLevel the level to check
+		 * @return	true if the logs of the given level are passed to the
+		 *			LogHandler, false otherwise */
+		bool isLogEnabled(LogLevel logLevel) const;
+
+		/** Passes the given trace to the LogHandler. If it's called inside
+		 * an audio callback the trace is queued without locking, and it
+		 * will be passed to the LogHandler from a background thread
+		 *
+		 * @param	logLevel the level of the trace
+		 * @param	str the trace string to log */
+		void log(LogLevel logLevel, const char* str) const;
 
 		/** @return	a pointer to the miniaudio logger, if available */
-		static void* getMALog();
+		void* getMALog() const;
 
 		/** @return	a pointer to the miniaudio Context, if available */
-		static ma_context* getMAContext();
+		ma_context* getMAContext() const;
+
+		/** @return	a pointer to the DeviceRegistry that caches the devices
+		 *			of the Context, if available */
+		DeviceRegistry* getDeviceRegistry() const;
+
+		/** Allocates memory with the Allocator of the given category
+		 *
+		 * @param	size the number of bytes to allocate
+		 * @param	category the AllocationCategory of the memory
+		 * @return	a pointer to the allocated memory, nullptr on failure */
+		void* allocate(std::size_t size, AllocationCategory category) const;
 
-		/** Initializes the Context
+		/** Reallocates memory with the Allocator of the given category
+		 *
+		 * @param	ptr a pointer to the memory to reallocate
+		 * @param	size the new number of bytes
+		 * @param	category the AllocationCategory of the memory
+		 * @return	a pointer to the reallocated memory, nullptr on
+		 *			failure */
+		void* reallocate(
+			void* ptr, std::size_t size, AllocationCategory category
+		) const;
+
+		/** Releases memory with the Allocator of the given category
+		 *
+		 * @param	ptr a pointer to the memory to release
+		 * @param	category the AllocationCategory of the memory */
+		void deallocate(void* ptr, AllocationCategory category) const;
+
+		/** @param	category the AllocationCategory of the callbacks
+		 * @return	a pointer to the miniaudio allocation callbacks that use
+		 *			the Allocator of the given category */
+		const void* getMAAllocationCallbacks(AllocationCategory category) const;
+
+		/** @param	category the AllocationCategory to check
+		 * @return	the number of allocations done by the Context in the
+		 *			given category. It can be called from any thread */
+		AllocationStats getAllocationStats(AllocationCategory category) const;
+
+		/** @return	a pointer to the default Context created with
+		 *			@see start, nullptr if it wasn't started */
+		static Context* getDefault();
+
+		/** Initializes the default Context, it's used by the Devices and
+		 * AudioEngines created without a Context
 		 *
 		 * @param	config the parameters of the Context
 		 * @return	true on success, false otherwise */
 		static bool start(const Config& config);
 
-		/** Destroys the Context instance and releases all the
-		 * resources */
+		/** Destroys the default Context and releases all the resources */
 		static void stop();
 	};
 
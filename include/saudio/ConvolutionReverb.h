@@ -0,0 +1,111 @@
+#ifndef SAUDIO_CONVOLUTION_REVERB_H
+#define SAUDIO_CONVOLUTION_REVERB_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include "IEffect.h"
+
+namespace saudio {
+
+	class Context;
+	class AudioEngine;
+	class IDataSource;
+	class NonUniformConvolver;
+
+
+	/**
+	 * Class ConvolutionReverb, it's an IEffect that adds the reverberation
+	 * of a room to a Bus by convolving its frames with a measured impulse
+	 * response. The frames are downmixed to mono and convolved with each
+	 * channel of the impulse response, so a stereo impulse response gives
+	 * a stereo reverberation. It uses non-uniformly partitioned convolution:
+	 * the start of the impulse response is convolved in the audio thread
+	 * with small blocks and its tail with larger blocks in a worker thread,
+	 * so long impulse responses can be used without increasing the latency
+	 * nor the cost of the audio callback.
+	 *
+	 * @note	the reverberation is delayed by the block size
+	 */
+	class ConvolutionReverb : public IEffect
+	{
+	private:	// Attributes
+		/** A pointer to the Context used for logging */
+		const Context* mContext;
+
+		/** Convolves the frames with the impulse response */
+		std::unique_ptr<NonUniformConvolver> mConvolver;
+
+		/** The gains of the reverberated and the original frames */
+		std::atomic<float> mWetGain, mDryGain;
+
+		/** The gains applied in the last processed frames, only used by
+		 * the audio thread */
+		float mAppliedWetGain, mAppliedDryGain;
+
+		/** The downmixed frames and the reverberation of each impulse
+		 * response channel */
+		std::vector<float> mMonoFrames, mWetFrames;
+
+	public:		// Functions
+		/** Creates a new ConvolutionReverb
+		 *
+		 * @param	engine the AudioEngine used for loading the IDataSource,
+		 *			ie. with a FileDataSource its decodeSampleRate must be
+		 *			the sample rate of the AudioEngine
+		 * @param	impulseResponse the IDataSource with the impulse
+		 *			response, each channel of the impulse response is used
+		 *			for the Bus channels with the same index modulo its
+		 *			number of channels
+		 * @param	blockSize the number of frames of the blocks convolved in
+		 *			the audio thread, it must be a power of two */
+		ConvolutionReverb(
+			AudioEngine& engine, const IDataSource& impulseResponse,
+			std::size_t blockSize = 128
+		);
+		ConvolutionReverb(const ConvolutionReverb& other) = delete;
+		ConvolutionReverb(ConvolutionReverb&& other) = delete;
+
+		/** Class destructor */
+		~ConvolutionReverb();
+
+		/** Assignment operator */
+		ConvolutionReverb& operator=(const ConvolutionReverb& other) = delete;
+		ConvolutionReverb& operator=(ConvolutionReverb&& other) = delete;
+
+		/** @return	true if the impulse response was loaded, false
+		 *			otherwise */
+		bool good() const;
+
+		/** @return	the gain of the reverberated frames */
+		float getWetGain() const;
+
+		/** Sets the gain of the reverberated frames
+		 *
+		 * @param	gain the new gain
+		 * @return	a reference to the current ConvolutionReverb object */
+		ConvolutionReverb& setWetGain(float gain);
+
+		/** @return	the gain of the original frames */
+		float getDryGain() const;
+
+		/** Sets the gain of the original frames
+		 *
+		 * @param	gain the new gain, 0 for using the ConvolutionReverb as a
+		 *			send effect
+		 * @return	a reference to the current ConvolutionReverb object */
+		ConvolutionReverb& setDryGain(float gain);
+
+		/** @return	the number of tail blocks that the worker thread didn't
+		 *			convolve in time since the last call, their
+		 *			reverberation is dropped */
+		uint64_t takeNumOverruns();
+
+		/** @copydoc IEffect::process() */
+		virtual void process(float* frames, std::size_t numFrames, std::size_t numChannels) override;
+	};
+
+}
+
+#endif		// SAUDIO_CONVOLUTION_REVERB_H
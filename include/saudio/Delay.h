@@ -0,0 +1,129 @@
+#ifndef SAUDIO_DELAY_H
+#define SAUDIO_DELAY_H
+
+#include <atomic>
+#include <vector>
+#include "IEffect.h"
+
+namespace saudio {
+
+	class AudioEngine;
+
+
+	/**
+	 * Class Delay, it's an IEffect that mixes the frames with a delayed
+	 * copy of themselves, ie. for echoes, or for chorus and flanger
+	 * effects when the delay time is modulated. The delay line is read
+	 * with linear interpolation, so the delay time can be fractional and
+	 * it's changed smoothly without clicks. The frames are delayed with
+	 * SIMD instructions.
+	 */
+	class Delay : public IEffect
+	{
+	private:	// Attributes
+		/** The sample rate of the delayed frames */
+		float mSampleRate;
+
+		/** The maximum number of channels that can be delayed */
+		std::size_t mNumChannels;
+
+		/** The maximum delay time in frames */
+		float mMaxDelayFrames;
+
+		/** The delay time in frames */
+		std::atomic<float> mDelayFrames;
+
+		/** The gain of the delayed frames fed back to the delay line */
+		std::atomic<float> mFeedback;
+
+		/** The gains of the delayed and of the original frames */
+		std::atomic<float> mWetGain, mDryGain;
+
+		/** The delay time in frames used in the last processed frames, it
+		 * follows @see mDelayFrames smoothly. Only used by the audio
+		 * thread */
+		float mAppliedDelayFrames;
+
+		/** The gains of the delayed and of the original frames used in the
+		 * last processed frames, they follow @see mWetGain and
+		 * @see mDryGain smoothly. Only used by the audio thread */
+		float mAppliedWetGain, mAppliedDryGain;
+
+		/** The interleaved frames of the delay line */
+		std::vector<float> mBuffer;
+
+		/** The frame of @see mBuffer where the next frame will be
+		 * written */
+		std::size_t mWriteIndex;
+
+	public:		// Functions
+		/** Creates a new Delay
+		 *
+		 * @param	engine the AudioEngine whose sample rate and channels will
+		 *			be used
+		 * @param	maxDelay the maximum delay time in seconds, the memory
+		 *			of the delay line is allocated for it
+		 * @param	delay the initial delay time in seconds */
+		Delay(AudioEngine& engine, float maxDelay = 1.0f, float delay = 0.25f);
+		Delay(const Delay& other) = delete;
+		Delay(Delay&& other) = delete;
+
+		/** Class destructor */
+		~Delay() = default;
+
+		/** Assignment operator */
+		Delay& operator=(const Delay& other) = delete;
+		Delay& operator=(Delay&& other) = delete;
+
+		/** @return	the delay time in seconds */
+		float getDelay() const;
+
+		/** Sets the delay time, the change is smoothed over some
+		 * milliseconds
+		 *
+		 * @param	delay the new delay time in seconds, it's clamped between
+		 *			one frame and the maximum delay time
+		 * @return	a reference to the current Delay object */
+		Delay& setDelay(float delay);
+
+		/** @return	the gain of the delayed frames fed back to the delay
+		 *			line */
+		float getFeedback() const;
+
+		/** Sets the gain of the delayed frames fed back to the delay line
+		 *
+		 * @param	feedback the new gain, from 0 (a single echo) to 1
+		 *			exclusive, it's clamped to keep the Delay stable
+		 * @return	a reference to the current Delay object */
+		Delay& setFeedback(float feedback);
+
+		/** @return	the gain of the delayed frames */
+		float getWetGain() const;
+
+		/** Sets the gain of the delayed frames, the change is smoothed over
+		 * some milliseconds
+		 *
+		 * @param	gain the new gain
+		 * @return	a reference to the current Delay object */
+		Delay& setWetGain(float gain);
+
+		/** @return	the gain of the original frames */
+		float getDryGain() const;
+
+		/** Sets the gain of the original frames, the change is smoothed
+		 * over some milliseconds
+		 *
+		 * @param	gain the new gain, 0 for using the Delay as a send
+		 *			effect
+		 * @return	a reference to the current Delay object */
+		Delay& setDryGain(float gain);
+
+		/** @copydoc IEffect::process()
+		 * @note	the frames are left unmodified if they have more channels
+		 *			than the AudioEngine */
+		virtual void process(float* frames, std::size_t numFrames, std::size_t numChannels) override;
+	};
+
+}
+
+#endif		// SAUDIO_DELAY_H
@@ -1,15 +1,24 @@
 #ifndef SAUDIO_DEVICE_H
 #define SAUDIO_DEVICE_H
 
+#include <mutex>
+#include <atomic>
 #include <memory>
 #include <vector>
 #include <string>
 #include "Constants.h"
+#include "CallbackStats.h"
+#include "Allocator.h"
 
 struct ma_device;
 
 namespace saudio {
 
+	class Context;
+	class CallbackProfiler;
+	struct DitherState;
+
+
 	/**
 	 * Class Device, it's the class used for initializing the
 	 * communications with the Audio device
@@ -17,11 +26,40 @@ namespace saudio {
 	class Device
 	{
 	public:		// Nested types
+		/** The different types of Device */
+		enum class DeviceType
+		{
+			Playback,		///< Output only Device
+			Capture,		///< Input only Device
+			Duplex			///< Input and output Device
+		};
+
+		/** The latency profiles of a Device */
+		enum class PerformanceProfile
+		{
+			LowLatency,		///< Favours low latency over stability
+			Conservative	///< Favours stability over low latency
+		};
+
+		/** The ways in which a Device can be opened */
+		enum class ShareMode
+		{
+			Shared,			///< The device is shared with other applications
+			Exclusive		///< Exclusive access to the device, if supported
+		};
+
 		/** Holds the info about an audio device */
 		struct DeviceInfo
 		{
 			std::string name;	///< The name of the device
 			bool isDefault;		///< If it's the default device or not
+
+			/** If it's a playback or a capture device */
+			DeviceType type = DeviceType::Playback;
+
+			/** The id of the device, it stays the same while the device is
+			 * connected. If it's 0 the device will be searched by its name */
+			uint64_t id = 0;
 		};
 
 		/** Struct Config, holds all the parameters needed for
@@ -31,6 +69,55 @@ namespace saudio {
 			Format decodeFormat = Format::f32;
 			uint32_t decodeChannels = 0;
 			uint32_t decodeSampleRate = 48000;
+
+			/** The format of the captured data, only used by capture and
+			 * duplex Devices */
+			Format captureFormat = Format::f32;
+
+			/** The number of channels of the captured data (0 for using the
+			 * native ones), only used by capture and duplex Devices */
+			uint32_t captureChannels = 0;
+
+			/** The desired size in frames of each period (the frames
+			 * processed by each callback). If it's 0
+			 * @see periodSizeInMilliseconds will be used instead */
+			uint32_t periodSizeInFrames = 0;
+
+			/** The desired size in milliseconds of each period. If it's also
+			 * 0 the backend default size for @see performanceProfile will
+			 * be used */
+			uint32_t periodSizeInMilliseconds = 0;
+
+			/** The desired number of periods of the device buffer, 0 for
+			 * using the backend default */
+			uint32_t periods = 0;
+
+			/** Hints the backend about the latency to use when no period size
+			 * is set */
+			PerformanceProfile performanceProfile = PerformanceProfile::LowLatency;
+
+			/** If the Device should be opened in exclusive mode. If the
+			 * backend doesn't support it, the Device will fallback to
+			 * the shared mode */
+			ShareMode shareMode = ShareMode::Shared;
+		};
+
+		/** Struct NegotiatedConfig, holds the parameters that the backend
+		 * actually used for creating the Device */
+		struct NegotiatedConfig
+		{
+			Format format = Format::Unknown;	///< The backend format
+			uint32_t channels = 0;				///< The backend channels
+			uint32_t sampleRate = 0;			///< The backend sample rate
+			uint32_t periodSizeInFrames = 0;	///< The size of each period
+			uint32_t periods = 0;				///< The number of periods
+			ShareMode shareMode = ShareMode::Shared;	///< The share mode
+
+			/** @return	the duration in milliseconds of a period */
+			float getPeriodSizeInMilliseconds() const
+			{
+				return sampleRate? 1000.0f * periodSizeInFrames / sampleRate : 0.0f;
+			};
 		};
 
 		/** Class IDeviceDataListener, it's the interface that should be
@@ -44,29 +131,106 @@ namespace saudio {
 			/** The function callback used for notifying the listener of new
 			 * Device data
 			 *
-			 * @param	output a pointer to the output data
-			 * @param	input a pointer to the input data
+			 * @param	output a pointer to the output data, an interleaved f32
+			 *			buffer with the channels of the Device that must be
+			 *			fully overwritten. The outputs of all the listeners
+			 *			of a Device are mixed together. It's nullptr with
+			 *			capture Devices
+			 * @param	input a pointer to the input data with the capture
+			 *			format and channels of the Device, nullptr with
+			 *			playback Devices
 			 * @param	frameCount the limit of frames to process */
 			virtual void onDeviceData(
 				void* output, const void* input, unsigned int frameCount
 			) = 0;
 		};
 
+	private:
+		/** The IDeviceDataListeners of a Device. Once published a list is
+		 * never modified, it's replaced with an updated copy instead */
+		using ListenerList = std::vector<IDeviceDataListener*>;
+
 	private:	// Attributes
+		/** A pointer to the Context used for creating the Device */
+		Context* mContext;
+
 		/** A pointer to the Device */
-		std::unique_ptr<ma_device> mDevice;
+		std::unique_ptr<ma_device, ObjectDeleter> mDevice;
 
 		/** The Listeners to notify when data is ready to be delivered to or
-		 * from the device */
-		std::vector<IDeviceDataListener*> mDeviceDataListeners;
+		 * from the device. The audio thread reads it without locks, and the
+		 * replaced lists are only deleted after the callbacks that could be
+		 * reading them have finished */
+		std::atomic<ListenerList*> mDeviceDataListeners;
+
+		/** The mutex used for serializing the updates of
+		 * @see mDeviceDataListeners */
+		std::mutex mListenersMutex;
+
+		/** Incremented at the start and at the end of each Device callback,
+		 * so it's odd while a callback is running */
+		std::atomic<uint64_t> mCallbackSequence;
+
+		/** The number of frames of the buffers used for mixing the outputs
+		 * of the listeners */
+		unsigned int mMixFrames;
+
+		/** The buffer where the outputs of the listeners are mixed */
+		std::vector<float> mMixBuffer;
+
+		/** The buffer where each listener renders its output */
+		std::vector<float> mListenerBuffer;
+
+		/** The profiler used for measuring the duration of the Device
+		 * callbacks */
+		std::unique_ptr<CallbackProfiler> mCallbackProfiler;
+
+		/** The state of the dither noise added when the mixed output is
+		 * converted to the format of the Device */
+		std::unique_ptr<DitherState> mDitherState;
 
 	public:		// Functions
-		/** Creates a new Device
+		/** Creates a new playback or capture Device
 		 *
-		 * @param	info the DeviceInfo of the Device to create
+		 * @param	context the Context used for creating the Device
+		 * @param	info the DeviceInfo of the Device to create, its type will
+		 *			be used as the type of the Device
+		 * @param	config the parameters of the Device to create */
+		Device(
+			Context& context,
+			const DeviceInfo& deviceInfo, const Config& config
+		);
+
+		/** Creates a new playback or capture Device with the default
+		 * Context
+		 *
+		 * @param	info the DeviceInfo of the Device to create, its type will
+		 *			be used as the type of the Device
 		 * @param	config the parameters of the Device to create */
 		Device(const DeviceInfo& deviceInfo, const Config& config);
 
+		/** Creates a new duplex Device
+		 *
+		 * @param	context the Context used for creating the Device
+		 * @param	playbackInfo the DeviceInfo of the playback device
+		 * @param	captureInfo the DeviceInfo of the capture device
+		 * @param	config the parameters of the Device to create */
+		Device(
+			Context& context,
+			const DeviceInfo& playbackInfo, const DeviceInfo& captureInfo,
+			const Config& config
+		);
+
+		/** Creates a new duplex Device with the default Context
+		 *
+		 * @param	playbackInfo the DeviceInfo of the playback device
+		 * @param	captureInfo the DeviceInfo of the capture device
+		 * @param	config the parameters of the Device to create */
+		Device(
+			const DeviceInfo& playbackInfo, const DeviceInfo& captureInfo,
+			const Config& config
+		);
+
 		/** Class destructor */
 		~Device();
 
@@ -77,6 +241,18 @@ namespace saudio {
 		/** @return	a pointer to the miniaudio Device, if available */
 		ma_device* getMADevice();
 
+		/** @return	a pointer to the Context used for creating the Device */
+		Context* getContext() const;
+
+		/** @return	the type of the Device */
+		DeviceType getType() const;
+
+		/** @return	the parameters that the backend used for creating the
+		 *			Device, they could differ from the requested ones. The
+		 *			capture ones are returned for capture Devices, and the
+		 *			playback ones for the rest */
+		NegotiatedConfig getNegotiatedConfig() const;
+
 		/** Adds the given IDeviceDataListener to the Device
 		 *
 		 * @param	listener the IDeviceDataListener to notify on new Device
@@ -90,9 +266,63 @@ namespace saudio {
 		 *			notified on new Device data */
 		void removeDeviceDataListener(IDeviceDataListener* listener);
 
-		/** @return	the DeviceInfos of all the Devices that can be used */
-		static std::vector<DeviceInfo> getDeviceInfos();
+		/** @return	a snapshot of the durations of the Device callbacks
+		 *			against their period budget. It can be called from any
+		 *			thread */
+		CallbackStats getCallbackStats() const;
+
+		/** Clears the durations of the Device callbacks */
+		void resetCallbackStats();
+
+		/** Returns the DeviceInfos of all the Devices that can be used
+		 *
+		 * @param	context the Context whose Devices will be returned
+		 * @param	type the type of the Devices to return, Playback or
+		 *			Capture
+		 * @return	the DeviceInfos */
+		static std::vector<DeviceInfo> getDeviceInfos(
+			const Context& context, DeviceType type = DeviceType::Playback
+		);
+
+		/** Returns the DeviceInfos of all the Devices that can be used with
+		 * the default Context
+		 *
+		 * @param	type the type of the Devices to return, Playback or
+		 *			Capture
+		 * @return	the DeviceInfos */
+		static std::vector<DeviceInfo> getDeviceInfos(
+			DeviceType type = DeviceType::Playback
+		);
+
+		/** Marks the cached DeviceInfos as outdated, so the devices will be
+		 * enumerated again the next time they are needed. The Devices do it
+		 * automatically when they are rerouted or stopped by the backend,
+		 * but it should also be called when the platform notifies that
+		 * a device was connected
+		 *
+		 * @param	context the Context whose DeviceInfos will be
+		 *			invalidated */
+		static void invalidateDeviceInfos(const Context& context);
+
+		/** Marks the cached DeviceInfos of the default Context as outdated
+		 * @see invalidateDeviceInfos(const Context&) */
+		static void invalidateDeviceInfos();
 	private:
+		/** Creates a new Device
+		 *
+		 * @param	context a pointer to the Context used for creating the
+		 *			Device
+		 * @param	playbackInfo a pointer to the DeviceInfo of the playback
+		 *			device, nullptr for capture Devices
+		 * @param	captureInfo a pointer to the DeviceInfo of the capture
+		 *			device, nullptr for playback Devices
+		 * @param	config the parameters of the Device to create */
+		Device(
+			Context* context,
+			const DeviceInfo* playbackInfo, const DeviceInfo* captureInfo,
+			const Config& config
+		);
+
 		/** The callback that will be executed when the device has new data is
 		 * available
 		 *
@@ -104,6 +334,36 @@ namespace saudio {
 			ma_device* device,
 			void* output, const void* input, unsigned int frameCount
 		);
+
+		/** Mixes the outputs of the given listeners into the Device output
+		 *
+		 * @param	listeners the listeners to notify
+		 * @param	output a pointer to the output data of the Device
+		 * @param	input a pointer to the input data of the Device
+		 * @param	frameCount the number of frames to process */
+		void mixListeners(
+			const ListenerList& listeners,
+			void* output, const void* input, unsigned int frameCount
+		);
+
+		/** Creates the miniaudio Device
+		 *
+		 * @param	playbackInfo a pointer to the DeviceInfo of the playback
+		 *			device, nullptr for capture Devices
+		 * @param	captureInfo a pointer to the DeviceInfo of the capture
+		 *			device, nullptr for playback Devices
+		 * @param	config the parameters of the Device to create
+		 * @return	true on success, false otherwise */
+		bool initInternal(
+			const DeviceInfo* playbackInfo, const DeviceInfo* captureInfo,
+			const Config& config
+		);
+
+		/** Replaces the current list of listeners with the given one and
+		 * deletes the old one once the audio thread can't access it
+		 *
+		 * @param	listeners the new list of listeners */
+		void publishListeners(ListenerList* listeners);
 	};
 
 }
@@ -3,11 +3,13 @@
 
 #include <memory>
 #include "IDataSource.h"
+#include "Allocator.h"
 
 struct ma_sound;
 
 namespace saudio {
 
+	class Context;
 	class AudioEngine;
 
 
@@ -19,11 +21,22 @@ namespace saudio {
 	{
 	private:	// Attributes
 		/** The data source owner (sound) */
-		std::unique_ptr<ma_sound> mDataSourceOwner;
+		std::unique_ptr<ma_sound, ObjectDeleter> mDataSourceOwner;
+
+		/** A pointer to the Context of the AudioEngine used for loading the
+		 * file, used for logging */
+		const Context* mContext;
 
 	public:		// Functions
-		/** Creates a new DataSource */
-		FileDataSource(AudioEngine& engine, const char* path);
+		/** Creates a new DataSource
+		 *
+		 * @param	engine the AudioEngine used for loading the file
+		 * @param	path the path to the audio file
+		 * @param	stream if the audio data should be streamed from the file
+		 *			instead of being fully decoded in memory
+		 * @note	a streamed FileDataSource has a single read cursor, so it
+		 *			shouldn't be shared between multiple Sounds */
+		FileDataSource(AudioEngine& engine, const char* path, bool stream = false);
 		FileDataSource(const FileDataSource& other) = delete;
 		FileDataSource(FileDataSource&& other);
 
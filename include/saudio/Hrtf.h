@@ -0,0 +1,108 @@
+#ifndef SAUDIO_HRTF_H
+#define SAUDIO_HRTF_H
+
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+namespace saudio {
+
+	class Context;
+	class AudioEngine;
+	class IDataSource;
+
+
+	/**
+	 * Class Hrtf, it holds a set of head related impulse responses (HRIRs)
+	 * measured at different directions around the listener. It's used by
+	 * the AudioEngine for rendering the spatialized Sounds binaurally,
+	 * interpolating between the closest measured directions.
+	 *
+	 * @note	the directions are relative to the listener, with the -Z axis
+	 *			pointing forward, +Y up and +X to the right. The impulse
+	 *			responses must have the sample rate of the AudioEngine,
+	 *			otherwise it's rejected and the Sounds are panned
+	 */
+	class Hrtf
+	{
+	private:	// Attributes
+		/** A pointer to the Context used for logging */
+		const Context* mContext;
+
+		/** The number of samples of each impulse response */
+		std::size_t mLength;
+
+		/** The sample rate of the impulse responses */
+		uint32_t mSampleRate;
+
+		/** The unit directions of the measurements */
+		std::vector<glm::vec3> mDirections;
+
+		/** The impulse responses of the measurements, for each one the
+		 * left ear samples are followed by the right ear ones */
+		std::vector<float> mImpulseResponses;
+
+	public:		// Functions
+		/** Creates a new empty Hrtf
+		 *
+		 * @param	length the number of samples of each impulse response
+		 * @param	sampleRate the sample rate of the impulse responses */
+		Hrtf(std::size_t length, uint32_t sampleRate);
+
+		/** Creates a new Hrtf from the given IDataSource
+		 *
+		 * @param	engine the AudioEngine used for loading the IDataSource,
+		 *			ie. with a FileDataSource its decodeSampleRate must be
+		 *			the sample rate of the AudioEngine
+		 * @param	source the IDataSource with the impulse responses. It
+		 *			must have 2 channels (left and right ears) and hold the
+		 *			impulse responses of all the directions one after the
+		 *			other, all of them with the same length
+		 * @param	directions a pointer to the directions of the impulse
+		 *			responses
+		 * @param	numDirections the number of directions */
+		Hrtf(
+			AudioEngine& engine, const IDataSource& source,
+			const glm::vec3* directions, std::size_t numDirections
+		);
+
+		/** @return	true if the Hrtf has at least one measurement, false
+		 *			otherwise */
+		bool good() const;
+
+		/** @return	the number of samples of each impulse response */
+		std::size_t getLength() const;
+
+		/** @return	the sample rate of the impulse responses */
+		uint32_t getSampleRate() const;
+
+		/** @return	the number of measurements */
+		std::size_t getNumMeasurements() const;
+
+		/** @return	the unit direction of the given measurement */
+		const glm::vec3& getDirection(std::size_t measurement) const;
+
+		/** Returns the impulse response of the given measurement and ear
+		 *
+		 * @param	measurement the index of the measurement
+		 * @param	right false for the left ear, true for the right one
+		 * @return	a pointer to the @see getLength samples of the impulse
+		 *			response */
+		const float* getImpulseResponse(std::size_t measurement, bool right) const;
+
+		/** Adds a new measurement
+		 *
+		 * @param	direction the direction of the measurement, it doesn't
+		 *			need to be normalized
+		 * @param	left a pointer to the @see getLength samples of the left
+		 *			ear impulse response
+		 * @param	right a pointer to the @see getLength samples of the
+		 *			right ear impulse response
+		 * @return	true if the measurement was added, false if the direction
+		 *			is zero */
+		bool addMeasurement(const glm::vec3& direction, const float* left, const float* right);
+	};
+
+}
+
+#endif		// SAUDIO_HRTF_H
@@ -0,0 +1,35 @@
+#ifndef SAUDIO_I_EFFECT_H
+#define SAUDIO_I_EFFECT_H
+
+#include <cstddef>
+
+namespace saudio {
+
+	/**
+	 * Class IEffect, an effect is an object that processes the audio frames
+	 * of a Bus in the audio thread. An IEffect can only be added to one Bus
+	 * at the same time.
+	 *
+	 * @note	@see process is called from the audio thread, so it must not
+	 *			block nor allocate memory
+	 */
+	class IEffect
+	{
+	public:		// Functions
+		/** Creates a new IEffect */
+		IEffect() = default;
+
+		/** Class destructor */
+		virtual ~IEffect() = default;
+
+		/** Processes the given frames in place
+		 *
+		 * @param	frames a pointer to the interleaved frames to process
+		 * @param	numFrames the number of frames
+		 * @param	numChannels the number of channels of each frame */
+		virtual void process(float* frames, std::size_t numFrames, std::size_t numChannels) = 0;
+	};
+
+}
+
+#endif		// SAUDIO_I_EFFECT_H
@@ -0,0 +1,143 @@
+#ifndef SAUDIO_LATENCY_CONTROLLER_H
+#define SAUDIO_LATENCY_CONTROLLER_H
+
+#include "Device.h"
+
+namespace saudio {
+
+	class AudioEngine;
+
+
+	/**
+	 * Class LatencyController, it owns a Device and adapts its period size
+	 * to the machine load. The period grows after the Device callbacks miss
+	 * their deadlines, and shrinks after they have been running with enough
+	 * headroom for a while. Each change rebuilds the Device and moves the
+	 * attached AudioEngines to the new one.
+	 *
+	 * @note	the attached AudioEngines must be destroyed or detached before
+	 *			the LatencyController, like with any other Device
+	 */
+	class LatencyController
+	{
+	public:		// Nested types
+		/** Struct Config, holds all the parameters needed for
+		 * adapting the Device latency */
+		struct Config
+		{
+			/** The minimum period size in frames */
+			uint32_t minPeriodSizeInFrames = 64;
+
+			/** The maximum period size in frames */
+			uint32_t maxPeriodSizeInFrames = 4096;
+
+			/** The number of deadline misses between two updates that make
+			 * the period size grow */
+			uint32_t missesToGrow = 1;
+
+			/** The highest callback load (duration/budget) considered as
+			 * headroom */
+			float headroomLoad = 0.5f;
+
+			/** The number of consecutive updates with headroom needed for
+			 * shrinking the period size. It's doubled each time a shrink
+			 * has to be reverted, and halved again after each
+			 * updatesToShrink consecutive updates without deadline misses */
+			uint32_t updatesToShrink = 20;
+		};
+
+	private:	// Attributes
+		/** The maximum multiplier of @see Config::updatesToShrink */
+		static constexpr uint32_t kMaxShrinkBackoff = 16;
+
+		/** The info of the controlled Device */
+		Device::DeviceInfo mDeviceInfo;
+
+		/** The parameters of the controlled Device */
+		Device::Config mDeviceConfig;
+
+		/** The parameters of the LatencyController */
+		Config mConfig;
+
+		/** The controlled Device */
+		std::unique_ptr<Device> mDevice;
+
+		/** The AudioEngines attached to @see mDevice */
+		std::vector<AudioEngine*> mEngines;
+
+		/** The number of consecutive updates with headroom */
+		uint32_t mHeadroomUpdates;
+
+		/** The number of consecutive updates without deadline misses */
+		uint32_t mStableUpdates;
+
+		/** The current multiplier of @see Config::updatesToShrink */
+		uint32_t mShrinkBackoff;
+
+		/** If the last change of the period size was a shrink */
+		bool mLastChangeWasShrink;
+
+	public:		// Functions
+		/** Creates a new LatencyController
+		 *
+		 * @param	context the Context used for creating the Devices
+		 * @param	deviceInfo the DeviceInfo of the Device to create
+		 * @param	deviceConfig the initial parameters of the Device
+		 * @param	config the parameters of the LatencyController */
+		LatencyController(
+			Context& context,
+			const Device::DeviceInfo& deviceInfo,
+			const Device::Config& deviceConfig,
+			const Config& config
+		);
+
+		/** Creates a new LatencyController whose Devices use the default
+		 * Context
+		 *
+		 * @param	deviceInfo the DeviceInfo of the Device to create
+		 * @param	deviceConfig the initial parameters of the Device
+		 * @param	config the parameters of the LatencyController */
+		LatencyController(
+			const Device::DeviceInfo& deviceInfo,
+			const Device::Config& deviceConfig,
+			const Config& config
+		);
+
+		/** @return	true if the controlled Device is valid, false otherwise */
+		bool good() const;
+
+		/** @return	the Device currently used. It changes each time the
+		 *			period size is updated */
+		Device& getDevice() const;
+
+		/** Attaches the given AudioEngine to the LatencyController, so it's
+		 * moved to the new Device each time the Device is rebuilt
+		 *
+		 * @param	engine the AudioEngine to attach
+		 * @return	true on success, false otherwise */
+		bool attach(AudioEngine& engine);
+
+		/** Detaches the given AudioEngine from the LatencyController
+		 *
+		 * @param	engine the AudioEngine to detach */
+		void detach(AudioEngine& engine);
+
+		/** Checks the Device callbacks since the last update and changes the
+		 * period size if needed. It should be called periodically (ie. once
+		 * each second)
+		 *
+		 * @return	true if the Device was rebuilt, false otherwise */
+		bool update();
+	private:
+		/** Rebuilds the Device with the given period size and moves the
+		 * attached AudioEngines to it
+		 *
+		 * @param	periodSizeInFrames the new period size
+		 * @return	true on success, false otherwise. On failure the
+		 *			AudioEngines stay in the old Device */
+		bool rebuildDevice(uint32_t periodSizeInFrames);
+	};
+
+}
+
+#endif		// SAUDIO_LATENCY_CONTROLLER_H
@@ -0,0 +1,93 @@
+#ifndef SAUDIO_ONE_POLE_FILTER_H
+#define SAUDIO_ONE_POLE_FILTER_H
+
+#include <atomic>
+#include <vector>
+#include "IEffect.h"
+
+namespace saudio {
+
+	class AudioEngine;
+
+
+	/**
+	 * Class OnePoleFilter, it's an IEffect that filters the frames with a
+	 * one-pole lowpass or highpass filter. It's cheaper than a
+	 * BiquadFilter and its 6 dB per octave slope makes it useful for
+	 * smoothing signals or for gentle tone controls. The frames are
+	 * filtered with SIMD instructions like in BiquadFilter.
+	 */
+	class OnePoleFilter : public IEffect
+	{
+	public:		// Nested types
+		/** The response of the filter */
+		enum class Type : int
+		{
+			LowPass, HighPass
+		};
+
+	private:	// Attributes
+		/** The sample rate of the filtered frames */
+		float mSampleRate;
+
+		/** The maximum number of channels that can be filtered */
+		std::size_t mNumChannels;
+
+		/** The response of the filter */
+		std::atomic<int> mType;
+
+		/** The cutoff frequency in Hz */
+		std::atomic<float> mCutoff;
+
+		/** The smoothing coefficient of the cutoff frequency */
+		std::atomic<float> mCoefficient;
+
+		/** The last lowpass output of each channel */
+		std::vector<float> mState;
+
+	public:		// Functions
+		/** Creates a new OnePoleFilter
+		 *
+		 * @param	engine the AudioEngine whose sample rate and channels will
+		 *			be used
+		 * @param	type the response of the filter
+		 * @param	cutoff the cutoff frequency in Hz */
+		OnePoleFilter(AudioEngine& engine, Type type = Type::LowPass, float cutoff = 1000.0f);
+		OnePoleFilter(const OnePoleFilter& other) = delete;
+		OnePoleFilter(OnePoleFilter&& other) = delete;
+
+		/** Class destructor */
+		~OnePoleFilter() = default;
+
+		/** Assignment operator */
+		OnePoleFilter& operator=(const OnePoleFilter& other) = delete;
+		OnePoleFilter& operator=(OnePoleFilter&& other) = delete;
+
+		/** @return	the response of the filter */
+		Type getType() const;
+
+		/** Sets the response of the filter
+		 *
+		 * @param	type the new response
+		 * @return	a reference to the current OnePoleFilter object */
+		OnePoleFilter& setType(Type type);
+
+		/** @return	the cutoff frequency in Hz */
+		float getCutoff() const;
+
+		/** Sets the cutoff frequency of the filter
+		 *
+		 * @param	cutoff the new cutoff frequency in Hz, it's clamped below
+		 *			the Nyquist frequency
+		 * @return	a reference to the current OnePoleFilter object */
+		OnePoleFilter& setCutoff(float cutoff);
+
+		/** @copydoc IEffect::process()
+		 * @note	the frames are left unmodified if they have more channels
+		 *			than the AudioEngine */
+		virtual void process(float* frames, std::size_t numFrames, std::size_t numChannels) override;
+	};
+
+}
+
+#endif		// SAUDIO_ONE_POLE_FILTER_H
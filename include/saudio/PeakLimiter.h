@@ -0,0 +1,141 @@
+#ifndef SAUDIO_PEAK_LIMITER_H
+#define SAUDIO_PEAK_LIMITER_H
+
+#include <atomic>
+#include <vector>
+#include <cstdint>
+#include "IEffect.h"
+
+namespace saudio {
+
+	class AudioEngine;
+
+
+	/**
+	 * Class PeakLimiter, it's an IEffect that keeps the peaks of the frames
+	 * below a threshold, ie. for avoiding the clipping of the master
+	 * output when many Sounds play at the same time. The frames are
+	 * delayed by a lookahead time so the gain reduction starts smoothly
+	 * before each peak: the gain is the minimum over the lookahead window,
+	 * released with a one-pole envelope and smoothed with a moving
+	 * average, so it never exceeds the threshold and it doesn't add
+	 * distortion. The same gain is applied to all the channels.
+	 *
+	 * @note	the frames are delayed by @see getLatency
+	 */
+	class PeakLimiter : public IEffect
+	{
+	private:	// Attributes
+		/** The sample rate of the limited frames */
+		float mSampleRate;
+
+		/** The maximum number of channels that can be limited */
+		std::size_t mNumChannels;
+
+		/** The number of lookahead frames */
+		std::size_t mLookahead;
+
+		/** The threshold in decibels and as a linear gain */
+		std::atomic<float> mThresholdDB, mThreshold;
+
+		/** The release time in seconds and its envelope coefficient */
+		std::atomic<float> mRelease, mReleaseCoefficient;
+
+		/** The lookahead delay line with the interleaved input frames, and
+		 * the frame where the next one will be written */
+		std::vector<float> mDelayLine;
+		std::size_t mDelayIndex;
+
+		/** The sliding minimum of the target gains over the lookahead
+		 * window, stored as a ring buffer of increasing gains with the
+		 * frame number of each one */
+		std::vector<float> mMinGains;
+		std::vector<uint64_t> mMinFrames;
+		std::size_t mMinFirst, mMinCount;
+
+		/** The number of processed frames */
+		uint64_t mFrameNumber;
+
+		/** The gain of the release envelope */
+		float mEnvelope;
+
+		/** The last envelope gains, their sum is the moving average */
+		std::vector<float> mAverageGains;
+		std::size_t mAverageIndex;
+		double mAverageSum;
+
+		/** The peaks, gains and delayed frames of the chunk being
+		 * processed */
+		std::vector<float> mPeaks, mGains, mDelayedFrames;
+
+	public:		// Functions
+		/** Creates a new PeakLimiter
+		 *
+		 * @param	engine the AudioEngine whose sample rate and channels will
+		 *			be used
+		 * @param	lookahead the lookahead time in seconds, it's the latency
+		 *			added by the PeakLimiter
+		 * @param	thresholdDB the maximum peak in decibels relative to
+		 *			full scale
+		 * @param	release the time in seconds that the gain takes to
+		 *			recover after a peak */
+		PeakLimiter(
+			AudioEngine& engine, float lookahead = 0.005f,
+			float thresholdDB = -1.0f, float release = 0.1f
+		);
+		PeakLimiter(const PeakLimiter& other) = delete;
+		PeakLimiter(PeakLimiter&& other) = delete;
+
+		/** Class destructor */
+		~PeakLimiter() = default;
+
+		/** Assignment operator */
+		PeakLimiter& operator=(const PeakLimiter& other) = delete;
+		PeakLimiter& operator=(PeakLimiter&& other) = delete;
+
+		/** @return	the number of frames that the PeakLimiter delays the
+		 *			frames */
+		std::size_t getLatency() const;
+
+		/** @return	the threshold in decibels */
+		float getThreshold() const;
+
+		/** Sets the maximum peak of the frames
+		 *
+		 * @param	thresholdDB the new threshold in decibels relative to
+		 *			full scale
+		 * @return	a reference to the current PeakLimiter object */
+		PeakLimiter& setThreshold(float thresholdDB);
+
+		/** @return	the release time in seconds */
+		float getRelease() const;
+
+		/** Sets the time that the gain takes to recover after a peak
+		 *
+		 * @param	release the new release time in seconds
+		 * @return	a reference to the current PeakLimiter object */
+		PeakLimiter& setRelease(float release);
+
+		/** @copydoc IEffect::process()
+		 * @note	the frames are left unmodified if they have more channels
+		 *			than the AudioEngine */
+		virtual void process(float* frames, std::size_t numFrames, std::size_t numChannels) override;
+	private:
+		/** Computes the gain of each frame of the chunk being processed
+		 * from its peak
+		 *
+		 * @param	numFrames the number of frames of the chunk */
+		void computeGains(std::size_t numFrames);
+
+		/** Writes the given frames to the lookahead delay line and reads
+		 * the delayed ones to @see mDelayedFrames
+		 *
+		 * @param	frames a pointer to the interleaved frames to write
+		 * @param	numFrames the number of frames
+		 * @param	numChannels the number of channels of each frame */
+		void delayFrames(const float* frames, std::size_t numFrames, std::size_t numChannels);
+	};
+
+}
+
+#endif		// SAUDIO_PEAK_LIMITER_H
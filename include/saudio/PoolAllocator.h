@@ -0,0 +1,124 @@
+#ifndef SAUDIO_POOL_ALLOCATOR_H
+#define SAUDIO_POOL_ALLOCATOR_H
+
+#include <atomic>
+#include "Allocator.h"
+
+namespace saudio {
+
+	/**
+	 * Class PoolAllocator, it's an Allocator that hands out fixed size blocks
+	 * from a preallocated pool. The free blocks are stored in a lock-free
+	 * stack, so it can be used from multiple threads, including the audio
+	 * ones, without locking. It's intended for the miniaudio objects
+	 * (@see AllocationCategory::Object), whose sizes don't change. The
+	 * allocations that don't fit in a block, or that are done when the pool
+	 * is exhausted, are forwarded to an upstream Allocator.
+	 */
+	class PoolAllocator : public Allocator
+	{
+	public:		// Nested types
+		/** Struct Config, holds all the parameters needed for creating the
+		 * PoolAllocator */
+		struct Config
+		{
+			/** The maximum number of bytes of each allocation served by the
+			 * pool */
+			std::size_t blockSize = 2048;
+
+			/** The number of blocks of the pool */
+			std::size_t numBlocks = 256;
+
+			/** The Allocator used for the allocations that can't be served
+			 * by the pool, nullptr for the C allocation functions */
+			Allocator* upstream = nullptr;
+		};
+
+	private:	// Attributes
+		/** The index used for marking the end of the free list */
+		static constexpr uint32_t kNullIndex = ~0u;
+
+		/** The Allocator used when the pool can't serve an allocation */
+		Allocator* mUpstream;
+
+		/** The number of bytes of each block, including its header */
+		std::size_t mBlockStride;
+
+		/** The number of bytes available in each block */
+		std::size_t mBlockCapacity;
+
+		/** The number of blocks of the pool */
+		uint32_t mNumBlocks;
+
+		/** The memory of all the blocks */
+		unsigned char* mBlocks;
+
+		/** The top of the stack of free blocks. The low 32 bits hold the
+		 * index of the block and the high ones a tag that changes on each
+		 * update, so the stack doesn't suffer from the ABA problem */
+		std::atomic<uint64_t> mFreeHead;
+
+		/** The number of blocks in use */
+		std::atomic<uint32_t> mNumUsedBlocks;
+
+		/** The number of allocations forwarded to @see mUpstream */
+		std::atomic<uint64_t> mNumUpstreamAllocations;
+
+	public:		// Functions
+		/** Creates a new PoolAllocator
+		 *
+		 * @param	config the parameters of the PoolAllocator */
+		PoolAllocator(const Config& config);
+		PoolAllocator(const PoolAllocator& other) = delete;
+		PoolAllocator(PoolAllocator&& other) = delete;
+
+		/** Class destructor. All the allocated memory must be released
+		 * before calling it */
+		~PoolAllocator();
+
+		/** Assignment operator */
+		PoolAllocator& operator=(const PoolAllocator& other) = delete;
+		PoolAllocator& operator=(PoolAllocator&& other) = delete;
+
+		/** @return	true if the pool was created successfully, false
+		 *			otherwise */
+		bool good() const;
+
+		/** @return	the number of blocks currently in use */
+		uint32_t getNumUsedBlocks() const
+		{ return mNumUsedBlocks.load(std::memory_order_relaxed); };
+
+		/** @return	the number of allocations that were forwarded to the
+		 *			upstream Allocator */
+		uint64_t getNumUpstreamAllocations() const
+		{ return mNumUpstreamAllocations.load(std::memory_order_relaxed); };
+
+		/** @copydoc Allocator::allocate() */
+		virtual void* allocate(std::size_t size) override;
+
+		/** @copydoc Allocator::reallocate() */
+		virtual void* reallocate(void* ptr, std::size_t size) override;
+
+		/** @copydoc Allocator::deallocate() */
+		virtual void deallocate(void* ptr) override;
+	private:
+		/** Pops a block from the stack of free blocks
+		 *
+		 * @return	the index of the block, @see kNullIndex if there are no
+		 *			free blocks */
+		uint32_t popFreeBlock();
+
+		/** Pushes the given block to the stack of free blocks
+		 *
+		 * @param	index the index of the block */
+		void pushFreeBlock(uint32_t index);
+
+		/** @param	index the index of a block
+		 * @return	a pointer to the header of the block */
+		unsigned char* getBlock(uint32_t index) const
+		{ return mBlocks + index * mBlockStride; };
+	};
+
+}
+
+#endif		// SAUDIO_POOL_ALLOCATOR_H
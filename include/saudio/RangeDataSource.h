@@ -0,0 +1,106 @@
+#ifndef SAUDIO_RANGE_DATA_SOURCE_H
+#define SAUDIO_RANGE_DATA_SOURCE_H
+
+#include <memory>
+#include <cstdint>
+#include "IDataSource.h"
+#include "Allocator.h"
+
+struct ma_resource_manager_data_source;
+
+namespace saudio {
+
+	class Context;
+	class AudioEngine;
+	class FileDataSource;
+
+
+	/**
+	 * Class RangeDataSource, it's a data source that plays a range of frames
+	 * of a decoded FileDataSource, ie. a dialog line inside a bank of lines
+	 * or a loop segment. It references the decoded buffer of the
+	 * FileDataSource instead of copying it, so creating a RangeDataSource
+	 * doesn't decode nor copy any audio data.
+	 *
+	 * @note	each RangeDataSource has its own read cursor, so every Sound
+	 *			should use a different one
+	 */
+	class RangeDataSource : public IDataSource
+	{
+	private:	// Attributes
+		/** The miniaudio data source that references the decoded buffer */
+		std::unique_ptr<ma_resource_manager_data_source, ObjectDeleter> mDataSource;
+
+		/** A pointer to the Context of the AudioEngine of the
+		 * FileDataSource, used for logging */
+		const Context* mContext;
+
+	public:		// Functions
+		/** Creates a new RangeDataSource
+		 *
+		 * @param	engine the AudioEngine used for loading the
+		 *			FileDataSource
+		 * @param	source the FileDataSource with the decoded audio data. It
+		 *			must be fully decoded (not streamed). The decoded buffer
+		 *			is reference counted, so it can be destroyed before the
+		 *			RangeDataSource
+		 * @param	beginFrame the first frame of the range
+		 * @param	endFrame the frame after the last one of the range, it's
+		 *			clamped to the length of the FileDataSource */
+		RangeDataSource(
+			AudioEngine& engine, const FileDataSource& source,
+			uint64_t beginFrame = 0, uint64_t endFrame = UINT64_MAX
+		);
+		RangeDataSource(const RangeDataSource& other) = delete;
+		RangeDataSource(RangeDataSource&& other);
+
+		/** Class destructor */
+		~RangeDataSource();
+
+		/** Assignment operator */
+		RangeDataSource& operator=(const RangeDataSource& other) = delete;
+		RangeDataSource& operator=(RangeDataSource&& other);
+
+		/** @copydoc IDataSource::good() */
+		virtual bool good() const;
+
+		/** @copydoc IDataSource::getMADataSource() */
+		virtual ma_data_source* getMADataSource() const;
+
+		/** Returns the range of the RangeDataSource
+		 *
+		 * @param	beginFrame a reference to the variable where the first
+		 *			frame of the range will be stored
+		 * @param	endFrame a reference to the variable where the frame
+		 *			after the last one of the range will be stored */
+		void getRange(uint64_t& beginFrame, uint64_t& endFrame) const;
+
+		/** Sets the frames that will be repeated while the RangeDataSource
+		 * is looping
+		 *
+		 * @param	beginFrame the first frame of the loop, relative to the
+		 *			start of the range
+		 * @param	endFrame the frame after the last one of the loop,
+		 *			relative to the start of the range. It's clamped to the
+		 *			end of the range
+		 * @return	true on success, false otherwise */
+		bool setLoopPoints(uint64_t beginFrame, uint64_t endFrame = UINT64_MAX);
+
+		/** @return	true if the RangeDataSource is looping, false otherwise */
+		bool isLooping() const;
+
+		/** Sets if the RangeDataSource must repeat its loop points once it
+		 * reaches them. In that case the RangeDataSource never ends
+		 *
+		 * @param	looping true if the RangeDataSource must loop, false
+		 *			otherwise
+		 * @return	a reference to the current RangeDataSource */
+		RangeDataSource& setLooping(bool looping);
+	private:
+		/** Releases @see mDataSource */
+		void uninitInternal();
+	};
+
+}
+
+#endif		// SAUDIO_RANGE_DATA_SOURCE_H
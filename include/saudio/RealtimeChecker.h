@@ -0,0 +1,75 @@
+#ifndef SAUDIO_REALTIME_CHECKER_H
+#define SAUDIO_REALTIME_CHECKER_H
+
+#include <cstdint>
+
+namespace saudio {
+
+	/**
+	 * Class RealtimeChecker, it's used for detecting the operations that
+	 * aren't real-time safe (memory allocations, mutex locks and blocking
+	 * system calls) done inside the audio callbacks. The Device callbacks and
+	 * the manual AudioEngine renders are marked as real-time scopes, and if
+	 * any of those operations is done inside them a report with its
+	 * backtrace is printed to stderr and the violation handler is called.
+	 *
+	 * @note	the operations are only intercepted if the library was built
+	 *			with the SOMBRA_AUDIO_RT_CHECK option on Linux with glibc,
+	 *			otherwise the RealtimeChecker does nothing. It's intended for
+	 *			debug builds only
+	 */
+	class RealtimeChecker
+	{
+	public:		// Nested types
+		/** The function called on each violation, with the name of the
+		 * intercepted function */
+		using ViolationHandler = void (*)(const char* violation);
+
+		/** Class Scope, marks the code executed during its lifetime in the
+		 * current thread as real-time */
+		class Scope
+		{
+		public:		// Functions
+			/** Creates a new Scope */
+			Scope();
+
+			/** Class destructor */
+			~Scope();
+		};
+
+		/** Class AllowScope, allows the non real-time operations during its
+		 * lifetime in the current thread, even inside a Scope */
+		class AllowScope
+		{
+		public:		// Functions
+			/** Creates a new AllowScope */
+			AllowScope();
+
+			/** Class destructor */
+			~AllowScope();
+		};
+
+	public:		// Functions
+		/** @return	true if the operations are being intercepted, false
+		 *			otherwise */
+		static bool isEnabled();
+
+		/** @return	true if the current thread is inside a real-time Scope,
+		 *			false otherwise */
+		static bool isInRealtimeScope();
+
+		/** Sets the function to call on each violation. By default the
+		 * process is aborted, so the tests fail as soon as a violation
+		 * happens
+		 *
+		 * @param	handler the new ViolationHandler, nullptr for only
+		 *			printing the reports */
+		static void setViolationHandler(ViolationHandler handler);
+
+		/** @return	the number of violations detected */
+		static uint64_t getNumViolations();
+	};
+
+}
+
+#endif		// SAUDIO_REALTIME_CHECKER_H
@@ -2,15 +2,23 @@
 #define SAUDIO_SOUND_H
 
 #include <memory>
+#include <cstdint>
 #include <glm/glm.hpp>
+#include "Allocator.h"
+#include "Automation.h"
 
 struct ma_sound;
 struct ma_engine;
 
 namespace saudio {
 
+	class Bus;
+	class IEffect;
+	class Context;
 	class IDataSource;
 	class AudioEngine;
+	class SequenceDataSource;
+	class BatchSpatializer;
 
 
 	/**
@@ -21,9 +29,59 @@ namespace saudio {
 	 */
 	class Sound
 	{
+	public:		// Nested types
+		friend class AudioEngine;
+
+		/** An opaque value that identifies the audio played by a Sound in
+		 * its SoundEvents, 0 is never used by a valid Sound */
+		using Handle = uint64_t;
+
+	private:	// Nested types
+		/** The data passed to the end callback of @see mSound */
+		struct EndCallbackData
+		{
+			/** The AudioEngine where the SoundEvents are pushed */
+			AudioEngine* audioEngine;
+
+			/** The Handle of the Sound */
+			Handle handle;
+		};
+
 	private:	// Attributes
 		/** A pointer to the Sound object */
-		std::unique_ptr<ma_sound> mSound;
+		std::unique_ptr<ma_sound, ObjectDeleter> mSound;
+
+		/** The data source played by @see mSound, it holds the binded
+		 * IDataSource and the queued ones */
+		std::unique_ptr<SequenceDataSource, ObjectDeleter> mSequence;
+
+		/** A pointer to the Context of the AudioEngine that holds the
+		 * Sound, used for logging */
+		const Context* mContext = nullptr;
+
+		/** A pointer to the AudioEngine that holds the Sound, its
+		 * SoundEvents are pushed to it */
+		AudioEngine* mAudioEngine = nullptr;
+
+		/** The batch spatializer of the engine that renders the Sound,
+		 * nullptr if it's spatialized by miniaudio */
+		BatchSpatializer* mBatchSpatializer = nullptr;
+
+		/** The index of the Sound in @see mBatchSpatializer */
+		int mVoice = -1;
+
+		/** The Bus where the Sound is mixed, nullptr if it's sent directly
+		 * to the output of the AudioEngine */
+		Bus* mBus = nullptr;
+
+		/** The Bus with the IEffects of the Sound, it's created when the
+		 * first IEffect is added and it's sent to @see mBus */
+		std::unique_ptr<Bus, ObjectDeleter> mEffectBus;
+
+		/** The data of the end callback of @see mSound, it's allocated
+		 * separately so its address doesn't change when the Sound is
+		 * moved */
+		std::unique_ptr<EndCallbackData, ObjectDeleter> mEndData;
 
 	public:		// Functions
 		/** Creates a new Sound
@@ -32,6 +90,13 @@ namespace saudio {
 		 *			Sound. If no AudioEngine is provided the Sound won't be
 		 *			initialized and @see good will return false */
 		Sound(AudioEngine* audioEngine = nullptr);
+
+		/** Creates a new Sound mixed in the given Bus. The Sound is rendered
+		 * by the same engine than the Bus, so it can be attached to it
+		 * even with parallel rendering
+		 *
+		 * @param	bus the Bus where the Sound will be mixed */
+		Sound(Bus& bus);
 		Sound(const Sound& other);
 		Sound(Sound&& other);
 
@@ -48,13 +113,22 @@ namespace saudio {
 		 * @param	audioEngine a pointer to the AudioEngine that will hold the
 		 *			new Sound. If no AudioEngine is provided the Sound won't be
 		 *			initialized and @see good will return false
-		 * @return	the new Sound */
+		 * @return	the new Sound, it isn't attached to the Bus of the
+		 *			copied one */
 		static Sound copy(const Sound& other, AudioEngine* audioEngine);
 
 		/** @return	true if the Sound was created and initialized
 		 *			successfully */
 		bool good() const;
 
+		/** @return	the handle of the Sound used in the SoundEvents of its
+		 *			AudioEngine
+		 * @note	the handle changes when the Sound is binded to another
+		 *			IDataSource or unbinded. The handles are never reused by
+		 *			the same AudioEngine, so the events of a destroyed Sound
+		 *			can't be mistaken for the events of a new one */
+		Handle getHandle() const;
+
 		/** @return	true if the current Sound is playing some sound, false
 		 *			otherwise */
 		bool isPlaying() const;
@@ -69,6 +143,35 @@ namespace saudio {
 		 * @return	a reference to the current Sound object */
 		Sound& setSpacialization(bool value);
 
+		/** @return	the Bus where the Sound is mixed, nullptr if it's sent
+		 *			directly to the output of its AudioEngine */
+		Bus* getBus() const;
+
+		/** Sets the Bus where the Sound is mixed
+		 *
+		 * @param	bus a pointer to the Bus, nullptr for sending the Sound
+		 *			directly to the output of its AudioEngine. The Sound
+		 *			must be rendered by the same engine than the Bus
+		 * @return	true on success, false otherwise */
+		bool setBus(Bus* bus);
+
+		/** Appends the given IEffect to the end of the chain that processes
+		 * the Sound before sending it to its Bus
+		 *
+		 * @param	effect the IEffect to add, it must outlive the Sound or
+		 *			be removed from it before being destroyed
+		 * @return	true on success, false otherwise
+		 * @note	the IEffects aren't copied with the Sound */
+		bool addEffect(IEffect& effect);
+
+		/** Removes the given IEffect from the Sound. Once it returns the
+		 * audio thread doesn't use the IEffect anymore
+		 *
+		 * @param	effect the IEffect to remove
+		 * @return	true if the IEffect was removed, false if it wasn't
+		 *			found */
+		bool removeEffect(IEffect& effect);
+
 		/** @return	the 3D position of the current Sound */
 		glm::vec3 getPosition() const;
 
@@ -159,10 +262,35 @@ namespace saudio {
 		 * IDataSource
 		 *
 		 * @param	source the IDataSource to bind to the current Sound
-		 * @note	this function will also stop the Sound from playing its
-		 *			old IDataSource */
+		 * @note	if the Sound already has an IDataSource with the same
+		 *			format, it's replaced in place before the next read or
+		 *			seek of the audio thread, so the Sound keeps its state
+		 *			and its queued IDataSources are discarded. Otherwise the
+		 *			Sound is recreated and stopped. In both cases the old
+		 *			IDataSource and the queued ones can be destroyed once it
+		 *			returns, it waits for the audio callbacks that could be
+		 *			using them */
 		Sound& bind(IDataSource* source);
 
+		/** Queues the given IDataSource, so it will be played when the
+		 * current one and the ones queued before it end. The switch is
+		 * done in the audio thread without gaps between them
+		 *
+		 * @param	source the IDataSource to queue. It must have the same
+		 *			format than the binded one, and it will be played from
+		 *			its first frame
+		 * @param	loop true if the IDataSource must be repeated until
+		 *			@see exitLoop is called, false otherwise
+		 * @return	true if the IDataSource was queued, false otherwise
+		 * @note	it must be called always from the same thread. The
+		 *			IDataSource must outlive the Sound unless it's discarded
+		 *			by @see bind or @see unbind */
+		bool queueNext(IDataSource* source, bool loop = false);
+
+		/** Makes the current looping IDataSource continue with the next
+		 * queued one when it reaches its end */
+		void exitLoop() const;
+
 		/** Stops and unbinds the Sound from its current Buffer */
 		Sound& unbind();
 
@@ -183,6 +311,84 @@ namespace saudio {
 		/** Stops a Sound from playing the sound of its binded Buffer with
 		 * @see pause and @see setToPCMFrame(0) */
 		void stop() const;
+
+		/** Starts playing the Sound at the given time of its AudioEngine.
+		 * To schedule multiple Sounds atomically use
+		 * @see AudioEngine::ScheduleBatch instead
+		 *
+		 * @param	engineFrame the time of the AudioEngine in PCM frames when
+		 *			the Sound must start
+		 * @return	true on success, false otherwise
+		 * @note	the command is committed like a ScheduleBatch, so
+		 *			the calls from different threads are serialized
+		 *			@see AudioEngine::commit */
+		bool playAt(uint64_t engineFrame) const;
+
+		/** Stops playing the Sound at the given time of its AudioEngine
+		 *
+		 * @param	engineFrame the time of the AudioEngine in PCM frames when
+		 *			the Sound must stop
+		 * @return	true on success, false otherwise
+		 * @note	the command is committed like a ScheduleBatch, so
+		 *			the calls from different threads are serialized
+		 *			@see AudioEngine::commit */
+		bool stopAt(uint64_t engineFrame) const;
+
+		/** Moves the Sound to the given frame at the given time of its
+		 * AudioEngine
+		 *
+		 * @param	engineFrame the time of the AudioEngine in PCM frames when
+		 *			the Sound must be moved
+		 * @param	frame the new frame to play
+		 * @return	true on success, false otherwise
+		 * @note	the command is committed like a ScheduleBatch, so
+		 *			the calls from different threads are serialized
+		 *			@see AudioEngine::commit */
+		bool setToPCMFrameAt(uint64_t engineFrame, uint64_t frame) const;
+
+		/** Changes the volume of the Sound linearly from its current value
+		 * to the given one. The volume is updated by the audio thread
+		 *
+		 * @param	volume the volume to reach
+		 * @param	frameCount the number of PCM frames of the ramp
+		 * @return	true on success, false otherwise */
+		bool rampVolume(float volume, uint64_t frameCount) const;
+
+		/** Changes the pitch of the Sound linearly from its current value
+		 * to the given one. The pitch is updated by the audio thread
+		 *
+		 * @param	pitch the pitch to reach
+		 * @param	frameCount the number of PCM frames of the ramp
+		 * @return	true on success, false otherwise */
+		bool rampPitch(float pitch, uint64_t frameCount) const;
+
+		/** Moves the Sound linearly from its current position to the given
+		 * one. The position is updated by the audio thread
+		 *
+		 * @param	position the position to reach
+		 * @param	frameCount the number of PCM frames of the ramp
+		 * @return	true on success, false otherwise */
+		bool rampPosition(const glm::vec3& position, uint64_t frameCount) const;
+
+		/** Makes the given parameter follow a curve, starting from its value
+		 * at the given time. It replaces any other automation of the same
+		 * parameter
+		 * @see AudioEngine::ScheduleBatch::automate
+		 *
+		 * @param	parameter the parameter to automate
+		 * @param	points a pointer to the AutomationPoints of the curve,
+		 *			sorted by frame
+		 * @param	numPoints the number of AutomationPoints, at most
+		 *			@see kMaxAutomationPoints
+		 * @param	engineFrame the time of the AudioEngine in PCM frames
+		 *			when the automation must start, 0 for starting it in the
+		 *			next audio callback
+		 * @return	true on success, false otherwise */
+		bool automate(
+			AutomationParameter parameter,
+			const AutomationPoint* points, std::size_t numPoints,
+			uint64_t engineFrame = 0
+		) const;
 	private:
 		/** Initializes the Sound with the given miniaudio engine
 		 *
@@ -201,6 +407,18 @@ namespace saudio {
 		 *			otherwise */
 		bool copyInternal(ma_sound* other, ma_engine* engine);
 
+		/** Makes the miniaudio sound push its end SoundEvents to
+		 * @see mAudioEngine */
+		void setEndCallback();
+
+		/** Adds the Sound to the render lane and to the batch spatializer
+		 * of the miniaudio engine that renders it, if they are enabled */
+		void registerInEngine();
+
+		/** Attaches the Sound to @see mEffectBus, to @see mBus or to the
+		 * endpoint of its engine */
+		void attachToOutput();
+
 		/** Unititializes the Sound */
 		void uninitInternal();
 	};
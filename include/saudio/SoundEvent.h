@@ -0,0 +1,37 @@
+#ifndef SAUDIO_SOUND_EVENT_H
+#define SAUDIO_SOUND_EVENT_H
+
+#include <cstdint>
+#include "Sound.h"
+
+namespace saudio {
+
+	/**
+	 * Struct SoundEvent, it's an event generated by a Sound while the
+	 * AudioEngine renders it. The events are queued by the audio thread and
+	 * retrieved with @see AudioEngine::pollSoundEvent
+	 */
+	struct SoundEvent
+	{
+		/** The different types of SoundEvents */
+		enum class Type : int
+		{
+			End		///< The Sound reached the end of its IDataSource
+		};
+
+		/** The type of the event */
+		Type type = Type::End;
+
+		/** The handle of the Sound that generated the event
+		 * @see Sound::getHandle */
+		Sound::Handle sound = 0;
+
+		/** The time of the AudioEngine in PCM frames when the event was
+		 * generated. Its precision is the number of frames rendered in each
+		 * audio callback */
+		uint64_t frame = 0;
+	};
+
+}
+
+#endif		// SAUDIO_SOUND_EVENT_H
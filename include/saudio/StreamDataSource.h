@@ -13,6 +13,12 @@ namespace saudio {
 	/**
 	 * Class StreamDataSource, it's a data source whose original audio data is
 	 * stored in a file
+	 *
+	 * @note	the samples are stored in a lock-free single producer single
+	 *			consumer ring buffer, so @see onNewSamples can be called from
+	 *			one thread (even an audio one) while the data is being played.
+	 *			The format setters must be called before binding the
+	 *			StreamDataSource to any Sound
 	 */
 	class StreamDataSource : public IDataSource
 	{
@@ -52,18 +58,27 @@ namespace saudio {
 		 * @return	a reference to the current StreamDataSource */
 		StreamDataSource& setFormat(Format format);
 
+		/** @return	the format set with @see setFormat */
+		Format getFormat() const;
+
 		/** Sets the sample rate of the StreamDataSource
 		 *
 		 * @param	sampleRate the sample rate of the StreamDataSource
 		 * @return	a reference to the current StreamDataSource */
 		StreamDataSource& setSampleRate(uint32_t sampleRate);
 
+		/** @return	the sample rate of the StreamDataSource */
+		uint32_t getSampleRate() const;
+
 		/** Sets the number of channels of the StreamDataSource
 		 *
 		 * @param	numChannels the number of channels
 		 * @return	a reference to the current StreamDataSource */
 		StreamDataSource& setNumChannels(int numChannels);
 
+		/** @return	the number of channels of the StreamDataSource */
+		int getNumChannels() const;
+
 		/** Sets the channels of the StreamDataSource
 		 *
 		 * @param	channels a pointer to the channels of the StreamDataSource
@@ -73,11 +88,35 @@ namespace saudio {
 			const Channel* channels, std::size_t channelCount
 		);
 
-		/** Adds the given data to the StreamDataSource so it can be played
+		/** Sets if the samples must be converted to f32, the native format
+		 * of the AudioEngine, when they are added with @see onNewSamples.
+		 * The conversion is done once by the producer thread instead of in
+		 * every read of the audio thread, at the cost of a bigger ring
+		 * buffer for the formats of less than 32 bits
 		 *
-		 * @param	data the new data of the StreamDataSource
+		 * @param	convert true for converting the samples when they are
+		 *			added, false for storing them in the format set with
+		 *			@see setFormat (default)
+		 * @return	a reference to the current StreamDataSource
+		 * @note	it resets the ring buffer and resizes the conversion
+		 *			buffer used by @see onNewSamples, so like the format
+		 *			setters it must be called before binding the
+		 *			StreamDataSource and never concurrently with
+		 *			@see onNewSamples */
+		StreamDataSource& setConvertOnWrite(bool convert);
+
+		/** Adds the given data to the StreamDataSource so it can be played.
+		 * The data is copied directly to the ring buffer (converted to f32
+		 * if @see setConvertOnWrite is enabled), the samples that don't fit
+		 * in it are discarded
+		 *
+		 * @param	data the new data of the StreamDataSource, in the format
+		 *			set with @see setFormat
 		 * @param	numSamples the number of samples in data
-		 * @return	a reference to the current StreamDataSource */
+		 * @return	a reference to the current StreamDataSource
+		 * @note	it doesn't lock nor allocate memory, but it must be called
+		 *			always from the same thread, and never while the format
+		 *			setters or @see setConvertOnWrite are being called */
 		StreamDataSource& onNewSamples(
 			const unsigned char* data, std::size_t numSamples
 		);
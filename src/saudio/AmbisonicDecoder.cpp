@@ -0,0 +1,151 @@
+#include <cmath>
+#include <algorithm>
+#include "AmbisonicDecoder.h"
+#include "BatchSpatializer.h"
+#include "SpatializerKernels.h"
+#include "MixKernels.h"
+#include "ObjectAllocation.h"
+#include "LogWrapper.h"
+
+namespace saudio {
+
+	/** The max-rE weights of each degree for each ambisonic order */
+	static constexpr float kMaxREWeights[kMaxAmbisonicOrder][kMaxAmbisonicOrder + 1] = {
+		{ 1.0f, 0.5773503f, 0.0f, 0.0f },
+		{ 1.0f, 0.7745967f, 0.4f, 0.0f },
+		{ 1.0f, 0.8611363f, 0.6123336f, 0.3047088f }
+	};
+
+	/** The in-phase weights of each degree for each ambisonic order */
+	static constexpr float kInPhaseWeights[kMaxAmbisonicOrder][kMaxAmbisonicOrder + 1] = {
+		{ 1.0f, 1.0f / 3.0f, 0.0f, 0.0f },
+		{ 1.0f, 1.0f / 2.0f, 1.0f / 10.0f, 0.0f },
+		{ 1.0f, 3.0f / 5.0f, 1.0f / 5.0f, 1.0f / 35.0f }
+	};
+
+
+	AmbisonicDecoder::AmbisonicDecoder(const Context* context, ma_engine* engine, std::size_t order) :
+		mContext(context), mNumInChannels((order + 1) * (order + 1)), mNumOutChannels(ma_engine_get_channels(engine)),
+		mNode(), mNodeInitialized(false)
+	{
+		std::vector<float> channelDirections(3 * mNumOutChannels);
+		BatchSpatializer::getChannelDirections(mNumOutChannels, channelDirections.data());
+		computeMatrix(order, channelDirections.data());
+
+		static const ma_node_vtable kVTable = { &onProcess, nullptr, 1, 1, 0 };
+		ma_uint32 inputChannels = static_cast<ma_uint32>(mNumInChannels);
+		ma_uint32 outputChannels = static_cast<ma_uint32>(mNumOutChannels);
+		ma_node_config nodeConfig = ma_node_config_init();
+		nodeConfig.vtable = &kVTable;
+		nodeConfig.pInputChannels = &inputChannels;
+		nodeConfig.pOutputChannels = &outputChannels;
+
+		mNode.parent = this;
+		ma_result result = ma_node_init(
+			ma_engine_get_node_graph(engine), &nodeConfig,
+			getMAAllocationCallbacks(mContext, AllocationCategory::Engine), &mNode
+		);
+		if (result != MA_SUCCESS) {
+			SAUDIO_ERROR_LOG(mContext) << "Failed to create the ambisonic decoder node";
+			return;
+		}
+		mNodeInitialized = true;
+
+		ma_node_attach_output_bus(&mNode, 0, ma_engine_get_endpoint(engine), 0);
+		SAUDIO_DEBUG_LOG(mContext) << "Created ambisonic decoder of order " << order << " with " << mNumOutChannels << " outputs";
+	}
+
+
+	AmbisonicDecoder::~AmbisonicDecoder()
+	{
+		if (mNodeInitialized) {
+			ma_node_uninit(&mNode, getMAAllocationCallbacks(mContext, AllocationCategory::Engine));
+		}
+	}
+
+
+	bool AmbisonicDecoder::good() const
+	{
+		return mNodeInitialized;
+	}
+
+
+	ma_node* AmbisonicDecoder::getNode()
+	{
+		return &mNode;
+	}
+
+// Private functions
+	void AmbisonicDecoder::computeMatrix(std::size_t order, const float* channelDirections)
+	{
+		mMatrix.assign(mNumOutChannels * mNumInChannels, 0.0f);
+
+		// The channels without direction (LFE) don't get any signal
+		std::vector<bool> hasDirection(mNumOutChannels);
+		std::size_t numSpeakers = 0;
+		for (std::size_t s = 0; s < mNumOutChannels; ++s) {
+			const float* direction = channelDirections + 3 * s;
+			hasDirection[s] = (direction[0] != 0.0f) || (direction[1] != 0.0f) || (direction[2] != 0.0f);
+			numSpeakers += hasDirection[s]? 1 : 0;
+		}
+		if (numSpeakers == 0) {
+			return;
+		}
+
+		// Sampling decoder, the N3D conversion is merged with the weights
+		const float* weights = (numSpeakers >= 4)? kMaxREWeights[order - 1] : kInPhaseWeights[order - 1];
+		float coefficients[(kMaxAmbisonicOrder + 1) * (kMaxAmbisonicOrder + 1)];
+		for (std::size_t s = 0; s < mNumOutChannels; ++s) {
+			if (!hasDirection[s]) {
+				continue;
+			}
+
+			evaluateAmbisonics(order, channelDirections + 3 * s, coefficients);
+			for (std::size_t k = 0; k < mNumInChannels; ++k) {
+				std::size_t degree = static_cast<std::size_t>(std::sqrt(static_cast<float>(k)) + 1e-3f);
+				mMatrix[s * mNumInChannels + k] = (2 * degree + 1) * weights[degree] * coefficients[k] / numSpeakers;
+			}
+		}
+
+		// Normalize the matrix so a voice in the direction of a speaker is
+		// rendered with unity power
+		float maxPower = 0.0f;
+		for (std::size_t s1 = 0; s1 < mNumOutChannels; ++s1) {
+			if (!hasDirection[s1]) {
+				continue;
+			}
+
+			evaluateAmbisonics(order, channelDirections + 3 * s1, coefficients);
+			float power = 0.0f;
+			for (std::size_t s2 = 0; s2 < mNumOutChannels; ++s2) {
+				float gain = 0.0f;
+				for (std::size_t k = 0; k < mNumInChannels; ++k) {
+					gain += mMatrix[s2 * mNumInChannels + k] * coefficients[k];
+				}
+				power += gain * gain;
+			}
+			maxPower = std::max(maxPower, power);
+		}
+
+		if (maxPower > 0.0f) {
+			float scale = 1.0f / std::sqrt(maxPower);
+			for (float& value : mMatrix) {
+				value *= scale;
+			}
+		}
+	}
+
+
+	void AmbisonicDecoder::onProcess(
+		ma_node* pNode, const float** ppFramesIn, ma_uint32* pFrameCountIn,
+		float** ppFramesOut, ma_uint32* pFrameCountOut
+	) {
+		AmbisonicDecoder* parent = static_cast<Node*>(pNode)->parent;
+
+		ma_uint32 frameCount = std::min(*pFrameCountIn, *pFrameCountOut);
+		mixMatrix(ppFramesOut[0], ppFramesIn[0], frameCount, parent->mNumInChannels, parent->mNumOutChannels, parent->mMatrix.data());
+		*pFrameCountIn = frameCount;
+		*pFrameCountOut = frameCount;
+	}
+
+}
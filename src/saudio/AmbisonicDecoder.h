@@ -0,0 +1,98 @@
+#ifndef SAUDIO_AMBISONIC_DECODER_H
+#define SAUDIO_AMBISONIC_DECODER_H
+
+#include <vector>
+#include <miniaudio.h>
+
+namespace saudio {
+
+	class Context;
+
+
+	/**
+	 * Class AmbisonicDecoder, it holds a miniaudio node that renders an
+	 * ambisonic bus (ACN channel order, SN3D normalization) to the output
+	 * channels of an engine. All the encoded voices are mixed in its input
+	 * bus, so the decoding cost depends on the ambisonic order and the
+	 * number of output channels but not on the number of voices.
+	 *
+	 * @note	it uses a sampling decoder with max-rE weights, or in-phase
+	 *			weights if there are less than 4 output channels with a
+	 *			direction, to avoid the out of phase signals in stereo
+	 */
+	class AmbisonicDecoder
+	{
+	private:	// Nested types
+		/** The miniaudio node of the decoder */
+		struct Node
+		{
+			/** The miniaudio node, it must be the first attribute */
+			ma_node_base base;
+
+			/** The AmbisonicDecoder that holds the node */
+			AmbisonicDecoder* parent;
+		};
+
+	private:	// Attributes
+		/** The Context used for allocating the node */
+		const Context* mContext;
+
+		/** The number of ambisonic channels */
+		std::size_t mNumInChannels;
+
+		/** The number of output channels */
+		std::size_t mNumOutChannels;
+
+		/** The decoding matrix, with one row per output channel */
+		std::vector<float> mMatrix;
+
+		/** The node that decodes the ambisonic bus */
+		Node mNode;
+
+		/** If @see mNode was initialized */
+		bool mNodeInitialized;
+
+	public:		// Functions
+		/** Creates a new AmbisonicDecoder and attaches it to the endpoint of
+		 * the given engine
+		 *
+		 * @param	context a pointer to the Context used for allocating the
+		 *			node, it can be nullptr
+		 * @param	engine the miniaudio engine where the node will be added
+		 * @param	order the ambisonic order, from 1 to
+		 *			@see kMaxAmbisonicOrder */
+		AmbisonicDecoder(const Context* context, ma_engine* engine, std::size_t order);
+		AmbisonicDecoder(const AmbisonicDecoder& other) = delete;
+		AmbisonicDecoder(AmbisonicDecoder&& other) = delete;
+
+		/** Class destructor */
+		~AmbisonicDecoder();
+
+		/** Assignment operator */
+		AmbisonicDecoder& operator=(const AmbisonicDecoder& other) = delete;
+		AmbisonicDecoder& operator=(AmbisonicDecoder&& other) = delete;
+
+		/** @return	true if the AmbisonicDecoder was created successfully,
+		 *			false otherwise */
+		bool good() const;
+
+		/** @return	the node where the encoded voices must be attached */
+		ma_node* getNode();
+	private:
+		/** Calculates @see mMatrix
+		 *
+		 * @param	order the ambisonic order
+		 * @param	channelDirections the unit vectors of each output channel
+		 *			in listener space, 3 floats per channel */
+		void computeMatrix(std::size_t order, const float* channelDirections);
+
+		/** The process callback of the decoder node */
+		static void onProcess(
+			ma_node* pNode, const float** ppFramesIn, ma_uint32* pFrameCountIn,
+			float** ppFramesOut, ma_uint32* pFrameCountOut
+		);
+	};
+
+}
+
+#endif		// SAUDIO_AMBISONIC_DECODER_H
@@ -0,0 +1,154 @@
+#include <cstring>
+#include <algorithm>
+#include "saudio/ArenaAllocator.h"
+
+namespace saudio {
+
+	/** The number of bytes reserved before each allocation for storing its
+	 * size, it keeps the returned memory 16 bytes aligned */
+	static constexpr std::size_t kHeaderSize = 16;
+
+
+	/** The Allocator used if there isn't any upstream one */
+	static Allocator sCAllocator;
+
+
+	/** @return	the given size rounded up to a multiple of
+	 *			@see kHeaderSize */
+	static std::size_t alignSize(std::size_t size)
+	{
+		return (size + kHeaderSize - 1) / kHeaderSize * kHeaderSize;
+	}
+
+
+	/** @return	a reference to the size stored in the header of the given
+	 *			allocation */
+	static std::size_t& getAllocationSize(void* ptr)
+	{
+		return *reinterpret_cast<std::size_t*>(static_cast<unsigned char*>(ptr) - kHeaderSize);
+	}
+
+
+	ArenaAllocator::ArenaAllocator(const Config& config) :
+		mUpstream(config.upstream? config.upstream : &sCAllocator),
+		mChunkSize(alignSize(config.chunkSize)), mChunkOffset(0), mLastAllocation(nullptr),
+		mNumLiveAllocations(0), mReservedBytes(0) {}
+
+
+	ArenaAllocator::~ArenaAllocator()
+	{
+		for (Chunk& chunk : mChunks) {
+			mUpstream->deallocate(chunk.data);
+		}
+	}
+
+
+	std::size_t ArenaAllocator::getNumLiveAllocations()
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		return mNumLiveAllocations;
+	}
+
+
+	std::size_t ArenaAllocator::getReservedBytes()
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		return mReservedBytes;
+	}
+
+
+	void* ArenaAllocator::allocate(std::size_t size)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		return allocateInternal(size);
+	}
+
+
+	void* ArenaAllocator::reallocate(void* ptr, std::size_t size)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		if (!ptr) {
+			return allocateInternal(size);
+		}
+
+		std::size_t& oldSize = getAllocationSize(ptr);
+		if (alignSize(size) <= alignSize(oldSize)) {
+			oldSize = size;
+			return ptr;
+		}
+
+		// The last allocation can grow in place while it fits in its chunk
+		unsigned char* bytes = static_cast<unsigned char*>(ptr);
+		if (bytes == mLastAllocation) {
+			const Chunk& chunk = mChunks.back();
+			std::size_t start = bytes - chunk.data;
+			if (start + alignSize(size) <= chunk.size) {
+				mChunkOffset = start + alignSize(size);
+				oldSize = size;
+				return ptr;
+			}
+		}
+
+		void* newPtr = allocateInternal(size);
+		if (newPtr) {
+			std::memcpy(newPtr, ptr, std::min(oldSize, size));
+			--mNumLiveAllocations;
+		}
+		return newPtr;
+	}
+
+
+	void ArenaAllocator::deallocate(void* ptr)
+	{
+		if (!ptr) {
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(mMutex);
+		if (--mNumLiveAllocations == 0) {
+			rewind();
+		}
+	}
+
+// Private functions
+	void* ArenaAllocator::allocateInternal(std::size_t size)
+	{
+		std::size_t requiredBytes = kHeaderSize + alignSize(size);
+		if (mChunks.empty() || (mChunkOffset + requiredBytes > mChunks.back().size)) {
+			std::size_t chunkSize = std::max(mChunkSize, requiredBytes);
+			auto data = static_cast<unsigned char*>(mUpstream->allocate(chunkSize));
+			if (!data) {
+				return nullptr;
+			}
+
+			mChunks.push_back({ data, chunkSize });
+			mChunkOffset = 0;
+			mReservedBytes += chunkSize;
+		}
+
+		unsigned char* ptr = mChunks.back().data + mChunkOffset + kHeaderSize;
+		mChunkOffset += requiredBytes;
+		getAllocationSize(ptr) = size;
+
+		mLastAllocation = ptr;
+		++mNumLiveAllocations;
+		return ptr;
+	}
+
+
+	void ArenaAllocator::rewind()
+	{
+		for (std::size_t i = 1; i < mChunks.size(); ++i) {
+			mUpstream->deallocate(mChunks[i].data);
+			mReservedBytes -= mChunks[i].size;
+		}
+		if (!mChunks.empty()) {
+			mChunks.resize(1);
+		}
+
+		mChunkOffset = 0;
+		mLastAllocation = nullptr;
+	}
+
+}
@@ -1,11 +1,22 @@
+#include <mutex>
+#include <chrono>
+#include <condition_variable>
 #include <istream>
 #include <algorithm>
 #include <miniaudio.h>
 #include <stdext/ReleaseVector.h>
 #include "saudio/Context.h"
 #include "saudio/AudioEngine.h"
+#include "saudio/RealtimeChecker.h"
 #include "LogWrapper.h"
 #include "MAWrapper.h"
+#include "CallbackProfiler.h"
+#include "ObjectAllocation.h"
+#include "SoundEventQueue.h"
+#include "SoundScheduler.h"
+#include "BatchSpatializer.h"
+#include "ParallelRenderer.h"
+#include "EffectChain.h"
 
 namespace saudio {
 
@@ -38,6 +49,100 @@ namespace saudio {
 	};
 
 
+	struct AudioEngine::OutputConverter
+	{
+		/** The number of frames of @see buffer */
+		static constexpr unsigned int kBufferFrames = 1024;
+
+		ma_data_converter converter;
+		uint32_t engineChannels;
+
+		/** The Engine frames pending to be converted */
+		std::vector<float> buffer;
+		ma_uint64 bufferOffset = 0;
+		ma_uint64 bufferedFrames = 0;
+
+		OutputConverter(uint32_t engineChannels) :
+			engineChannels(engineChannels),
+			buffer(kBufferFrames * engineChannels) {};
+	};
+
+
+	/** The duration in milliseconds of the fades used while changing the
+	 * Device */
+	static constexpr uint32_t kDeviceFadeMs = 10;
+
+	/** The maximum time in milliseconds that a Device change waits for the
+	 * crossfade, ie. if the old Device stops while crossfading */
+	static constexpr uint32_t kDeviceSwitchTimeoutMs = 250;
+
+
+	/**
+	 * Sends the Engine output to a Device. Only one DeviceOutput renders
+	 * the Engine at a time. While the Device changes, the old one copies the
+	 * frames it renders to the new one, so both can play at the same time
+	 * with complementary fades. The fades start once the new one has
+	 * buffered enough frames to cover its callbacks until it renders the
+	 * Engine, so there aren't gaps of silence
+	 */
+	struct AudioEngine::DeviceOutput : public Device::IDeviceDataListener
+	{
+		AudioEngine& engine;
+		Device& device;
+
+		/** Converts the Engine output to the format of @see device, nullptr
+		 * if they match */
+		std::unique_ptr<OutputConverter> converter;
+
+		/** If the Engine is rendered in the callbacks of @see device,
+		 * otherwise the frames are taken from @see crossfadeFrames */
+		std::atomic<bool> rendersEngine;
+
+		/** The DeviceOutput that receives a copy of the rendered Engine
+		 * frames while crossfading, nullptr if there is no crossfade */
+		std::atomic<DeviceOutput*> crossfadeTarget;
+
+		/** The gain applied to the output of @see device */
+		std::atomic<float> fadeGain;
+
+		/** The value that @see fadeGain must reach */
+		std::atomic<float> fadeTarget;
+
+		/** If @see fadeGain has reached zero, it's notified with
+		 * @see fadeCondition so the Device can be changed */
+		std::atomic<bool> fadedOut;
+		std::mutex fadeMutex;
+		std::condition_variable fadeCondition;
+
+		/** The Engine frames copied by the previous DeviceOutput while
+		 * crossfading, it has a single producer and a single consumer. The
+		 * number of frames is a power of two */
+		std::vector<float> crossfadeFrames;
+		std::size_t crossfadeMask = 0;
+		std::atomic<std::size_t> numCrossfadePushed;
+		std::atomic<std::size_t> numCrossfadePopped;
+
+		/** The number of frames that @see crossfadeFrames must hold before
+		 * starting the fades */
+		std::size_t crossfadeStartFrames = 0;
+
+		/** If the fade in has started, set by the audio thread of
+		 * @see device once @see crossfadeStartFrames are buffered */
+		std::atomic<bool> crossfadeStarted;
+
+		DeviceOutput(AudioEngine& engine, Device& device);
+		~DeviceOutput();
+		bool init(bool crossfade);
+		virtual void onDeviceData(
+			void* output, const void* input, unsigned int frameCount
+		) override;
+		void readDeviceFrames(float* output, unsigned int frameCount, bool render);
+		void readEngineFrames(float* output, uint64_t frameCount, bool render);
+		void pushCrossfadeFrames(const float* frames, uint64_t frameCount);
+		void applyFade(float* output, unsigned int frameCount);
+	};
+
+
 	AudioEngine::MaVFS::MaVFS(IVFS* vfs) : vfs(vfs)
 	{
 		callbacks = {
@@ -205,50 +310,347 @@ namespace saudio {
 	}
 
 
-	AudioEngine::AudioEngine(Device& device, const AudioEngine::Config& config) : mDevice(device)
+	AudioEngine::DeviceOutput::DeviceOutput(AudioEngine& engine, Device& device) :
+		engine(engine), device(device), rendersEngine(false), crossfadeTarget(nullptr),
+		fadeGain(1.0f), fadeTarget(1.0f), fadedOut(false),
+		numCrossfadePushed(0), numCrossfadePopped(0), crossfadeStarted(false) {}
+
+
+	AudioEngine::DeviceOutput::~DeviceOutput()
 	{
-		ma_resource_manager_config resourceManagerConfig = ma_resource_manager_config_init();
-		resourceManagerConfig.pLog = static_cast<ma_log*>(Context::getMALog());
-		resourceManagerConfig.decodedFormat = toMAFormat(config.decodeFormat);
-		resourceManagerConfig.decodedChannels = config.decodeChannels;
-		resourceManagerConfig.decodedSampleRate = config.decodeSampleRate;
-		if (config.vfs) {
-			mVFS = std::make_unique<MaVFS>(config.vfs);
-			resourceManagerConfig.pVFS = static_cast<ma_vfs*>(mVFS.get());
+		if (converter) {
+			ma_data_converter_uninit(&converter->converter, getMAAllocationCallbacks(engine.mContext, AllocationCategory::Engine));
 		}
+	}
 
-		mResourceManager = std::make_unique<ma_resource_manager>();
-		ma_result result = ma_resource_manager_init(&resourceManagerConfig, mResourceManager.get());
-		if (result != MA_SUCCESS) {
-			SAUDIO_ERROR_LOG << "ResourceManager creation error";
-			mResourceManager = nullptr;
+
+	bool AudioEngine::DeviceOutput::init(bool crossfade)
+	{
+		ma_device* maDevice = device.getMADevice();
+		uint32_t engineChannels = ma_engine_get_channels(engine.mEngine.get());
+		uint32_t engineSampleRate = ma_engine_get_sample_rate(engine.mEngine.get());
+		if ((maDevice->playback.channels != engineChannels) || (maDevice->sampleRate != engineSampleRate)) {
+			ma_data_converter_config converterConfig = ma_data_converter_config_init(
+				ma_format_f32, ma_format_f32,
+				engineChannels, maDevice->playback.channels,
+				engineSampleRate, maDevice->sampleRate
+			);
+
+			converter = std::make_unique<OutputConverter>(engineChannels);
+			ma_result result = ma_data_converter_init(&converterConfig, getMAAllocationCallbacks(engine.mContext, AllocationCategory::Engine), &converter->converter);
+			if (result != MA_SUCCESS) {
+				SAUDIO_ERROR_LOG(engine.mContext) << "Failed to create the output converter";
+				converter = nullptr;
+				return false;
+			}
+		}
+
+		if (crossfade) {
+			// The buffered frames must cover the fade and the largest read
+			// of the Device callbacks, so they don't run out before this
+			// output starts rendering the Engine
+			uint32_t internalSampleRate = std::max<uint32_t>(maDevice->playback.internalSampleRate, 1);
+			std::size_t periodFrames = static_cast<std::size_t>(
+				uint64_t(maDevice->playback.internalPeriodSizeInFrames) * engineSampleRate / internalSampleRate
+			);
+			crossfadeStartFrames = kDeviceFadeMs * engineSampleRate / 1000
+				+ std::max<std::size_t>(periodFrames, OutputConverter::kBufferFrames);
+
+			// It must also hold the frames pushed by the old Device until
+			// they are read
+			std::size_t minFrames = 2 * crossfadeStartFrames + 4 * kDeviceFadeMs * engineSampleRate / 1000;
+			std::size_t numFrames = 2;
+			while (numFrames < minFrames) {
+				numFrames *= 2;
+			}
+
+			crossfadeFrames.resize(numFrames * engineChannels);
+			crossfadeMask = numFrames - 1;
+			fadeGain.store(0.0f);
+			fadeTarget.store(0.0f);
+		}
+
+		return true;
+	}
+
+
+	void AudioEngine::DeviceOutput::onDeviceData(void* output, const void*, unsigned int frameCount)
+	{
+		ma_device* maDevice = device.getMADevice();
+		float* fOutput = static_cast<float*>(output);
+
+		// Only the callbacks that render the Engine are profiled
+		bool render = rendersEngine.load(std::memory_order_acquire);
+		if (render) {
+			CallbackProfiler::ScopedTimer timer(*engine.mCallbackProfiler, frameCount, maDevice->sampleRate);
+			readDeviceFrames(fOutput, frameCount, true);
+		}
+		else {
+			readDeviceFrames(fOutput, frameCount, false);
+		}
+		applyFade(fOutput, frameCount);
+	}
+
+
+	void AudioEngine::DeviceOutput::readDeviceFrames(float* output, unsigned int frameCount, bool render)
+	{
+		if (!converter) {
+			readEngineFrames(output, frameCount, render);
 			return;
 		}
 
-		ma_engine_config engineConfig = ma_engine_config_init();
-		engineConfig.pResourceManager = mResourceManager.get();
-		engineConfig.pContext = Context::getMAContext();
-		engineConfig.pDevice = mDevice.getMADevice();
-		engineConfig.listenerCount = 1;
+		OutputConverter& oc = *converter;
+		uint32_t deviceChannels = device.getMADevice()->playback.channels;
 
-		mEngine = std::make_unique<ma_engine>();
-		result = ma_engine_init(&engineConfig, mEngine.get());
-		if (result != MA_SUCCESS) {
-			SAUDIO_ERROR_LOG << "Engine creation error";
-			mEngine = nullptr;
+		ma_uint64 remainingFrames = frameCount;
+		while (remainingFrames > 0) {
+			if (oc.bufferedFrames == 0) {
+				ma_uint64 requiredFrames = 0;
+				ma_data_converter_get_required_input_frame_count(&oc.converter, remainingFrames, &requiredFrames);
+				requiredFrames = std::clamp<ma_uint64>(requiredFrames, 1, OutputConverter::kBufferFrames);
+
+				readEngineFrames(oc.buffer.data(), requiredFrames, render);
+				oc.bufferOffset = 0;
+				oc.bufferedFrames = requiredFrames;
+			}
+
+			ma_uint64 framesIn = oc.bufferedFrames, framesOut = remainingFrames;
+			ma_data_converter_process_pcm_frames(
+				&oc.converter, oc.buffer.data() + oc.bufferOffset * oc.engineChannels, &framesIn,
+				output, &framesOut
+			);
+			if ((framesIn == 0) && (framesOut == 0)) {
+				std::fill(output, output + remainingFrames * deviceChannels, 0.0f);
+				break;
+			}
+
+			oc.bufferOffset += framesIn;
+			oc.bufferedFrames -= framesIn;
+			output += framesOut * deviceChannels;
+			remainingFrames -= framesOut;
+		}
+	}
+
+
+	void AudioEngine::DeviceOutput::readEngineFrames(float* output, uint64_t frameCount, bool render)
+	{
+		uint32_t numChannels = ma_engine_get_channels(engine.mEngine.get());
+
+		// The frames copied while crossfading go first, so the audio stays
+		// continuous when this output starts rendering the Engine. If it
+		// already renders the Engine no more frames will be pushed
+		if (!crossfadeFrames.empty()) {
+			std::size_t popped = numCrossfadePopped.load(std::memory_order_relaxed);
+			std::size_t available = numCrossfadePushed.load(std::memory_order_acquire) - popped;
+			if (!render && !crossfadeStarted.load(std::memory_order_relaxed)) {
+				if (available < crossfadeStartFrames) {
+					// Keep buffering, the output is still silent
+					std::fill(output, output + frameCount * numChannels, 0.0f);
+					return;
+				}
+
+				fadeTarget.store(1.0f, std::memory_order_relaxed);
+				crossfadeStarted.store(true, std::memory_order_release);
+			}
+			std::size_t numFrames = static_cast<std::size_t>(std::min<uint64_t>(frameCount, available));
+			for (std::size_t i = 0; i < numFrames; ++i) {
+				const float* frame = crossfadeFrames.data() + ((popped + i) & crossfadeMask) * numChannels;
+				std::copy(frame, frame + numChannels, output + i * numChannels);
+			}
+			numCrossfadePopped.store(popped + numFrames, std::memory_order_release);
+
+			output += numFrames * numChannels;
+			frameCount -= numFrames;
+		}
+
+		if (frameCount == 0) {
 			return;
 		}
 
-		if (!mDevice.addDeviceDataListener(this)) {
-			SAUDIO_ERROR_LOG << "Failed to add as a Device listener";
+		if (!render) {
+			// The old Device has stopped or fallen behind
+			std::fill(output, output + frameCount * numChannels, 0.0f);
 			return;
 		}
+
+		engine.readEngineFrames(output, frameCount);
+
+		DeviceOutput* target = crossfadeTarget.load(std::memory_order_acquire);
+		if (target) {
+			target->pushCrossfadeFrames(output, frameCount);
+
+			// Fade out at the same time that the target fades in
+			if (target->crossfadeStarted.load(std::memory_order_acquire)) {
+				fadeTarget.store(0.0f, std::memory_order_relaxed);
+			}
+		}
+	}
+
+
+	void AudioEngine::DeviceOutput::pushCrossfadeFrames(const float* frames, uint64_t frameCount)
+	{
+		uint32_t numChannels = ma_engine_get_channels(engine.mEngine.get());
+
+		// The frames that don't fit are dropped
+		std::size_t pushed = numCrossfadePushed.load(std::memory_order_relaxed);
+		std::size_t space = crossfadeMask + 1 - (pushed - numCrossfadePopped.load(std::memory_order_acquire));
+		std::size_t numFrames = static_cast<std::size_t>(std::min<uint64_t>(frameCount, space));
+		for (std::size_t i = 0; i < numFrames; ++i) {
+			float* frame = crossfadeFrames.data() + ((pushed + i) & crossfadeMask) * numChannels;
+			std::copy(frames + i * numChannels, frames + (i + 1) * numChannels, frame);
+		}
+		numCrossfadePushed.store(pushed + numFrames, std::memory_order_release);
+	}
+
+
+	void AudioEngine::DeviceOutput::applyFade(float* output, unsigned int frameCount)
+	{
+		float gain = fadeGain.load(std::memory_order_relaxed);
+		float target = fadeTarget.load(std::memory_order_relaxed);
+		if ((gain == target) && (gain == 1.0f)) {
+			return;
+		}
+
+		ma_device* maDevice = device.getMADevice();
+		uint32_t numChannels = maDevice->playback.channels;
+		float step = 1000.0f / (kDeviceFadeMs * maDevice->sampleRate);
+		for (unsigned int i = 0; i < frameCount; ++i) {
+			gain = (gain < target)? std::min(gain + step, target) : std::max(gain - step, target);
+			for (uint32_t j = 0; j < numChannels; ++j) {
+				output[i * numChannels + j] *= gain;
+			}
+		}
+
+		fadeGain.store(gain, std::memory_order_relaxed);
+
+		if ((gain == 0.0f) && (target == 0.0f) && crossfadeTarget.load(std::memory_order_relaxed)
+			&& !fadedOut.exchange(true, std::memory_order_release)
+		) {
+			// It doesn't lock, if the waiting thread misses it it will wake
+			// up with its timeout
+			fadeCondition.notify_all();
+		}
+	}
+
+
+	AudioEngine::ScheduleBatch& AudioEngine::ScheduleBatch::play(const Sound& sound, uint64_t frame)
+	{
+		Command command;
+		command.type = Command::Type::Start;
+		command.soundHandle = sound.getHandle();
+		command.frame = frame;
+		mCommands.push_back(command);
+		return *this;
+	}
+
+
+	AudioEngine::ScheduleBatch& AudioEngine::ScheduleBatch::stop(const Sound& sound, uint64_t frame)
+	{
+		Command command;
+		command.type = Command::Type::Stop;
+		command.soundHandle = sound.getHandle();
+		command.frame = frame;
+		mCommands.push_back(command);
+		return *this;
+	}
+
+
+	AudioEngine::ScheduleBatch& AudioEngine::ScheduleBatch::setToPCMFrame(
+		const Sound& sound, uint64_t frame, uint64_t seekFrame
+	) {
+		Command command;
+		command.type = Command::Type::Seek;
+		command.soundHandle = sound.getHandle();
+		command.frame = frame;
+		command.seekFrame = seekFrame;
+		mCommands.push_back(command);
+		return *this;
+	}
+
+
+	AudioEngine::ScheduleBatch& AudioEngine::ScheduleBatch::automate(
+		const Sound& sound, AutomationParameter parameter, uint64_t frame,
+		const AutomationPoint* points, std::size_t numPoints
+	) {
+		Command command;
+		command.type = Command::Type::Automate;
+		command.soundHandle = sound.getHandle();
+		command.frame = frame;
+		command.parameter = parameter;
+		mCommands.push_back(command);
+
+		AutomationCurve curve;
+		curve.numPoints = std::min(numPoints, kMaxAutomationPoints);
+		std::copy(points, points + curve.numPoints, curve.points);
+		mCurves.push_back(curve);
+		return *this;
+	}
+
+
+	void AudioEngine::ScheduleBatch::clear()
+	{
+		mCommands.clear();
+		mCurves.clear();
+	}
+
+
+	AudioEngine::AudioEngine(Device& device, const AudioEngine::Config& config) :
+		mContext(device.getContext()), mDevice(&device), mCallbackProfiler(std::make_unique<CallbackProfiler>()),
+		mNextSoundHandle(1)
+	{
+		if (device.getType() == Device::DeviceType::Capture) {
+			SAUDIO_ERROR_LOG(mContext) << "Can't render to a capture Device";
+			mDevice = nullptr;
+			return;
+		}
+
+		if (!initInternal(config)) {
+			return;
+		}
+
+		mOutput = std::make_unique<DeviceOutput>(*this, device);
+		if (!mOutput->init(false)) {
+			return;
+		}
+
+		mOutput->rendersEngine.store(true);
+		if (!mDevice->addDeviceDataListener(mOutput.get())) {
+			SAUDIO_ERROR_LOG(mContext) << "Failed to add as a Device listener";
+			return;
+		}
+
+		ma_device* maDevice = mDevice->getMADevice();
+		if (!ma_device_is_started(maDevice) && (ma_device_start(maDevice) != MA_SUCCESS)) {
+			SAUDIO_ERROR_LOG(mContext) << "Failed to start the Device";
+		}
+	}
+
+
+	AudioEngine::AudioEngine(Context& context, const AudioEngine::Config& config) :
+		mContext(&context), mDevice(nullptr), mCallbackProfiler(std::make_unique<CallbackProfiler>()),
+		mNextSoundHandle(1)
+	{
+		initInternal(config);
+	}
+
+
+	AudioEngine::AudioEngine(const AudioEngine::Config& config) :
+		mContext(Context::getDefault()), mDevice(nullptr), mCallbackProfiler(std::make_unique<CallbackProfiler>()),
+		mNextSoundHandle(1)
+	{
+		initInternal(config);
 	}
 
 
 	AudioEngine::~AudioEngine()
 	{
-		mDevice.removeDeviceDataListener(this);
+		if (mDevice && mOutput) {
+			mDevice->removeDeviceDataListener(mOutput.get());
+		}
+		mOutput = nullptr;
+
+		mRenderer = nullptr;
+		mBatchSpatializer = nullptr;
 
 		if (mEngine) {
 			ma_engine_uninit(mEngine.get());
@@ -268,18 +670,121 @@ namespace saudio {
 	}
 
 
-	Device& AudioEngine::getDevice() const
+	Context* AudioEngine::getContext() const
+	{
+		return mContext;
+	}
+
+
+	Device* AudioEngine::getDevice() const
 	{
 		return mDevice;
 	}
 
 
+	bool AudioEngine::setDevice(Device& device)
+	{
+		if (!good() || !device.good()) {
+			return false;
+		}
+		if (device.getType() == Device::DeviceType::Capture) {
+			SAUDIO_ERROR_LOG(mContext) << "Can't render to a capture Device";
+			return false;
+		}
+		if (mContext && (device.getContext() != mContext)) {
+			SAUDIO_ERROR_LOG(mContext) << "The Device belongs to another Context";
+			return false;
+		}
+		if (mDevice == &device) {
+			return true;
+		}
+
+		// Until the crossfade finishes the new output plays the frames
+		// rendered by the old one. On failure the old one is left untouched
+		bool crossfade = (mOutput != nullptr);
+		auto output = std::make_unique<DeviceOutput>(*this, device);
+		if (!output->init(crossfade)) {
+			return false;
+		}
+
+		if (!crossfade) {
+			output->rendersEngine.store(true);
+		}
+		if (!device.addDeviceDataListener(output.get())) {
+			SAUDIO_ERROR_LOG(mContext) << "Failed to add as a Device listener";
+			return false;
+		}
+
+		ma_device* maDevice = device.getMADevice();
+		if (!ma_device_is_started(maDevice) && (ma_device_start(maDevice) != MA_SUCCESS)) {
+			SAUDIO_ERROR_LOG(mContext) << "Failed to start the Device";
+			device.removeDeviceDataListener(output.get());
+			return false;
+		}
+
+		if (crossfade) {
+			// The old Device sends its frames to the new one, and fades out
+			// once the new one has buffered enough of them to fade in
+			mOutput->crossfadeTarget.store(output.get(), std::memory_order_release);
+			{
+				std::unique_lock lock(mOutput->fadeMutex);
+				mOutput->fadeCondition.wait_for(lock, std::chrono::milliseconds(kDeviceSwitchTimeoutMs), [&]() {
+					return mOutput->fadedOut.load(std::memory_order_acquire);
+				});
+			}
+
+			// After this call the old Device won't access to the Engine, so
+			// the new one can start rendering it. If the old one stopped
+			// before finishing the crossfade, the new one fades in anyway
+			mDevice->removeDeviceDataListener(mOutput.get());
+			output->fadeTarget.store(1.0f);
+			output->rendersEngine.store(true, std::memory_order_release);
+		}
+
+		mOutput = std::move(output);
+		mDevice = &device;
+
+		SAUDIO_INFO_LOG(mContext) << "Changed to Device " << maDevice;
+		return true;
+	}
+
+
 	ma_engine* AudioEngine::getMAEngine() const
 	{
 		return mEngine.get();
 	}
 
 
+	uint32_t AudioEngine::getChannels() const
+	{
+		return ma_engine_get_channels(mEngine.get());
+	}
+
+
+	uint32_t AudioEngine::getSampleRate() const
+	{
+		return ma_engine_get_sample_rate(mEngine.get());
+	}
+
+
+	uint64_t AudioEngine::getTimeInPCMFrames() const
+	{
+		return ma_engine_get_time_in_pcm_frames(mEngine.get());
+	}
+
+
+	uint64_t AudioEngine::millisecondsToPCMFrames(uint64_t milliseconds) const
+	{
+		return milliseconds * ma_engine_get_sample_rate(mEngine.get()) / 1000;
+	}
+
+
+	bool AudioEngine::commit(const ScheduleBatch& batch)
+	{
+		return commit(batch.mCommands.data(), batch.mCommands.size(), batch.mCurves.data(), batch.mCurves.size());
+	}
+
+
 	glm::vec3 AudioEngine::getListenerPosition() const
 	{
 		ma_vec3f pos = ma_engine_listener_get_position(mEngine.get(), kListenerIndex);
@@ -289,7 +794,9 @@ namespace saudio {
 
 	AudioEngine& AudioEngine::setListenerPosition(const glm::vec3& position)
 	{
-		ma_engine_listener_set_position(mEngine.get(), kListenerIndex, position.x, position.y, position.z);
+		for (ma_engine* engine : mEngines) {
+			ma_engine_listener_set_position(engine, kListenerIndex, position.x, position.y, position.z);
+		}
 		return *this;
 	}
 
@@ -306,8 +813,10 @@ namespace saudio {
 
 	AudioEngine& AudioEngine::setListenerOrientation(const glm::vec3& forwardVector, const glm::vec3& upVector)
 	{
-		ma_engine_listener_set_direction(mEngine.get(), kListenerIndex, forwardVector.x, forwardVector.y, forwardVector.z);
-		ma_engine_listener_set_world_up(mEngine.get(), kListenerIndex, upVector.x, upVector.y, upVector.z);
+		for (ma_engine* engine : mEngines) {
+			ma_engine_listener_set_direction(engine, kListenerIndex, forwardVector.x, forwardVector.y, forwardVector.z);
+			ma_engine_listener_set_world_up(engine, kListenerIndex, upVector.x, upVector.y, upVector.z);
+		}
 		return *this;
 	}
 
@@ -320,7 +829,9 @@ namespace saudio {
 
 	AudioEngine& AudioEngine::setListenerCone(float innerAngle, float outerAngle, float outerGain)
 	{
-		ma_engine_listener_set_cone(mEngine.get(), kListenerIndex, innerAngle, outerAngle, outerGain);
+		for (ma_engine* engine : mEngines) {
+			ma_engine_listener_set_cone(engine, kListenerIndex, innerAngle, outerAngle, outerGain);
+		}
 		return *this;
 	}
 
@@ -334,14 +845,241 @@ namespace saudio {
 
 	AudioEngine& AudioEngine::setListenerVelocity(const glm::vec3& velocity)
 	{
-		ma_engine_listener_set_velocity(mEngine.get(), kListenerIndex, velocity.x, velocity.y, velocity.z);
+		for (ma_engine* engine : mEngines) {
+			ma_engine_listener_set_velocity(engine, kListenerIndex, velocity.x, velocity.y, velocity.z);
+		}
 		return *this;
 	}
 
 
-	void AudioEngine::onDeviceData(void* output, const void*, unsigned int frameCount)
+	CallbackStats AudioEngine::getCallbackStats() const
+	{
+		return mCallbackProfiler->getStats();
+	}
+
+
+	void AudioEngine::resetCallbackStats()
+	{
+		mCallbackProfiler->reset();
+	}
+
+
+	bool AudioEngine::pollSoundEvent(SoundEvent& event)
+	{
+		return mSoundEvents && mSoundEvents->pop(event);
+	}
+
+
+	uint64_t AudioEngine::takeNumDroppedSoundEvents()
+	{
+		return mSoundEvents? mSoundEvents->takeNumDropped() : 0;
+	}
+
+
+	bool AudioEngine::addMasterEffect(IEffect& effect)
+	{
+		return mMasterEffects->add(effect);
+	}
+
+
+	bool AudioEngine::removeMasterEffect(IEffect& effect)
+	{
+		return mMasterEffects->remove(effect);
+	}
+
+
+	unsigned int AudioEngine::render(float* output, unsigned int frameCount)
+	{
+		if (mDevice) {
+			SAUDIO_ERROR_LOG(mContext) << "Can't render manually an AudioEngine with a Device";
+			return 0;
+		}
+
+		RealtimeChecker::Scope realtimeScope;
+		CallbackProfiler::ScopedTimer timer(*mCallbackProfiler, frameCount, ma_engine_get_sample_rate(mEngine.get()));
+
+		readEngineFrames(output, frameCount);
+		return frameCount;
+	}
+
+// Private functions
+	bool AudioEngine::initInternal(const AudioEngine::Config& config)
+	{
+		mSoundEvents = std::make_unique<SoundEventQueue>(config.soundEventQueueSize);
+		mScheduler = std::make_unique<SoundScheduler>(config.scheduleQueueSize, config.maxAutomations, config.automationBlockSize);
+		mMasterEffects = std::make_unique<EffectChain>(mContext);
+
+		ma_resource_manager_config resourceManagerConfig = ma_resource_manager_config_init();
+		resourceManagerConfig.pLog = mContext? static_cast<ma_log*>(mContext->getMALog()) : nullptr;
+		resourceManagerConfig.decodedFormat = toMAFormat(config.decodeFormat);
+		resourceManagerConfig.decodedChannels = config.decodeChannels;
+		resourceManagerConfig.decodedSampleRate = config.decodeSampleRate;
+		if (config.vfs) {
+			mVFS = std::make_unique<MaVFS>(config.vfs);
+			resourceManagerConfig.pVFS = static_cast<ma_vfs*>(mVFS.get());
+		}
+
+		if (mContext) {
+			resourceManagerConfig.allocationCallbacks = *getMAAllocationCallbacks(mContext, AllocationCategory::Decoding);
+		}
+
+		mResourceManager = makeObject<ma_resource_manager>(mContext, AllocationCategory::Engine);
+		ma_result result = ma_resource_manager_init(&resourceManagerConfig, mResourceManager.get());
+		if (result != MA_SUCCESS) {
+			SAUDIO_ERROR_LOG(mContext) << "ResourceManager creation error";
+			mResourceManager = nullptr;
+			return false;
+		}
+
+		ma_engine_config engineConfig = ma_engine_config_init();
+		engineConfig.pResourceManager = mResourceManager.get();
+		engineConfig.pContext = mContext? mContext->getMAContext() : nullptr;
+		engineConfig.pLog = mContext? static_cast<ma_log*>(mContext->getMALog()) : nullptr;
+		engineConfig.listenerCount = 1;
+		// The Engine never owns the Device, its output is sent to it by
+		// mOutput, so it can be changed later
+		engineConfig.noDevice = MA_TRUE;
+		if (mDevice) {
+			engineConfig.channels = mDevice->getMADevice()->playback.channels;
+			engineConfig.sampleRate = mDevice->getMADevice()->sampleRate;
+		}
+		else {
+			engineConfig.channels = config.outputChannels;
+			engineConfig.sampleRate = config.outputSampleRate;
+		}
+
+		if (mContext) {
+			engineConfig.allocationCallbacks = *getMAAllocationCallbacks(mContext, AllocationCategory::Engine);
+		}
+
+		mEngine = makeObject<ma_engine>(mContext, AllocationCategory::Engine);
+		result = ma_engine_init(&engineConfig, mEngine.get());
+		if (result != MA_SUCCESS) {
+			SAUDIO_ERROR_LOG(mContext) << "Engine creation error";
+			mEngine = nullptr;
+			return false;
+		}
+
+		bool batchSpatialization = config.batchSpatialization || (config.ambisonicOrder > 0) || config.hrtf;
+		BatchSpatializer::Config spatializerConfig;
+		spatializerConfig.maxVoices = config.hrtf? config.maxHrtfVoices : config.maxBatchVoices;
+		spatializerConfig.ambisonicOrder = config.ambisonicOrder;
+		spatializerConfig.hrtf = config.hrtf;
+		spatializerConfig.hrtfBlockSize = config.hrtfBlockSize;
+		if (batchSpatialization) {
+			mBatchSpatializer = std::make_unique<BatchSpatializer>(mContext, mEngine.get(), spatializerConfig);
+		}
+
+		mEngines.push_back(mEngine.get());
+		if (config.numRenderThreads > 0) {
+			mRenderer = std::make_unique<ParallelRenderer>(
+				mContext, mEngine.get(), config.numRenderLanes, config.numRenderThreads,
+				batchSpatialization? &spatializerConfig : nullptr, kListenerIndex
+			);
+			for (std::size_t i = 0; i < mRenderer->getNumLanes(); ++i) {
+				mEngines.push_back(mRenderer->getLaneEngine(i));
+			}
+		}
+
+		return true;
+	}
+
+
+	bool AudioEngine::commit(
+		const ScheduleBatch::Command* commands, std::size_t count,
+		const ScheduleBatch::AutomationCurve* curves, std::size_t numCurves
+	) {
+		if (!mScheduler->push(commands, count, curves, numCurves)) {
+			SAUDIO_WARN_LOG(mContext) << "Not enough space for " << count << " scheduled commands";
+			return false;
+		}
+
+		return true;
+	}
+
+
+	void AudioEngine::readEngineFrames(float* output, uint64_t frameCount)
+	{
+		uint32_t numChannels = ma_engine_get_channels(mEngine.get());
+		uint64_t time = ma_engine_get_time_in_pcm_frames(mEngine.get());
+
+		if (mBatchSpatializer) {
+			mBatchSpatializer->update(kListenerIndex);
+		}
+
+		// The read is splitted at the frames of the seeks and at the
+		// automation blocks, the start and stop times are handled by
+		// miniaudio inside the block
+		float* remainingOutput = output;
+		uint64_t remainingFrames = frameCount;
+		bool scheduling = false;
+		while (remainingFrames > 0) {
+			// If a Sound is cancelling its commands, they are deferred
+			// until the next automation block
+			if (!scheduling) {
+				scheduling = mScheduler->beginBlock();
+				if (scheduling) {
+					mScheduler->update(time);
+				}
+			}
+
+			uint64_t framesToRead = scheduling? mScheduler->process(kMainEngineIndex, time, remainingFrames)
+				: std::min(remainingFrames, mScheduler->getAutomationBlockSize());
+			ma_engine_read_pcm_frames(mEngine.get(), remainingOutput, framesToRead, nullptr);
+
+			remainingOutput += framesToRead * numChannels;
+			remainingFrames -= framesToRead;
+			time += framesToRead;
+		}
+
+		// The lanes are rendered once for the whole read, each one splitted
+		// at the frames of the seeks and automations of its own Sounds
+		if (mRenderer) {
+			mRenderer->render(output, frameCount, scheduling? mScheduler.get() : nullptr);
+		}
+		mMasterEffects->process(output, frameCount, numChannels);
+
+		if (scheduling) {
+			mScheduler->endBlock();
+		}
+	}
+
+
+	ma_engine* AudioEngine::selectSoundEngine() const
+	{
+		ma_engine* engine = mRenderer? mRenderer->selectEngine() : nullptr;
+		return engine? engine : mEngine.get();
+	}
+
+
+	BatchSpatializer* AudioEngine::getBatchSpatializer(ma_engine* engine) const
+	{
+		if (engine == mEngine.get()) {
+			return mBatchSpatializer.get();
+		}
+
+		return mRenderer? mRenderer->getBatchSpatializer(engine) : nullptr;
+	}
+
+
+	std::size_t AudioEngine::getEngineIndex(ma_engine* engine) const
+	{
+		return std::find(mEngines.begin(), mEngines.end(), engine) - mEngines.begin();
+	}
+
+
+	void AudioEngine::onMASoundEnd(void* pUserData, ma_sound* pSound)
 	{
-		ma_engine_read_pcm_frames(mEngine.get(), output, frameCount, nullptr);
+		// Called from the audio thread, the event is queued without locking
+		auto endData = static_cast<const Sound::EndCallbackData*>(pUserData);
+
+		// The Sound can be rendered by one of the engines of the
+		// ParallelRenderer, so the time is taken from its own engine
+		SoundEvent event;
+		event.type = SoundEvent::Type::End;
+		event.sound = endData->handle;
+		event.frame = ma_engine_get_time_in_pcm_frames(ma_sound_get_engine(pSound));
+		endData->audioEngine->mSoundEvents->push(event);
 	}
 
 }
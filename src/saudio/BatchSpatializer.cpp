@@ -0,0 +1,556 @@
+#include <cmath>
+#include <thread>
+#include <algorithm>
+#include "BatchSpatializer.h"
+#include "saudio/Hrtf.h"
+#include "AmbisonicDecoder.h"
+#include "HrtfRenderer.h"
+#include "MixKernels.h"
+#include "ObjectAllocation.h"
+#include "LogWrapper.h"
+
+namespace saudio {
+
+	/** The number of parameters of each voice in @see SpatialVoices */
+	static constexpr std::size_t kNumVoiceParameters = 18;
+
+	/** The maximum number of frames downmixed at the same time for the
+	 * binaural rendering */
+	static constexpr std::size_t kBinauralChunkFrames = 512;
+
+
+	// Private functions
+	/** Returns the unit vector of the given channel position in listener
+	 * space (x right, y up, z forward)
+	 *
+	 * @param	channel the channel position
+	 * @param	direction a pointer to the array where the 3 components of
+	 *			the vector will be stored. It will be zero if the channel
+	 *			doesn't have a direction */
+	static void getChannelDirection(ma_channel channel, float* direction)
+	{
+		static constexpr float kSqrt2 = 0.7071068f;
+		static constexpr float kSqrt3 = 0.5773503f;
+
+		float x = 0.0f, y = 0.0f, z = 0.0f;
+		switch (channel) {
+			case MA_CHANNEL_FRONT_LEFT:			x = -kSqrt2;	z = kSqrt2;		break;
+			case MA_CHANNEL_FRONT_RIGHT:		x = kSqrt2;		z = kSqrt2;		break;
+			case MA_CHANNEL_FRONT_CENTER:						z = 1.0f;		break;
+			case MA_CHANNEL_BACK_LEFT:			x = -kSqrt2;	z = -kSqrt2;	break;
+			case MA_CHANNEL_BACK_RIGHT:			x = kSqrt2;		z = -kSqrt2;	break;
+			case MA_CHANNEL_FRONT_LEFT_CENTER:	x = -0.3826834f;	z = 0.9238795f;	break;
+			case MA_CHANNEL_FRONT_RIGHT_CENTER:	x = 0.3826834f;	z = 0.9238795f;	break;
+			case MA_CHANNEL_BACK_CENTER:						z = -1.0f;		break;
+			case MA_CHANNEL_SIDE_LEFT:			x = -1.0f;						break;
+			case MA_CHANNEL_SIDE_RIGHT:			x = 1.0f;						break;
+			case MA_CHANNEL_TOP_CENTER:			y = 1.0f;						break;
+			case MA_CHANNEL_TOP_FRONT_LEFT:		x = -kSqrt3;	y = kSqrt3;	z = kSqrt3;		break;
+			case MA_CHANNEL_TOP_FRONT_CENTER:	y = kSqrt2;		z = kSqrt2;		break;
+			case MA_CHANNEL_TOP_FRONT_RIGHT:	x = kSqrt3;		y = kSqrt3;	z = kSqrt3;		break;
+			case MA_CHANNEL_TOP_BACK_LEFT:		x = -kSqrt3;	y = kSqrt3;	z = -kSqrt3;	break;
+			case MA_CHANNEL_TOP_BACK_CENTER:	y = kSqrt2;		z = -kSqrt2;	break;
+			case MA_CHANNEL_TOP_BACK_RIGHT:		x = kSqrt3;		y = kSqrt3;	z = -kSqrt3;	break;
+			default:																break;
+		}
+
+		direction[0] = x;
+		direction[1] = y;
+		direction[2] = z;
+	}
+
+
+	/** Transforms the given vector from listener space, where the listener
+	 * looks down -z like in miniaudio, to world space
+	 *
+	 * @param	listener the listener parameters
+	 * @param	v the vector to transform
+	 * @return	the rotated vector, it must be translated by the listener
+	 *			position if it's a position */
+	static ma_vec3f listenerToWorld(const SpatialListener& listener, const ma_vec3f& v)
+	{
+		return {
+			v.x * listener.right[0] + v.y * listener.up[0] - v.z * listener.forward[0],
+			v.x * listener.right[1] + v.y * listener.up[1] - v.z * listener.forward[1],
+			v.x * listener.right[2] + v.y * listener.up[2] - v.z * listener.forward[2]
+		};
+	}
+
+
+	/** Returns the pitch shift of the doppler effect, with the same formula
+	 * than the miniaudio spatializer
+	 *
+	 * @param	relativePosition the position of the listener relative to
+	 *			the voice
+	 * @param	voiceVelocity the velocity of the voice
+	 * @param	listenerVelocity the velocity of the listener
+	 * @param	speedOfSound the speed of sound
+	 * @param	dopplerFactor the doppler factor of the voice
+	 * @return	the pitch multiplier */
+	static float dopplerPitch(
+		const ma_vec3f& relativePosition, const ma_vec3f& voiceVelocity, const ma_vec3f& listenerVelocity,
+		float speedOfSound, float dopplerFactor
+	) {
+		float length = std::sqrt(relativePosition.x * relativePosition.x + relativePosition.y * relativePosition.y + relativePosition.z * relativePosition.z);
+		if (length == 0.0f) {
+			return 1.0f;
+		}
+
+		float maxSpeed = speedOfSound / dopplerFactor;
+		float listenerSpeed = std::min(maxSpeed, (relativePosition.x * listenerVelocity.x + relativePosition.y * listenerVelocity.y + relativePosition.z * listenerVelocity.z) / length);
+		float voiceSpeed = std::min(maxSpeed, (relativePosition.x * voiceVelocity.x + relativePosition.y * voiceVelocity.y + relativePosition.z * voiceVelocity.z) / length);
+		return (speedOfSound - dopplerFactor * listenerSpeed) / (speedOfSound - dopplerFactor * voiceSpeed);
+	}
+
+// Public functions
+	BatchSpatializer::BatchSpatializer(const Context* context, ma_engine* engine, const Config& config) :
+		mContext(context), mEngine(engine), mNumChannels(ma_engine_get_channels(engine)),
+		mAmbisonicOrder(std::min(config.ambisonicOrder, kMaxAmbisonicOrder)), mNumGainChannels(mNumChannels),
+		mMaxVoices((config.maxVoices + kSpatialBatchSize - 1) / kSpatialBatchSize * kSpatialBatchSize),
+		mVoices(new Voice[mMaxVoices]), mNumUsedVoices(0), mUpdateSequence(0),
+		mParameters(kNumVoiceParameters * mMaxVoices), mSpatialVoices(),
+		mChannelDirections(3 * mNumChannels)
+	{
+		if (config.ambisonicOrder > kMaxAmbisonicOrder) {
+			SAUDIO_WARN_LOG(mContext) << "Ambisonic order " << config.ambisonicOrder << " not supported, using " << kMaxAmbisonicOrder;
+		}
+
+		if (config.hrtf) {
+			std::size_t blockSize = config.hrtfBlockSize;
+			if ((blockSize == 0) || ((blockSize & (blockSize - 1)) != 0)) {
+				SAUDIO_ERROR_LOG(mContext) << "HRTF block size " << blockSize << " isn't a power of two, the voices will be panned";
+			}
+			else if (mNumChannels != 2) {
+				SAUDIO_WARN_LOG(mContext) << "HRTF requires a stereo output, the voices will be panned to " << mNumChannels << " channels";
+			}
+			else if (!config.hrtf->good() || (config.hrtf->getNumMeasurements() == 0)) {
+				SAUDIO_ERROR_LOG(mContext) << "Invalid HRTF, the voices will be panned";
+			}
+			else if (config.hrtf->getSampleRate() != ma_engine_get_sample_rate(mEngine)) {
+				SAUDIO_ERROR_LOG(mContext) << "HRTF sample rate " << config.hrtf->getSampleRate()
+					<< " doesn't match the engine one " << ma_engine_get_sample_rate(mEngine) << ", the voices will be panned";
+			}
+			else {
+				mHrtfRenderer = std::make_unique<HrtfRenderer>(*config.hrtf, blockSize, mMaxVoices);
+				mDirections.resize(3 * mMaxVoices, 0.0f);
+				mMonoFrames.resize(kBinauralChunkFrames);
+				mNumGainChannels = 1;
+				mAmbisonicOrder = 0;
+			}
+		}
+
+		if (mAmbisonicOrder > 0) {
+			mDecoder = std::make_unique<AmbisonicDecoder>(mContext, mEngine, mAmbisonicOrder);
+			if (mDecoder->good()) {
+				mNumGainChannels = (mAmbisonicOrder + 1) * (mAmbisonicOrder + 1);
+			}
+			else {
+				SAUDIO_ERROR_LOG(mContext) << "Failed to create the ambisonic decoder, the voices will be panned";
+				mDecoder = nullptr;
+				mAmbisonicOrder = 0;
+			}
+		}
+
+		mGains.resize(mNumGainChannels * mMaxVoices, 1.0f);
+		mAppliedGains.resize(mNumGainChannels * mMaxVoices, 1.0f);
+
+		mFreeVoices.reserve(mMaxVoices);
+		for (std::size_t i = 0; i < mMaxVoices; ++i) {
+			mVoices[i].sound = nullptr;
+			mVoices[i].spatialized = false;
+			mVoices[i].reset = false;
+			mVoices[i].nodeInitialized = false;
+			mVoices[i].output = nullptr;
+			mVoices[i].active = false;
+			mVoices[i].snap = false;
+			mFreeVoices.push_back(mMaxVoices - i - 1);
+		}
+
+		float** arrays[kNumVoiceParameters] = {
+			&mSpatialVoices.positionX, &mSpatialVoices.positionY, &mSpatialVoices.positionZ,
+			&mSpatialVoices.directionX, &mSpatialVoices.directionY, &mSpatialVoices.directionZ,
+			&mSpatialVoices.minDistance, &mSpatialVoices.maxDistance, &mSpatialVoices.rolloff,
+			&mSpatialVoices.inverseWeight, &mSpatialVoices.linearWeight, &mSpatialVoices.fixedAttenuation,
+			&mSpatialVoices.minGain, &mSpatialVoices.maxGain,
+			&mSpatialVoices.coneInnerCos, &mSpatialVoices.coneOuterCos, &mSpatialVoices.coneOuterGain,
+			&mSpatialVoices.spatialized
+		};
+		for (std::size_t i = 0; i < kNumVoiceParameters; ++i) {
+			*arrays[i] = mParameters.data() + i * mMaxVoices;
+		}
+
+		getChannelDirections(mNumChannels, mChannelDirections.data());
+	}
+
+
+	BatchSpatializer::~BatchSpatializer()
+	{
+		for (std::size_t i = 0; i < mMaxVoices; ++i) {
+			if (mVoices[i].nodeInitialized) {
+				ma_node_uninit(&mVoices[i].node, getMAAllocationCallbacks(mContext, AllocationCategory::Engine));
+			}
+		}
+
+		mDecoder = nullptr;
+		mHrtfRenderer = nullptr;
+	}
+
+
+	void BatchSpatializer::getChannelDirections(std::size_t numChannels, float* directions)
+	{
+		if (numChannels == 2) {
+			float stereoDirections[] = { -1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f };
+			std::copy(std::begin(stereoDirections), std::end(stereoDirections), directions);
+		}
+		else {
+			ma_channel channelMap[MA_MAX_CHANNELS];
+			ma_channel_map_init_standard(ma_standard_channel_map_default, channelMap, MA_MAX_CHANNELS, static_cast<ma_uint32>(numChannels));
+			for (std::size_t c = 0; c < numChannels; ++c) {
+				getChannelDirection(channelMap[c], directions + 3 * c);
+			}
+		}
+	}
+
+
+	int BatchSpatializer::addVoice(ma_sound* sound, bool spatialized)
+	{
+		if (mFreeVoices.empty()) {
+			return -1;
+		}
+
+		std::size_t index = mFreeVoices.back();
+		Voice& voice = mVoices[index];
+
+		static const ma_node_vtable kVTable = { &onProcess, nullptr, 1, 1, 0 };
+		ma_uint32 inputChannels = static_cast<ma_uint32>(mNumChannels);
+		ma_uint32 outputChannels = static_cast<ma_uint32>(mHrtfRenderer? mNumChannels : mNumGainChannels);
+		ma_node_config nodeConfig = ma_node_config_init();
+		nodeConfig.vtable = &kVTable;
+		nodeConfig.pInputChannels = &inputChannels;
+		nodeConfig.pOutputChannels = &outputChannels;
+
+		voice.node.parent = this;
+		voice.node.index = index;
+		ma_result result = ma_node_init(
+			ma_engine_get_node_graph(mEngine), &nodeConfig,
+			getMAAllocationCallbacks(mContext, AllocationCategory::Engine), &voice.node
+		);
+		if (result != MA_SUCCESS) {
+			return -1;
+		}
+		voice.nodeInitialized = true;
+		mFreeVoices.pop_back();
+
+		voice.output = nullptr;
+		ma_node* output = mDecoder? mDecoder->getNode() : ma_engine_get_endpoint(mEngine);
+		ma_node_attach_output_bus(&voice.node, 0, output, 0);
+		ma_sound_set_spatialization_enabled(sound, MA_FALSE);
+		route(voice, sound, spatialized);
+
+		voice.spatialized.store(spatialized, std::memory_order_relaxed);
+		voice.reset.store(true, std::memory_order_relaxed);
+		voice.sound.store(sound, std::memory_order_release);
+
+		std::size_t numUsedVoices = mNumUsedVoices.load(std::memory_order_relaxed);
+		if (index + 1 > numUsedVoices) {
+			mNumUsedVoices.store(index + 1, std::memory_order_release);
+		}
+
+		return static_cast<int>(index);
+	}
+
+
+	void BatchSpatializer::removeVoice(int voice)
+	{
+		if ((voice < 0) || (static_cast<std::size_t>(voice) >= mMaxVoices)) {
+			return;
+		}
+
+		Voice& v = mVoices[voice];
+		ma_sound* sound = v.sound.exchange(nullptr);
+		if (!sound) {
+			return;
+		}
+
+		// Wait until the update that could be reading the sound finishes
+		uint64_t sequence = mUpdateSequence.load();
+		if (sequence % 2 == 1) {
+			while (mUpdateSequence.load() == sequence) {
+				std::this_thread::yield();
+			}
+		}
+
+		// Restore the sound routing and uninitialize the gain node
+		ma_node_attach_output_bus(sound, 0, v.output? v.output : ma_engine_get_endpoint(mEngine), 0);
+		ma_sound_set_spatialization_enabled(sound, v.spatialized.load(std::memory_order_relaxed)? MA_TRUE : MA_FALSE);
+		ma_node_uninit(&v.node, getMAAllocationCallbacks(mContext, AllocationCategory::Engine));
+		v.nodeInitialized = false;
+
+		mFreeVoices.push_back(voice);
+	}
+
+
+	bool BatchSpatializer::isSpatialized(int voice) const
+	{
+		return mVoices[voice].spatialized.load(std::memory_order_relaxed);
+	}
+
+
+	void BatchSpatializer::setSpatialized(int voice, bool spatialized)
+	{
+		Voice& v = mVoices[voice];
+		bool wasSpatialized = v.spatialized.exchange(spatialized, std::memory_order_relaxed);
+		if ((mDecoder || mHrtfRenderer) && (wasSpatialized != spatialized)) {
+			route(v, v.sound.load(std::memory_order_relaxed), spatialized);
+		}
+	}
+
+
+	void BatchSpatializer::setOutput(int voice, ma_node* output)
+	{
+		Voice& v = mVoices[voice];
+		v.output = output;
+		if (!mDecoder) {
+			ma_node_attach_output_bus(&v.node, 0, output? output : ma_engine_get_endpoint(mEngine), 0);
+		}
+		route(v, v.sound.load(std::memory_order_relaxed), v.spatialized.load(std::memory_order_relaxed));
+	}
+
+
+	void BatchSpatializer::update(ma_uint32 listenerIndex)
+	{
+		std::size_t numVoices = mNumUsedVoices.load(std::memory_order_acquire);
+		numVoices = (numVoices + kSpatialBatchSize - 1) / kSpatialBatchSize * kSpatialBatchSize;
+		if (numVoices == 0) {
+			return;
+		}
+
+		SpatialListener listener;
+		ma_vec3f position = ma_engine_listener_get_position(mEngine, listenerIndex);
+		ma_vec3f forward = ma_engine_listener_get_direction(mEngine, listenerIndex);
+		ma_vec3f worldUp = ma_engine_listener_get_world_up(mEngine, listenerIndex);
+
+		float forwardLength = std::sqrt(forward.x * forward.x + forward.y * forward.y + forward.z * forward.z);
+		forward = (forwardLength > 0.0f)? ma_vec3f{ forward.x / forwardLength, forward.y / forwardLength, forward.z / forwardLength } : ma_vec3f{ 0.0f, 0.0f, -1.0f };
+		ma_vec3f right = { forward.y * worldUp.z - forward.z * worldUp.y, forward.z * worldUp.x - forward.x * worldUp.z, forward.x * worldUp.y - forward.y * worldUp.x };
+		float rightLength = std::sqrt(right.x * right.x + right.y * right.y + right.z * right.z);
+		right = (rightLength > 0.0f)? ma_vec3f{ right.x / rightLength, right.y / rightLength, right.z / rightLength } : ma_vec3f{ 1.0f, 0.0f, 0.0f };
+		ma_vec3f up = { right.y * forward.z - right.z * forward.y, right.z * forward.x - right.x * forward.z, right.x * forward.y - right.y * forward.x };
+
+		float innerAngle, outerAngle, outerGain;
+		ma_engine_listener_get_cone(mEngine, listenerIndex, &innerAngle, &outerAngle, &outerGain);
+
+		listener.position[0] = position.x;	listener.position[1] = position.y;	listener.position[2] = position.z;
+		listener.right[0] = right.x;		listener.right[1] = right.y;		listener.right[2] = right.z;
+		listener.up[0] = up.x;				listener.up[1] = up.y;				listener.up[2] = up.z;
+		listener.forward[0] = forward.x;	listener.forward[1] = forward.y;	listener.forward[2] = forward.z;
+		listener.coneInnerCos = std::cos(0.5f * innerAngle);
+		listener.coneOuterCos = std::cos(0.5f * outerAngle);
+		listener.coneOuterGain = outerGain;
+
+		mUpdateSequence.fetch_add(1);
+		gatherParameters(numVoices, listener, listenerIndex);
+		mUpdateSequence.fetch_add(1);
+
+		if (mHrtfRenderer) {
+			computeVoiceGains(listener, mSpatialVoices, numVoices, mGains.data(), mDirections.data(), mMaxVoices);
+			for (std::size_t i = 0; i < numVoices; ++i) {
+				if (mVoices[i].active && (mSpatialVoices.spatialized[i] > 0.0f)) {
+					float direction[3] = { mDirections[i], mDirections[mMaxVoices + i], mDirections[2 * mMaxVoices + i] };
+					mHrtfRenderer->setDirection(i, direction);
+				}
+			}
+		}
+		else if (mAmbisonicOrder > 0) {
+			computeAmbisonicGains(listener, mSpatialVoices, numVoices, mAmbisonicOrder, mGains.data(), mMaxVoices);
+		}
+		else {
+			computeSpatialGains(listener, mSpatialVoices, numVoices, mChannelDirections.data(), mNumChannels, mGains.data(), mMaxVoices);
+		}
+	}
+
+// Private functions
+	void BatchSpatializer::gatherParameters(
+		std::size_t numVoices, const SpatialListener& listener, ma_uint32 listenerIndex
+	) {
+		ma_vec3f listenerPosition = { listener.position[0], listener.position[1], listener.position[2] };
+		ma_vec3f listenerVelocity = ma_engine_listener_get_velocity(mEngine, listenerIndex);
+		float speedOfSound = ma_spatializer_listener_get_speed_of_sound(&mEngine->listeners[listenerIndex]);
+
+		for (std::size_t i = 0; i < numVoices; ++i) {
+			ma_sound* sound = mVoices[i].sound.load(std::memory_order_acquire);
+			if (sound) {
+				ma_vec3f position = ma_sound_get_position(sound);
+				ma_vec3f direction = ma_sound_get_direction(sound);
+				ma_vec3f velocity = ma_sound_get_velocity(sound);
+				float innerAngle, outerAngle, outerGain;
+				ma_sound_get_cone(sound, &innerAngle, &outerAngle, &outerGain);
+				bool spatialized = mVoices[i].spatialized.load(std::memory_order_relaxed);
+
+				// The relative voices are moved to world space, so the
+				// kernels only handle the absolute ones
+				if (ma_sound_get_positioning(sound) == ma_positioning_relative) {
+					position = listenerToWorld(listener, position);
+					position = { position.x + listenerPosition.x, position.y + listenerPosition.y, position.z + listenerPosition.z };
+					direction = listenerToWorld(listener, direction);
+					velocity = listenerToWorld(listener, velocity);
+				}
+
+				// The inverse and linear models are evaluated by the kernels,
+				// the exponential one is rarely used and needs a pow, so it's
+				// computed here. Like in miniaudio, the voices without a
+				// distance range aren't attenuated
+				float minDistance = ma_sound_get_min_distance(sound);
+				float maxDistance = ma_sound_get_max_distance(sound);
+				float rolloff = ma_sound_get_rolloff(sound);
+				float inverseWeight = 0.0f, linearWeight = 0.0f, fixedAttenuation = 1.0f;
+				if (minDistance < maxDistance) {
+					switch (ma_sound_get_attenuation_model(sound)) {
+						case ma_attenuation_model_inverse:
+							inverseWeight = 1.0f;
+							break;
+						case ma_attenuation_model_linear:
+							linearWeight = 1.0f;
+							break;
+						case ma_attenuation_model_exponential: {
+							ma_vec3f v = { position.x - listenerPosition.x, position.y - listenerPosition.y, position.z - listenerPosition.z };
+							float distance = std::clamp(std::sqrt(v.x * v.x + v.y * v.y + v.z * v.z), minDistance, maxDistance);
+							fixedAttenuation = std::pow(distance / minDistance, -rolloff);
+						} break;
+						default:
+							break;
+					}
+				}
+
+				// The miniaudio spatialization of the voice is disabled, so
+				// its doppler pitch is set here and applied by the engine
+				// node when it's read
+				float pitch = 1.0f;
+				float dopplerFactor = ma_sound_get_doppler_factor(sound);
+				if (spatialized && (dopplerFactor > 0.0f)) {
+					ma_vec3f relativePosition = { listenerPosition.x - position.x, listenerPosition.y - position.y, listenerPosition.z - position.z };
+					pitch = dopplerPitch(relativePosition, velocity, listenerVelocity, speedOfSound, dopplerFactor);
+				}
+				sound->engineNode.spatializer.dopplerPitch = pitch;
+
+				mSpatialVoices.positionX[i] = position.x;
+				mSpatialVoices.positionY[i] = position.y;
+				mSpatialVoices.positionZ[i] = position.z;
+				mSpatialVoices.directionX[i] = direction.x;
+				mSpatialVoices.directionY[i] = direction.y;
+				mSpatialVoices.directionZ[i] = direction.z;
+				mSpatialVoices.minDistance[i] = minDistance;
+				mSpatialVoices.maxDistance[i] = maxDistance;
+				mSpatialVoices.rolloff[i] = rolloff;
+				mSpatialVoices.inverseWeight[i] = inverseWeight;
+				mSpatialVoices.linearWeight[i] = linearWeight;
+				mSpatialVoices.fixedAttenuation[i] = fixedAttenuation;
+				mSpatialVoices.minGain[i] = ma_sound_get_min_gain(sound);
+				mSpatialVoices.maxGain[i] = ma_sound_get_max_gain(sound);
+				mSpatialVoices.coneInnerCos[i] = std::cos(0.5f * innerAngle);
+				mSpatialVoices.coneOuterCos[i] = std::cos(0.5f * outerAngle);
+				mSpatialVoices.coneOuterGain[i] = outerGain;
+				mSpatialVoices.spatialized[i] = spatialized? 1.0f : 0.0f;
+
+				// The first gains of a new voice aren't ramped from the ones
+				// of the previous voice in the same slot
+				if (mVoices[i].reset.exchange(false, std::memory_order_relaxed)) {
+					mVoices[i].snap = true;
+					if (mHrtfRenderer) {
+						mHrtfRenderer->reset(i);
+					}
+				}
+				mVoices[i].active = true;
+			}
+			else {
+				mVoices[i].active = false;
+
+				// Free voices are passed through, their gains aren't used
+				mSpatialVoices.positionX[i] = mSpatialVoices.positionY[i] = mSpatialVoices.positionZ[i] = 0.0f;
+				mSpatialVoices.directionX[i] = mSpatialVoices.directionY[i] = 0.0f;
+				mSpatialVoices.directionZ[i] = -1.0f;
+				mSpatialVoices.minDistance[i] = mSpatialVoices.maxDistance[i] = mSpatialVoices.rolloff[i] = 1.0f;
+				mSpatialVoices.inverseWeight[i] = mSpatialVoices.linearWeight[i] = 0.0f;
+				mSpatialVoices.fixedAttenuation[i] = 1.0f;
+				mSpatialVoices.minGain[i] = 0.0f;
+				mSpatialVoices.maxGain[i] = 1.0f;
+				mSpatialVoices.coneInnerCos[i] = mSpatialVoices.coneOuterCos[i] = -1.0f;
+				mSpatialVoices.coneOuterGain[i] = 1.0f;
+				mSpatialVoices.spatialized[i] = 0.0f;
+			}
+		}
+	}
+
+
+	void BatchSpatializer::route(Voice& voice, ma_sound* sound, bool spatialized)
+	{
+		// With ambisonics or a Hrtf the not spatialized voices can't go
+		// through the encoder or the convolution, so they skip it and their
+		// node is stopped
+		if ((mDecoder || mHrtfRenderer) && !spatialized) {
+			ma_node_attach_output_bus(sound, 0, voice.output? voice.output : ma_engine_get_endpoint(mEngine), 0);
+			ma_node_set_state(&voice.node, ma_node_state_stopped);
+		}
+		else {
+			ma_node_set_state(&voice.node, ma_node_state_started);
+			ma_node_attach_output_bus(sound, 0, &voice.node, 0);
+		}
+	}
+
+
+	void BatchSpatializer::renderBinaural(
+		std::size_t voice, const float* input, float* output,
+		std::size_t numFrames, float startGain, float endGain
+	) {
+		// The voice is downmixed in chunks, interpolating the gain ramp at
+		// the limits of each chunk
+		for (std::size_t offset = 0; offset < numFrames; offset += kBinauralChunkFrames) {
+			std::size_t count = std::min(numFrames - offset, kBinauralChunkFrames);
+			float chunkStart = startGain + (endGain - startGain) * offset / numFrames;
+			float chunkEnd = startGain + (endGain - startGain) * (offset + count) / numFrames;
+
+			encodeGainRamp(mMonoFrames.data(), input + offset * mNumChannels, count, mNumChannels, 1, &chunkStart, &chunkEnd);
+			mHrtfRenderer->process(voice, mMonoFrames.data(), output + offset * mNumChannels, count);
+		}
+	}
+
+
+	void BatchSpatializer::onProcess(
+		ma_node* pNode, const float** ppFramesIn, ma_uint32* pFrameCountIn,
+		float** ppFramesOut, ma_uint32* pFrameCountOut
+	) {
+		VoiceNode* node = static_cast<VoiceNode*>(pNode);
+		BatchSpatializer* parent = node->parent;
+		Voice& voice = parent->mVoices[node->index];
+		ma_uint32 frameCount = std::min(*pFrameCountIn, *pFrameCountOut);
+		*pFrameCountIn = frameCount;
+		*pFrameCountOut = frameCount;
+
+		// The voice was added after the last update, its gains are unknown
+		if (!voice.active) {
+			std::size_t numOutChannels = parent->mHrtfRenderer? parent->mNumChannels : parent->mNumGainChannels;
+			std::fill(ppFramesOut[0], ppFramesOut[0] + frameCount * numOutChannels, 0.0f);
+			return;
+		}
+
+		float startGains[MA_MAX_CHANNELS], endGains[MA_MAX_CHANNELS];
+		for (std::size_t c = 0; c < parent->mNumGainChannels; ++c) {
+			std::size_t gainIndex = c * parent->mMaxVoices + node->index;
+			endGains[c] = parent->mGains[gainIndex];
+			startGains[c] = voice.snap? endGains[c] : parent->mAppliedGains[gainIndex];
+			parent->mAppliedGains[gainIndex] = endGains[c];
+		}
+		voice.snap = false;
+
+		if (parent->mHrtfRenderer) {
+			parent->renderBinaural(node->index, ppFramesIn[0], ppFramesOut[0], frameCount, startGains[0], endGains[0]);
+		}
+		else if (parent->mAmbisonicOrder > 0) {
+			encodeGainRamp(ppFramesOut[0], ppFramesIn[0], frameCount, parent->mNumChannels, parent->mNumGainChannels, startGains, endGains);
+		}
+		else {
+			applyGainRamp(ppFramesOut[0], ppFramesIn[0], frameCount, parent->mNumChannels, startGains, endGains);
+		}
+	}
+
+}
@@ -0,0 +1,279 @@
+#ifndef SAUDIO_BATCH_SPATIALIZER_H
+#define SAUDIO_BATCH_SPATIALIZER_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <miniaudio.h>
+#include "SpatializerKernels.h"
+
+namespace saudio {
+
+	class Hrtf;
+	class Context;
+	class HrtfRenderer;
+	class AmbisonicDecoder;
+
+
+	/**
+	 * Class BatchSpatializer, it spatializes all the 3D voices of an
+	 * AudioEngine at the same time. The miniaudio spatialization of the
+	 * voices is disabled and their output is routed through a gain node.
+	 * Once per Engine read the parameters of all the voices are gathered
+	 * into arrays and their channel gains are computed together with SIMD
+	 * instructions. Then each gain node applies its gains with a vectorized
+	 * ramp. Optionally the voices can be encoded to a shared ambisonic bus
+	 * instead, that is decoded once to the output channels, or rendered
+	 * binaurally with the HRIRs of a Hrtf.
+	 *
+	 * @note	the voice parameters are still stored in the miniaudio sounds,
+	 *			so the Sound setters don't change. All the attenuation
+	 *			models, the relative positioning and the doppler effect are
+	 *			supported. The unsupported parameters are the directional
+	 *			attenuation factor, the listener handedness and enabled
+	 *			state, the pinned listener of the sounds (the listener of
+	 *			@see update is always used) and the gain smoothing time
+	 *			(the gains are ramped across each Engine read), also the
+	 *			voices are panned with their own algorithm
+	 */
+	class BatchSpatializer
+	{
+	public:		// Nested types
+		/** The parameters of a BatchSpatializer */
+		struct Config
+		{
+			/** The maximum number of voices */
+			std::size_t maxVoices = 4096;
+
+			/** The order of the ambisonic bus where the voices will be
+			 * encoded, 0 to pan them directly to the output channels */
+			std::size_t ambisonicOrder = 0;
+
+			/** The HRIRs used for rendering the voices binaurally, nullptr
+			 * to pan them. It's only used with stereo outputs, and it has
+			 * priority over @see ambisonicOrder. It must outlive the
+			 * BatchSpatializer */
+			const Hrtf* hrtf = nullptr;
+
+			/** The number of frames of the HRTF convolution blocks, it must
+			 * be a power of two. The binaural voices are delayed by it */
+			std::size_t hrtfBlockSize = 128;
+		};
+
+	private:
+		/** The node that applies the gains of a voice */
+		struct VoiceNode
+		{
+			/** The miniaudio node, it must be the first attribute */
+			ma_node_base base;
+
+			/** The BatchSpatializer that holds the voice */
+			BatchSpatializer* parent;
+
+			/** The index of the voice */
+			std::size_t index;
+		};
+
+		/** Holds the state of a voice */
+		struct Voice
+		{
+			/** The sound of the voice, nullptr if the voice is free */
+			std::atomic<ma_sound*> sound;
+
+			/** If the voice must be spatialized */
+			std::atomic<bool> spatialized;
+
+			/** If the gains must be reset because the voice was added */
+			std::atomic<bool> reset;
+
+			/** If @see node was initialized */
+			bool nodeInitialized;
+
+			/** The node where the voice output is sent, nullptr for the
+			 * engine endpoint. Only used by the thread that adds and
+			 * removes the voices */
+			ma_node* output;
+
+			/** If the gains of the voice have been computed and if they must
+			 * be applied without a ramp, only used by the audio thread */
+			bool active, snap;
+
+			/** The node that applies the gains */
+			VoiceNode node;
+		};
+
+	private:	// Attributes
+		/** The Context used for allocating the nodes */
+		const Context* mContext;
+
+		/** The miniaudio engine of the voices */
+		ma_engine* mEngine;
+
+		/** The number of output channels */
+		std::size_t mNumChannels;
+
+		/** The ambisonic order of the encoded voices, 0 if the voices are
+		 * panned directly to the output channels */
+		std::size_t mAmbisonicOrder;
+
+		/** The number of channels of the gain nodes, the output or the
+		 * ambisonic ones */
+		std::size_t mNumGainChannels;
+
+		/** Decodes the ambisonic bus, nullptr if @see mAmbisonicOrder is 0 */
+		std::unique_ptr<AmbisonicDecoder> mDecoder;
+
+		/** Renders the voices binaurally, nullptr if they aren't rendered
+		 * with a Hrtf */
+		std::unique_ptr<HrtfRenderer> mHrtfRenderer;
+
+		/** The maximum number of voices, padded to @see kSpatialBatchSize */
+		std::size_t mMaxVoices;
+
+		/** The voices */
+		std::unique_ptr<Voice[]> mVoices;
+
+		/** The indices of the free voices, only used by the thread that adds
+		 * and removes the voices */
+		std::vector<std::size_t> mFreeVoices;
+
+		/** The number of voices that have been used, the free ones above it
+		 * aren't processed */
+		std::atomic<std::size_t> mNumUsedVoices;
+
+		/** Incremented by the audio thread before and after reading the
+		 * voice sounds, so a voice can be removed safely */
+		std::atomic<uint64_t> mUpdateSequence;
+
+		/** The parameters of the voices, stored as a structure of arrays */
+		std::vector<float> mParameters;
+		SpatialVoices mSpatialVoices;
+
+		/** The unit vectors of the output channels in listener space, only
+		 * used for panning */
+		std::vector<float> mChannelDirections;
+
+		/** The gains computed in the last update and the ones applied by the
+		 * nodes, stored per channel */
+		std::vector<float> mGains, mAppliedGains;
+
+		/** The directions of the voices in listener space computed in the
+		 * last update, stored per component. Only used with a Hrtf */
+		std::vector<float> mDirections;
+
+		/** The downmixed frames of the voice being rendered binaurally */
+		std::vector<float> mMonoFrames;
+
+	public:		// Functions
+		/** Creates a new BatchSpatializer
+		 *
+		 * @param	context a pointer to the Context used for allocating the
+		 *			nodes, it can be nullptr
+		 * @param	engine the miniaudio engine of the voices
+		 * @param	config the parameters of the BatchSpatializer */
+		BatchSpatializer(const Context* context, ma_engine* engine, const Config& config);
+		BatchSpatializer(const BatchSpatializer& other) = delete;
+		BatchSpatializer(BatchSpatializer&& other) = delete;
+
+		/** Class destructor */
+		~BatchSpatializer();
+
+		/** Assignment operator */
+		BatchSpatializer& operator=(const BatchSpatializer& other) = delete;
+		BatchSpatializer& operator=(BatchSpatializer&& other) = delete;
+
+		/** Calculates the unit vectors of the output channels in listener
+		 * space (x right, y up, z forward). The stereo outputs are panned
+		 * laterally, the other layouts use the direction of each channel of
+		 * the default miniaudio channel map
+		 *
+		 * @param	numChannels the number of output channels
+		 * @param	directions a pointer to the array where the 3 components
+		 *			of each vector will be stored. It will be zero for the
+		 *			channels without direction */
+		static void getChannelDirections(std::size_t numChannels, float* directions);
+
+		/** Adds the given sound as a voice, routing its output through a
+		 * gain node. It must be called always from the same thread
+		 *
+		 * @param	sound the sound to spatialize, it must be attached to the
+		 *			engine endpoint
+		 * @param	spatialized if the sound must be spatialized
+		 * @return	the index of the voice, -1 if there are no free voices */
+		int addVoice(ma_sound* sound, bool spatialized);
+
+		/** Removes the given voice. It must be called from the same thread
+		 * than @see addVoice and before uninitializing its sound
+		 *
+		 * @param	voice the index of the voice */
+		void removeVoice(int voice);
+
+		/** @return	true if the given voice is spatialized, false otherwise */
+		bool isSpatialized(int voice) const;
+
+		/** Sets if the given voice must be spatialized
+		 *
+		 * @param	voice the index of the voice
+		 * @param	spatialized true if the voice must be spatialized, false
+		 *			if it must be passed through. With ambisonics or a Hrtf
+		 *			the not spatialized voices are routed directly to the
+		 *			output */
+		void setSpatialized(int voice, bool spatialized);
+
+		/** Sets where the output of the given voice is sent
+		 *
+		 * @param	voice the index of the voice
+		 * @param	output the node where the voice will be attached,
+		 *			nullptr for the engine endpoint. With ambisonics the
+		 *			spatialized voices are still encoded to the ambisonic
+		 *			bus, that is decoded to the endpoint */
+		void setOutput(int voice, ma_node* output);
+
+		/** Computes the gains of all the voices. It must be called from the
+		 * audio thread before reading from the engine
+		 *
+		 * @param	listenerIndex the index of the engine listener */
+		void update(ma_uint32 listenerIndex);
+	private:
+		/** Gathers the parameters of all the voices and updates their
+		 * doppler pitch
+		 *
+		 * @param	numVoices the number of voices to gather
+		 * @param	listener the parameters of the listener
+		 * @param	listenerIndex the index of the engine listener */
+		void gatherParameters(
+			std::size_t numVoices, const SpatialListener& listener, ma_uint32 listenerIndex
+		);
+
+		/** Attaches the sound of the given voice to its gain node or to its
+		 * output
+		 *
+		 * @param	voice the voice to update
+		 * @param	sound the sound of the voice
+		 * @param	spatialized if the voice must be spatialized */
+		void route(Voice& voice, ma_sound* sound, bool spatialized);
+
+		/** Renders the given voice with @see mHrtfRenderer
+		 *
+		 * @param	voice the index of the voice
+		 * @param	input a pointer to the frames of the voice
+		 * @param	output a pointer to the array where the stereo frames
+		 *			will be stored
+		 * @param	numFrames the number of frames to render
+		 * @param	startGain the gain of the voice at the first frame
+		 * @param	endGain the gain of the voice after the last frame */
+		void renderBinaural(
+			std::size_t voice, const float* input, float* output,
+			std::size_t numFrames, float startGain, float endGain
+		);
+
+		/** The process callback of the voice nodes */
+		static void onProcess(
+			ma_node* pNode, const float** ppFramesIn, ma_uint32* pFrameCountIn,
+			float** ppFramesOut, ma_uint32* pFrameCountOut
+		);
+	};
+
+}
+
+#endif		// SAUDIO_BATCH_SPATIALIZER_H
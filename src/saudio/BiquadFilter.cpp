@@ -0,0 +1,157 @@
+#include <cmath>
+#include <algorithm>
+#include "saudio/BiquadFilter.h"
+#include "saudio/AudioEngine.h"
+#include "EffectKernels.h"
+#include "LogWrapper.h"
+
+namespace saudio {
+
+	static_assert(BiquadFilter::kMaxStages <= kMaxBiquadStages, "Too many BiquadFilter stages");
+
+
+	// Private functions
+	/** Computes the coefficients of a biquad stage with the formulas of the
+	 * Audio EQ Cookbook by Robert Bristow-Johnson
+	 *
+	 * @param	type the response of the stage
+	 * @param	frequency the cutoff or center frequency in Hz
+	 * @param	q the quality factor of the stage
+	 * @param	gainDB the gain in decibels of the peaking and shelving
+	 *			stages
+	 * @param	sampleRate the sample rate of the filtered frames
+	 * @return	the normalized coefficients */
+	static BiquadCoefficients computeCoefficients(
+		BiquadFilter::Type type, float frequency, float q, float gainDB, float sampleRate
+	) {
+		static constexpr double kPi = 3.14159265358979323846;
+
+		double w0 = 2.0 * kPi * std::clamp(frequency, 1.0f, 0.49f * sampleRate) / sampleRate;
+		double cosW0 = std::cos(w0);
+		double alpha = std::sin(w0) / (2.0 * std::max(q, 0.01f));
+		double a = std::pow(10.0, gainDB / 40.0);
+		double sqrtA2Alpha = 2.0 * std::sqrt(a) * alpha;
+
+		double b0 = 1.0, b1 = 0.0, b2 = 0.0, a0 = 1.0, a1 = 0.0, a2 = 0.0;
+		switch (type) {
+			case BiquadFilter::Type::LowPass:
+				b0 = (1.0 - cosW0) / 2.0;	b1 = 1.0 - cosW0;	b2 = b0;
+				a0 = 1.0 + alpha;	a1 = -2.0 * cosW0;	a2 = 1.0 - alpha;
+				break;
+			case BiquadFilter::Type::HighPass:
+				b0 = (1.0 + cosW0) / 2.0;	b1 = -(1.0 + cosW0);	b2 = b0;
+				a0 = 1.0 + alpha;	a1 = -2.0 * cosW0;	a2 = 1.0 - alpha;
+				break;
+			case BiquadFilter::Type::BandPass:
+				b0 = alpha;	b1 = 0.0;	b2 = -alpha;
+				a0 = 1.0 + alpha;	a1 = -2.0 * cosW0;	a2 = 1.0 - alpha;
+				break;
+			case BiquadFilter::Type::Notch:
+				b0 = 1.0;	b1 = -2.0 * cosW0;	b2 = 1.0;
+				a0 = 1.0 + alpha;	a1 = -2.0 * cosW0;	a2 = 1.0 - alpha;
+				break;
+			case BiquadFilter::Type::Peaking:
+				b0 = 1.0 + alpha * a;	b1 = -2.0 * cosW0;	b2 = 1.0 - alpha * a;
+				a0 = 1.0 + alpha / a;	a1 = -2.0 * cosW0;	a2 = 1.0 - alpha / a;
+				break;
+			case BiquadFilter::Type::LowShelf:
+				b0 = a * ((a + 1.0) - (a - 1.0) * cosW0 + sqrtA2Alpha);
+				b1 = 2.0 * a * ((a - 1.0) - (a + 1.0) * cosW0);
+				b2 = a * ((a + 1.0) - (a - 1.0) * cosW0 - sqrtA2Alpha);
+				a0 = (a + 1.0) + (a - 1.0) * cosW0 + sqrtA2Alpha;
+				a1 = -2.0 * ((a - 1.0) + (a + 1.0) * cosW0);
+				a2 = (a + 1.0) + (a - 1.0) * cosW0 - sqrtA2Alpha;
+				break;
+			case BiquadFilter::Type::HighShelf:
+				b0 = a * ((a + 1.0) + (a - 1.0) * cosW0 + sqrtA2Alpha);
+				b1 = -2.0 * a * ((a - 1.0) + (a + 1.0) * cosW0);
+				b2 = a * ((a + 1.0) + (a - 1.0) * cosW0 - sqrtA2Alpha);
+				a0 = (a + 1.0) - (a - 1.0) * cosW0 + sqrtA2Alpha;
+				a1 = 2.0 * ((a - 1.0) - (a + 1.0) * cosW0);
+				a2 = (a + 1.0) - (a - 1.0) * cosW0 - sqrtA2Alpha;
+				break;
+		}
+
+		BiquadCoefficients ret;
+		ret.b0 = static_cast<float>(b0 / a0);
+		ret.b1 = static_cast<float>(b1 / a0);
+		ret.b2 = static_cast<float>(b2 / a0);
+		ret.a1 = static_cast<float>(a1 / a0);
+		ret.a2 = static_cast<float>(a2 / a0);
+		return ret;
+	}
+
+// Public functions
+	BiquadFilter::BiquadFilter(AudioEngine& engine, std::size_t numStages) :
+		mSampleRate(static_cast<float>(engine.getSampleRate())), mNumChannels(engine.getChannels()),
+		mNumStages(std::min(numStages, kMaxStages)), mVersion(0), mAppliedVersion(0),
+		mCoefficients(new BiquadCoefficients[kMaxStages]), mState(2 * kMaxStages * mNumChannels, 0.0f)
+	{
+		if (numStages > kMaxStages) {
+			SAUDIO_WARN_LOG(engine.getContext()) << "Can't create " << numStages << " stages, using " << kMaxStages;
+		}
+
+		// The stages are identity filters (0 dB Peaking) until they are set
+		for (Stage& stage : mStages) {
+			stage.type.store(static_cast<int>(Type::Peaking), std::memory_order_relaxed);
+			stage.frequency.store(1000.0f, std::memory_order_relaxed);
+			stage.q.store(0.7071f, std::memory_order_relaxed);
+			stage.gainDB.store(0.0f, std::memory_order_relaxed);
+		}
+	}
+
+
+	BiquadFilter::~BiquadFilter() {}
+
+
+	std::size_t BiquadFilter::getNumStages() const
+	{
+		return mNumStages;
+	}
+
+
+	bool BiquadFilter::setStage(std::size_t stage, Type type, float frequency, float q, float gainDB)
+	{
+		if (stage >= mNumStages) {
+			return false;
+		}
+
+		mStages[stage].type.store(static_cast<int>(type), std::memory_order_relaxed);
+		mStages[stage].frequency.store(frequency, std::memory_order_relaxed);
+		mStages[stage].q.store(q, std::memory_order_relaxed);
+		mStages[stage].gainDB.store(gainDB, std::memory_order_relaxed);
+		mVersion.fetch_add(1, std::memory_order_release);
+		return true;
+	}
+
+
+	void BiquadFilter::process(float* frames, std::size_t numFrames, std::size_t numChannels)
+	{
+		if ((numFrames == 0) || (numChannels > mNumChannels)) {
+			return;
+		}
+
+		uint32_t version = mVersion.load(std::memory_order_acquire);
+		if (version != mAppliedVersion) {
+			updateCoefficients();
+			mAppliedVersion = version;
+		}
+
+		processBiquads(frames, numFrames, numChannels, mCoefficients.get(), mNumStages, mState.data());
+	}
+
+// Private functions
+	void BiquadFilter::updateCoefficients()
+	{
+		for (std::size_t i = 0; i < mNumStages; ++i) {
+			mCoefficients[i] = computeCoefficients(
+				static_cast<Type>(mStages[i].type.load(std::memory_order_relaxed)),
+				mStages[i].frequency.load(std::memory_order_relaxed),
+				mStages[i].q.load(std::memory_order_relaxed),
+				mStages[i].gainDB.load(std::memory_order_relaxed),
+				mSampleRate
+			);
+		}
+	}
+
+}
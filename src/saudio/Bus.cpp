@@ -0,0 +1,141 @@
+#include <algorithm>
+#include "saudio/Bus.h"
+#include "saudio/AudioEngine.h"
+#include "EffectChain.h"
+#include "LogWrapper.h"
+#include "ObjectAllocation.h"
+
+namespace saudio {
+
+	/**
+	 * Struct BusNode, the miniaudio node of a Bus
+	 */
+	struct BusNode
+	{
+		/** The miniaudio node, it must be the first attribute */
+		ma_node_base base;
+
+		/** The Bus that holds the node */
+		Bus* parent;
+
+		/** The process callback of the node */
+		static void onProcess(
+			ma_node* pNode, const float** ppFramesIn, ma_uint32* pFrameCountIn,
+			float** ppFramesOut, ma_uint32* pFrameCountOut
+		) {
+			Bus* parent = static_cast<BusNode*>(pNode)->parent;
+
+			ma_uint32 frameCount = std::min(*pFrameCountIn, *pFrameCountOut);
+			std::copy(ppFramesIn[0], ppFramesIn[0] + frameCount * parent->mNumChannels, ppFramesOut[0]);
+			parent->mEffectChain->process(ppFramesOut[0], frameCount, parent->mNumChannels);
+			*pFrameCountIn = frameCount;
+			*pFrameCountOut = frameCount;
+		}
+	};
+
+
+	Bus::Bus(AudioEngine& audioEngine) : Bus(audioEngine, audioEngine.getMAEngine()) {}
+
+
+	Bus::~Bus()
+	{
+		if (mNodeInitialized) {
+			ma_node_uninit(mNode.get(), getMAAllocationCallbacks(mContext, AllocationCategory::Engine));
+			SAUDIO_DEBUG_LOG(mContext) << "Deleted Bus " << this;
+		}
+	}
+
+
+	bool Bus::good() const
+	{
+		return mNodeInitialized;
+	}
+
+
+	std::size_t Bus::getChannels() const
+	{
+		return mNumChannels;
+	}
+
+
+	float Bus::getVolume() const
+	{
+		return ma_node_get_output_bus_volume(mNode.get(), 0);
+	}
+
+
+	Bus& Bus::setVolume(float volume)
+	{
+		ma_node_set_output_bus_volume(mNode.get(), 0, volume);
+		return *this;
+	}
+
+
+	bool Bus::setOutput(Bus* output)
+	{
+		if (output == this) {
+			SAUDIO_ERROR_LOG(mContext) << "A Bus can't be sent to itself";
+			return false;
+		}
+		if (output && (output->mEngine != mEngine)) {
+			SAUDIO_ERROR_LOG(mContext) << "The output Bus must be rendered by the same engine";
+			return false;
+		}
+
+		ma_node* outputNode = output? static_cast<ma_node*>(output->mNode.get()) : ma_engine_get_endpoint(mEngine);
+		return ma_node_attach_output_bus(mNode.get(), 0, outputNode, 0) == MA_SUCCESS;
+	}
+
+
+	bool Bus::addEffect(IEffect& effect)
+	{
+		return mEffectChain->add(effect);
+	}
+
+
+	bool Bus::removeEffect(IEffect& effect)
+	{
+		return mEffectChain->remove(effect);
+	}
+
+// Private functions
+	Bus::Bus(AudioEngine& audioEngine, ma_engine* engine) :
+		mContext(audioEngine.getContext()), mAudioEngine(&audioEngine), mEngine(engine),
+		mNumChannels(audioEngine.getChannels()), mNodeInitialized(false),
+		mEffectChain(std::make_unique<EffectChain>(mContext))
+	{
+		if (!engine) {
+			SAUDIO_ERROR_LOG(mContext) << "Can't create a Bus without an engine";
+			return;
+		}
+
+		mNode = makeObject<BusNode>(mContext, AllocationCategory::Engine);
+		if (!mNode) {
+			SAUDIO_ERROR_LOG(mContext) << "Failed to allocate the Bus node";
+			return;
+		}
+
+		static const ma_node_vtable kVTable = { &BusNode::onProcess, nullptr, 1, 1, 0 };
+		ma_uint32 numChannels = static_cast<ma_uint32>(mNumChannels);
+		ma_node_config nodeConfig = ma_node_config_init();
+		nodeConfig.vtable = &kVTable;
+		nodeConfig.pInputChannels = &numChannels;
+		nodeConfig.pOutputChannels = &numChannels;
+
+		mNode->parent = this;
+		ma_result result = ma_node_init(
+			ma_engine_get_node_graph(engine), &nodeConfig,
+			getMAAllocationCallbacks(mContext, AllocationCategory::Engine), mNode.get()
+		);
+		if (result != MA_SUCCESS) {
+			SAUDIO_ERROR_LOG(mContext) << "Failed to create the Bus node";
+			mNode = nullptr;
+			return;
+		}
+		mNodeInitialized = true;
+
+		ma_node_attach_output_bus(mNode.get(), 0, ma_engine_get_endpoint(engine), 0);
+		SAUDIO_DEBUG_LOG(mContext) << "Created Bus " << this;
+	}
+
+}
@@ -0,0 +1,142 @@
+#ifndef SAUDIO_CALLBACK_PROFILER_H
+#define SAUDIO_CALLBACK_PROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include "saudio/CallbackStats.h"
+
+namespace saudio {
+
+	/**
+	 * Class CallbackProfiler, it's used for measuring the duration of the
+	 * audio callbacks. The measures are recorded with relaxed atomics, so
+	 * they can be written from the audio thread without locks and read from
+	 * any other thread
+	 */
+	class CallbackProfiler
+	{
+	public:		// Nested types
+		/** Class ScopedTimer, records the time elapsed between its creation
+		 * and its destruction in a CallbackProfiler */
+		class ScopedTimer
+		{
+		private:	// Attributes
+			/** The CallbackProfiler where the duration will be recorded */
+			CallbackProfiler& mProfiler;
+
+			/** The budget in nanoseconds of the measured callback */
+			uint64_t mBudgetNs;
+
+			/** The time point where the measure started */
+			std::chrono::steady_clock::time_point mStart;
+
+		public:		// Functions
+			/** Creates a new ScopedTimer
+			 *
+			 * @param	profiler the CallbackProfiler where the duration will
+			 *			be recorded
+			 * @param	frameCount the number of frames of the callback
+			 * @param	sampleRate the sample rate of the frames */
+			ScopedTimer(
+				CallbackProfiler& profiler,
+				uint64_t frameCount, uint32_t sampleRate
+			) : mProfiler(profiler),
+				mBudgetNs(sampleRate? (1000000000ull * frameCount / sampleRate) : 0),
+				mStart(std::chrono::steady_clock::now()) {};
+
+			/** Class destructor */
+			~ScopedTimer()
+			{
+				auto duration = std::chrono::steady_clock::now() - mStart;
+				mProfiler.record(
+					std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count(),
+					mBudgetNs
+				);
+			};
+		};
+
+	private:	// Attributes
+		/** The load resolution used for storing the worst load atomically */
+		static constexpr uint64_t kLoadScale = 1000;
+
+		std::atomic<uint64_t> mNumCallbacks = 0;
+		std::atomic<uint64_t> mNumDeadlineMisses = 0;
+		std::atomic<uint64_t> mLastDurationNs = 0;
+		std::atomic<uint64_t> mLastBudgetNs = 0;
+		std::atomic<uint64_t> mWorstDurationNs = 0;
+		std::atomic<uint64_t> mWorstScaledLoad = 0;
+		std::array<std::atomic<uint64_t>, CallbackStats::kNumBuckets> mLoadHistogram = {};
+
+	public:		// Functions
+		/** Records a new callback duration
+		 *
+		 * @param	durationNs the duration in nanoseconds of the callback
+		 * @param	budgetNs the budget in nanoseconds of the callback */
+		void record(uint64_t durationNs, uint64_t budgetNs)
+		{
+			mNumCallbacks.fetch_add(1, std::memory_order_relaxed);
+			mLastDurationNs.store(durationNs, std::memory_order_relaxed);
+			mLastBudgetNs.store(budgetNs, std::memory_order_relaxed);
+			if (durationNs > budgetNs) {
+				mNumDeadlineMisses.fetch_add(1, std::memory_order_relaxed);
+			}
+
+			uint64_t scaledLoad = budgetNs? (kLoadScale * durationNs / budgetNs) : 0;
+			storeMax(mWorstDurationNs, durationNs);
+			storeMax(mWorstScaledLoad, scaledLoad);
+
+			uint64_t bucketScaledLoad = static_cast<uint64_t>(CallbackStats::kBucketLoad * kLoadScale);
+			std::size_t iBucket = std::min<uint64_t>(scaledLoad / bucketScaledLoad, CallbackStats::kNumBuckets - 1);
+			mLoadHistogram[iBucket].fetch_add(1, std::memory_order_relaxed);
+		};
+
+		/** @return	a snapshot of the recorded durations. Since every field
+		 *			is read independently, a snapshot taken while a callback
+		 *			is being recorded could mix values of both callbacks */
+		CallbackStats getStats() const
+		{
+			CallbackStats ret;
+			ret.numCallbacks = mNumCallbacks.load(std::memory_order_relaxed);
+			ret.numDeadlineMisses = mNumDeadlineMisses.load(std::memory_order_relaxed);
+			ret.lastDurationNs = mLastDurationNs.load(std::memory_order_relaxed);
+			ret.lastBudgetNs = mLastBudgetNs.load(std::memory_order_relaxed);
+			ret.worstDurationNs = mWorstDurationNs.load(std::memory_order_relaxed);
+			ret.worstLoad = static_cast<float>(mWorstScaledLoad.load(std::memory_order_relaxed)) / kLoadScale;
+			for (std::size_t i = 0; i < CallbackStats::kNumBuckets; ++i) {
+				ret.loadHistogram[i] = mLoadHistogram[i].load(std::memory_order_relaxed);
+			}
+			return ret;
+		};
+
+		/** Clears all the recorded durations */
+		void reset()
+		{
+			mNumCallbacks.store(0, std::memory_order_relaxed);
+			mNumDeadlineMisses.store(0, std::memory_order_relaxed);
+			mLastDurationNs.store(0, std::memory_order_relaxed);
+			mLastBudgetNs.store(0, std::memory_order_relaxed);
+			mWorstDurationNs.store(0, std::memory_order_relaxed);
+			mWorstScaledLoad.store(0, std::memory_order_relaxed);
+			for (auto& bucket : mLoadHistogram) {
+				bucket.store(0, std::memory_order_relaxed);
+			}
+		};
+	private:
+		/** Stores the given value in the given atomic if it's greater than
+		 * its current one
+		 *
+		 * @param	atomic the atomic to update
+		 * @param	value the new value */
+		static void storeMax(std::atomic<uint64_t>& atomic, uint64_t value)
+		{
+			uint64_t current = atomic.load(std::memory_order_relaxed);
+			while ((value > current)
+				&& !atomic.compare_exchange_weak(current, value, std::memory_order_relaxed)
+			);
+		};
+	};
+
+}
+
+#endif		// SAUDIO_CALLBACK_PROFILER_H
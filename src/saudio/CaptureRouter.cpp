@@ -0,0 +1,95 @@
+#include <vector>
+#include <algorithm>
+#include <miniaudio.h>
+#include "saudio/CaptureRouter.h"
+#include "saudio/StreamDataSource.h"
+#include "MAWrapper.h"
+#include "LogWrapper.h"
+
+namespace saudio {
+
+	CaptureRouter::CaptureRouter(Device& device, StreamDataSource& streamDataSource) :
+		mDevice(device), mStreamDataSource(streamDataSource), mGood(false)
+	{
+		if (!mDevice.good() || !mStreamDataSource.good()) {
+			SAUDIO_ERROR_LOG(mDevice.getContext()) << "Invalid Device or StreamDataSource";
+			return;
+		}
+		if (mDevice.getType() == Device::DeviceType::Playback) {
+			SAUDIO_ERROR_LOG(mDevice.getContext()) << "Can't capture frames from a playback Device";
+			return;
+		}
+
+		// The StreamDataSource could be already binded, so it's never
+		// reconfigured here
+		const ma_device* maDevice = mDevice.getMADevice();
+		if ((mStreamDataSource.getNumChannels() != static_cast<int>(maDevice->capture.channels))
+			|| (mStreamDataSource.getSampleRate() != maDevice->sampleRate)
+			|| (mStreamDataSource.getFormat() != fromMAFormat(maDevice->capture.format))
+		) {
+			SAUDIO_ERROR_LOG(mDevice.getContext()) << "The StreamDataSource format doesn't match the capture one of the Device";
+			return;
+		}
+
+		if (!mDevice.addDeviceDataListener(this)) {
+			SAUDIO_ERROR_LOG(mDevice.getContext()) << "Failed to add as a Device listener";
+			return;
+		}
+
+		mGood = true;
+	}
+
+
+	CaptureRouter::~CaptureRouter()
+	{
+		if (mGood) {
+			mDevice.removeDeviceDataListener(this);
+		}
+	}
+
+
+	bool CaptureRouter::good() const
+	{
+		return mGood;
+	}
+
+
+	bool CaptureRouter::configure(Device& device, StreamDataSource& streamDataSource)
+	{
+		if (!device.good() || !streamDataSource.good()) {
+			SAUDIO_ERROR_LOG(device.getContext()) << "Invalid Device or StreamDataSource";
+			return false;
+		}
+		if (device.getType() == Device::DeviceType::Playback) {
+			SAUDIO_ERROR_LOG(device.getContext()) << "Can't capture frames from a playback Device";
+			return false;
+		}
+
+		const ma_device* maDevice = device.getMADevice();
+		std::vector<Channel> channels;
+		for (ma_uint32 i = 0; i < maDevice->capture.channels; ++i) {
+			channels.push_back( fromMAChannel(maDevice->capture.channelMap[i]) );
+		}
+
+		streamDataSource.setNumChannels(static_cast<int>(maDevice->capture.channels))
+			.setChannels(channels.data(), channels.size())
+			.setSampleRate(maDevice->sampleRate)
+			.setFormat(fromMAFormat(maDevice->capture.format));
+		return true;
+	}
+
+
+	void CaptureRouter::onDeviceData(void* output, const void* input, unsigned int frameCount)
+	{
+		if (input) {
+			mStreamDataSource.onNewSamples(static_cast<const unsigned char*>(input), frameCount);
+		}
+
+		if (output) {
+			// Duplex Device, the CaptureRouter doesn't add anything to the
+			// output
+			std::fill(static_cast<float*>(output), static_cast<float*>(output) + frameCount * mDevice.getMADevice()->playback.channels, 0.0f);
+		}
+	}
+
+}
@@ -1,86 +1,267 @@
+#include <mutex>
+#include <atomic>
 #include <memory>
+#include <thread>
+#include <cstdio>
 #define MINIAUDIO_IMPLEMENTATION
 #include <miniaudio.h>
 #include "saudio/Context.h"
+#include "saudio/RealtimeChecker.h"
+#include "MAWrapper.h"
 #include "LogWrapper.h"
+#include "DeviceRegistry.h"
+#include "LogQueue.h"
 
 namespace saudio {
 
+	/** Holds the allocation functions and counters of an
+	 * AllocationCategory */
+	struct CategoryAllocator
+	{
+		/** The Allocator of the category */
+		Allocator* allocator = nullptr;
+
+		/** The miniaudio callbacks that use @see allocator */
+		ma_allocation_callbacks maCallbacks = {};
+
+		/** The allocation counters */
+		std::atomic<uint64_t> numAllocations = 0;
+		std::atomic<uint64_t> numReallocations = 0;
+		std::atomic<uint64_t> numDeallocations = 0;
+		std::atomic<uint64_t> bytesRequested = 0;
+
+		/** Allocates memory with @see allocator
+		 *
+		 * @param	size the number of bytes to allocate
+		 * @return	a pointer to the allocated memory */
+		void* allocate(std::size_t size);
+
+		/** Reallocates memory with @see allocator
+		 *
+		 * @param	ptr a pointer to the memory to reallocate
+		 * @param	size the new number of bytes
+		 * @return	a pointer to the reallocated memory */
+		void* reallocate(void* ptr, std::size_t size);
+
+		/** Releases memory with @see allocator
+		 *
+		 * @param	ptr a pointer to the memory to release */
+		void deallocate(void* ptr);
+	};
+
+
+	/** The time between each check of the queued logs */
+	static constexpr std::chrono::milliseconds kLogThreadPeriod(10);
+
+
 	struct Context::Impl
 	{
 		/** A pointer to the LogHandler that used for printing logs */
 		LogHandler* logHandler = nullptr;
 
+		/** The maximum level of the logs passed to @see logHandler */
+		std::atomic<LogLevel> logLevel;
+
+		/** The logs waiting to be passed to @see logHandler */
+		LogQueue logQueue;
+
+		/** Serializes the calls to @see logHandler and the pops from
+		 * @see logQueue, so the traces are passed one at a time and in
+		 * order */
+		std::mutex dispatchMutex;
+
+		/** If @see logThread must stop */
+		std::atomic<bool> stopLogThread;
+
+		/** The thread that passes the queued logs to @see logHandler */
+		std::thread logThread;
+
+		/** The allocators of each AllocationCategory */
+		CategoryAllocator categoryAllocators[kNumAllocationCategories];
+
 		/** The miniaudio log */
 		std::unique_ptr<ma_log> maLog;
 
 		/** The miniaudio context */
 		std::unique_ptr<ma_context> maContext;
 
+		/** The cache of the devices of @see maContext */
+		std::unique_ptr<DeviceRegistry> deviceRegistry;
+
 		/** Creates a new Context Impl
 		 *
+		 * @param	context the Context that owns the Impl
 		 * @param	config the parameters of the Context Impl */
-		Impl(const Context::Config& config);
+		Impl(const Context& context, const Context::Config& config);
 
 		/** Class destructor */
 		~Impl();
+
+		/** Passes the given trace to @see logHandler, or queues it if it's
+		 * called inside an audio callback
+		 *
+		 * @param	level the level of the trace
+		 * @param	str the trace string to log
+		 * @param	queue if the trace must be queued always */
+		void log(LogLevel level, const char* str, bool queue = false);
+
+		/** Passes the given trace to @see logHandler
+		 *
+		 * @param	level the level of the trace
+		 * @param	str the trace string to log
+		 * @note	@see dispatchMutex must be locked */
+		void dispatch(LogLevel level, const char* str);
+
+		/** Passes all the queued traces to @see logHandler
+		 *
+		 * @note	@see dispatchMutex must be locked */
+		void dispatchQueued();
+
+		/** Passes all the queued traces to @see logHandler, locking
+		 * @see dispatchMutex */
+		void drainLogs();
+
+		/** The callback used by miniaudio for logging
+		 *
+		 * @param	pUserData a pointer to the Impl
+		 * @param	level the miniaudio level of the trace
+		 * @param	pMessage the trace string */
+		static void maLogCallback(void* pUserData, ma_uint32 level, const char* pMessage);
 	};
 
 
-	Context::Impl* Context::sImpl = nullptr;
+	Context* Context::sDefault = nullptr;
 	LogHandler Context::Context::Config::sDefaultLogHandler = {};
+	Allocator Context::Config::sDefaultAllocator = {};
 
 
-	static void myMALogCallback(void*, ma_uint32 level, const char* pMessage)
-	{
-		auto pLogHandler = Context::getLogHandler();
-		if (pLogHandler) {
-			switch (level) {
-				case MA_LOG_LEVEL_DEBUG:
-					pLogHandler->debug(pMessage);
-					break;
-				case MA_LOG_LEVEL_INFO:
-					pLogHandler->info(pMessage);
-					break;
-				case MA_LOG_LEVEL_WARNING:
-					pLogHandler->warning(pMessage);
-					break;
-				case MA_LOG_LEVEL_ERROR:
-					pLogHandler->error(pMessage);
-					break;
-			}
+	static void* maMallocCallback(size_t size, void* pUserData)
+	{
+		return static_cast<CategoryAllocator*>(pUserData)->allocate(size);
+	}
+
+
+	static void* maReallocCallback(void* ptr, size_t size, void* pUserData)
+	{
+		return static_cast<CategoryAllocator*>(pUserData)->reallocate(ptr, size);
+	}
+
+
+	static void maFreeCallback(void* ptr, void* pUserData)
+	{
+		static_cast<CategoryAllocator*>(pUserData)->deallocate(ptr);
+	}
+
+
+	void Context::Impl::maLogCallback(void* pUserData, ma_uint32 level, const char* pMessage)
+	{
+		// miniaudio can log from its audio threads, so the traces are always
+		// passed to the LogHandler from the log thread
+		auto impl = static_cast<Context::Impl*>(pUserData);
+		switch (level) {
+			case MA_LOG_LEVEL_DEBUG:
+				impl->log(LogLevel::Debug, pMessage, true);
+				break;
+			case MA_LOG_LEVEL_INFO:
+				impl->log(LogLevel::Info, pMessage, true);
+				break;
+			case MA_LOG_LEVEL_WARNING:
+				impl->log(LogLevel::Warning, pMessage, true);
+				break;
+			case MA_LOG_LEVEL_ERROR:
+				impl->log(LogLevel::Error, pMessage, true);
+				break;
+		}
+	}
+
+
+	void* CategoryAllocator::allocate(std::size_t size)
+	{
+		numAllocations.fetch_add(1, std::memory_order_relaxed);
+		bytesRequested.fetch_add(size, std::memory_order_relaxed);
+		return allocator->allocate(size);
+	}
+
+
+	void* CategoryAllocator::reallocate(void* ptr, std::size_t size)
+	{
+		numReallocations.fetch_add(1, std::memory_order_relaxed);
+		bytesRequested.fetch_add(size, std::memory_order_relaxed);
+		return allocator->reallocate(ptr, size);
+	}
+
+
+	void CategoryAllocator::deallocate(void* ptr)
+	{
+		if (ptr) {
+			numDeallocations.fetch_add(1, std::memory_order_relaxed);
+			allocator->deallocate(ptr);
 		}
 	}
 
 
-	Context::Impl::Impl(const Context::Config& config) : logHandler(config.logHandler)
+	Context::Impl::Impl(const Context& context, const Context::Config& config) :
+		logHandler(config.logHandler), logLevel(config.logLevel), logQueue(config.logQueueSize), stopLogThread(false)
 	{
+		logThread = std::thread([this]() {
+			while (!stopLogThread.load()) {
+				drainLogs();
+				std::this_thread::sleep_for(kLogThreadPeriod);
+			}
+			drainLogs();
+		});
+
+		for (std::size_t i = 0; i < kNumAllocationCategories; ++i) {
+			CategoryAllocator& categoryAllocator = categoryAllocators[i];
+			categoryAllocator.allocator = config.allocators[i]? config.allocators[i] : &Context::Config::sDefaultAllocator;
+			categoryAllocator.maCallbacks.pUserData = &categoryAllocator;
+			categoryAllocator.maCallbacks.onMalloc = &maMallocCallback;
+			categoryAllocator.maCallbacks.onRealloc = &maReallocCallback;
+			categoryAllocator.maCallbacks.onFree = &maFreeCallback;
+		}
+		const ma_allocation_callbacks* deviceCallbacks = &categoryAllocators[static_cast<std::size_t>(AllocationCategory::Device)].maCallbacks;
+
 		// Create the miniaudio log
 		maLog = std::make_unique<ma_log>();
-		ma_result result = ma_log_init(nullptr, maLog.get());
+		ma_result result = ma_log_init(deviceCallbacks, maLog.get());
 		if (result != MA_SUCCESS) {
 			logHandler->error("Log creation error");
 			maLog = nullptr;
 			return;
 		}
 
-		ma_log_register_callback(maLog.get(), ma_log_callback_init(&myMALogCallback, nullptr));
+		ma_log_register_callback(maLog.get(), ma_log_callback_init(&maLogCallback, this));
 
 		// Create the miniaudio context
 		ma_context_config contextConfig = ma_context_config_init();
 		contextConfig.pLog = maLog.get();
+		contextConfig.allocationCallbacks = *deviceCallbacks;
+
+		std::vector<ma_backend> backends;
+		for (Context::Backend backend : config.backends) {
+			backends.push_back( toMABackend(backend) );
+		}
 
 		maContext = std::make_unique<ma_context>();
-		result = ma_context_init(nullptr, 0, &contextConfig, maContext.get());
+		result = ma_context_init(
+			backends.empty()? nullptr : backends.data(), static_cast<ma_uint32>(backends.size()),
+			&contextConfig, maContext.get()
+		);
 		if (result != MA_SUCCESS) {
 			logHandler->error("Context creation error");
 			maContext = nullptr;
+			return;
 		}
+
+		// The devices aren't enumerated until they are needed
+		deviceRegistry = std::make_unique<DeviceRegistry>(context);
 	}
 
 
 	Context::Impl::~Impl()
 	{
+		deviceRegistry = nullptr;
+
 		if (maContext) {
 			ma_context_uninit(maContext.get());
 			maContext = nullptr;
@@ -90,52 +271,225 @@ namespace saudio {
 			ma_log_uninit(maLog.get());
 			maLog = nullptr;
 		}
+
+		// The remaining logs are drained before stopping the thread
+		stopLogThread.store(true);
+		if (logThread.joinable()) {
+			logThread.join();
+		}
+	}
+
+
+	void Context::Impl::log(LogLevel level, const char* str, bool queue)
+	{
+		if (!logHandler || (level > logLevel.load(std::memory_order_relaxed))) {
+			return;
+		}
+
+		if (queue || RealtimeChecker::isInRealtimeScope()) {
+			logQueue.push(level, str);
+		}
+		else {
+			// The queued traces go first, so the LogHandler receives them
+			// in order
+			std::unique_lock lock(dispatchMutex);
+			dispatchQueued();
+			dispatch(level, str);
+		}
+	}
+
+
+	void Context::Impl::dispatch(LogLevel level, const char* str)
+	{
+		switch (level) {
+			case LogLevel::Error:
+				logHandler->error(str);
+				break;
+			case LogLevel::Warning:
+				logHandler->warning(str);
+				break;
+			case LogLevel::Info:
+				logHandler->info(str);
+				break;
+			default:
+				logHandler->debug(str);
+				break;
+		}
+	}
+
+
+	void Context::Impl::dispatchQueued()
+	{
+		LogLevel level;
+		char message[LogQueue::kMessageSize];
+		while (logQueue.pop(level, message)) {
+			dispatch(level, message);
+		}
+
+		uint64_t numDropped = logQueue.takeNumDropped();
+		if (numDropped > 0) {
+			std::snprintf(message, sizeof(message), "%llu traces were dropped, the log queue was full", static_cast<unsigned long long>(numDropped));
+			dispatch(LogLevel::Warning, message);
+		}
 	}
 
 
-	bool Context::good()
+	void Context::Impl::drainLogs()
+	{
+		std::unique_lock lock(dispatchMutex);
+		dispatchQueued();
+	}
+
+
+	Context::Context(const Config& config) : mImpl(std::make_unique<Impl>(*this, config))
+	{
+		if (good()) {
+			SAUDIO_INFO_LOG(this) << "Created Context " << this << " with the "
+				<< ma_get_backend_name(getMAContext()->backend) << " backend";
+		}
+	}
+
+
+	Context::~Context()
+	{
+		SAUDIO_INFO_LOG(this) << "Deleting Context " << this;
+	}
+
+
+	bool Context::good() const
 	{
 		return getMAContext();
 	}
 
 
-	LogHandler* Context::getLogHandler()
+	LogHandler* Context::getLogHandler() const
+	{
+		return mImpl->logHandler;
+	}
+
+
+	LogLevel Context::getLogLevel() const
+	{
+		return mImpl->logLevel.load(std::memory_order_relaxed);
+	}
+
+
+	void Context::setLogLevel(LogLevel logLevel)
+	{
+		mImpl->logLevel.store(logLevel, std::memory_order_relaxed);
+	}
+
+
+	bool Context::isLogEnabled(LogLevel logLevel) const
+	{
+		return mImpl->logHandler && (logLevel <= mImpl->logLevel.load(std::memory_order_relaxed));
+	}
+
+
+	void Context::log(LogLevel logLevel, const char* str) const
 	{
-		return sImpl? sImpl->logHandler : nullptr;
+		mImpl->log(logLevel, str);
 	}
 
 
-	void* Context::getMALog()
+	void* Context::getMALog() const
 	{
-		return sImpl? sImpl->maLog.get() : nullptr;
+		return mImpl->maLog.get();
 	}
 
 
-	ma_context* Context::getMAContext()
+	ma_context* Context::getMAContext() const
 	{
-		return sImpl? sImpl->maContext.get() : nullptr;
+		return mImpl->maContext.get();
+	}
+
+
+	DeviceRegistry* Context::getDeviceRegistry() const
+	{
+		return mImpl->deviceRegistry.get();
+	}
+
+
+	void* Context::allocate(std::size_t size, AllocationCategory category) const
+	{
+		return mImpl->categoryAllocators[static_cast<std::size_t>(category)].allocate(size);
+	}
+
+
+	void* Context::reallocate(void* ptr, std::size_t size, AllocationCategory category) const
+	{
+		return mImpl->categoryAllocators[static_cast<std::size_t>(category)].reallocate(ptr, size);
+	}
+
+
+	void Context::deallocate(void* ptr, AllocationCategory category) const
+	{
+		mImpl->categoryAllocators[static_cast<std::size_t>(category)].deallocate(ptr);
+	}
+
+
+	const void* Context::getMAAllocationCallbacks(AllocationCategory category) const
+	{
+		return &mImpl->categoryAllocators[static_cast<std::size_t>(category)].maCallbacks;
+	}
+
+
+	AllocationStats Context::getAllocationStats(AllocationCategory category) const
+	{
+		const CategoryAllocator& categoryAllocator = mImpl->categoryAllocators[static_cast<std::size_t>(category)];
+
+		AllocationStats ret;
+		ret.numAllocations = categoryAllocator.numAllocations.load(std::memory_order_relaxed);
+		ret.numReallocations = categoryAllocator.numReallocations.load(std::memory_order_relaxed);
+		ret.numDeallocations = categoryAllocator.numDeallocations.load(std::memory_order_relaxed);
+		ret.bytesRequested = categoryAllocator.bytesRequested.load(std::memory_order_relaxed);
+		return ret;
+	}
+
+
+	Context* Context::getDefault()
+	{
+		return sDefault;
 	}
 
 
 	bool Context::start(const Context::Config& config)
 	{
-		sImpl = new Impl(config);
-		if (!getMAContext()) {
+		if (sDefault) {
+			SAUDIO_ERROR_LOG(sDefault) << "The default Context was already started";
+			return false;
+		}
+
+		sDefault = new Context(config);
+		if (!sDefault->good()) {
 			stop();
 			return false;
 		}
 
-		SAUDIO_INFO_LOG << "started";
 		return true;
 	}
 
+
 	void Context::stop()
 	{
-		SAUDIO_INFO_LOG << "stop";
+		if (sDefault) {
+			delete sDefault;
+			sDefault = nullptr;
+		}
+	}
+
 
-		if (sImpl) {
-			delete sImpl;
-			sImpl = nullptr;
+	void ObjectDeleter::operator()(void* ptr) const
+	{
+		if (destroy) {
+			destroy(ptr);
+		}
+
+		if (context) {
+			context->deallocate(ptr, category);
+		}
+		else {
+			std::free(ptr);
 		}
 	}
 
@@ -0,0 +1,130 @@
+#include "ConvolutionKernels.h"
+
+#if defined(__AVX__)
+	#include <immintrin.h>
+	#define SAUDIO_CONVOLUTION_AVX
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+	#include <xmmintrin.h>
+	#define SAUDIO_CONVOLUTION_SSE
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#include <arm_neon.h>
+	#define SAUDIO_CONVOLUTION_NEON
+#endif
+
+namespace saudio {
+
+	void complexMultiplyAdd(
+		float* accRe, float* accIm,
+		const float* aRe, const float* aIm,
+		const float* bRe, const float* bIm,
+		std::size_t count
+	) {
+		std::size_t i = 0;
+
+#if defined(SAUDIO_CONVOLUTION_AVX)
+		for (; i + 8 <= count; i += 8) {
+			__m256 ar = _mm256_loadu_ps(aRe + i), ai = _mm256_loadu_ps(aIm + i);
+			__m256 br = _mm256_loadu_ps(bRe + i), bi = _mm256_loadu_ps(bIm + i);
+			__m256 re = _mm256_sub_ps(_mm256_mul_ps(ar, br), _mm256_mul_ps(ai, bi));
+			__m256 im = _mm256_add_ps(_mm256_mul_ps(ar, bi), _mm256_mul_ps(ai, br));
+			_mm256_storeu_ps(accRe + i, _mm256_add_ps(_mm256_loadu_ps(accRe + i), re));
+			_mm256_storeu_ps(accIm + i, _mm256_add_ps(_mm256_loadu_ps(accIm + i), im));
+		}
+#elif defined(SAUDIO_CONVOLUTION_SSE)
+		for (; i + 4 <= count; i += 4) {
+			__m128 ar = _mm_loadu_ps(aRe + i), ai = _mm_loadu_ps(aIm + i);
+			__m128 br = _mm_loadu_ps(bRe + i), bi = _mm_loadu_ps(bIm + i);
+			__m128 re = _mm_sub_ps(_mm_mul_ps(ar, br), _mm_mul_ps(ai, bi));
+			__m128 im = _mm_add_ps(_mm_mul_ps(ar, bi), _mm_mul_ps(ai, br));
+			_mm_storeu_ps(accRe + i, _mm_add_ps(_mm_loadu_ps(accRe + i), re));
+			_mm_storeu_ps(accIm + i, _mm_add_ps(_mm_loadu_ps(accIm + i), im));
+		}
+#elif defined(SAUDIO_CONVOLUTION_NEON)
+		for (; i + 4 <= count; i += 4) {
+			float32x4_t ar = vld1q_f32(aRe + i), ai = vld1q_f32(aIm + i);
+			float32x4_t br = vld1q_f32(bRe + i), bi = vld1q_f32(bIm + i);
+			float32x4_t re = vmlsq_f32(vmulq_f32(ar, br), ai, bi);
+			float32x4_t im = vmlaq_f32(vmulq_f32(ar, bi), ai, br);
+			vst1q_f32(accRe + i, vaddq_f32(vld1q_f32(accRe + i), re));
+			vst1q_f32(accIm + i, vaddq_f32(vld1q_f32(accIm + i), im));
+		}
+#endif
+
+		for (; i < count; ++i) {
+			accRe[i] += aRe[i] * bRe[i] - aIm[i] * bIm[i];
+			accIm[i] += aRe[i] * bIm[i] + aIm[i] * bRe[i];
+		}
+	}
+
+
+	void multiplyAdd(float* dst, const float* src, float weight, std::size_t count)
+	{
+		std::size_t i = 0;
+
+#if defined(SAUDIO_CONVOLUTION_AVX)
+		__m256 w = _mm256_set1_ps(weight);
+		for (; i + 8 <= count; i += 8) {
+			__m256 product = _mm256_mul_ps(_mm256_loadu_ps(src + i), w);
+			_mm256_storeu_ps(dst + i, _mm256_add_ps(_mm256_loadu_ps(dst + i), product));
+		}
+#elif defined(SAUDIO_CONVOLUTION_SSE)
+		__m128 w = _mm_set1_ps(weight);
+		for (; i + 4 <= count; i += 4) {
+			__m128 product = _mm_mul_ps(_mm_loadu_ps(src + i), w);
+			_mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), product));
+		}
+#elif defined(SAUDIO_CONVOLUTION_NEON)
+		float32x4_t w = vdupq_n_f32(weight);
+		for (; i + 4 <= count; i += 4) {
+			vst1q_f32(dst + i, vmlaq_f32(vld1q_f32(dst + i), vld1q_f32(src + i), w));
+		}
+#endif
+
+		for (; i < count; ++i) {
+			dst[i] += src[i] * weight;
+		}
+	}
+
+
+	void crossfade(float* dst, const float* from, const float* to, std::size_t count)
+	{
+		if (count == 0) {
+			return;
+		}
+
+		float step = 1.0f / count;
+		std::size_t i = 0;
+
+#if defined(SAUDIO_CONVOLUTION_AVX)
+		__m256 t = _mm256_setr_ps(0.0f, step, 2 * step, 3 * step, 4 * step, 5 * step, 6 * step, 7 * step);
+		__m256 increment = _mm256_set1_ps(8 * step);
+		for (; i + 8 <= count; i += 8) {
+			__m256 a = _mm256_loadu_ps(from + i), b = _mm256_loadu_ps(to + i);
+			_mm256_storeu_ps(dst + i, _mm256_add_ps(a, _mm256_mul_ps(_mm256_sub_ps(b, a), t)));
+			t = _mm256_add_ps(t, increment);
+		}
+#elif defined(SAUDIO_CONVOLUTION_SSE)
+		__m128 t = _mm_setr_ps(0.0f, step, 2 * step, 3 * step);
+		__m128 increment = _mm_set1_ps(4 * step);
+		for (; i + 4 <= count; i += 4) {
+			__m128 a = _mm_loadu_ps(from + i), b = _mm_loadu_ps(to + i);
+			_mm_storeu_ps(dst + i, _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), t)));
+			t = _mm_add_ps(t, increment);
+		}
+#elif defined(SAUDIO_CONVOLUTION_NEON)
+		float initialT[4] = { 0.0f, step, 2 * step, 3 * step };
+		float32x4_t t = vld1q_f32(initialT);
+		float32x4_t increment = vdupq_n_f32(4 * step);
+		for (; i + 4 <= count; i += 4) {
+			float32x4_t a = vld1q_f32(from + i), b = vld1q_f32(to + i);
+			vst1q_f32(dst + i, vmlaq_f32(a, vsubq_f32(b, a), t));
+			t = vaddq_f32(t, increment);
+		}
+#endif
+
+		for (; i < count; ++i) {
+			dst[i] = from[i] + (to[i] - from[i]) * (i * step);
+		}
+	}
+
+}
@@ -0,0 +1,49 @@
+#ifndef SAUDIO_CONVOLUTION_KERNELS_H
+#define SAUDIO_CONVOLUTION_KERNELS_H
+
+#include <cstddef>
+
+namespace saudio {
+
+	/** Multiplies the given complex arrays and adds the result to the
+	 * destination ones (acc[i] += a[i] * b[i]). The complex numbers are
+	 * stored as split real and imaginary arrays
+	 *
+	 * @param	accRe a pointer to the real part of the accumulators
+	 * @param	accIm a pointer to the imaginary part of the accumulators
+	 * @param	aRe a pointer to the real part of the first factors
+	 * @param	aIm a pointer to the imaginary part of the first factors
+	 * @param	bRe a pointer to the real part of the second factors
+	 * @param	bIm a pointer to the imaginary part of the second factors
+	 * @param	count the number of complex numbers */
+	void complexMultiplyAdd(
+		float* accRe, float* accIm,
+		const float* aRe, const float* aIm,
+		const float* bRe, const float* bIm,
+		std::size_t count
+	);
+
+
+	/** Adds the given samples multiplied by a weight to the destination
+	 * ones (dst[i] += src[i] * weight)
+	 *
+	 * @param	dst a pointer to the samples where the result will be stored
+	 * @param	src a pointer to the samples to add
+	 * @param	weight the weight of the samples
+	 * @param	count the number of samples */
+	void multiplyAdd(float* dst, const float* src, float weight, std::size_t count);
+
+
+	/** Crossfades linearly between the given samples
+	 * (dst[i] = mix(from[i], to[i], i / count))
+	 *
+	 * @param	dst a pointer to the samples where the result will be
+	 *			stored, it can be the same than from
+	 * @param	from a pointer to the samples at the start of the crossfade
+	 * @param	to a pointer to the samples at the end of the crossfade
+	 * @param	count the number of samples */
+	void crossfade(float* dst, const float* from, const float* to, std::size_t count);
+
+}
+
+#endif		// SAUDIO_CONVOLUTION_KERNELS_H
@@ -0,0 +1,134 @@
+#include <algorithm>
+#include "saudio/ConvolutionReverb.h"
+#include "saudio/IDataSource.h"
+#include "saudio/AudioEngine.h"
+#include "NonUniformConvolver.h"
+#include "LogWrapper.h"
+#include "MAWrapper.h"
+
+namespace saudio {
+
+	/** The maximum number of frames downmixed at the same time */
+	static constexpr std::size_t kChunkFrames = 512;
+
+
+	ConvolutionReverb::ConvolutionReverb(
+		AudioEngine& engine, const IDataSource& impulseResponse, std::size_t blockSize
+	) : mContext(engine.getContext()), mWetGain(1.0f), mDryGain(1.0f), mAppliedWetGain(1.0f), mAppliedDryGain(1.0f)
+	{
+		if (!impulseResponse.good()) {
+			SAUDIO_ERROR_LOG(mContext) << "Invalid impulse response data source";
+			return;
+		}
+		if ((blockSize == 0) || ((blockSize & (blockSize - 1)) != 0)) {
+			SAUDIO_ERROR_LOG(mContext) << "The block size " << blockSize << " isn't a power of two";
+			return;
+		}
+
+		std::vector<float> frames;
+		ma_uint32 numChannels = 0;
+		if (!readAllFrames(impulseResponse.getMADataSource(), frames, numChannels)) {
+			SAUDIO_ERROR_LOG(mContext) << "Failed to read the impulse response data source";
+			return;
+		}
+
+		// Deinterleave the impulse response channels
+		std::size_t length = frames.size() / numChannels;
+		std::vector<float> channels(frames.size());
+		std::vector<const float*> channelPtrs(numChannels);
+		for (std::size_t c = 0; c < numChannels; ++c) {
+			for (std::size_t i = 0; i < length; ++i) {
+				channels[c * length + i] = frames[i * numChannels + c];
+			}
+			channelPtrs[c] = &channels[c * length];
+		}
+
+		mConvolver = std::make_unique<NonUniformConvolver>(mContext, channelPtrs.data(), numChannels, length, blockSize);
+		mMonoFrames.resize(kChunkFrames);
+		mWetFrames.resize(kChunkFrames * numChannels);
+
+		SAUDIO_INFO_LOG(mContext) << "Loaded impulse response of " << length << " frames and " << numChannels << " channels";
+	}
+
+
+	ConvolutionReverb::~ConvolutionReverb() {}
+
+
+	bool ConvolutionReverb::good() const
+	{
+		return mConvolver != nullptr;
+	}
+
+
+	float ConvolutionReverb::getWetGain() const
+	{
+		return mWetGain.load(std::memory_order_relaxed);
+	}
+
+
+	ConvolutionReverb& ConvolutionReverb::setWetGain(float gain)
+	{
+		mWetGain.store(gain, std::memory_order_relaxed);
+		return *this;
+	}
+
+
+	float ConvolutionReverb::getDryGain() const
+	{
+		return mDryGain.load(std::memory_order_relaxed);
+	}
+
+
+	ConvolutionReverb& ConvolutionReverb::setDryGain(float gain)
+	{
+		mDryGain.store(gain, std::memory_order_relaxed);
+		return *this;
+	}
+
+
+	uint64_t ConvolutionReverb::takeNumOverruns()
+	{
+		return mConvolver? mConvolver->takeNumOverruns() : 0;
+	}
+
+
+	void ConvolutionReverb::process(float* frames, std::size_t numFrames, std::size_t numChannels)
+	{
+		if (!mConvolver || (numFrames == 0) || (numChannels == 0)) {
+			return;
+		}
+
+		// The gain changes are ramped during the processed frames
+		float wetGain = mWetGain.load(std::memory_order_relaxed), dryGain = mDryGain.load(std::memory_order_relaxed);
+		float wetStep = (wetGain - mAppliedWetGain) / numFrames, dryStep = (dryGain - mAppliedDryGain) / numFrames;
+		std::size_t numIRChannels = mConvolver->getNumChannels();
+
+		for (std::size_t offset = 0; offset < numFrames; offset += kChunkFrames) {
+			std::size_t count = std::min(numFrames - offset, kChunkFrames);
+			float* chunk = frames + offset * numChannels;
+
+			for (std::size_t i = 0; i < count; ++i) {
+				float sum = 0.0f;
+				for (std::size_t c = 0; c < numChannels; ++c) {
+					sum += chunk[i * numChannels + c];
+				}
+				mMonoFrames[i] = sum / numChannels;
+			}
+
+			mConvolver->process(mMonoFrames.data(), mWetFrames.data(), count);
+
+			for (std::size_t i = 0; i < count; ++i) {
+				float wet = mAppliedWetGain + wetStep * (offset + i);
+				float dry = mAppliedDryGain + dryStep * (offset + i);
+				for (std::size_t c = 0; c < numChannels; ++c) {
+					float& sample = chunk[i * numChannels + c];
+					sample = dry * sample + wet * mWetFrames[i * numIRChannels + c % numIRChannels];
+				}
+			}
+		}
+
+		mAppliedWetGain = wetGain;
+		mAppliedDryGain = dryGain;
+	}
+
+}
@@ -0,0 +1,137 @@
+#include <cmath>
+#include <algorithm>
+#include "saudio/Delay.h"
+#include "saudio/AudioEngine.h"
+#include "EffectKernels.h"
+
+namespace saudio {
+
+	/** The time constant in seconds of the delay time smoothing */
+	static constexpr float kDelaySmoothingTime = 0.05f;
+
+	/** The time constant in seconds of the wet and dry gain smoothing */
+	static constexpr float kGainSmoothingTime = 0.01f;
+
+	/** The distance to the targets below which the smoothed delay time in
+	 * frames and the smoothed gains jump to them, so the parameters stop
+	 * changing */
+	static constexpr float kDelaySnapFrames = 1e-3f;
+	static constexpr float kGainSnap = 1e-4f;
+
+	/** The maximum feedback gain, it keeps the delay line stable */
+	static constexpr float kMaxFeedback = 0.99f;
+
+
+	/** Moves the given value towards the target one with a one-pole
+	 * smoothing
+	 *
+	 * @param	value the current value
+	 * @param	target the target value
+	 * @param	smoothing the smoothing coefficient, from 0 to 1
+	 * @param	snap the distance to the target below which the target is
+	 *			returned
+	 * @return	the new value */
+	static float smoothTowards(float value, float target, float smoothing, float snap)
+	{
+		value += smoothing * (target - value);
+		return (std::fabs(target - value) < snap)? target : value;
+	}
+
+
+	Delay::Delay(AudioEngine& engine, float maxDelay, float delay) :
+		mSampleRate(static_cast<float>(engine.getSampleRate())), mNumChannels(engine.getChannels()),
+		mMaxDelayFrames(std::max(std::ceil(maxDelay * mSampleRate), 1.0f)),
+		mDelayFrames(1.0f), mFeedback(0.0f), mWetGain(1.0f), mDryGain(1.0f),
+		mAppliedDelayFrames(1.0f), mAppliedWetGain(1.0f), mAppliedDryGain(1.0f),
+		mBuffer((static_cast<std::size_t>(mMaxDelayFrames) + 2) * mNumChannels, 0.0f), mWriteIndex(0)
+	{
+		setDelay(delay);
+		mAppliedDelayFrames = mDelayFrames.load(std::memory_order_relaxed);
+	}
+
+
+	float Delay::getDelay() const
+	{
+		return mDelayFrames.load(std::memory_order_relaxed) / mSampleRate;
+	}
+
+
+	Delay& Delay::setDelay(float delay)
+	{
+		mDelayFrames.store(std::clamp(delay * mSampleRate, 1.0f, mMaxDelayFrames), std::memory_order_relaxed);
+		return *this;
+	}
+
+
+	float Delay::getFeedback() const
+	{
+		return mFeedback.load(std::memory_order_relaxed);
+	}
+
+
+	Delay& Delay::setFeedback(float feedback)
+	{
+		mFeedback.store(std::clamp(feedback, 0.0f, kMaxFeedback), std::memory_order_relaxed);
+		return *this;
+	}
+
+
+	float Delay::getWetGain() const
+	{
+		return mWetGain.load(std::memory_order_relaxed);
+	}
+
+
+	Delay& Delay::setWetGain(float gain)
+	{
+		mWetGain.store(gain, std::memory_order_relaxed);
+		return *this;
+	}
+
+
+	float Delay::getDryGain() const
+	{
+		return mDryGain.load(std::memory_order_relaxed);
+	}
+
+
+	Delay& Delay::setDryGain(float gain)
+	{
+		mDryGain.store(gain, std::memory_order_relaxed);
+		return *this;
+	}
+
+
+	void Delay::process(float* frames, std::size_t numFrames, std::size_t numChannels)
+	{
+		if ((numFrames == 0) || (numChannels > mNumChannels)) {
+			return;
+		}
+
+		// The delay time and the gains move towards the target ones with a
+		// one-pole smoothing evaluated once per block, and they're
+		// interpolated linearly inside the block
+		float delaySmoothing = 1.0f - std::exp(-static_cast<float>(numFrames) / (kDelaySmoothingTime * mSampleRate));
+		float gainSmoothing = 1.0f - std::exp(-static_cast<float>(numFrames) / (kGainSmoothingTime * mSampleRate));
+
+		DelayParameters parameters;
+		parameters.startDelay = mAppliedDelayFrames;
+		parameters.endDelay = smoothTowards(mAppliedDelayFrames, mDelayFrames.load(std::memory_order_relaxed), delaySmoothing, kDelaySnapFrames);
+		parameters.feedback = mFeedback.load(std::memory_order_relaxed);
+		parameters.startWetGain = mAppliedWetGain;
+		parameters.endWetGain = smoothTowards(mAppliedWetGain, mWetGain.load(std::memory_order_relaxed), gainSmoothing, kGainSnap);
+		parameters.startDryGain = mAppliedDryGain;
+		parameters.endDryGain = smoothTowards(mAppliedDryGain, mDryGain.load(std::memory_order_relaxed), gainSmoothing, kGainSnap);
+
+		processDelay(
+			frames, numFrames, numChannels,
+			mBuffer.data(), mBuffer.size() / mNumChannels, mWriteIndex,
+			parameters
+		);
+
+		mAppliedDelayFrames = parameters.endDelay;
+		mAppliedWetGain = parameters.endWetGain;
+		mAppliedDryGain = parameters.endDryGain;
+	}
+
+}
@@ -1,64 +1,86 @@
+#include <thread>
 #include <algorithm>
 #include <miniaudio.h>
 #include "saudio/Device.h"
 #include "saudio/Context.h"
+#include "saudio/RealtimeChecker.h"
 #include "MAWrapper.h"
 #include "LogWrapper.h"
+#include "CallbackProfiler.h"
+#include "MixKernels.h"
+#include "FormatKernels.h"
+#include "DeviceRegistry.h"
+#include "ObjectAllocation.h"
 
 namespace saudio {
 
-	Device::Device(const DeviceInfo& info, const Config& config)
-	{
-		SAUDIO_DEBUG_LOG << "init \"" << info.name << "\"";
+	/** The minimum number of frames of the Device mix buffers */
+	static constexpr unsigned int kMinMixFrames = 512;
 
-		ma_device_info* deviceInfos;
-		ma_uint32 deviceCount;
-		ma_result result = ma_context_get_devices(Context::getMAContext(), &deviceInfos, &deviceCount, nullptr, nullptr);
-		if (result != MA_SUCCESS) {
-			SAUDIO_ERROR_LOG << "Failed to retrieve the devices";
-			return;
-		}
 
-		ma_device_id* deviceId = nullptr;
-		for (ma_uint32 i = 0; i < deviceCount; ++i) {
-			if (info.name == deviceInfos[i].name) {
-				deviceId = &deviceInfos[i].id;
+	/** The callback that will be executed when the state of a miniaudio
+	 * device changes
+	 *
+	 * @param	notification a pointer to the notification */
+	static void maDeviceNotificationCallback(const ma_device_notification* notification)
+	{
+		bool deviceListChanged = false;
+		switch (notification->type) {
+			case ma_device_notification_type_rerouted: {
+				deviceListChanged = true;
+			} break;
+			case ma_device_notification_type_stopped: {
+				// The stops requested with ma_device_stop or ma_device_uninit
+				// are notified while stopping, any other stop means that
+				// the device was lost (ie. disconnected)
+				deviceListChanged = (ma_device_get_state(notification->pDevice) != ma_device_state_stopping);
+			} break;
+			default:
 				break;
-			}
 		}
-		if (!deviceId) {
-			SAUDIO_ERROR_LOG << "Device \"" << info.name << "\" not found";
-			return;
+
+		if (deviceListChanged) {
+			auto device = static_cast<Device*>(notification->pDevice->pUserData);
+			Device::invalidateDeviceInfos(*device->getContext());
 		}
+	}
 
-		ma_device_config deviceConfig;
-		deviceConfig = ma_device_config_init(ma_device_type_playback);
-		deviceConfig.playback.pDeviceID = deviceId;
-		deviceConfig.playback.format = toMAFormat(config.decodeFormat);
-		deviceConfig.playback.channels = config.decodeChannels;
-		deviceConfig.sampleRate = config.decodeSampleRate;
-		deviceConfig.dataCallback = &maDeviceDataCallback;
-		deviceConfig.pUserData = this;
 
-		mDevice = std::make_unique<ma_device>();
-		result = ma_device_init(Context::getMAContext(), &deviceConfig, mDevice.get());
-		if (result != MA_SUCCESS) {
-			SAUDIO_ERROR_LOG << "Failed to initialize the device \"" << info.name << "\"";
-			mDevice = nullptr;
-			return;
-		}
+	Device::Device(Context& context, const DeviceInfo& info, const Config& config) :
+		Device(
+			&context,
+			(info.type != DeviceType::Capture)? &info : nullptr,
+			(info.type == DeviceType::Capture)? &info : nullptr,
+			config
+		) {}
+
+
+	Device::Device(const DeviceInfo& info, const Config& config) :
+		Device(
+			Context::getDefault(),
+			(info.type != DeviceType::Capture)? &info : nullptr,
+			(info.type == DeviceType::Capture)? &info : nullptr,
+			config
+		) {}
+
+
+	Device::Device(Context& context, const DeviceInfo& playbackInfo, const DeviceInfo& captureInfo, const Config& config) :
+		Device(&context, &playbackInfo, &captureInfo, config) {}
 
-		SAUDIO_DEBUG_LOG << "Created Device " << mDevice.get();
-	}
+
+	Device::Device(const DeviceInfo& playbackInfo, const DeviceInfo& captureInfo, const Config& config) :
+		Device(Context::getDefault(), &playbackInfo, &captureInfo, config) {}
 
 
 	Device::~Device()
 	{
 		if (mDevice) {
 			ma_device_uninit(mDevice.get());
-			SAUDIO_DEBUG_LOG << "Deleted Device " << mDevice.get();
+			SAUDIO_DEBUG_LOG(mContext) << "Deleted Device " << mDevice.get();
 			mDevice = nullptr;
 		}
+
+		delete mDeviceDataListeners.load();
 	}
 
 
@@ -74,15 +96,26 @@ namespace saudio {
 	}
 
 
+	Context* Device::getContext() const
+	{
+		return mContext;
+	}
+
+
 	bool Device::addDeviceDataListener(IDeviceDataListener* listener)
 	{
 		if (!listener || !good()) {
 			return false;
 		}
 
-		auto it = std::find(mDeviceDataListeners.begin(), mDeviceDataListeners.end(), listener);
-		if (it == mDeviceDataListeners.end()) {
-			mDeviceDataListeners.push_back(listener);
+		std::unique_lock lock(mListenersMutex);
+
+		const ListenerList* current = mDeviceDataListeners.load();
+		auto it = std::find(current->begin(), current->end(), listener);
+		if (it == current->end()) {
+			auto listeners = new ListenerList(*current);
+			listeners->push_back(listener);
+			publishListeners(listeners);
 		}
 
 		return true;
@@ -95,41 +128,272 @@ namespace saudio {
 			return;
 		}
 
-		auto it = std::find(mDeviceDataListeners.begin(), mDeviceDataListeners.end(), listener);
-		if (it != mDeviceDataListeners.end()) {
-			mDeviceDataListeners.erase(it);
+		std::unique_lock lock(mListenersMutex);
+
+		const ListenerList* current = mDeviceDataListeners.load();
+		auto it = std::find(current->begin(), current->end(), listener);
+		if (it != current->end()) {
+			auto listeners = new ListenerList(*current);
+			listeners->erase(listeners->begin() + std::distance(current->begin(), it));
+			publishListeners(listeners);
 		}
 	}
 
 
-	std::vector<Device::DeviceInfo> Device::getDeviceInfos()
+	Device::DeviceType Device::getType() const
 	{
-		std::vector<DeviceInfo> ret;
-
-		if (Context::good()) {
-			ma_device_info* deviceInfos;
-			ma_uint32 deviceCount;
-			ma_result result = ma_context_get_devices(Context::getMAContext(), &deviceInfos, &deviceCount, nullptr, nullptr);
-			if (result == MA_SUCCESS) {
-				for (ma_uint32 i = 0; i < deviceCount; ++i) {
-					ret.push_back({ deviceInfos[i].name, static_cast<bool>(deviceInfos[i].isDefault) });
-				}
-			}
-			else {
-				SAUDIO_ERROR_LOG << "Failed to retrieve the device infos";
-			}
+		if (mDevice && (mDevice->type == ma_device_type_capture)) {
+			return DeviceType::Capture;
+		}
+		else if (mDevice && (mDevice->type == ma_device_type_duplex)) {
+			return DeviceType::Duplex;
 		}
+		return DeviceType::Playback;
+	}
+
 
+	Device::NegotiatedConfig Device::getNegotiatedConfig() const
+	{
+		NegotiatedConfig ret;
+		if (mDevice) {
+			// Capture devices use the capture side, the rest the playback one
+			const auto& side = (mDevice->type == ma_device_type_capture)? mDevice->capture : mDevice->playback;
+			ret.format = fromMAFormat(side.internalFormat);
+			ret.channels = side.internalChannels;
+			ret.sampleRate = side.internalSampleRate;
+			ret.periodSizeInFrames = side.internalPeriodSizeInFrames;
+			ret.periods = side.internalPeriods;
+			ret.shareMode = (side.shareMode == ma_share_mode_exclusive)? ShareMode::Exclusive : ShareMode::Shared;
+		}
 		return ret;
 	}
 
+
+	CallbackStats Device::getCallbackStats() const
+	{
+		return mCallbackProfiler->getStats();
+	}
+
+
+	void Device::resetCallbackStats()
+	{
+		mCallbackProfiler->reset();
+	}
+
+
+	std::vector<Device::DeviceInfo> Device::getDeviceInfos(const Context& context, DeviceType type)
+	{
+		DeviceRegistry* registry = context.getDeviceRegistry();
+		return registry? registry->getDeviceInfos(type) : std::vector<DeviceInfo>();
+	}
+
+
+	std::vector<Device::DeviceInfo> Device::getDeviceInfos(DeviceType type)
+	{
+		Context* context = Context::getDefault();
+		return context? getDeviceInfos(*context, type) : std::vector<DeviceInfo>();
+	}
+
+
+	void Device::invalidateDeviceInfos(const Context& context)
+	{
+		DeviceRegistry* registry = context.getDeviceRegistry();
+		if (registry) {
+			registry->invalidate();
+		}
+	}
+
+
+	void Device::invalidateDeviceInfos()
+	{
+		Context* context = Context::getDefault();
+		if (context) {
+			invalidateDeviceInfos(*context);
+		}
+	}
+
 // Private functions
+	Device::Device(Context* context, const DeviceInfo* playbackInfo, const DeviceInfo* captureInfo, const Config& config) :
+		mContext(context), mDeviceDataListeners(new ListenerList()), mCallbackSequence(0), mMixFrames(0),
+		mCallbackProfiler(std::make_unique<CallbackProfiler>()), mDitherState(std::make_unique<DitherState>())
+	{
+		if (!mContext) {
+			// There is no LogHandler to report it
+			return;
+		}
+
+		if (playbackInfo && captureInfo) {
+			SAUDIO_DEBUG_LOG(mContext) << "init \"" << playbackInfo->name << "\" and \"" << captureInfo->name << "\"";
+
+			if ((playbackInfo->type != DeviceType::Playback) || (captureInfo->type != DeviceType::Capture)) {
+				SAUDIO_ERROR_LOG(mContext) << "Invalid DeviceInfo types for a duplex Device";
+				return;
+			}
+		}
+		else {
+			SAUDIO_DEBUG_LOG(mContext) << "init \"" << (playbackInfo? playbackInfo : captureInfo)->name << "\"";
+		}
+
+		initInternal(playbackInfo, captureInfo, config);
+	}
+
+
 	void Device::maDeviceDataCallback(ma_device* device, void* output, const void* input, unsigned int frameCount)
 	{
+		RealtimeChecker::Scope realtimeScope;
 		Device* pDevice = static_cast<Device*>(device->pUserData);
-		for (auto listener : pDevice->mDeviceDataListeners) {
-			listener->onDeviceData(output, input, frameCount);
+		CallbackProfiler::ScopedTimer timer(*pDevice->mCallbackProfiler, frameCount, device->sampleRate);
+
+		// The sequence must be incremented before loading the listeners, see
+		// publishListeners
+		pDevice->mCallbackSequence.fetch_add(1);
+		const ListenerList* listeners = pDevice->mDeviceDataListeners.load();
+		pDevice->mixListeners(*listeners, output, input, frameCount);
+		pDevice->mCallbackSequence.fetch_add(1);
+	}
+
+
+	void Device::mixListeners(
+		const ListenerList& listeners,
+		void* output, const void* input, unsigned int frameCount
+	) {
+		if (listeners.empty()) {
+			// The output is already silenced by miniaudio
+			return;
+		}
+
+		if (!output) {
+			// Capture Device, there is nothing to mix
+			for (auto listener : listeners) {
+				listener->onDeviceData(nullptr, input, frameCount);
+			}
+			return;
+		}
+
+		ma_format outputFormat = mDevice->playback.format;
+		ma_uint32 numChannels = mDevice->playback.channels;
+		if ((listeners.size() == 1) && (outputFormat == ma_format_f32)) {
+			// Nothing to mix, the listener can write directly to the output
+			listeners.front()->onDeviceData(output, input, frameCount);
+			return;
 		}
+
+		ma_uint32 outputFrameSize = ma_get_bytes_per_frame(outputFormat, numChannels);
+		ma_uint32 inputFrameSize = input? ma_get_bytes_per_frame(mDevice->capture.format, mDevice->capture.channels) : 0;
+
+		for (unsigned int iFrame = 0; iFrame < frameCount; iFrame += mMixFrames) {
+			unsigned int chunkFrames = std::min(mMixFrames, frameCount - iFrame);
+			std::size_t chunkSamples = static_cast<std::size_t>(chunkFrames) * numChannels;
+			unsigned char* chunkOutput = static_cast<unsigned char*>(output) + iFrame * outputFrameSize;
+			const void* chunkInput = input? static_cast<const unsigned char*>(input) + iFrame * inputFrameSize : nullptr;
+
+			// f32 outputs are used directly as mix buffers
+			float* mix = (outputFormat == ma_format_f32)? reinterpret_cast<float*>(chunkOutput) : mMixBuffer.data();
+
+			listeners.front()->onDeviceData(mix, chunkInput, chunkFrames);
+			for (std::size_t i = 1; i < listeners.size(); ++i) {
+				listeners[i]->onDeviceData(mListenerBuffer.data(), chunkInput, chunkFrames);
+				mixAdd(mix, mListenerBuffer.data(), chunkSamples);
+			}
+
+			if (outputFormat != ma_format_f32) {
+				convertFromF32(chunkOutput, fromMAFormat(outputFormat), mix, chunkSamples, mDitherState.get());
+			}
+		}
+	}
+
+
+	bool Device::initInternal(const DeviceInfo* playbackInfo, const DeviceInfo* captureInfo, const Config& config)
+	{
+		DeviceRegistry* registry = mContext->getDeviceRegistry();
+		if (!registry) {
+			SAUDIO_ERROR_LOG(mContext) << "The Context wasn't created successfully";
+			return false;
+		}
+
+		ma_device_id playbackId, captureId;
+		if (playbackInfo && !registry->findDeviceId(*playbackInfo, playbackId)) {
+			return false;
+		}
+		if (captureInfo && !registry->findDeviceId(*captureInfo, captureId)) {
+			return false;
+		}
+
+		ma_device_type type = (playbackInfo && captureInfo)? ma_device_type_duplex :
+			playbackInfo? ma_device_type_playback : ma_device_type_capture;
+		ma_share_mode shareMode = (config.shareMode == ShareMode::Exclusive)? ma_share_mode_exclusive : ma_share_mode_shared;
+		const std::string& name = playbackInfo? playbackInfo->name : captureInfo->name;
+
+		ma_device_config deviceConfig;
+		deviceConfig = ma_device_config_init(type);
+		if (playbackInfo) {
+			deviceConfig.playback.pDeviceID = &playbackId;
+			deviceConfig.playback.format = toMAFormat(config.decodeFormat);
+			deviceConfig.playback.channels = config.decodeChannels;
+			deviceConfig.playback.shareMode = shareMode;
+		}
+		if (captureInfo) {
+			deviceConfig.capture.pDeviceID = &captureId;
+			deviceConfig.capture.format = toMAFormat(config.captureFormat);
+			deviceConfig.capture.channels = config.captureChannels;
+			deviceConfig.capture.shareMode = shareMode;
+		}
+		deviceConfig.sampleRate = config.decodeSampleRate;
+		deviceConfig.periodSizeInFrames = config.periodSizeInFrames;
+		deviceConfig.periodSizeInMilliseconds = config.periodSizeInMilliseconds;
+		deviceConfig.periods = config.periods;
+		deviceConfig.performanceProfile = (config.performanceProfile == PerformanceProfile::Conservative)?
+			ma_performance_profile_conservative : ma_performance_profile_low_latency;
+		deviceConfig.dataCallback = &maDeviceDataCallback;
+		deviceConfig.notificationCallback = &maDeviceNotificationCallback;
+		deviceConfig.pUserData = this;
+
+		mDevice = makeObject<ma_device>(mContext, AllocationCategory::Device);
+		ma_result result = ma_device_init(mContext->getMAContext(), &deviceConfig, mDevice.get());
+		if ((result != MA_SUCCESS) && (config.shareMode == ShareMode::Exclusive)) {
+			SAUDIO_WARN_LOG(mContext) << "Failed to open \"" << name << "\" in exclusive mode, falling back to shared mode";
+			deviceConfig.playback.shareMode = ma_share_mode_shared;
+			deviceConfig.capture.shareMode = ma_share_mode_shared;
+			result = ma_device_init(mContext->getMAContext(), &deviceConfig, mDevice.get());
+		}
+		if (result != MA_SUCCESS) {
+			SAUDIO_ERROR_LOG(mContext) << "Failed to initialize the device \"" << name << "\"";
+			mDevice = nullptr;
+			return false;
+		}
+
+		// The mix buffers are allocated here so the audio thread never
+		// allocates memory
+		if (playbackInfo) {
+			mMixFrames = std::max(mDevice->playback.internalPeriodSizeInFrames, kMinMixFrames);
+			mMixBuffer.resize(mMixFrames * mDevice->playback.channels);
+			mListenerBuffer.resize(mMixFrames * mDevice->playback.channels);
+		}
+
+		NegotiatedConfig negotiated = getNegotiatedConfig();
+		SAUDIO_DEBUG_LOG(mContext) << "Created Device " << mDevice.get()
+			<< " with a period of " << negotiated.periodSizeInFrames
+			<< " frames x " << negotiated.periods;
+		return true;
+	}
+
+
+	void Device::publishListeners(ListenerList* listeners)
+	{
+		ListenerList* old = mDeviceDataListeners.exchange(listeners);
+
+		// Wait until the callback that could be using the old list finishes.
+		// The callback increments the sequence before loading the list, so
+		// if the sequence is even here any later callback will load the new
+		// list (both operations are sequentially consistent)
+		uint64_t sequence = mCallbackSequence.load();
+		if (sequence % 2 == 1) {
+			while (mCallbackSequence.load() == sequence) {
+				std::this_thread::yield();
+			}
+		}
+
+		delete old;
 	}
 
 }
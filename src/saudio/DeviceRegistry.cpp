@@ -0,0 +1,111 @@
+#include <algorithm>
+#include "DeviceRegistry.h"
+#include "LogWrapper.h"
+
+namespace saudio {
+
+	std::vector<Device::DeviceInfo> DeviceRegistry::getDeviceInfos(Device::DeviceType type)
+	{
+		std::vector<Device::DeviceInfo> ret;
+
+		std::lock_guard<std::mutex> lock(mMutex);
+		if (refresh()) {
+			for (const Entry& entry : mEntries) {
+				if (entry.info.type == type) {
+					ret.push_back(entry.info);
+				}
+			}
+		}
+
+		return ret;
+	}
+
+
+	bool DeviceRegistry::findDeviceId(const Device::DeviceInfo& info, ma_device_id& maId)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		bool wasStale = mStale.load();
+		if (!refresh()) {
+			return false;
+		}
+
+		const Entry* entry = find(info);
+		if (!entry && !wasStale && refresh(true)) {
+			entry = find(info);
+		}
+
+		if (!entry) {
+			SAUDIO_ERROR_LOG(&mContext) << "Device \"" << info.name << "\" not found";
+			return false;
+		}
+
+		maId = entry->maId;
+		return true;
+	}
+
+// Private functions
+	bool DeviceRegistry::refresh(bool force)
+	{
+		if (!force && !mStale.load()) {
+			return true;
+		}
+
+		// The flag is cleared before enumerating, so any invalidation done
+		// meanwhile will trigger another enumeration
+		mStale.store(false);
+
+		ma_device_info *playbackInfos, *captureInfos;
+		ma_uint32 playbackCount, captureCount;
+		ma_result result = ma_context_get_devices(mContext.getMAContext(), &playbackInfos, &playbackCount, &captureInfos, &captureCount);
+		if (result != MA_SUCCESS) {
+			SAUDIO_ERROR_LOG(&mContext) << "Failed to retrieve the devices";
+			mStale.store(true);
+			return false;
+		}
+
+		mEntries.clear();
+		mEntryIndices.clear();
+
+		auto addEntries = [this](const ma_device_info* deviceInfos, ma_uint32 deviceCount, Device::DeviceType type) {
+			for (ma_uint32 i = 0; i < deviceCount; ++i) {
+				auto itKnown = std::find_if(mKnownDevices.begin(), mKnownDevices.end(), [&](const Entry& known) {
+					return (known.info.type == type) && ma_device_id_equal(&known.maId, &deviceInfos[i].id);
+				});
+				if (itKnown == mKnownDevices.end()) {
+					Device::DeviceInfo info = { deviceInfos[i].name, false, type, mNextId++ };
+					itKnown = mKnownDevices.insert(mKnownDevices.end(), { info, deviceInfos[i].id });
+				}
+
+				// The name and the default device can change between
+				// enumerations
+				Entry entry = { itKnown->info, deviceInfos[i].id };
+				entry.info.name = deviceInfos[i].name;
+				entry.info.isDefault = deviceInfos[i].isDefault;
+
+				mEntryIndices.emplace(entry.info.id, mEntries.size());
+				mEntries.push_back(entry);
+			}
+		};
+		addEntries(playbackInfos, playbackCount, Device::DeviceType::Playback);
+		addEntries(captureInfos, captureCount, Device::DeviceType::Capture);
+
+		SAUDIO_DEBUG_LOG(&mContext) << "Enumerated " << playbackCount << " playback and " << captureCount << " capture devices";
+		return true;
+	}
+
+
+	const DeviceRegistry::Entry* DeviceRegistry::find(const Device::DeviceInfo& info) const
+	{
+		if (info.id != 0) {
+			auto it = mEntryIndices.find(info.id);
+			return (it != mEntryIndices.end())? &mEntries[it->second] : nullptr;
+		}
+
+		auto it = std::find_if(mEntries.begin(), mEntries.end(), [&](const Entry& entry) {
+			return (entry.info.type == info.type) && (entry.info.name == info.name);
+		});
+		return (it != mEntries.end())? &*it : nullptr;
+	}
+
+}
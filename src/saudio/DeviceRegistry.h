@@ -0,0 +1,109 @@
+#ifndef SAUDIO_DEVICE_REGISTRY_H
+#define SAUDIO_DEVICE_REGISTRY_H
+
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <unordered_map>
+#include <miniaudio.h>
+#include "saudio/Device.h"
+#include "saudio/Context.h"
+
+namespace saudio {
+
+	/**
+	 * Class DeviceRegistry, it caches the devices enumerated by a miniaudio
+	 * context, so the backend isn't probed again each time a Device is
+	 * created or the DeviceInfos are requested. Each device gets a numeric
+	 * id that stays the same while the device is connected and after
+	 * refreshing the cache, so the Devices can be found without comparing
+	 * their names. The enumeration is lazy, it's done the first time it's
+	 * needed and then each time the registry is invalidated
+	 */
+	class DeviceRegistry
+	{
+	private:	// Nested types
+		/** Holds a cached device */
+		struct Entry
+		{
+			/** The DeviceInfo of the device */
+			Device::DeviceInfo info;
+
+			/** The miniaudio id of the device */
+			ma_device_id maId;
+		};
+
+	private:	// Attributes
+		/** The Context whose devices are cached */
+		const Context& mContext;
+
+		/** The mutex used for protecting the cache */
+		std::mutex mMutex;
+
+		/** If the cached devices must be enumerated again */
+		std::atomic<bool> mStale;
+
+		/** The devices of the last enumeration */
+		std::vector<Entry> mEntries;
+
+		/** Maps the ids of the cached devices to their indices in
+		 * @see mEntries */
+		std::unordered_map<uint64_t, std::size_t> mEntryIndices;
+
+		/** All the devices seen since the DeviceRegistry was created, used
+		 * for keeping their ids between enumerations */
+		std::vector<Entry> mKnownDevices;
+
+		/** The id of the next new device */
+		uint64_t mNextId;
+
+	public:		// Functions
+		/** Creates a new DeviceRegistry
+		 *
+		 * @param	context the Context whose devices will be cached */
+		DeviceRegistry(const Context& context) :
+			mContext(context), mStale(true), mNextId(1) {};
+
+		/** Marks the cached devices as stale, so they will be enumerated
+		 * again the next time they are needed. It can be called from any
+		 * thread, including the audio ones */
+		void invalidate() { mStale.store(true); };
+
+		/** Returns the DeviceInfos of the cached devices
+		 *
+		 * @param	type the type of the devices to return, Playback or
+		 *			Capture
+		 * @return	the DeviceInfos */
+		std::vector<Device::DeviceInfo> getDeviceInfos(Device::DeviceType type);
+
+		/** Searches the miniaudio id of the given device. The device is
+		 * searched by its id, or by its name if it doesn't have one. If it
+		 * isn't found the devices are enumerated again, in case it was
+		 * connected after the last enumeration
+		 *
+		 * @param	info the DeviceInfo of the device to search
+		 * @param	maId a reference to the id where the device id will be
+		 *			stored
+		 * @return	true if the device was found, false otherwise */
+		bool findDeviceId(const Device::DeviceInfo& info, ma_device_id& maId);
+	private:
+		/** Enumerates the devices again if the cache is stale
+		 *
+		 * @param	force if the devices must be enumerated even if the cache
+		 *			isn't stale
+		 * @return	true if the cache is valid, false otherwise
+		 * @note	@see mMutex must be locked */
+		bool refresh(bool force = false);
+
+		/** Searches the given device in the cache
+		 *
+		 * @param	info the DeviceInfo of the device to search
+		 * @return	a pointer to the cached device, nullptr if it wasn't
+		 *			found
+		 * @note	@see mMutex must be locked */
+		const Entry* find(const Device::DeviceInfo& info) const;
+	};
+
+}
+
+#endif		// SAUDIO_DEVICE_REGISTRY_H
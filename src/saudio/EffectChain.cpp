@@ -0,0 +1,70 @@
+#include <thread>
+#include <algorithm>
+#include "saudio/IEffect.h"
+#include "EffectChain.h"
+#include "LogWrapper.h"
+
+namespace saudio {
+
+	EffectChain::EffectChain(const Context* context) :
+		mContext(context), mLists(), mCurrentList(0), mProcessSequence(0) {}
+
+
+	bool EffectChain::add(IEffect& effect)
+	{
+		if (mEffects.size() >= kMaxEffects) {
+			SAUDIO_WARN_LOG(mContext) << "An effect chain can't hold more than " << kMaxEffects << " IEffects";
+			return false;
+		}
+
+		mEffects.push_back(&effect);
+		publish();
+		return true;
+	}
+
+
+	bool EffectChain::remove(IEffect& effect)
+	{
+		auto itEffect = std::find(mEffects.begin(), mEffects.end(), &effect);
+		if (itEffect == mEffects.end()) {
+			return false;
+		}
+
+		mEffects.erase(itEffect);
+		publish();
+		return true;
+	}
+
+
+	void EffectChain::process(float* frames, std::size_t numFrames, std::size_t numChannels)
+	{
+		mProcessSequence.fetch_add(1);
+
+		const Effects& list = mLists[mCurrentList.load()];
+		for (std::size_t i = 0; i < list.numEffects; ++i) {
+			list.effects[i]->process(frames, numFrames, numChannels);
+		}
+
+		mProcessSequence.fetch_add(1);
+	}
+
+// Private functions
+	void EffectChain::publish()
+	{
+		std::size_t nextList = 1 - mCurrentList.load(std::memory_order_relaxed);
+		Effects& list = mLists[nextList];
+		std::copy(mEffects.begin(), mEffects.end(), list.effects);
+		list.numEffects = mEffects.size();
+
+		// Wait until the audio thread stops processing the previous list,
+		// so it can be reused and the removed IEffects destroyed
+		mCurrentList.store(nextList);
+		uint64_t sequence = mProcessSequence.load();
+		if (sequence % 2 == 1) {
+			while (mProcessSequence.load() == sequence) {
+				std::this_thread::yield();
+			}
+		}
+	}
+
+}
@@ -0,0 +1,91 @@
+#ifndef SAUDIO_EFFECT_CHAIN_H
+#define SAUDIO_EFFECT_CHAIN_H
+
+#include <atomic>
+#include <vector>
+#include <cstdint>
+
+namespace saudio {
+
+	class Context;
+	class IEffect;
+
+
+	/**
+	 * Class EffectChain, it holds a list of IEffects that are processed in
+	 * order by the audio thread. The IEffects can be added and removed from
+	 * another thread while the chain is being processed: the list is double
+	 * buffered, and the audio thread marks when it's processing it, so a
+	 * removed IEffect isn't used anymore once @see remove returns.
+	 */
+	class EffectChain
+	{
+	public:		// Nested types
+		/** The maximum number of IEffects of a chain */
+		static constexpr std::size_t kMaxEffects = 16;
+
+	private:
+		/** The IEffects read by the audio thread */
+		struct Effects
+		{
+			IEffect* effects[kMaxEffects];
+			std::size_t numEffects;
+		};
+
+	private:	// Attributes
+		/** The Context used for logging */
+		const Context* mContext;
+
+		/** The IEffects of the chain, only used by the thread that adds and
+		 * removes them */
+		std::vector<IEffect*> mEffects;
+
+		/** The lists read by the audio thread, one is published while the
+		 * other one is written */
+		Effects mLists[2];
+
+		/** The index of the list read by the audio thread */
+		std::atomic<std::size_t> mCurrentList;
+
+		/** Incremented by the audio thread before and after processing the
+		 * IEffects, so they can be removed safely */
+		std::atomic<uint64_t> mProcessSequence;
+
+	public:		// Functions
+		/** Creates a new EffectChain
+		 *
+		 * @param	context a pointer to the Context used for logging, it can
+		 *			be nullptr */
+		EffectChain(const Context* context);
+
+		/** Appends the given IEffect to the end of the chain. It must be
+		 * called always from the same thread
+		 *
+		 * @param	effect the IEffect to add
+		 * @return	true on success, false if the chain is full */
+		bool add(IEffect& effect);
+
+		/** Removes the given IEffect from the chain. It must be called from
+		 * the same thread than @see add
+		 *
+		 * @param	effect the IEffect to remove
+		 * @return	true if the IEffect was removed, false if it wasn't
+		 *			found */
+		bool remove(IEffect& effect);
+
+		/** Processes the given frames with the IEffects of the chain. It
+		 * must be called from the audio thread
+		 *
+		 * @param	frames a pointer to the interleaved frames to process
+		 * @param	numFrames the number of frames
+		 * @param	numChannels the number of channels of each frame */
+		void process(float* frames, std::size_t numFrames, std::size_t numChannels);
+	private:
+		/** Publishes @see mEffects to the audio thread and waits until it
+		 * stops using the previous list */
+		void publish();
+	};
+
+}
+
+#endif		// SAUDIO_EFFECT_CHAIN_H
@@ -0,0 +1,556 @@
+#include <cmath>
+#include <algorithm>
+#include "EffectKernels.h"
+#include "SimdPack.h"
+
+namespace saudio {
+
+	/** The maximum number of frames of a channel copied to a contiguous
+	 * buffer by @see processBiquads and @see processOnePole */
+	static constexpr std::size_t kChunkFrames = 256;
+
+
+	/** The outputs of a biquad stage for a block of Pack::kSize frames of a
+	 * channel as linear combinations of the inputs and of the initial
+	 * state. Lane i of input[j] holds the output i for a unit input at
+	 * frame j, and lane i of state1 and state2 the output i for a unit
+	 * initial z1 or z2, so the recursion over the frames of the block is
+	 * replaced by Pack::kSize + 2 multiply-adds */
+	struct BiquadBlockResponse
+	{
+		Pack input[Pack::kSize];
+		Pack state1, state2;
+
+		/** The z1 and z2 values after the block for a unit initial z1
+		 * (first column) or z2 (second column) and zero inputs */
+		float nextState[2][2];
+
+		BiquadBlockResponse() = default;
+		BiquadBlockResponse(const BiquadCoefficients& c)
+		{
+			auto simulate = [&](std::size_t impulseFrame, float z1, float z2, float* next = nullptr) {
+				float lanes[Pack::kSize];
+				for (std::size_t i = 0; i < Pack::kSize; ++i) {
+					float x = (i == impulseFrame)? 1.0f : 0.0f;
+					float y = c.b0 * x + z1;
+					z1 = c.b1 * x - c.a1 * y + z2;
+					z2 = c.b2 * x - c.a2 * y;
+					lanes[i] = y;
+				}
+				if (next) {
+					next[0] = z1;
+					next[1] = z2;
+				}
+				return Pack::load(lanes);
+			};
+
+			for (std::size_t j = 0; j < Pack::kSize; ++j) {
+				input[j] = simulate(j, 0.0f, 0.0f);
+			}
+
+			float next1[2], next2[2];
+			state1 = simulate(Pack::kSize, 1.0f, 0.0f, next1);
+			state2 = simulate(Pack::kSize, 0.0f, 1.0f, next2);
+			nextState[0][0] = next1[0];
+			nextState[0][1] = next2[0];
+			nextState[1][0] = next1[1];
+			nextState[1][1] = next2[1];
+		};
+	};
+
+
+	/** The outputs of a one-pole lowpass for a block of Pack::kSize frames
+	 * of a channel as linear combinations of the inputs and of the last
+	 * output, @see BiquadBlockResponse */
+	struct OnePoleBlockResponse
+	{
+		Pack input[Pack::kSize];
+		Pack state;
+
+		/** The last output of the block for a unit initial state and zero
+		 * inputs */
+		float nextState;
+
+		OnePoleBlockResponse(float coefficient)
+		{
+			auto simulate = [&](std::size_t impulseFrame, float y) {
+				float lanes[Pack::kSize];
+				for (std::size_t i = 0; i < Pack::kSize; ++i) {
+					float x = (i == impulseFrame)? 1.0f : 0.0f;
+					y = y + coefficient * (x - y);
+					lanes[i] = y;
+				}
+				return Pack::load(lanes);
+			};
+
+			for (std::size_t j = 0; j < Pack::kSize; ++j) {
+				input[j] = simulate(j, 0.0f);
+			}
+			state = simulate(Pack::kSize, 1.0f);
+
+			float lanes[Pack::kSize];
+			state.store(lanes);
+			nextState = lanes[Pack::kSize - 1];
+		};
+	};
+
+
+	/** Calculates the contribution of the inputs of a block to its
+	 * outputs
+	 *
+	 * @param	responses the outputs for a unit input at each frame of the
+	 *			block
+	 * @param	block a pointer to the Pack::kSize inputs of the block
+	 * @return	the sum of the responses scaled by the inputs */
+	inline Pack accumulateInputs(const Pack* responses, const float* block)
+	{
+		// Two sums shorten the chain of dependent additions
+		Pack sum0 = Pack::set(0.0f), sum1 = Pack::set(0.0f);
+		std::size_t j = 0;
+		for (; j + 1 < Pack::kSize; j += 2) {
+			sum0 = sum0 + Pack::set(block[j]) * responses[j];
+			sum1 = sum1 + Pack::set(block[j + 1]) * responses[j + 1];
+		}
+		if (j < Pack::kSize) {
+			sum0 = sum0 + Pack::set(block[j]) * responses[j];
+		}
+		return sum0 + sum1;
+	}
+
+
+	/** Filters the contiguous frames of a channel with a biquad stage, in
+	 * blocks of Pack::kSize frames
+	 *
+	 * @param	response the block response of the stage
+	 * @param	c the coefficients of the stage
+	 * @param	samples a pointer to the frames to filter
+	 * @param	numSamples the number of frames
+	 * @param	z1 the first state value of the stage, it's updated
+	 * @param	z2 the second state value of the stage, it's updated */
+	inline void processBiquadChannel(
+		const BiquadBlockResponse& response, const BiquadCoefficients& c,
+		float* samples, std::size_t numSamples, float& z1, float& z2
+	) {
+		const std::size_t last = Pack::kSize - 1;
+		float s1 = z1, s2 = z2;
+
+		std::size_t i = 0;
+		for (; i + Pack::kSize <= numSamples; i += Pack::kSize) {
+			float* block = samples + i;
+
+			// The contribution of the inputs doesn't depend on the previous
+			// blocks
+			Pack inputPart = accumulateInputs(response.input, block);
+			Pack y = inputPart + (Pack::set(s1) * response.state1 + Pack::set(s2) * response.state2);
+
+			// The state after the block is also split in the contribution of
+			// the inputs, from the last two frames, and the one of the
+			// current state, so the blocks only depend on each other
+			// through a few scalar operations
+			float inputOutput[Pack::kSize];
+			inputPart.store(inputOutput);
+			float u1 = c.b1 * block[last] - c.a1 * inputOutput[last];
+			float u2 = c.b2 * block[last] - c.a2 * inputOutput[last];
+			if constexpr (Pack::kSize > 1) {
+				u1 += c.b2 * block[last - 1] - c.a2 * inputOutput[last - 1];
+			}
+
+			float next1 = u1 + response.nextState[0][0] * s1 + response.nextState[0][1] * s2;
+			float next2 = u2 + response.nextState[1][0] * s1 + response.nextState[1][1] * s2;
+			s1 = next1;
+			s2 = next2;
+			y.store(block);
+		}
+
+		for (; i < numSamples; ++i) {
+			float x = samples[i], y = c.b0 * x + s1;
+			s1 = c.b1 * x - c.a1 * y + s2;
+			s2 = c.b2 * x - c.a2 * y;
+			samples[i] = y;
+		}
+
+		z1 = s1;
+		z2 = s2;
+	}
+
+
+	/** Filters the contiguous frames of a channel with a one-pole filter,
+	 * @see processBiquadChannel
+	 *
+	 * @param	response the block response of the lowpass
+	 * @param	coefficient the smoothing coefficient of the lowpass
+	 * @param	highPass true for the highpass output, false for the
+	 *			lowpass one
+	 * @param	samples a pointer to the frames to filter
+	 * @param	numSamples the number of frames
+	 * @param	state the last lowpass output, it's updated */
+	inline void processOnePoleChannel(
+		const OnePoleBlockResponse& response, float coefficient, bool highPass,
+		float* samples, std::size_t numSamples, float& state
+	) {
+		float last = state;
+
+		std::size_t i = 0;
+		for (; i + Pack::kSize <= numSamples; i += Pack::kSize) {
+			float* block = samples + i;
+
+			Pack inputPart = accumulateInputs(response.input, block);
+			Pack y = inputPart + Pack::set(last) * response.state;
+
+			// The last output is split like the biquad state
+			float inputOutput[Pack::kSize];
+			inputPart.store(inputOutput);
+			last = inputOutput[Pack::kSize - 1] + response.nextState * last;
+			(highPass? Pack::load(block) - y : y).store(block);
+		}
+
+		for (; i < numSamples; ++i) {
+			last += coefficient * (samples[i] - last);
+			samples[i] = highPass? samples[i] - last : last;
+		}
+
+		state = last;
+	}
+
+
+	/** Delays a single frame, @see processDelay
+	 *
+	 * @param	frame a pointer to the frame to delay
+	 * @param	numChannels the number of channels of the frame
+	 * @param	buffer a pointer to the interleaved frames of the delay line
+	 * @param	bufferFrames the number of frames of the delay line
+	 * @param	writeIndex the frame of the delay line where the frame will
+	 *			be written, it's updated by the function
+	 * @param	delay the delay in frames, at least 1
+	 * @param	feedback the gain of the delayed frame fed back to the delay
+	 *			line
+	 * @param	wetGain the gain of the delayed frame
+	 * @param	dryGain the gain of the original frame */
+	inline void delayFrame(
+		float* frame, std::size_t numChannels,
+		float* buffer, std::size_t bufferFrames, std::size_t& writeIndex,
+		float delay, float feedback, float wetGain, float dryGain
+	) {
+		// Fractional read position, the delay is at least one frame so
+		// it never reads the frame being written
+		float readPosition = static_cast<float>(writeIndex) - delay;
+		if (readPosition < 0.0f) {
+			readPosition += bufferFrames;
+		}
+		std::size_t i0 = std::min(static_cast<std::size_t>(readPosition), bufferFrames - 1);
+		std::size_t i1 = (i0 + 1 < bufferFrames)? i0 + 1 : 0;
+		float t = readPosition - i0;
+
+		const float* delayed0 = buffer + i0 * numChannels;
+		const float* delayed1 = buffer + i1 * numChannels;
+		float* written = buffer + writeIndex * numChannels;
+
+		std::size_t c = 0;
+		if (numChannels >= Pack::kSize) {
+			const Pack tPack = Pack::set(t), feedbackPack = Pack::set(feedback);
+			const Pack wetPack = Pack::set(wetGain), dryPack = Pack::set(dryGain);
+			for (; c + Pack::kSize <= numChannels; c += Pack::kSize) {
+				Pack x = Pack::load(frame + c), d0 = Pack::load(delayed0 + c), d1 = Pack::load(delayed1 + c);
+				Pack y = d0 + (d1 - d0) * tPack;
+				(x + feedbackPack * y).store(written + c);
+				(dryPack * x + wetPack * y).store(frame + c);
+			}
+		}
+
+		for (; c < numChannels; ++c) {
+			float x = frame[c], y = delayed0[c] + (delayed1[c] - delayed0[c]) * t;
+			written[c] = x + feedback * y;
+			frame[c] = dryGain * x + wetGain * y;
+		}
+
+		writeIndex = (writeIndex + 1 < bufferFrames)? writeIndex + 1 : 0;
+	}
+
+
+	void processBiquads(
+		float* frames, std::size_t numFrames, std::size_t numChannels,
+		const BiquadCoefficients* stages, std::size_t numStages, float* state
+	) {
+		numStages = std::min(numStages, kMaxBiquadStages);
+		std::size_t numGroupedChannels = numChannels - numChannels % Pack::kSize;
+
+		// Each lane holds a channel, so the recursion over the frames is
+		// computed for multiple channels at the same time
+		for (std::size_t c0 = 0; c0 < numGroupedChannels; c0 += Pack::kSize) {
+			Pack b0[kMaxBiquadStages], b1[kMaxBiquadStages], b2[kMaxBiquadStages], a1[kMaxBiquadStages], a2[kMaxBiquadStages];
+			Pack z1[kMaxBiquadStages], z2[kMaxBiquadStages];
+			for (std::size_t s = 0; s < numStages; ++s) {
+				b0[s] = Pack::set(stages[s].b0);
+				b1[s] = Pack::set(stages[s].b1);
+				b2[s] = Pack::set(stages[s].b2);
+				a1[s] = Pack::set(stages[s].a1);
+				a2[s] = Pack::set(stages[s].a2);
+				z1[s] = Pack::load(state + (2 * s) * numChannels + c0);
+				z2[s] = Pack::load(state + (2 * s + 1) * numChannels + c0);
+			}
+
+			for (std::size_t f = 0; f < numFrames; ++f) {
+				float* frame = frames + f * numChannels + c0;
+				Pack x = Pack::load(frame);
+				for (std::size_t s = 0; s < numStages; ++s) {
+					Pack y = b0[s] * x + z1[s];
+					z1[s] = b1[s] * x - a1[s] * y + z2[s];
+					z2[s] = b2[s] * x - a2[s] * y;
+					x = y;
+				}
+				x.store(frame);
+			}
+
+			for (std::size_t s = 0; s < numStages; ++s) {
+				z1[s].store(state + (2 * s) * numChannels + c0);
+				z2[s].store(state + (2 * s + 1) * numChannels + c0);
+			}
+		}
+
+		if (numGroupedChannels == numChannels) {
+			return;
+		}
+
+		// The remaining channels, ie. the ones of mono and stereo frames,
+		// would leave most of the lanes empty, so each lane holds a frame of
+		// a block instead. The frames are copied to a contiguous buffer,
+		// where each stage filters all the blocks before the next one
+		BiquadBlockResponse responses[kMaxBiquadStages];
+		if (numFrames >= Pack::kSize) {
+			for (std::size_t s = 0; s < numStages; ++s) {
+				responses[s] = BiquadBlockResponse(stages[s]);
+			}
+		}
+
+		for (std::size_t f0 = 0; f0 < numFrames; f0 += kChunkFrames) {
+			std::size_t numChunkFrames = std::min(kChunkFrames, numFrames - f0);
+			for (std::size_t c = numGroupedChannels; c < numChannels; ++c) {
+				float samples[kChunkFrames];
+				for (std::size_t i = 0; i < numChunkFrames; ++i) {
+					samples[i] = frames[(f0 + i) * numChannels + c];
+				}
+				for (std::size_t s = 0; s < numStages; ++s) {
+					processBiquadChannel(
+						responses[s], stages[s], samples, numChunkFrames,
+						state[(2 * s) * numChannels + c], state[(2 * s + 1) * numChannels + c]
+					);
+				}
+				for (std::size_t i = 0; i < numChunkFrames; ++i) {
+					frames[(f0 + i) * numChannels + c] = samples[i];
+				}
+			}
+		}
+	}
+
+
+	void processOnePole(
+		float* frames, std::size_t numFrames, std::size_t numChannels,
+		float coefficient, bool highPass, float* state
+	) {
+		std::size_t numGroupedChannels = numChannels - numChannels % Pack::kSize;
+
+		const Pack a = Pack::set(coefficient);
+		for (std::size_t c0 = 0; c0 < numGroupedChannels; c0 += Pack::kSize) {
+			Pack y = Pack::load(state + c0);
+
+			for (std::size_t f = 0; f < numFrames; ++f) {
+				float* frame = frames + f * numChannels + c0;
+				Pack x = Pack::load(frame);
+				y = y + a * (x - y);
+				(highPass? x - y : y).store(frame);
+			}
+
+			y.store(state + c0);
+		}
+
+		if (numGroupedChannels == numChannels) {
+			return;
+		}
+
+		// Each lane holds a frame of a block, @see processBiquads
+		const OnePoleBlockResponse response(coefficient);
+		for (std::size_t f0 = 0; f0 < numFrames; f0 += kChunkFrames) {
+			std::size_t numChunkFrames = std::min(kChunkFrames, numFrames - f0);
+			for (std::size_t c = numGroupedChannels; c < numChannels; ++c) {
+				float samples[kChunkFrames];
+				for (std::size_t i = 0; i < numChunkFrames; ++i) {
+					samples[i] = frames[(f0 + i) * numChannels + c];
+				}
+				processOnePoleChannel(response, coefficient, highPass, samples, numChunkFrames, state[c]);
+				for (std::size_t i = 0; i < numChunkFrames; ++i) {
+					frames[(f0 + i) * numChannels + c] = samples[i];
+				}
+			}
+		}
+	}
+
+
+	void processDelay(
+		float* frames, std::size_t numFrames, std::size_t numChannels,
+		float* buffer, std::size_t bufferFrames, std::size_t& writeIndex,
+		const DelayParameters& parameters
+	) {
+		if (numFrames == 0) {
+			return;
+		}
+
+		bool constant = (parameters.startDelay == parameters.endDelay)
+			&& (parameters.startWetGain == parameters.endWetGain)
+			&& (parameters.startDryGain == parameters.endDryGain);
+		if (!constant) {
+			float delayStep = (parameters.endDelay - parameters.startDelay) / numFrames;
+			float wetGainStep = (parameters.endWetGain - parameters.startWetGain) / numFrames;
+			float dryGainStep = (parameters.endDryGain - parameters.startDryGain) / numFrames;
+			for (std::size_t f = 0; f < numFrames; ++f) {
+				delayFrame(
+					frames + f * numChannels, numChannels, buffer, bufferFrames, writeIndex,
+					std::max(parameters.startDelay + delayStep * f, 1.0f), parameters.feedback,
+					parameters.startWetGain + wetGainStep * f, parameters.startDryGain + dryGainStep * f
+				);
+			}
+			return;
+		}
+
+		// With constant parameters consecutive frames are read from
+		// consecutive frames of the delay line, so the frames are processed
+		// as a flat array of samples until the read or write positions wrap
+		// around, with the channels of multiple frames in each Pack
+		const float delay = std::max(parameters.startDelay, 1.0f);
+		const Pack feedback = Pack::set(parameters.feedback);
+		const Pack wetGain = Pack::set(parameters.startWetGain), dryGain = Pack::set(parameters.startDryGain);
+
+		std::size_t f = 0;
+		while (f < numFrames) {
+			float readPosition = static_cast<float>(writeIndex) - delay;
+			if (readPosition < 0.0f) {
+				readPosition += bufferFrames;
+			}
+			std::size_t i0 = std::min(static_cast<std::size_t>(readPosition), bufferFrames - 1);
+			std::size_t i1 = i0 + 1;
+
+			// The samples written by a Pack can't be read by the same Pack
+			std::size_t lag = (writeIndex + bufferFrames - i1) % bufferFrames;
+			std::size_t numSegmentFrames = std::min({ numFrames - f, bufferFrames - writeIndex, bufferFrames - i1 });
+			if ((i1 >= bufferFrames) || (lag * numChannels < Pack::kSize) || (numSegmentFrames == 0)) {
+				delayFrame(
+					frames + f * numChannels, numChannels, buffer, bufferFrames, writeIndex,
+					delay, parameters.feedback, parameters.startWetGain, parameters.startDryGain
+				);
+				++f;
+				continue;
+			}
+
+			const float t = readPosition - i0;
+			const Pack tPack = Pack::set(t);
+			float* samples = frames + f * numChannels;
+			const float* delayed0 = buffer + i0 * numChannels;
+			const float* delayed1 = buffer + i1 * numChannels;
+			float* written = buffer + writeIndex * numChannels;
+
+			std::size_t numSamples = numSegmentFrames * numChannels, s = 0;
+			for (; s + Pack::kSize <= numSamples; s += Pack::kSize) {
+				Pack x = Pack::load(samples + s), d0 = Pack::load(delayed0 + s), d1 = Pack::load(delayed1 + s);
+				Pack y = d0 + (d1 - d0) * tPack;
+				(x + feedback * y).store(written + s);
+				(dryGain * x + wetGain * y).store(samples + s);
+			}
+			for (; s < numSamples; ++s) {
+				float x = samples[s], y = delayed0[s] + (delayed1[s] - delayed0[s]) * t;
+				written[s] = x + parameters.feedback * y;
+				samples[s] = parameters.startDryGain * x + parameters.startWetGain * y;
+			}
+
+			writeIndex += numSegmentFrames;
+			if (writeIndex == bufferFrames) {
+				writeIndex = 0;
+			}
+			f += numSegmentFrames;
+		}
+	}
+
+
+	void computePeaks(const float* frames, std::size_t numFrames, std::size_t numChannels, float* peaks)
+	{
+		std::size_t f = 0;
+
+		if (numChannels == 1) {
+			for (; f + Pack::kSize <= numFrames; f += Pack::kSize) {
+				abs(Pack::load(frames + f)).store(peaks + f);
+			}
+		}
+		else if (numChannels == 2) {
+			// The maximum of each pair of lanes is the peak of a frame
+#if defined(SAUDIO_SIMD_AVX)
+			for (; f + 4 <= numFrames; f += 4) {
+				__m256 v = _mm256_andnot_ps(_mm256_set1_ps(-0.0f), _mm256_loadu_ps(frames + 2 * f));
+				__m256 m = _mm256_max_ps(v, _mm256_permute_ps(v, _MM_SHUFFLE(2, 3, 0, 1)));
+				m = _mm256_permute_ps(m, _MM_SHUFFLE(2, 0, 2, 0));
+				_mm_storel_pi(reinterpret_cast<__m64*>(peaks + f), _mm256_castps256_ps128(m));
+				_mm_storel_pi(reinterpret_cast<__m64*>(peaks + f + 2), _mm256_extractf128_ps(m, 1));
+			}
+#elif defined(SAUDIO_SIMD_SSE)
+			for (; f + 2 <= numFrames; f += 2) {
+				__m128 v = _mm_andnot_ps(_mm_set1_ps(-0.0f), _mm_loadu_ps(frames + 2 * f));
+				__m128 m = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+				_mm_storel_pi(reinterpret_cast<__m64*>(peaks + f), _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 0, 2, 0)));
+			}
+#elif defined(SAUDIO_SIMD_NEON)
+			for (; f + 4 <= numFrames; f += 4) {
+				float32x4x2_t v = vld2q_f32(frames + 2 * f);
+				vst1q_f32(peaks + f, vmaxq_f32(vabsq_f32(v.val[0]), vabsq_f32(v.val[1])));
+			}
+#endif
+		}
+
+		for (; f < numFrames; ++f) {
+			float peak = 0.0f;
+			for (std::size_t c = 0; c < numChannels; ++c) {
+				peak = std::max(peak, std::fabs(frames[f * numChannels + c]));
+			}
+			peaks[f] = peak;
+		}
+	}
+
+
+	void applyFrameGains(
+		float* dst, const float* src, const float* gains,
+		std::size_t numFrames, std::size_t numChannels
+	) {
+		std::size_t f = 0;
+
+		if (numChannels == 1) {
+			for (; f + Pack::kSize <= numFrames; f += Pack::kSize) {
+				(Pack::load(src + f) * Pack::load(gains + f)).store(dst + f);
+			}
+		}
+		else if (numChannels == 2) {
+			// Each gain is duplicated for the two samples of its frame
+#if defined(SAUDIO_SIMD_AVX)
+			for (; f + 4 <= numFrames; f += 4) {
+				__m128 g = _mm_loadu_ps(gains + f);
+				__m256 g2 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_unpacklo_ps(g, g)), _mm_unpackhi_ps(g, g), 1);
+				_mm256_storeu_ps(dst + 2 * f, _mm256_mul_ps(_mm256_loadu_ps(src + 2 * f), g2));
+			}
+#elif defined(SAUDIO_SIMD_SSE)
+			for (; f + 4 <= numFrames; f += 4) {
+				__m128 g = _mm_loadu_ps(gains + f);
+				_mm_storeu_ps(dst + 2 * f, _mm_mul_ps(_mm_loadu_ps(src + 2 * f), _mm_unpacklo_ps(g, g)));
+				_mm_storeu_ps(dst + 2 * f + 4, _mm_mul_ps(_mm_loadu_ps(src + 2 * f + 4), _mm_unpackhi_ps(g, g)));
+			}
+#elif defined(SAUDIO_SIMD_NEON)
+			for (; f + 4 <= numFrames; f += 4) {
+				float32x4x2_t g = vzipq_f32(vld1q_f32(gains + f), vld1q_f32(gains + f));
+				vst1q_f32(dst + 2 * f, vmulq_f32(vld1q_f32(src + 2 * f), g.val[0]));
+				vst1q_f32(dst + 2 * f + 4, vmulq_f32(vld1q_f32(src + 2 * f + 4), g.val[1]));
+			}
+#endif
+		}
+
+		for (; f < numFrames; ++f) {
+			for (std::size_t c = 0; c < numChannels; ++c) {
+				dst[f * numChannels + c] = src[f * numChannels + c] * gains[f];
+			}
+		}
+	}
+
+}
@@ -0,0 +1,126 @@
+#ifndef SAUDIO_EFFECT_KERNELS_H
+#define SAUDIO_EFFECT_KERNELS_H
+
+#include <cstddef>
+
+namespace saudio {
+
+	/** The maximum number of stages of @see processBiquads */
+	static constexpr std::size_t kMaxBiquadStages = 8;
+
+
+	/** The normalized coefficients of a biquad filter stage
+	 * (y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] - a1 y[n-1] - a2 y[n-2]) */
+	struct BiquadCoefficients
+	{
+		float b0 = 1.0f, b1 = 0.0f, b2 = 0.0f, a1 = 0.0f, a2 = 0.0f;
+	};
+
+
+	/** Filters the given interleaved frames in place with a cascade of
+	 * biquad stages in transposed direct form II. The channels are
+	 * processed at the same time with SIMD instructions, the ones that
+	 * don't fill a SIMD register (ie. mono or stereo frames) are processed
+	 * in blocks of frames instead
+	 *
+	 * @param	frames a pointer to the frames to filter
+	 * @param	numFrames the number of frames
+	 * @param	numChannels the number of channels of the frames
+	 * @param	stages a pointer to the coefficients of each stage
+	 * @param	numStages the number of stages, up to
+	 *			@see kMaxBiquadStages
+	 * @param	state a pointer to the 2 * numStages * numChannels state
+	 *			values of the stages, they must be zero initially */
+	void processBiquads(
+		float* frames, std::size_t numFrames, std::size_t numChannels,
+		const BiquadCoefficients* stages, std::size_t numStages, float* state
+	);
+
+
+	/** Filters the given interleaved frames in place with a one-pole
+	 * lowpass (y[n] = y[n-1] + coefficient (x[n] - y[n-1])) or with the
+	 * complementary highpass (x[n] - y[n]). The channels are processed
+	 * like in @see processBiquads
+	 *
+	 * @param	frames a pointer to the frames to filter
+	 * @param	numFrames the number of frames
+	 * @param	numChannels the number of channels of the frames
+	 * @param	coefficient the smoothing coefficient, from 0 to 1
+	 * @param	highPass true for the highpass output, false for the
+	 *			lowpass one
+	 * @param	state a pointer to the last lowpass output of each channel */
+	void processOnePole(
+		float* frames, std::size_t numFrames, std::size_t numChannels,
+		float coefficient, bool highPass, float* state
+	);
+
+
+	/** The parameters of @see processDelay */
+	struct DelayParameters
+	{
+		/** The delay in frames at the first and after the last frame, it's
+		 * interpolated linearly between both */
+		float startDelay, endDelay;
+
+		/** The gain of the delayed frames fed back to the delay line */
+		float feedback;
+
+		/** The gains of the delayed frames at the first and after the last
+		 * frame, they're interpolated like the delay */
+		float startWetGain, endWetGain;
+
+		/** The gains of the original frames at the first and after the
+		 * last frame, they're interpolated like the delay */
+		float startDryGain, endDryGain;
+	};
+
+
+	/** Delays the given interleaved frames in place with a fractional
+	 * delay line, reading it with linear interpolation. If the parameters
+	 * don't change the frames are processed as a flat array of samples
+	 * with SIMD instructions, otherwise the channels of each frame are
+	 * processed at the same time
+	 *
+	 * @param	frames a pointer to the frames to delay
+	 * @param	numFrames the number of frames
+	 * @param	numChannels the number of channels of the frames
+	 * @param	buffer a pointer to the interleaved frames of the delay line
+	 * @param	bufferFrames the number of frames of the delay line, it must
+	 *			be greater than the maximum delay plus 1
+	 * @param	writeIndex the frame of the delay line where the next frame
+	 *			will be written, it's updated by the function
+	 * @param	parameters the parameters of the delay */
+	void processDelay(
+		float* frames, std::size_t numFrames, std::size_t numChannels,
+		float* buffer, std::size_t bufferFrames, std::size_t& writeIndex,
+		const DelayParameters& parameters
+	);
+
+
+	/** Computes the absolute peak of each of the given interleaved frames
+	 * (peaks[f] = max(|frames[f][c]|))
+	 *
+	 * @param	frames a pointer to the frames
+	 * @param	numFrames the number of frames
+	 * @param	numChannels the number of channels of the frames
+	 * @param	peaks a pointer to the array where the peak of each frame
+	 *			will be stored */
+	void computePeaks(const float* frames, std::size_t numFrames, std::size_t numChannels, float* peaks);
+
+
+	/** Multiplies each of the given interleaved frames by a gain
+	 * (dst[f][c] = src[f][c] * gains[f])
+	 *
+	 * @param	dst a pointer to the frames where the result will be stored
+	 * @param	src a pointer to the frames to multiply
+	 * @param	gains a pointer to the gain of each frame
+	 * @param	numFrames the number of frames
+	 * @param	numChannels the number of channels of the frames */
+	void applyFrameGains(
+		float* dst, const float* src, const float* gains,
+		std::size_t numFrames, std::size_t numChannels
+	);
+
+}
+
+#endif		// SAUDIO_EFFECT_KERNELS_H
@@ -0,0 +1,135 @@
+#include <cmath>
+#include "FFT.h"
+
+namespace saudio {
+
+	FFT::FFT(std::size_t size) : mSize(size)
+	{
+		const double kPi = 3.14159265358979323846;
+		std::size_t half = mSize / 2;
+
+		std::size_t numBits = 0;
+		while ((std::size_t(1) << numBits) < half) {
+			numBits++;
+		}
+
+		mBitReverse.resize(half);
+		for (std::size_t i = 0; i < half; ++i) {
+			std::size_t reversed = 0;
+			for (std::size_t b = 0; b < numBits; ++b) {
+				reversed |= ((i >> b) & 1) << (numBits - b - 1);
+			}
+			mBitReverse[i] = reversed;
+		}
+
+		mTwiddleRe.resize(half / 2);
+		mTwiddleIm.resize(half / 2);
+		for (std::size_t i = 0; i < half / 2; ++i) {
+			double angle = -2.0 * kPi * i / half;
+			mTwiddleRe[i] = static_cast<float>(std::cos(angle));
+			mTwiddleIm[i] = static_cast<float>(std::sin(angle));
+		}
+
+		mSplitRe.resize(half + 1);
+		mSplitIm.resize(half + 1);
+		for (std::size_t k = 0; k <= half; ++k) {
+			double angle = -2.0 * kPi * k / mSize;
+			mSplitRe[k] = static_cast<float>(std::cos(angle));
+			mSplitIm[k] = static_cast<float>(std::sin(angle));
+		}
+
+		mBufferRe.resize(half);
+		mBufferIm.resize(half);
+	}
+
+
+	std::size_t FFT::getSize() const
+	{
+		return mSize;
+	}
+
+
+	std::size_t FFT::getNumBins() const
+	{
+		return mSize / 2 + 1;
+	}
+
+
+	void FFT::forward(const float* input, float* re, float* im)
+	{
+		std::size_t half = mSize / 2;
+
+		// Pack the even samples in the real part and the odd ones in the
+		// imaginary part
+		for (std::size_t i = 0; i < half; ++i) {
+			mBufferRe[mBitReverse[i]] = input[2 * i];
+			mBufferIm[mBitReverse[i]] = input[2 * i + 1];
+		}
+		transform(false);
+
+		// Split the spectra of the even and odd samples and combine them
+		for (std::size_t k = 0; k <= half; ++k) {
+			std::size_t k1 = k % half, k2 = (half - k) % half;
+			float zRe = mBufferRe[k1], zIm = mBufferIm[k1];
+			float cRe = mBufferRe[k2], cIm = -mBufferIm[k2];
+
+			float evenRe = 0.5f * (zRe + cRe), evenIm = 0.5f * (zIm + cIm);
+			float oddRe = 0.5f * (zIm - cIm), oddIm = -0.5f * (zRe - cRe);
+
+			re[k] = evenRe + mSplitRe[k] * oddRe - mSplitIm[k] * oddIm;
+			im[k] = evenIm + mSplitRe[k] * oddIm + mSplitIm[k] * oddRe;
+		}
+	}
+
+
+	void FFT::inverse(const float* re, const float* im, float* output)
+	{
+		std::size_t half = mSize / 2;
+
+		// Recover the spectra of the even and odd samples and pack them
+		for (std::size_t k = 0; k < half; ++k) {
+			float xRe = re[k], xIm = im[k];
+			float cRe = re[half - k], cIm = -im[half - k];
+
+			float evenRe = 0.5f * (xRe + cRe), evenIm = 0.5f * (xIm + cIm);
+			float dRe = 0.5f * (xRe - cRe), dIm = 0.5f * (xIm - cIm);
+			float oddRe = dRe * mSplitRe[k] + dIm * mSplitIm[k];
+			float oddIm = dIm * mSplitRe[k] - dRe * mSplitIm[k];
+
+			mBufferRe[mBitReverse[k]] = evenRe - oddIm;
+			mBufferIm[mBitReverse[k]] = evenIm + oddRe;
+		}
+		transform(true);
+
+		float scale = 1.0f / half;
+		for (std::size_t i = 0; i < half; ++i) {
+			output[2 * i] = mBufferRe[i] * scale;
+			output[2 * i + 1] = mBufferIm[i] * scale;
+		}
+	}
+
+// Private functions
+	void FFT::transform(bool inverse)
+	{
+		std::size_t half = mSize / 2;
+		float sign = inverse? -1.0f : 1.0f;
+
+		for (std::size_t length = 2; length <= half; length *= 2) {
+			std::size_t step = half / length;
+			for (std::size_t start = 0; start < half; start += length) {
+				for (std::size_t j = 0; j < length / 2; ++j) {
+					float wRe = mTwiddleRe[j * step], wIm = sign * mTwiddleIm[j * step];
+					std::size_t i1 = start + j, i2 = i1 + length / 2;
+
+					float tRe = mBufferRe[i2] * wRe - mBufferIm[i2] * wIm;
+					float tIm = mBufferRe[i2] * wIm + mBufferIm[i2] * wRe;
+					mBufferRe[i2] = mBufferRe[i1] - tRe;
+					mBufferIm[i2] = mBufferIm[i1] - tIm;
+					mBufferRe[i1] += tRe;
+					mBufferIm[i1] += tIm;
+				}
+			}
+		}
+	}
+
+}
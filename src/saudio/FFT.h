@@ -0,0 +1,78 @@
+#ifndef SAUDIO_FFT_H
+#define SAUDIO_FFT_H
+
+#include <vector>
+
+namespace saudio {
+
+	/**
+	 * Class FFT, it calculates the discrete Fourier transform of real
+	 * signals with a power of two size. The signal is packed in a complex
+	 * one of half its size that is transformed with an iterative radix-2
+	 * FFT, and the twiddle factors are precomputed, so the transforms
+	 * don't allocate memory.
+	 *
+	 * @note	the spectra are stored as split real and imaginary arrays of
+	 *			size / 2 + 1 bins, so they can be processed with SIMD
+	 *			instructions
+	 */
+	class FFT
+	{
+	private:	// Attributes
+		/** The size of the real signals */
+		std::size_t mSize;
+
+		/** The bit reversed indices of the complex FFT */
+		std::vector<std::size_t> mBitReverse;
+
+		/** The twiddle factors of the complex FFT */
+		std::vector<float> mTwiddleRe, mTwiddleIm;
+
+		/** The twiddle factors used for splitting the real spectrum */
+		std::vector<float> mSplitRe, mSplitIm;
+
+		/** The buffers of the complex FFT */
+		std::vector<float> mBufferRe, mBufferIm;
+
+	public:		// Functions
+		/** Creates a new FFT
+		 *
+		 * @param	size the size of the real signals, it must be a power of
+		 *			two greater or equal than 4 */
+		FFT(std::size_t size);
+
+		/** @return	the size of the real signals */
+		std::size_t getSize() const;
+
+		/** @return	the number of bins of the spectra */
+		std::size_t getNumBins() const;
+
+		/** Calculates the spectrum of the given signal
+		 *
+		 * @param	input a pointer to the @see getSize samples of the signal
+		 * @param	re a pointer to the array where the real part of the
+		 *			@see getNumBins bins will be stored
+		 * @param	im a pointer to the array where the imaginary part of the
+		 *			@see getNumBins bins will be stored */
+		void forward(const float* input, float* re, float* im);
+
+		/** Calculates the signal of the given spectrum, scaled so
+		 * inverse(forward(x)) = x
+		 *
+		 * @param	re a pointer to the real part of the spectrum
+		 * @param	im a pointer to the imaginary part of the spectrum
+		 * @param	output a pointer to the array where the @see getSize
+		 *			samples of the signal will be stored */
+		void inverse(const float* re, const float* im, float* output);
+	private:
+		/** Calculates the complex FFT of @see mBufferRe and
+		 * @see mBufferIm in place
+		 *
+		 * @param	inverse true for the inverse transform (without scaling),
+		 *			false for the forward one */
+		void transform(bool inverse);
+	};
+
+}
+
+#endif		// SAUDIO_FFT_H
@@ -2,32 +2,36 @@
 #include "saudio/FileDataSource.h"
 #include "saudio/AudioEngine.h"
 #include "LogWrapper.h"
+#include "ObjectAllocation.h"
 
 namespace saudio {
 
-	FileDataSource::FileDataSource(AudioEngine& engine, const char* path) : IDataSource()
+	FileDataSource::FileDataSource(AudioEngine& engine, const char* path, bool stream) :
+		IDataSource(), mContext(engine.getContext())
 	{
-		mDataSourceOwner = std::make_unique<ma_sound>();
-		ma_result res = ma_sound_init_from_file(engine.getMAEngine(), path, MA_SOUND_FLAG_DECODE, nullptr, nullptr, mDataSourceOwner.get());
+		ma_uint32 flags = stream? MA_SOUND_FLAG_STREAM : MA_SOUND_FLAG_DECODE;
+
+		mDataSourceOwner = makeObject<ma_sound>(mContext);
+		ma_result res = ma_sound_init_from_file(engine.getMAEngine(), path, flags, nullptr, nullptr, mDataSourceOwner.get());
 		if (res != MA_SUCCESS) {
-			SAUDIO_ERROR_LOG << "Failed to create the DataSourceOwner";
+			SAUDIO_ERROR_LOG(mContext) << "Failed to create the DataSourceOwner";
 			mDataSourceOwner = nullptr;
 		}
 		else {
-			SAUDIO_DEBUG_LOG << "Created DataSourceOwner " << mDataSourceOwner.get();
+			SAUDIO_DEBUG_LOG(mContext) << "Created DataSourceOwner " << mDataSourceOwner.get();
 		}
 	}
 
 
 	FileDataSource::FileDataSource(FileDataSource&& other) :
-		mDataSourceOwner(std::move(other.mDataSourceOwner)) {}
+		mDataSourceOwner(std::move(other.mDataSourceOwner)), mContext(other.mContext) {}
 
 
 	FileDataSource::~FileDataSource()
 	{
 		if (mDataSourceOwner) {
 			ma_sound_uninit(mDataSourceOwner.get());
-			SAUDIO_DEBUG_LOG << "Deleted DataSourceOwner " << mDataSourceOwner.get();
+			SAUDIO_DEBUG_LOG(mContext) << "Deleted DataSourceOwner " << mDataSourceOwner.get();
 			mDataSourceOwner = nullptr;
 		}
 	}
@@ -37,11 +41,12 @@ namespace saudio {
 	{
 		if (mDataSourceOwner) {
 			ma_sound_uninit(mDataSourceOwner.get());
-			SAUDIO_DEBUG_LOG << "Deleted DataSourceOwner " << mDataSourceOwner.get();
+			SAUDIO_DEBUG_LOG(mContext) << "Deleted DataSourceOwner " << mDataSourceOwner.get();
 			mDataSourceOwner = nullptr;
 		}
 
 		mDataSourceOwner = std::move(other.mDataSourceOwner);
+		mContext = other.mContext;
 
 		return *this;
 	}
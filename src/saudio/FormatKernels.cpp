@@ -0,0 +1,657 @@
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include "FormatKernels.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <immintrin.h>
+	#define SAUDIO_FORMAT_SSE2
+	#if defined(__GNUC__) || defined(__clang__)
+		#define SAUDIO_FORMAT_AVX2
+		#define SAUDIO_TARGET_AVX2 __attribute__((target("avx2")))
+	#elif defined(_MSC_VER)
+		#include <intrin.h>
+		#define SAUDIO_FORMAT_AVX2
+		#define SAUDIO_TARGET_AVX2
+	#endif
+#elif defined(__aarch64__) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+	#include <arm_neon.h>
+	#define SAUDIO_FORMAT_NEON
+#endif
+
+namespace saudio {
+
+	/** The scales between the f32 samples and the integer ones. The same
+	 * power of two is used in both directions, like miniaudio does, so the
+	 * integer samples are recovered exactly after a round trip. The
+	 * positive full scale is clipped to the largest integer sample */
+	static constexpr float kU8Scale = 128.0f;
+	static constexpr float kS16Scale = 32768.0f;
+	static constexpr float kS24Scale = 8388608.0f;
+	static constexpr float kS32Scale = 2147483648.0f;
+
+	/** The largest float below 2^31, the maximum s32 sample */
+	static constexpr float kMaxS32 = 2147483520.0f;
+
+	/** The scale of the 24 bits kept from the dither noise values */
+	static constexpr float kUniformScale = 1.0f / 16777216.0f;
+
+
+	/** The conversion functions of an instruction set */
+	struct ConversionKernels
+	{
+		void (*u8ToF32)(float*, const unsigned char*, std::size_t);
+		void (*s16ToF32)(float*, const unsigned char*, std::size_t);
+		void (*s32ToF32)(float*, const unsigned char*, std::size_t);
+		void (*f32ToU8)(unsigned char*, const float*, std::size_t, DitherState*);
+		void (*f32ToS16)(unsigned char*, const float*, std::size_t, DitherState*);
+		void (*f32ToS32)(unsigned char*, const float*, std::size_t);
+	};
+
+
+	// Private functions
+	/** @return	the next uniform value between 0 and 1 of the given
+	 *			xorshift generator */
+	static float nextUniform(uint32_t& state)
+	{
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return (state >> 8) * kUniformScale;
+	}
+
+
+	/** @return	the next triangular dither value between -1 and 1 of the
+	 *			given xorshift generator, or 0 if there is no dither */
+	static float nextDither(DitherState* dither)
+	{
+		if (!dither) {
+			return 0.0f;
+		}
+
+		float a = nextUniform(dither->lanes[0]);
+		return a - nextUniform(dither->lanes[0]);
+	}
+
+
+	static void u8ToF32Scalar(float* dst, const unsigned char* src, std::size_t numSamples)
+	{
+		for (std::size_t i = 0; i < numSamples; ++i) {
+			dst[i] = (static_cast<float>(src[i]) - 128.0f) * (1.0f / kU8Scale);
+		}
+	}
+
+
+	static void s16ToF32Scalar(float* dst, const unsigned char* src, std::size_t numSamples)
+	{
+		for (std::size_t i = 0; i < numSamples; ++i) {
+			int16_t sample;
+			std::memcpy(&sample, src + 2 * i, sizeof(int16_t));
+			dst[i] = sample * (1.0f / kS16Scale);
+		}
+	}
+
+
+	static void s24ToF32Scalar(float* dst, const unsigned char* src, std::size_t numSamples)
+	{
+		for (std::size_t i = 0; i < numSamples; ++i) {
+			const unsigned char* bytes = src + 3 * i;
+			uint32_t sample = (uint32_t(bytes[0]) << 8) | (uint32_t(bytes[1]) << 16) | (uint32_t(bytes[2]) << 24);
+			dst[i] = static_cast<int32_t>(sample) * (1.0f / kS32Scale);
+		}
+	}
+
+
+	static void s32ToF32Scalar(float* dst, const unsigned char* src, std::size_t numSamples)
+	{
+		for (std::size_t i = 0; i < numSamples; ++i) {
+			int32_t sample;
+			std::memcpy(&sample, src + 4 * i, sizeof(int32_t));
+			dst[i] = sample * (1.0f / kS32Scale);
+		}
+	}
+
+
+	static void f32ToU8Scalar(unsigned char* dst, const float* src, std::size_t numSamples, DitherState* dither)
+	{
+		for (std::size_t i = 0; i < numSamples; ++i) {
+			float sample = std::clamp(src[i] * kU8Scale + 128.0f + nextDither(dither), 0.0f, 255.0f);
+			dst[i] = static_cast<unsigned char>(std::lrint(sample));
+		}
+	}
+
+
+	static void f32ToS16Scalar(unsigned char* dst, const float* src, std::size_t numSamples, DitherState* dither)
+	{
+		for (std::size_t i = 0; i < numSamples; ++i) {
+			float sample = std::clamp(src[i] * kS16Scale + nextDither(dither), -32768.0f, 32767.0f);
+			int16_t value = static_cast<int16_t>(std::lrint(sample));
+			std::memcpy(dst + 2 * i, &value, sizeof(int16_t));
+		}
+	}
+
+
+	static void f32ToS24Scalar(unsigned char* dst, const float* src, std::size_t numSamples)
+	{
+		for (std::size_t i = 0; i < numSamples; ++i) {
+			float sample = std::clamp(src[i] * kS24Scale, -8388608.0f, 8388607.0f);
+			uint32_t value = static_cast<uint32_t>(static_cast<int32_t>(std::lrint(sample)));
+			dst[3 * i + 0] = static_cast<unsigned char>(value);
+			dst[3 * i + 1] = static_cast<unsigned char>(value >> 8);
+			dst[3 * i + 2] = static_cast<unsigned char>(value >> 16);
+		}
+	}
+
+
+	static void f32ToS32Scalar(unsigned char* dst, const float* src, std::size_t numSamples)
+	{
+		for (std::size_t i = 0; i < numSamples; ++i) {
+			float sample = std::min(std::clamp(src[i], -1.0f, 1.0f) * kS32Scale, kMaxS32);
+			int32_t value = static_cast<int32_t>(std::lrint(sample));
+			std::memcpy(dst + 4 * i, &value, sizeof(int32_t));
+		}
+	}
+
+#if defined(SAUDIO_FORMAT_SSE2)
+	/** @return	the next triangular dither values of the first 4 lanes of
+	 *			the given state, updating it */
+	static inline __m128 nextDitherSSE2(__m128i& state)
+	{
+		const __m128 scale = _mm_set1_ps(kUniformScale);
+
+		__m128 values[2];
+		for (__m128& value : values) {
+			state = _mm_xor_si128(state, _mm_slli_epi32(state, 13));
+			state = _mm_xor_si128(state, _mm_srli_epi32(state, 17));
+			state = _mm_xor_si128(state, _mm_slli_epi32(state, 5));
+			value = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(state, 8)), scale);
+		}
+		return _mm_sub_ps(values[0], values[1]);
+	}
+
+
+	static void u8ToF32SSE2(float* dst, const unsigned char* src, std::size_t numSamples)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128 offset = _mm_set1_ps(128.0f), scale = _mm_set1_ps(1.0f / kU8Scale);
+
+		std::size_t i = 0;
+		for (; i + 16 <= numSamples; i += 16) {
+			__m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+			__m128i words[2] = { _mm_unpacklo_epi8(bytes, zero), _mm_unpackhi_epi8(bytes, zero) };
+			for (int j = 0; j < 2; ++j) {
+				__m128 lo = _mm_cvtepi32_ps(_mm_unpacklo_epi16(words[j], zero));
+				__m128 hi = _mm_cvtepi32_ps(_mm_unpackhi_epi16(words[j], zero));
+				_mm_storeu_ps(dst + i + 8 * j, _mm_mul_ps(_mm_sub_ps(lo, offset), scale));
+				_mm_storeu_ps(dst + i + 8 * j + 4, _mm_mul_ps(_mm_sub_ps(hi, offset), scale));
+			}
+		}
+
+		u8ToF32Scalar(dst + i, src + i, numSamples - i);
+	}
+
+
+	static void s16ToF32SSE2(float* dst, const unsigned char* src, std::size_t numSamples)
+	{
+		const __m128 scale = _mm_set1_ps(1.0f / kS16Scale);
+
+		std::size_t i = 0;
+		for (; i + 8 <= numSamples; i += 8) {
+			// Sign extend the samples by moving them to the high half
+			__m128i words = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * i));
+			__m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(words, words), 16);
+			__m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(words, words), 16);
+			_mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+			_mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+		}
+
+		s16ToF32Scalar(dst + i, src + 2 * i, numSamples - i);
+	}
+
+
+	static void s32ToF32SSE2(float* dst, const unsigned char* src, std::size_t numSamples)
+	{
+		const __m128 scale = _mm_set1_ps(1.0f / kS32Scale);
+
+		std::size_t i = 0;
+		for (; i + 4 <= numSamples; i += 4) {
+			__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 4 * i));
+			_mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(v), scale));
+		}
+
+		s32ToF32Scalar(dst + i, src + 4 * i, numSamples - i);
+	}
+
+
+	static void f32ToU8SSE2(unsigned char* dst, const float* src, std::size_t numSamples, DitherState* dither)
+	{
+		const __m128 scale = _mm_set1_ps(kU8Scale), offset = _mm_set1_ps(128.0f);
+		const __m128 lo = _mm_setzero_ps(), hi = _mm_set1_ps(255.0f);
+		__m128i state = dither? _mm_loadu_si128(reinterpret_cast<const __m128i*>(dither->lanes)) : _mm_setzero_si128();
+
+		std::size_t i = 0;
+		for (; i + 16 <= numSamples; i += 16) {
+			__m128i values[4];
+			for (int j = 0; j < 4; ++j) {
+				__m128 v = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(src + i + 4 * j), scale), offset);
+				if (dither) {
+					v = _mm_add_ps(v, nextDitherSSE2(state));
+				}
+				values[j] = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(v, lo), hi));
+			}
+
+			__m128i words0 = _mm_packs_epi32(values[0], values[1]);
+			__m128i words1 = _mm_packs_epi32(values[2], values[3]);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(words0, words1));
+		}
+
+		if (dither) {
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dither->lanes), state);
+		}
+		f32ToU8Scalar(dst + i, src + i, numSamples - i, dither);
+	}
+
+
+	static void f32ToS16SSE2(unsigned char* dst, const float* src, std::size_t numSamples, DitherState* dither)
+	{
+		const __m128 scale = _mm_set1_ps(kS16Scale);
+		const __m128 lo = _mm_set1_ps(-32768.0f), hi = _mm_set1_ps(32767.0f);
+		__m128i state = dither? _mm_loadu_si128(reinterpret_cast<const __m128i*>(dither->lanes)) : _mm_setzero_si128();
+
+		std::size_t i = 0;
+		for (; i + 8 <= numSamples; i += 8) {
+			__m128i values[2];
+			for (int j = 0; j < 2; ++j) {
+				__m128 v = _mm_mul_ps(_mm_loadu_ps(src + i + 4 * j), scale);
+				if (dither) {
+					v = _mm_add_ps(v, nextDitherSSE2(state));
+				}
+				values[j] = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(v, lo), hi));
+			}
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2 * i), _mm_packs_epi32(values[0], values[1]));
+		}
+
+		if (dither) {
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dither->lanes), state);
+		}
+		f32ToS16Scalar(dst + 2 * i, src + i, numSamples - i, dither);
+	}
+
+
+	static void f32ToS32SSE2(unsigned char* dst, const float* src, std::size_t numSamples)
+	{
+		const __m128 scale = _mm_set1_ps(kS32Scale), maxSample = _mm_set1_ps(kMaxS32);
+		const __m128 lo = _mm_set1_ps(-1.0f), hi = _mm_set1_ps(1.0f);
+
+		std::size_t i = 0;
+		for (; i + 4 <= numSamples; i += 4) {
+			__m128 v = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i), lo), hi);
+			v = _mm_min_ps(_mm_mul_ps(v, scale), maxSample);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 4 * i), _mm_cvtps_epi32(v));
+		}
+
+		f32ToS32Scalar(dst + 4 * i, src + i, numSamples - i);
+	}
+#endif
+#if defined(SAUDIO_FORMAT_AVX2)
+	/** @return	true if the CPU and the OS support AVX2, false otherwise */
+	static bool cpuSupportsAVX2()
+	{
+#if defined(_MSC_VER) && !defined(__clang__)
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7) {
+			return false;
+		}
+
+		// The OS must save the AVX registers
+		__cpuid(info, 1);
+		bool osxsave = (info[2] & (1 << 27)) != 0, avx = (info[2] & (1 << 28)) != 0;
+		if (!osxsave || !avx || ((_xgetbv(0) & 6) != 6)) {
+			return false;
+		}
+
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+#else
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2");
+#endif
+	}
+
+
+	/** @return	the next triangular dither values of the 8 lanes of the
+	 *			given state, updating it */
+	SAUDIO_TARGET_AVX2
+	static inline __m256 nextDitherAVX2(__m256i& state)
+	{
+		const __m256 scale = _mm256_set1_ps(kUniformScale);
+
+		__m256 values[2];
+		for (__m256& value : values) {
+			state = _mm256_xor_si256(state, _mm256_slli_epi32(state, 13));
+			state = _mm256_xor_si256(state, _mm256_srli_epi32(state, 17));
+			state = _mm256_xor_si256(state, _mm256_slli_epi32(state, 5));
+			value = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(state, 8)), scale);
+		}
+		return _mm256_sub_ps(values[0], values[1]);
+	}
+
+
+	SAUDIO_TARGET_AVX2
+	static void u8ToF32AVX2(float* dst, const unsigned char* src, std::size_t numSamples)
+	{
+		const __m256 offset = _mm256_set1_ps(128.0f), scale = _mm256_set1_ps(1.0f / kU8Scale);
+
+		std::size_t i = 0;
+		for (; i + 8 <= numSamples; i += 8) {
+			__m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i));
+			__m256 v = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(bytes));
+			_mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_sub_ps(v, offset), scale));
+		}
+
+		u8ToF32Scalar(dst + i, src + i, numSamples - i);
+	}
+
+
+	SAUDIO_TARGET_AVX2
+	static void s16ToF32AVX2(float* dst, const unsigned char* src, std::size_t numSamples)
+	{
+		const __m256 scale = _mm256_set1_ps(1.0f / kS16Scale);
+
+		std::size_t i = 0;
+		for (; i + 8 <= numSamples; i += 8) {
+			__m128i words = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * i));
+			__m256 v = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(words));
+			_mm256_storeu_ps(dst + i, _mm256_mul_ps(v, scale));
+		}
+
+		s16ToF32Scalar(dst + i, src + 2 * i, numSamples - i);
+	}
+
+
+	SAUDIO_TARGET_AVX2
+	static void s32ToF32AVX2(float* dst, const unsigned char* src, std::size_t numSamples)
+	{
+		const __m256 scale = _mm256_set1_ps(1.0f / kS32Scale);
+
+		std::size_t i = 0;
+		for (; i + 8 <= numSamples; i += 8) {
+			__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 4 * i));
+			_mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale));
+		}
+
+		s32ToF32Scalar(dst + i, src + 4 * i, numSamples - i);
+	}
+
+
+	SAUDIO_TARGET_AVX2
+	static void f32ToU8AVX2(unsigned char* dst, const float* src, std::size_t numSamples, DitherState* dither)
+	{
+		const __m256 scale = _mm256_set1_ps(kU8Scale), offset = _mm256_set1_ps(128.0f);
+		const __m256 lo = _mm256_setzero_ps(), hi = _mm256_set1_ps(255.0f);
+		__m256i state = dither? _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dither->lanes)) : _mm256_setzero_si256();
+
+		std::size_t i = 0;
+		for (; i + 16 <= numSamples; i += 16) {
+			__m256i values[2];
+			for (int j = 0; j < 2; ++j) {
+				__m256 v = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(src + i + 8 * j), scale), offset);
+				if (dither) {
+					v = _mm256_add_ps(v, nextDitherAVX2(state));
+				}
+				values[j] = _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(v, lo), hi));
+			}
+
+			// The packs work on each 128 bit half, so the 64 bit groups are
+			// reordered before packing them to bytes
+			__m256i words = _mm256_permute4x64_epi64(_mm256_packs_epi32(values[0], values[1]), 0xD8);
+			__m128i bytes = _mm_packus_epi16(_mm256_castsi256_si128(words), _mm256_extracti128_si256(words, 1));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), bytes);
+		}
+
+		if (dither) {
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dither->lanes), state);
+		}
+		f32ToU8Scalar(dst + i, src + i, numSamples - i, dither);
+	}
+
+
+	SAUDIO_TARGET_AVX2
+	static void f32ToS16AVX2(unsigned char* dst, const float* src, std::size_t numSamples, DitherState* dither)
+	{
+		const __m256 scale = _mm256_set1_ps(kS16Scale);
+		const __m256 lo = _mm256_set1_ps(-32768.0f), hi = _mm256_set1_ps(32767.0f);
+		__m256i state = dither? _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dither->lanes)) : _mm256_setzero_si256();
+
+		std::size_t i = 0;
+		for (; i + 16 <= numSamples; i += 16) {
+			__m256i values[2];
+			for (int j = 0; j < 2; ++j) {
+				__m256 v = _mm256_mul_ps(_mm256_loadu_ps(src + i + 8 * j), scale);
+				if (dither) {
+					v = _mm256_add_ps(v, nextDitherAVX2(state));
+				}
+				values[j] = _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(v, lo), hi));
+			}
+
+			__m256i words = _mm256_permute4x64_epi64(_mm256_packs_epi32(values[0], values[1]), 0xD8);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 2 * i), words);
+		}
+
+		if (dither) {
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dither->lanes), state);
+		}
+		f32ToS16Scalar(dst + 2 * i, src + i, numSamples - i, dither);
+	}
+
+
+	SAUDIO_TARGET_AVX2
+	static void f32ToS32AVX2(unsigned char* dst, const float* src, std::size_t numSamples)
+	{
+		const __m256 scale = _mm256_set1_ps(kS32Scale), maxSample = _mm256_set1_ps(kMaxS32);
+		const __m256 lo = _mm256_set1_ps(-1.0f), hi = _mm256_set1_ps(1.0f);
+
+		std::size_t i = 0;
+		for (; i + 8 <= numSamples; i += 8) {
+			__m256 v = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(src + i), lo), hi);
+			v = _mm256_min_ps(_mm256_mul_ps(v, scale), maxSample);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 4 * i), _mm256_cvtps_epi32(v));
+		}
+
+		f32ToS32Scalar(dst + 4 * i, src + i, numSamples - i);
+	}
+#endif
+#if defined(SAUDIO_FORMAT_NEON)
+	/** @return	the next triangular dither values of the first 4 lanes of
+	 *			the given state, updating it */
+	static inline float32x4_t nextDitherNEON(uint32x4_t& state)
+	{
+		float32x4_t values[2];
+		for (float32x4_t& value : values) {
+			state = veorq_u32(state, vshlq_n_u32(state, 13));
+			state = veorq_u32(state, vshrq_n_u32(state, 17));
+			state = veorq_u32(state, vshlq_n_u32(state, 5));
+			value = vmulq_n_f32(vcvtq_f32_u32(vshrq_n_u32(state, 8)), kUniformScale);
+		}
+		return vsubq_f32(values[0], values[1]);
+	}
+
+
+	static void u8ToF32NEON(float* dst, const unsigned char* src, std::size_t numSamples)
+	{
+		const float32x4_t offset = vdupq_n_f32(128.0f);
+
+		std::size_t i = 0;
+		for (; i + 8 <= numSamples; i += 8) {
+			uint16x8_t words = vmovl_u8(vld1_u8(src + i));
+			float32x4_t lo = vcvtq_f32_u32(vmovl_u16(vget_low_u16(words)));
+			float32x4_t hi = vcvtq_f32_u32(vmovl_u16(vget_high_u16(words)));
+			vst1q_f32(dst + i, vmulq_n_f32(vsubq_f32(lo, offset), 1.0f / kU8Scale));
+			vst1q_f32(dst + i + 4, vmulq_n_f32(vsubq_f32(hi, offset), 1.0f / kU8Scale));
+		}
+
+		u8ToF32Scalar(dst + i, src + i, numSamples - i);
+	}
+
+
+	static void s16ToF32NEON(float* dst, const unsigned char* src, std::size_t numSamples)
+	{
+		std::size_t i = 0;
+		for (; i + 8 <= numSamples; i += 8) {
+			int16x8_t words = vreinterpretq_s16_u8(vld1q_u8(src + 2 * i));
+			float32x4_t lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(words)));
+			float32x4_t hi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(words)));
+			vst1q_f32(dst + i, vmulq_n_f32(lo, 1.0f / kS16Scale));
+			vst1q_f32(dst + i + 4, vmulq_n_f32(hi, 1.0f / kS16Scale));
+		}
+
+		s16ToF32Scalar(dst + i, src + 2 * i, numSamples - i);
+	}
+
+
+	static void s32ToF32NEON(float* dst, const unsigned char* src, std::size_t numSamples)
+	{
+		std::size_t i = 0;
+		for (; i + 4 <= numSamples; i += 4) {
+			int32x4_t v = vreinterpretq_s32_u8(vld1q_u8(src + 4 * i));
+			vst1q_f32(dst + i, vmulq_n_f32(vcvtq_f32_s32(v), 1.0f / kS32Scale));
+		}
+
+		s32ToF32Scalar(dst + i, src + 4 * i, numSamples - i);
+	}
+
+
+	static void f32ToU8NEON(unsigned char* dst, const float* src, std::size_t numSamples, DitherState* dither)
+	{
+		const float32x4_t offset = vdupq_n_f32(128.0f), lo = vdupq_n_f32(0.0f), hi = vdupq_n_f32(255.0f);
+		uint32x4_t state = dither? vld1q_u32(dither->lanes) : vdupq_n_u32(0);
+
+		std::size_t i = 0;
+		for (; i + 8 <= numSamples; i += 8) {
+			int32x4_t values[2];
+			for (int j = 0; j < 2; ++j) {
+				float32x4_t v = vmlaq_n_f32(offset, vld1q_f32(src + i + 4 * j), kU8Scale);
+				if (dither) {
+					v = vaddq_f32(v, nextDitherNEON(state));
+				}
+				values[j] = vcvtnq_s32_f32(vminq_f32(vmaxq_f32(v, lo), hi));
+			}
+
+			int16x8_t words = vcombine_s16(vqmovn_s32(values[0]), vqmovn_s32(values[1]));
+			vst1_u8(dst + i, vqmovun_s16(words));
+		}
+
+		if (dither) {
+			vst1q_u32(dither->lanes, state);
+		}
+		f32ToU8Scalar(dst + i, src + i, numSamples - i, dither);
+	}
+
+
+	static void f32ToS16NEON(unsigned char* dst, const float* src, std::size_t numSamples, DitherState* dither)
+	{
+		const float32x4_t lo = vdupq_n_f32(-32768.0f), hi = vdupq_n_f32(32767.0f);
+		uint32x4_t state = dither? vld1q_u32(dither->lanes) : vdupq_n_u32(0);
+
+		std::size_t i = 0;
+		for (; i + 8 <= numSamples; i += 8) {
+			int32x4_t values[2];
+			for (int j = 0; j < 2; ++j) {
+				float32x4_t v = vmulq_n_f32(vld1q_f32(src + i + 4 * j), kS16Scale);
+				if (dither) {
+					v = vaddq_f32(v, nextDitherNEON(state));
+				}
+				values[j] = vcvtnq_s32_f32(vminq_f32(vmaxq_f32(v, lo), hi));
+			}
+
+			int16x8_t words = vcombine_s16(vqmovn_s32(values[0]), vqmovn_s32(values[1]));
+			vst1q_u8(dst + 2 * i, vreinterpretq_u8_s16(words));
+		}
+
+		if (dither) {
+			vst1q_u32(dither->lanes, state);
+		}
+		f32ToS16Scalar(dst + 2 * i, src + i, numSamples - i, dither);
+	}
+
+
+	static void f32ToS32NEON(unsigned char* dst, const float* src, std::size_t numSamples)
+	{
+		const float32x4_t lo = vdupq_n_f32(-1.0f), hi = vdupq_n_f32(1.0f);
+
+		std::size_t i = 0;
+		for (; i + 4 <= numSamples; i += 4) {
+			// The conversion saturates the samples above the s32 range
+			float32x4_t v = vminq_f32(vmaxq_f32(vld1q_f32(src + i), lo), hi);
+			int32x4_t values = vcvtnq_s32_f32(vmulq_n_f32(v, kS32Scale));
+			vst1q_u8(dst + 4 * i, vreinterpretq_u8_s32(values));
+		}
+
+		f32ToS32Scalar(dst + 4 * i, src + i, numSamples - i);
+	}
+#endif
+
+	/** @return	the conversion functions of the best instruction set
+	 *			supported by the CPU */
+	static ConversionKernels selectKernels()
+	{
+#if defined(SAUDIO_FORMAT_AVX2)
+		if (cpuSupportsAVX2()) {
+			return { &u8ToF32AVX2, &s16ToF32AVX2, &s32ToF32AVX2, &f32ToU8AVX2, &f32ToS16AVX2, &f32ToS32AVX2 };
+		}
+#endif
+#if defined(SAUDIO_FORMAT_SSE2)
+		return { &u8ToF32SSE2, &s16ToF32SSE2, &s32ToF32SSE2, &f32ToU8SSE2, &f32ToS16SSE2, &f32ToS32SSE2 };
+#elif defined(SAUDIO_FORMAT_NEON)
+		return { &u8ToF32NEON, &s16ToF32NEON, &s32ToF32NEON, &f32ToU8NEON, &f32ToS16NEON, &f32ToS32NEON };
+#else
+		return { &u8ToF32Scalar, &s16ToF32Scalar, &s32ToF32Scalar, &f32ToU8Scalar, &f32ToS16Scalar, &f32ToS32Scalar };
+#endif
+	}
+
+
+	/** @return	the conversion functions used by the kernels, they are
+	 *			selected on the first call */
+	static const ConversionKernels& getKernels()
+	{
+		static const ConversionKernels sKernels = selectKernels();
+		return sKernels;
+	}
+
+// Public functions
+	bool convertToF32(float* dst, const void* src, Format srcFormat, std::size_t numSamples)
+	{
+		const ConversionKernels& kernels = getKernels();
+		const unsigned char* bytes = static_cast<const unsigned char*>(src);
+
+		switch (srcFormat) {
+			case Format::u8:	kernels.u8ToF32(dst, bytes, numSamples);			return true;
+			case Format::s16:	kernels.s16ToF32(dst, bytes, numSamples);			return true;
+			case Format::s24:	s24ToF32Scalar(dst, bytes, numSamples);				return true;
+			case Format::s32:	kernels.s32ToF32(dst, bytes, numSamples);			return true;
+			case Format::f32:	std::memcpy(dst, src, numSamples * sizeof(float));	return true;
+			default:																return false;
+		}
+	}
+
+
+	bool convertFromF32(
+		void* dst, Format dstFormat, const float* src, std::size_t numSamples,
+		DitherState* dither
+	) {
+		const ConversionKernels& kernels = getKernels();
+		unsigned char* bytes = static_cast<unsigned char*>(dst);
+
+		switch (dstFormat) {
+			case Format::u8:	kernels.f32ToU8(bytes, src, numSamples, dither);	return true;
+			case Format::s16:	kernels.f32ToS16(bytes, src, numSamples, dither);	return true;
+			case Format::s24:	f32ToS24Scalar(bytes, src, numSamples);				return true;
+			case Format::s32:	kernels.f32ToS32(bytes, src, numSamples);			return true;
+			case Format::f32:	std::memcpy(dst, src, numSamples * sizeof(float));	return true;
+			default:																return false;
+		}
+	}
+
+}
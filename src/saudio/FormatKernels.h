@@ -0,0 +1,55 @@
+#ifndef SAUDIO_FORMAT_KERNELS_H
+#define SAUDIO_FORMAT_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include "saudio/Constants.h"
+
+namespace saudio {
+
+	/** The state of the noise generators used for dithering in
+	 * @see convertFromF32, one per SIMD lane */
+	struct DitherState
+	{
+		uint32_t lanes[8] = {
+			0x9E3779B9u, 0x7F4A7C15u, 0x85EBCA6Bu, 0xC2B2AE35u,
+			0x27D4EB2Fu, 0x165667B1u, 0xD3A2646Cu, 0xFD7046C5u
+		};
+	};
+
+
+	/** Converts the given samples to f32, scaling them to the [-1, 1]
+	 * range. The conversion is done with the SIMD instructions available
+	 * in the CPU, they are selected at runtime
+	 *
+	 * @param	dst a pointer to the array where the converted samples will
+	 *			be stored
+	 * @param	src a pointer to the samples to convert
+	 * @param	srcFormat the format of the samples to convert
+	 * @param	numSamples the number of samples to convert
+	 * @return	true on success, false if the format isn't supported */
+	bool convertToF32(float* dst, const void* src, Format srcFormat, std::size_t numSamples);
+
+
+	/** Converts the given f32 samples to another format, clipping them to
+	 * the [-1, 1] range. The u8 and s16 samples are dithered with
+	 * triangular noise of 1 LSB, so the quantization error isn't
+	 * correlated with the signal. The conversion is done with the SIMD
+	 * instructions available in the CPU, they are selected at runtime
+	 *
+	 * @param	dst a pointer to the array where the converted samples will
+	 *			be stored
+	 * @param	dstFormat the format of the converted samples
+	 * @param	src a pointer to the samples to convert
+	 * @param	numSamples the number of samples to convert
+	 * @param	dither a pointer to the state of the dither noise, nullptr
+	 *			for rounding the samples without dithering
+	 * @return	true on success, false if the format isn't supported */
+	bool convertFromF32(
+		void* dst, Format dstFormat, const float* src, std::size_t numSamples,
+		DitherState* dither
+	);
+
+}
+
+#endif		// SAUDIO_FORMAT_KERNELS_H
@@ -0,0 +1,116 @@
+#include "saudio/Hrtf.h"
+#include "saudio/IDataSource.h"
+#include "saudio/AudioEngine.h"
+#include "LogWrapper.h"
+#include "MAWrapper.h"
+
+namespace saudio {
+
+	Hrtf::Hrtf(std::size_t length, uint32_t sampleRate) :
+		mContext(nullptr), mLength(length), mSampleRate(sampleRate) {}
+
+
+	Hrtf::Hrtf(
+		AudioEngine& engine, const IDataSource& source,
+		const glm::vec3* directions, std::size_t numDirections
+	) : mContext(engine.getContext()), mLength(0), mSampleRate(0)
+	{
+		if (!source.good() || (numDirections == 0)) {
+			SAUDIO_ERROR_LOG(mContext) << "Invalid HRIR data source";
+			return;
+		}
+
+		std::vector<float> frames;
+		ma_uint32 numChannels = 0;
+		if (!readAllFrames(source.getMADataSource(), frames, numChannels)) {
+			SAUDIO_ERROR_LOG(mContext) << "Failed to read the HRIR data source";
+			return;
+		}
+		if (numChannels != 2) {
+			SAUDIO_ERROR_LOG(mContext) << "The HRIR data source must have 2 channels, it has " << numChannels;
+			return;
+		}
+
+		ma_uint32 sampleRate = 0;
+		if ((ma_data_source_get_data_format(source.getMADataSource(), nullptr, nullptr, &sampleRate, nullptr, 0) != MA_SUCCESS)
+			|| (sampleRate == 0)
+		) {
+			SAUDIO_ERROR_LOG(mContext) << "Failed to get the sample rate of the HRIR data source";
+			return;
+		}
+		mSampleRate = sampleRate;
+
+		mLength = frames.size() / (2 * numDirections);
+		if (mLength == 0) {
+			SAUDIO_ERROR_LOG(mContext) << "Not enough frames for " << numDirections << " HRIRs";
+			return;
+		}
+
+		// Deinterleave the ears of each impulse response
+		std::vector<float> left(mLength), right(mLength);
+		for (std::size_t i = 0; i < numDirections; ++i) {
+			const float* measurement = frames.data() + 2 * i * mLength;
+			for (std::size_t j = 0; j < mLength; ++j) {
+				left[j] = measurement[2 * j];
+				right[j] = measurement[2 * j + 1];
+			}
+
+			if (!addMeasurement(directions[i], left.data(), right.data())) {
+				SAUDIO_WARN_LOG(mContext) << "Skipped HRIR " << i << " with an invalid direction";
+			}
+		}
+
+		SAUDIO_INFO_LOG(mContext) << "Loaded " << mDirections.size() << " HRIRs of " << mLength << " samples";
+	}
+
+
+	bool Hrtf::good() const
+	{
+		return !mDirections.empty();
+	}
+
+
+	std::size_t Hrtf::getLength() const
+	{
+		return mLength;
+	}
+
+
+	uint32_t Hrtf::getSampleRate() const
+	{
+		return mSampleRate;
+	}
+
+
+	std::size_t Hrtf::getNumMeasurements() const
+	{
+		return mDirections.size();
+	}
+
+
+	const glm::vec3& Hrtf::getDirection(std::size_t measurement) const
+	{
+		return mDirections[measurement];
+	}
+
+
+	const float* Hrtf::getImpulseResponse(std::size_t measurement, bool right) const
+	{
+		return mImpulseResponses.data() + (2 * measurement + (right? 1 : 0)) * mLength;
+	}
+
+
+	bool Hrtf::addMeasurement(const glm::vec3& direction, const float* left, const float* right)
+	{
+		float length = glm::length(direction);
+		if (!(length > 0.0f)) {
+			return false;
+		}
+
+		mDirections.push_back(direction / length);
+		mImpulseResponses.insert(mImpulseResponses.end(), left, left + mLength);
+		mImpulseResponses.insert(mImpulseResponses.end(), right, right + mLength);
+		return true;
+	}
+
+}
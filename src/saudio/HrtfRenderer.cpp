@@ -0,0 +1,181 @@
+#include <algorithm>
+#include "saudio/Hrtf.h"
+#include "HrtfRenderer.h"
+#include "ConvolutionKernels.h"
+
+namespace saudio {
+
+	/** The cosine of the angle that the direction of a voice must change to
+	 * update its filters (1 degree) */
+	static constexpr float kDirectionThreshold = 0.99985f;
+
+	/** The number of measurements interpolated for each direction */
+	static constexpr std::size_t kNumInterpolated = 3;
+
+
+	HrtfRenderer::Voice::Voice(std::size_t blockSize, std::size_t numPartitions) :
+		convolver(blockSize, numPartitions), current(0), hasFilter(false), pending(false), direction{},
+		input(blockSize, 0.0f), output(2 * blockSize, 0.0f), position(0) {}
+
+
+	HrtfRenderer::HrtfRenderer(const Hrtf& hrtf, std::size_t blockSize, std::size_t maxVoices) :
+		mBlockSize(blockSize), mNumMeasurements(hrtf.getNumMeasurements()),
+		mLeft(blockSize), mRight(blockSize), mNextLeft(blockSize), mNextRight(blockSize)
+	{
+		std::size_t numPartitions = (hrtf.getLength() + blockSize - 1) / blockSize;
+
+		// Partition the HRIRs of all the measurements
+		PartitionedConvolver convolver(blockSize, numPartitions);
+		mDirections.resize(3 * mNumMeasurements);
+		mFilters.resize(2 * mNumMeasurements);
+		for (std::size_t i = 0; i < mNumMeasurements; ++i) {
+			const glm::vec3& direction = hrtf.getDirection(i);
+			mDirections[3 * i] = direction.x;
+			mDirections[3 * i + 1] = direction.y;
+			mDirections[3 * i + 2] = -direction.z;
+
+			convolver.computeFilter(hrtf.getImpulseResponse(i, false), hrtf.getLength(), mFilters[2 * i]);
+			convolver.computeFilter(hrtf.getImpulseResponse(i, true), hrtf.getLength(), mFilters[2 * i + 1]);
+		}
+
+		// The interpolated filters are preallocated so they can be updated
+		// from the audio thread
+		mVoices.reserve(maxVoices);
+		for (std::size_t i = 0; i < maxVoices; ++i) {
+			mVoices.emplace_back(std::make_unique<Voice>(blockSize, numPartitions));
+			for (auto& filters : mVoices.back()->filters) {
+				for (PartitionedFilter& filter : filters) {
+					filter = mFilters[0];
+				}
+			}
+		}
+	}
+
+
+	HrtfRenderer::~HrtfRenderer() {}
+
+
+	void HrtfRenderer::reset(std::size_t voice)
+	{
+		Voice& v = *mVoices[voice];
+		v.convolver.reset();
+		v.hasFilter = false;
+		v.pending = false;
+		v.position = 0;
+		std::fill(v.input.begin(), v.input.end(), 0.0f);
+		std::fill(v.output.begin(), v.output.end(), 0.0f);
+	}
+
+
+	void HrtfRenderer::setDirection(std::size_t voice, const float* direction)
+	{
+		Voice& v = *mVoices[voice];
+		float cosAngle = v.direction[0] * direction[0] + v.direction[1] * direction[1] + v.direction[2] * direction[2];
+		if ((v.hasFilter || v.pending) && (cosAngle > kDirectionThreshold)) {
+			return;
+		}
+
+		// Find the closest measurements
+		std::size_t closest[kNumInterpolated];
+		float closestCos[kNumInterpolated];
+		std::size_t numClosest = 0;
+		for (std::size_t i = 0; i < mNumMeasurements; ++i) {
+			const float* measurement = &mDirections[3 * i];
+			float cosMeasurement = measurement[0] * direction[0] + measurement[1] * direction[1] + measurement[2] * direction[2];
+
+			std::size_t j = numClosest;
+			while ((j > 0) && (closestCos[j - 1] < cosMeasurement)) {
+				if (j < kNumInterpolated) {
+					closest[j] = closest[j - 1];
+					closestCos[j] = closestCos[j - 1];
+				}
+				j--;
+			}
+			if (j < kNumInterpolated) {
+				closest[j] = i;
+				closestCos[j] = cosMeasurement;
+				numClosest = std::min(numClosest + 1, kNumInterpolated);
+			}
+		}
+
+		// Inverse distance weights, an exact match uses a single measurement
+		float weights[kNumInterpolated], weightSum = 0.0f;
+		for (std::size_t j = 0; j < numClosest; ++j) {
+			weights[j] = 1.0f / std::max(1.0f - closestCos[j], 1e-6f);
+			weightSum += weights[j];
+		}
+
+		// Interpolate the filters of each ear
+		std::size_t next = v.hasFilter? 1 - v.current : v.current;
+		for (std::size_t ear = 0; ear < 2; ++ear) {
+			PartitionedFilter& filter = v.filters[next][ear];
+			std::fill(filter.re.begin(), filter.re.end(), 0.0f);
+			std::fill(filter.im.begin(), filter.im.end(), 0.0f);
+			for (std::size_t j = 0; j < numClosest; ++j) {
+				const PartitionedFilter& measurement = mFilters[2 * closest[j] + ear];
+				multiplyAdd(filter.re.data(), measurement.re.data(), weights[j] / weightSum, filter.re.size());
+				multiplyAdd(filter.im.data(), measurement.im.data(), weights[j] / weightSum, filter.im.size());
+			}
+		}
+
+		std::copy(direction, direction + 3, v.direction);
+		if (v.hasFilter) {
+			v.pending = true;
+		}
+		else {
+			v.hasFilter = true;
+		}
+	}
+
+
+	void HrtfRenderer::process(std::size_t voice, const float* input, float* output, std::size_t numFrames)
+	{
+		Voice& v = *mVoices[voice];
+
+		while (numFrames > 0) {
+			std::size_t count = std::min(numFrames, mBlockSize - v.position);
+			std::copy(input, input + count, v.input.begin() + v.position);
+			std::copy(v.output.begin() + 2 * v.position, v.output.begin() + 2 * (v.position + count), output);
+
+			v.position += count;
+			if (v.position == mBlockSize) {
+				processBlock(v);
+				v.position = 0;
+			}
+
+			input += count;
+			output += 2 * count;
+			numFrames -= count;
+		}
+	}
+
+// Private functions
+	void HrtfRenderer::processBlock(Voice& voice)
+	{
+		voice.convolver.pushBlock(voice.input.data());
+		if (!voice.hasFilter) {
+			std::fill(voice.output.begin(), voice.output.end(), 0.0f);
+			return;
+		}
+
+		voice.convolver.convolve(voice.filters[voice.current][0], mLeft.data());
+		voice.convolver.convolve(voice.filters[voice.current][1], mRight.data());
+
+		// Crossfade to the next filters during the whole block
+		if (voice.pending) {
+			std::size_t next = 1 - voice.current;
+			voice.convolver.convolve(voice.filters[next][0], mNextLeft.data());
+			voice.convolver.convolve(voice.filters[next][1], mNextRight.data());
+			crossfade(mLeft.data(), mLeft.data(), mNextLeft.data(), mBlockSize);
+			crossfade(mRight.data(), mRight.data(), mNextRight.data(), mBlockSize);
+			voice.current = next;
+			voice.pending = false;
+		}
+
+		for (std::size_t i = 0; i < mBlockSize; ++i) {
+			voice.output[2 * i] = mLeft[i];
+			voice.output[2 * i + 1] = mRight[i];
+		}
+	}
+
+}
@@ -0,0 +1,124 @@
+#ifndef SAUDIO_HRTF_RENDERER_H
+#define SAUDIO_HRTF_RENDERER_H
+
+#include <memory>
+#include <vector>
+#include "PartitionedConvolver.h"
+
+namespace saudio {
+
+	class Hrtf;
+
+
+	/**
+	 * Class HrtfRenderer, it renders mono voices binaurally. The HRIRs of an
+	 * Hrtf are partitioned once, and each voice convolves its signal with
+	 * the interpolation of the HRIRs of the measurements closest to its
+	 * direction using uniformly partitioned convolution. When the direction
+	 * of a voice changes, the old and new filters are crossfaded during a
+	 * block.
+	 *
+	 * @note	the voices are processed in blocks, so their output is
+	 *			delayed by the block size. All the functions must be called
+	 *			from the audio thread
+	 */
+	class HrtfRenderer
+	{
+	private:	// Nested types
+		/** Holds the convolution state of a voice */
+		struct Voice
+		{
+			/** Convolves the voice blocks */
+			PartitionedConvolver convolver;
+
+			/** The filters of the left and right ears, the current ones and
+			 * the next ones */
+			PartitionedFilter filters[2][2];
+
+			/** The index of the current filters in @see filters */
+			std::size_t current;
+
+			/** If the current filters are valid and if the voice must
+			 * change to the next ones */
+			bool hasFilter, pending;
+
+			/** The direction of the last filters */
+			float direction[3];
+
+			/** The samples of the block being filled */
+			std::vector<float> input;
+
+			/** The interleaved stereo samples of the last rendered block */
+			std::vector<float> output;
+
+			/** The number of samples of @see input */
+			std::size_t position;
+
+			Voice(std::size_t blockSize, std::size_t numPartitions);
+		};
+
+	private:	// Attributes
+		/** The number of samples of each block */
+		std::size_t mBlockSize;
+
+		/** The number of measurements */
+		std::size_t mNumMeasurements;
+
+		/** The unit directions of the measurements in listener space (x
+		 * right, y up, z forward) */
+		std::vector<float> mDirections;
+
+		/** The partitioned filters of each measurement and ear */
+		std::vector<PartitionedFilter> mFilters;
+
+		/** The voices */
+		std::vector<std::unique_ptr<Voice>> mVoices;
+
+		/** The buffers used for rendering a block with the left and right
+		 * current and next filters */
+		std::vector<float> mLeft, mRight, mNextLeft, mNextRight;
+
+	public:		// Functions
+		/** Creates a new HrtfRenderer
+		 *
+		 * @param	hrtf the HRIRs used for rendering the voices
+		 * @param	blockSize the number of samples of each block, it must be
+		 *			a power of two
+		 * @param	maxVoices the maximum number of voices */
+		HrtfRenderer(const Hrtf& hrtf, std::size_t blockSize, std::size_t maxVoices);
+
+		/** Class destructor */
+		~HrtfRenderer();
+
+		/** Clears the state of the given voice, the filters of its next
+		 * direction will be used without crossfading
+		 *
+		 * @param	voice the index of the voice */
+		void reset(std::size_t voice);
+
+		/** Sets the direction of the given voice. If it has changed enough
+		 * the voice filters are interpolated from the closest measurements
+		 *
+		 * @param	voice the index of the voice
+		 * @param	direction the unit direction of the voice in listener
+		 *			space (x right, y up, z forward) */
+		void setDirection(std::size_t voice, const float* direction);
+
+		/** Renders the given voice
+		 *
+		 * @param	voice the index of the voice
+		 * @param	input a pointer to the mono samples of the voice
+		 * @param	output a pointer to the array where the interleaved
+		 *			stereo frames will be stored
+		 * @param	numFrames the number of frames to render */
+		void process(std::size_t voice, const float* input, float* output, std::size_t numFrames);
+	private:
+		/** Convolves the filled block of the given voice
+		 *
+		 * @param	voice the voice to convolve */
+		void processBlock(Voice& voice);
+	};
+
+}
+
+#endif		// SAUDIO_HRTF_RENDERER_H
@@ -0,0 +1,163 @@
+#include <algorithm>
+#include "saudio/LatencyController.h"
+#include "saudio/AudioEngine.h"
+#include "LogWrapper.h"
+
+namespace saudio {
+
+	LatencyController::LatencyController(
+		Context& context,
+		const Device::DeviceInfo& deviceInfo,
+		const Device::Config& deviceConfig,
+		const Config& config
+	) : mDeviceInfo(deviceInfo), mDeviceConfig(deviceConfig), mConfig(config),
+		mHeadroomUpdates(0), mStableUpdates(0), mShrinkBackoff(1), mLastChangeWasShrink(false)
+	{
+		mDevice = std::make_unique<Device>(context, mDeviceInfo, mDeviceConfig);
+	}
+
+
+	LatencyController::LatencyController(
+		const Device::DeviceInfo& deviceInfo,
+		const Device::Config& deviceConfig,
+		const Config& config
+	) : mDeviceInfo(deviceInfo), mDeviceConfig(deviceConfig), mConfig(config),
+		mHeadroomUpdates(0), mStableUpdates(0), mShrinkBackoff(1), mLastChangeWasShrink(false)
+	{
+		mDevice = std::make_unique<Device>(mDeviceInfo, mDeviceConfig);
+	}
+
+
+	bool LatencyController::good() const
+	{
+		return mDevice->good();
+	}
+
+
+	Device& LatencyController::getDevice() const
+	{
+		return *mDevice;
+	}
+
+
+	bool LatencyController::attach(AudioEngine& engine)
+	{
+		if (engine.getDevice() != mDevice.get()) {
+			if (!engine.setDevice(*mDevice)) {
+				return false;
+			}
+		}
+
+		if (std::find(mEngines.begin(), mEngines.end(), &engine) == mEngines.end()) {
+			mEngines.push_back(&engine);
+		}
+
+		return true;
+	}
+
+
+	void LatencyController::detach(AudioEngine& engine)
+	{
+		mEngines.erase(std::remove(mEngines.begin(), mEngines.end(), &engine), mEngines.end());
+	}
+
+
+	bool LatencyController::update()
+	{
+		if (!good()) {
+			return false;
+		}
+
+		CallbackStats stats = mDevice->getCallbackStats();
+		mDevice->resetCallbackStats();
+		if (stats.numCallbacks == 0) {
+			return false;
+		}
+
+		uint32_t periodSize = mDevice->getNegotiatedConfig().periodSizeInFrames;
+		if (stats.numDeadlineMisses > 0) {
+			mStableUpdates = 0;
+		}
+		else if (++mStableUpdates >= mConfig.updatesToShrink) {
+			// The current period held for a while, so the last shrink
+			// wasn't too aggressive and the backoff can decay
+			mStableUpdates = 0;
+			mLastChangeWasShrink = false;
+			mShrinkBackoff = std::max(mShrinkBackoff / 2, 1u);
+		}
+
+		if (stats.numDeadlineMisses >= mConfig.missesToGrow) {
+			mHeadroomUpdates = 0;
+			if (mLastChangeWasShrink) {
+				// The last shrink was too aggressive, wait longer next time
+				mShrinkBackoff = std::min(2 * mShrinkBackoff, kMaxShrinkBackoff);
+			}
+
+			uint32_t newPeriodSize = std::min(2 * periodSize, mConfig.maxPeriodSizeInFrames);
+			if (newPeriodSize > periodSize) {
+				SAUDIO_INFO_LOG(mDevice->getContext()) << stats.numDeadlineMisses << " deadline misses, growing the period from "
+					<< periodSize << " to " << newPeriodSize << " frames";
+				if (rebuildDevice(newPeriodSize)) {
+					mLastChangeWasShrink = false;
+					return true;
+				}
+			}
+		}
+		else if (stats.worstLoad < mConfig.headroomLoad) {
+			++mHeadroomUpdates;
+			if (mHeadroomUpdates >= mShrinkBackoff * mConfig.updatesToShrink) {
+				mHeadroomUpdates = 0;
+
+				uint32_t newPeriodSize = std::max(periodSize / 2, mConfig.minPeriodSizeInFrames);
+				if (newPeriodSize < periodSize) {
+					SAUDIO_INFO_LOG(mDevice->getContext()) << "Worst load " << stats.worstLoad << ", shrinking the period from "
+						<< periodSize << " to " << newPeriodSize << " frames";
+					if (rebuildDevice(newPeriodSize)) {
+						mLastChangeWasShrink = true;
+						mStableUpdates = 0;
+						return true;
+					}
+				}
+			}
+		}
+		else {
+			mHeadroomUpdates = 0;
+		}
+
+		return false;
+	}
+
+// Private functions
+	bool LatencyController::rebuildDevice(uint32_t periodSizeInFrames)
+	{
+		Device::Config deviceConfig = mDeviceConfig;
+		deviceConfig.periodSizeInFrames = periodSizeInFrames;
+		deviceConfig.periodSizeInMilliseconds = 0;
+
+		auto device = std::make_unique<Device>(*mDevice->getContext(), mDeviceInfo, deviceConfig);
+		if (!device->good()) {
+			SAUDIO_ERROR_LOG(mDevice->getContext()) << "Failed to rebuild the Device, keeping the old one";
+			return false;
+		}
+
+		for (std::size_t i = 0; i < mEngines.size(); ++i) {
+			if (!mEngines[i]->setDevice(*device)) {
+				SAUDIO_ERROR_LOG(mDevice->getContext()) << "Failed to move the AudioEngine " << mEngines[i] << " to the new Device, keeping the old one";
+
+				// The new Device can't be destroyed while the moved
+				// AudioEngines use it
+				for (std::size_t j = 0; j < i; ++j) {
+					if (!mEngines[j]->setDevice(*mDevice)) {
+						SAUDIO_ERROR_LOG(mDevice->getContext()) << "Failed to move back the AudioEngine " << mEngines[j];
+					}
+				}
+				return false;
+			}
+		}
+
+		mDeviceConfig = deviceConfig;
+		mDevice = std::move(device);
+		return true;
+	}
+
+}
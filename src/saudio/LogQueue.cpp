@@ -0,0 +1,34 @@
+#include <cstring>
+#include "LogQueue.h"
+
+namespace saudio {
+
+	LogQueue::LogQueue(std::size_t capacity) : mQueue(capacity) {}
+
+
+	bool LogQueue::push(LogLevel level, const char* message)
+	{
+		return mQueue.pushWith([&](Entry& entry) {
+			entry.level = level;
+			std::size_t length = strnlen(message, kMessageSize - 1);
+			std::memcpy(entry.message, message, length);
+			entry.message[length] = '\0';
+		});
+	}
+
+
+	bool LogQueue::pop(LogLevel& level, char* message)
+	{
+		return mQueue.popWith([&](const Entry& entry) {
+			level = entry.level;
+			std::memcpy(message, entry.message, kMessageSize);
+		});
+	}
+
+
+	uint64_t LogQueue::takeNumDropped()
+	{
+		return mQueue.takeNumDropped();
+	}
+
+}
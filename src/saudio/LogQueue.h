@@ -0,0 +1,72 @@
+#ifndef SAUDIO_LOG_QUEUE_H
+#define SAUDIO_LOG_QUEUE_H
+
+#include "saudio/Context.h"
+#include "MPSCQueue.h"
+
+namespace saudio {
+
+	/**
+	 * Class LogQueue, it's a bounded lock-free queue of log messages. Any
+	 * number of threads, including the audio ones, can push messages to it
+	 * without locking or allocating memory, while a single thread pops them
+	 * and passes them to the LogHandler. The messages that don't fit in the
+	 * queue are dropped.
+	 */
+	class LogQueue
+	{
+	public:		// Nested types
+		/** The maximum number of characters of each message, including the
+		 * null terminator */
+		static constexpr std::size_t kMessageSize = 512;
+
+	private:	// Nested types
+		/** Holds a message of the queue */
+		struct Entry
+		{
+			/** The level of the message */
+			LogLevel level;
+
+			/** The text of the message */
+			char message[kMessageSize];
+		};
+
+	private:	// Attributes
+		/** The queue that holds the messages */
+		MPSCQueue<Entry> mQueue;
+
+	public:		// Functions
+		/** Creates a new LogQueue
+		 *
+		 * @param	capacity the maximum number of messages in the queue, it
+		 *			will be rounded up to a power of two */
+		LogQueue(std::size_t capacity);
+
+		/** Pushes a message to the queue. It can be called from any
+		 * thread
+		 *
+		 * @param	level the level of the message
+		 * @param	message the text of the message, it will be truncated
+		 *			to @see kMessageSize characters
+		 * @return	true if the message was pushed, false if it was dropped */
+		bool push(LogLevel level, const char* message);
+
+		/** Pops the oldest message of the queue. It must be called always
+		 * from the same thread
+		 *
+		 * @param	level a reference to the level where the level of the
+		 *			message will be stored
+		 * @param	message a pointer to the buffer of @see kMessageSize
+		 *			characters where the text of the message will be
+		 *			stored
+		 * @return	true if a message was popped, false if the queue was
+		 *			empty */
+		bool pop(LogLevel& level, char* message);
+
+		/** @return	the number of messages dropped since the last call */
+		uint64_t takeNumDropped();
+	};
+
+}
+
+#endif		// SAUDIO_LOG_QUEUE_H
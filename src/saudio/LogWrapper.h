@@ -5,11 +5,13 @@
 #include <stdext/StringUtils.h>
 #include "saudio/Context.h"
 
-namespace saudio {
-
-	/** The different log levels */
-	enum class LogLevel : int { Error = 0, Warning, Info, Debug };
+/** The maximum level of the logs compiled into the library, the log macros
+ * of the higher levels are removed */
+#ifndef SAUDIO_MIN_LOG_LEVEL
+	#define SAUDIO_MIN_LOG_LEVEL 3
+#endif
 
+namespace saudio {
 
 	/**
 	 * Class LogStream, it's used to write logs with the LogHandler in a stream
@@ -22,40 +24,74 @@ namespace saudio {
 		/** The buffer where the traces will be stored */
 		stdext::ArrayStreambuf<CharT, Size> mASBuf;
 
+		/** The Context used for printing the traces */
+		const Context* mContext;
+
 	public:		// Functions
-		/** Creates a new LogStream */
-		LogStream() : std::basic_ostream<CharT>(&mASBuf) {};
+		/** Creates a new LogStream
+		 *
+		 * @param	context a pointer to the Context whose LogHandler will
+		 *			print the traces. It can be nullptr, ie. with AudioEngines
+		 *			without any Context, in that case nothing is printed */
+		LogStream(const Context* context) :
+			std::basic_ostream<CharT>(&mASBuf), mContext(context) {};
 
 		/** Class destructor */
 		~LogStream()
 		{
-			if constexpr (Level == LogLevel::Error) {
-				Context::getLogHandler()->error(mASBuf.data());
-			}
-			else if constexpr (Level == LogLevel::Warning) {
-				Context::getLogHandler()->warning(mASBuf.data());
-			}
-			else if constexpr (Level == LogLevel::Info) {
-				Context::getLogHandler()->info(mASBuf.data());
-			}
-			else {
-				Context::getLogHandler()->debug(mASBuf.data());
+			if (mContext) {
+				mContext->log(Level, mASBuf.data());
 			}
 		};
 	};
 
+
+	/** Checks if the logs of the given level must be formatted
+	 *
+	 * @param	context a pointer to the Context used for printing the logs
+	 * @param	level the level of the logs
+	 * @return	true if the logs must be formatted, false otherwise */
+	inline bool isLogEnabled(const Context* context, LogLevel level)
+	{
+		return context && context->isLogEnabled(level);
+	}
+
 }
 
 #define FORMAT_LOCATION(function, line) function << "(" << line << "): "
 #define LOCATION FORMAT_LOCATION(__func__, __LINE__)
 
-#define SAUDIO_ERROR_LOG	\
-	LogStream<char, 512, LogLevel::Error>() << LOCATION
-#define SAUDIO_WARN_LOG	\
-	LogStream<char, 512, LogLevel::Warning>() << LOCATION
-#define SAUDIO_INFO_LOG	\
-	LogStream<char, 512, LogLevel::Info>() << LOCATION
-#define SAUDIO_DEBUG_LOG	\
-	LogStream<char, 512, LogLevel::Debug>() << LOCATION
+// The streamed values are only evaluated if the level is enabled. The else
+// branch keeps the macros safe inside unbraced if-else statements
+#define SAUDIO_LOG(context, level)	\
+	if (!saudio::isLogEnabled(context, level)) {} else saudio::LogStream<char, 512, level>(context) << LOCATION
+
+// The disabled levels are never executed, so the compiler removes them
+#define SAUDIO_NO_LOG(context, level)	\
+	while (false) saudio::LogStream<char, 512, level>(context)
+
+#if SAUDIO_MIN_LOG_LEVEL >= 0
+	#define SAUDIO_ERROR_LOG(context) SAUDIO_LOG(context, LogLevel::Error)
+#else
+	#define SAUDIO_ERROR_LOG(context) SAUDIO_NO_LOG(context, LogLevel::Error)
+#endif
+
+#if SAUDIO_MIN_LOG_LEVEL >= 1
+	#define SAUDIO_WARN_LOG(context) SAUDIO_LOG(context, LogLevel::Warning)
+#else
+	#define SAUDIO_WARN_LOG(context) SAUDIO_NO_LOG(context, LogLevel::Warning)
+#endif
+
+#if SAUDIO_MIN_LOG_LEVEL >= 2
+	#define SAUDIO_INFO_LOG(context) SAUDIO_LOG(context, LogLevel::Info)
+#else
+	#define SAUDIO_INFO_LOG(context) SAUDIO_NO_LOG(context, LogLevel::Info)
+#endif
+
+#if SAUDIO_MIN_LOG_LEVEL >= 3
+	#define SAUDIO_DEBUG_LOG(context) SAUDIO_LOG(context, LogLevel::Debug)
+#else
+	#define SAUDIO_DEBUG_LOG(context) SAUDIO_NO_LOG(context, LogLevel::Debug)
+#endif
 
 #endif		// SAUDIO_LOG_WRAPPER_H
@@ -1,8 +1,10 @@
 #ifndef SAUDIO_MAWRAPPER_H
 #define SAUDIO_MAWRAPPER_H
 
+#include <vector>
 #include <miniaudio.h>
 #include "saudio/Constants.h"
+#include "saudio/Context.h"
 
 namespace saudio {
 
@@ -19,6 +21,19 @@ namespace saudio {
 	}
 
 
+	constexpr Format fromMAFormat(ma_format format)
+	{
+		switch (format) {
+			case ma_format_u8:					return Format::u8;
+			case ma_format_s16:					return Format::s16;
+			case ma_format_s24:					return Format::s24;
+			case ma_format_s32:					return Format::s32;
+			case ma_format_f32:					return Format::f32;
+			default:							return Format::Unknown;
+		}
+	}
+
+
 	constexpr uint32_t bytesPerMAFormat(Format format)
 	{
 		switch (format) {
@@ -60,6 +75,86 @@ namespace saudio {
 		}
 	}
 
+
+	constexpr ma_backend toMABackend(Context::Backend backend)
+	{
+		switch (backend) {
+			case Context::Backend::WASAPI:		return ma_backend_wasapi;
+			case Context::Backend::DirectSound:	return ma_backend_dsound;
+			case Context::Backend::WinMM:		return ma_backend_winmm;
+			case Context::Backend::CoreAudio:	return ma_backend_coreaudio;
+			case Context::Backend::sndio:		return ma_backend_sndio;
+			case Context::Backend::audio4:		return ma_backend_audio4;
+			case Context::Backend::OSS:			return ma_backend_oss;
+			case Context::Backend::PulseAudio:	return ma_backend_pulseaudio;
+			case Context::Backend::ALSA:		return ma_backend_alsa;
+			case Context::Backend::JACK:		return ma_backend_jack;
+			case Context::Backend::AAudio:		return ma_backend_aaudio;
+			case Context::Backend::OpenSL:		return ma_backend_opensl;
+			case Context::Backend::WebAudio:	return ma_backend_webaudio;
+			default:							return ma_backend_null;
+		}
+	}
+
+
+	constexpr Channel fromMAChannel(ma_channel channel)
+	{
+		switch (channel) {
+			case MA_CHANNEL_MONO:				return Channel::Mono;
+			case MA_CHANNEL_FRONT_LEFT:			return Channel::FrontLeft;
+			case MA_CHANNEL_FRONT_RIGHT:		return Channel::FrontRight;
+			case MA_CHANNEL_FRONT_CENTER:		return Channel::FrontCenter;
+			case MA_CHANNEL_LFE:				return Channel::LFE;
+			case MA_CHANNEL_BACK_LEFT:			return Channel::BackLeft;
+			case MA_CHANNEL_BACK_RIGHT:			return Channel::BackRight;
+			case MA_CHANNEL_FRONT_LEFT_CENTER:	return Channel::FrontLeftCenter;
+			case MA_CHANNEL_FRONT_RIGHT_CENTER:	return Channel::FrontRightCenter;
+			case MA_CHANNEL_BACK_CENTER:		return Channel::BackCenter;
+			case MA_CHANNEL_SIDE_LEFT:			return Channel::SideLeft;
+			case MA_CHANNEL_SIDE_RIGHT:			return Channel::SideRight;
+			case MA_CHANNEL_TOP_CENTER:			return Channel::TopCenter;
+			case MA_CHANNEL_TOP_FRONT_LEFT:		return Channel::TopFrontLeft;
+			case MA_CHANNEL_TOP_FRONT_CENTER:	return Channel::TopFrontCenter;
+			case MA_CHANNEL_TOP_FRONT_RIGHT:	return Channel::TopFrontRight;
+			case MA_CHANNEL_TOP_BACK_LEFT:		return Channel::TopBackLeft;
+			case MA_CHANNEL_TOP_BACK_CENTER:	return Channel::TopBackCenter;
+			case MA_CHANNEL_TOP_BACK_RIGHT:		return Channel::TopBackRight;
+			default:							return Channel::None;
+		}
+	}
+
+
+	/** Reads all the frames of the given data source converted to f32,
+	 * starting from its first frame
+	 *
+	 * @param	dataSource a pointer to the miniaudio data source
+	 * @param	frames the vector where the interleaved samples will be
+	 *			stored
+	 * @param	numChannels the number of channels of the frames
+	 * @return	true if the frames were read successfully, false otherwise
+	 * @note	it moves the cursor of the data source, so it must not be
+	 *			used by a Sound at the same time */
+	inline bool readAllFrames(ma_data_source* dataSource, std::vector<float>& frames, ma_uint32& numChannels)
+	{
+		ma_format format;
+		ma_uint64 length = 0;
+		if ((ma_data_source_get_data_format(dataSource, &format, &numChannels, nullptr, nullptr, 0) != MA_SUCCESS)
+			|| (ma_data_source_get_length_in_pcm_frames(dataSource, &length) != MA_SUCCESS)
+			|| (length == 0)
+			|| (ma_data_source_seek_to_pcm_frame(dataSource, 0) != MA_SUCCESS)
+		) {
+			return false;
+		}
+
+		std::vector<unsigned char> buffer(length * numChannels * ma_get_bytes_per_sample(format));
+		ma_uint64 framesRead = 0;
+		ma_data_source_read_pcm_frames(dataSource, buffer.data(), length, &framesRead);
+
+		frames.resize(framesRead * numChannels);
+		ma_pcm_convert(frames.data(), ma_format_f32, buffer.data(), format, framesRead * numChannels, ma_dither_mode_none);
+		return framesRead > 0;
+	}
+
 }
 
 #endif		// SAUDIO_MAWRAPPER_H
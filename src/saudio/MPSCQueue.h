@@ -0,0 +1,155 @@
+#ifndef SAUDIO_MPSC_QUEUE_H
+#define SAUDIO_MPSC_QUEUE_H
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+namespace saudio {
+
+	/**
+	 * Class MPSCQueue, it's a bounded lock-free queue of Ts. Any number of
+	 * threads, including the audio ones, can push elements to it without
+	 * locking or allocating memory, while a single thread pops them. The
+	 * elements that don't fit in the queue are dropped.
+	 *
+	 * @note	each slot has a sequence number that tells in which turn it
+	 *			can be written or read, so the producers only contend on the
+	 *			push position
+	 */
+	template <typename T>
+	class MPSCQueue
+	{
+	private:	// Nested types
+		/** Holds an element of the queue */
+		struct Slot
+		{
+			/** Used for synchronizing the producers and the consumer, it
+			 * tells in which turn the slot can be written or read */
+			std::atomic<std::size_t> sequence;
+
+			/** The element stored in the slot */
+			T value;
+		};
+
+	private:	// Attributes
+		/** The slots of the queue */
+		std::unique_ptr<Slot[]> mSlots;
+
+		/** The number of slots minus one, the number of slots is a power of
+		 * two */
+		std::size_t mMask;
+
+		/** The position where the next element will be pushed */
+		alignas(64) std::atomic<std::size_t> mPushPosition;
+
+		/** The position of the next element to pop */
+		alignas(64) std::atomic<std::size_t> mPopPosition;
+
+		/** The number of elements dropped because the queue was full */
+		std::atomic<uint64_t> mNumDropped;
+
+	public:		// Functions
+		/** Creates a new MPSCQueue
+		 *
+		 * @param	capacity the maximum number of elements in the queue, it
+		 *			will be rounded up to a power of two */
+		MPSCQueue(std::size_t capacity) :
+			mMask(0), mPushPosition(0), mPopPosition(0), mNumDropped(0)
+		{
+			std::size_t numSlots = 2;
+			while (numSlots < capacity) {
+				numSlots *= 2;
+			}
+
+			mSlots = std::make_unique<Slot[]>(numSlots);
+			mMask = numSlots - 1;
+			for (std::size_t i = 0; i < numSlots; ++i) {
+				mSlots[i].sequence.store(i, std::memory_order_relaxed);
+			}
+		}
+
+		/** Pushes an element to the queue. It can be called from any thread
+		 *
+		 * @param	value the element to push
+		 * @return	true if the element was pushed, false if it was dropped */
+		bool push(const T& value)
+		{ return pushWith([&](T& slotValue) { slotValue = value; }); }
+
+		/** Pushes an element to the queue by writing it in place. It can be
+		 * called from any thread
+		 *
+		 * @param	write the function used for writing the element, it
+		 *			receives a reference to the T stored in the claimed slot
+		 * @return	true if the element was pushed, false if it was dropped */
+		template <typename F>
+		bool pushWith(F&& write)
+		{
+			Slot* slot = nullptr;
+			std::size_t position = mPushPosition.load(std::memory_order_relaxed);
+			while (true) {
+				slot = &mSlots[position & mMask];
+				std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+				auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+				if (diff == 0) {
+					// The slot is free, try to claim it
+					if (mPushPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+						break;
+					}
+				}
+				else if (diff < 0) {
+					// The queue is full
+					mNumDropped.fetch_add(1, std::memory_order_relaxed);
+					return false;
+				}
+				else {
+					position = mPushPosition.load(std::memory_order_relaxed);
+				}
+			}
+
+			write(slot->value);
+			slot->sequence.store(position + 1, std::memory_order_release);
+			return true;
+		}
+
+		/** Pops the oldest element of the queue. It must be called always
+		 * from the same thread
+		 *
+		 * @param	value a reference to the T where the popped element will
+		 *			be stored
+		 * @return	true if an element was popped, false if the queue was
+		 *			empty */
+		bool pop(T& value)
+		{ return popWith([&](const T& slotValue) { value = slotValue; }); }
+
+		/** Pops the oldest element of the queue by reading it in place. It
+		 * must be called always from the same thread
+		 *
+		 * @param	read the function used for reading the element, it
+		 *			receives a reference to the T stored in the slot
+		 * @return	true if an element was popped, false if the queue was
+		 *			empty */
+		template <typename F>
+		bool popWith(F&& read)
+		{
+			std::size_t position = mPopPosition.load(std::memory_order_relaxed);
+			Slot& slot = mSlots[position & mMask];
+			if (slot.sequence.load(std::memory_order_acquire) != position + 1) {
+				return false;
+			}
+
+			read(static_cast<const T&>(slot.value));
+			slot.sequence.store(position + mMask + 1, std::memory_order_release);
+			mPopPosition.store(position + 1, std::memory_order_relaxed);
+			return true;
+		}
+
+		/** @return	the number of elements dropped since the last call */
+		uint64_t takeNumDropped()
+		{ return mNumDropped.exchange(0, std::memory_order_relaxed); }
+	};
+
+}
+
+#endif		// SAUDIO_MPSC_QUEUE_H
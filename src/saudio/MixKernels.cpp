@@ -0,0 +1,192 @@
+#include "MixKernels.h"
+
+#if defined(__AVX__)
+	#include <immintrin.h>
+	#define SAUDIO_MIX_AVX
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+	#include <xmmintrin.h>
+	#define SAUDIO_MIX_SSE
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#include <arm_neon.h>
+	#define SAUDIO_MIX_NEON
+#endif
+
+namespace saudio {
+
+	void mixAdd(float* dst, const float* src, std::size_t numSamples)
+	{
+		std::size_t i = 0;
+
+#if defined(SAUDIO_MIX_AVX)
+		for (; i + 8 <= numSamples; i += 8) {
+			__m256 a = _mm256_loadu_ps(dst + i);
+			__m256 b = _mm256_loadu_ps(src + i);
+			_mm256_storeu_ps(dst + i, _mm256_add_ps(a, b));
+		}
+#elif defined(SAUDIO_MIX_SSE)
+		for (; i + 4 <= numSamples; i += 4) {
+			__m128 a = _mm_loadu_ps(dst + i);
+			__m128 b = _mm_loadu_ps(src + i);
+			_mm_storeu_ps(dst + i, _mm_add_ps(a, b));
+		}
+#elif defined(SAUDIO_MIX_NEON)
+		for (; i + 4 <= numSamples; i += 4) {
+			float32x4_t a = vld1q_f32(dst + i);
+			float32x4_t b = vld1q_f32(src + i);
+			vst1q_f32(dst + i, vaddq_f32(a, b));
+		}
+#endif
+
+		for (; i < numSamples; ++i) {
+			dst[i] += src[i];
+		}
+	}
+
+
+	void applyGainRamp(
+		float* dst, const float* src,
+		std::size_t numFrames, std::size_t numChannels,
+		const float* startGains, const float* endGains
+	) {
+		if (numFrames == 0) {
+			return;
+		}
+
+		float invNumFrames = 1.0f / numFrames;
+		std::size_t f = 0;
+
+		if (numChannels == 2) {
+			// Stereo, the gains of consecutive frames are interleaved in the
+			// same registers as the samples
+			float steps[2] = {
+				(endGains[0] - startGains[0]) * invNumFrames,
+				(endGains[1] - startGains[1]) * invNumFrames
+			};
+
+#if defined(SAUDIO_MIX_AVX)
+			__m256 gain = _mm256_setr_ps(
+				startGains[0], startGains[1],
+				startGains[0] + steps[0], startGains[1] + steps[1],
+				startGains[0] + 2 * steps[0], startGains[1] + 2 * steps[1],
+				startGains[0] + 3 * steps[0], startGains[1] + 3 * steps[1]
+			);
+			__m256 increment = _mm256_setr_ps(
+				4 * steps[0], 4 * steps[1], 4 * steps[0], 4 * steps[1],
+				4 * steps[0], 4 * steps[1], 4 * steps[0], 4 * steps[1]
+			);
+			for (; f + 4 <= numFrames; f += 4) {
+				_mm256_storeu_ps(dst + 2 * f, _mm256_mul_ps(_mm256_loadu_ps(src + 2 * f), gain));
+				gain = _mm256_add_ps(gain, increment);
+			}
+#elif defined(SAUDIO_MIX_SSE)
+			__m128 gain = _mm_setr_ps(startGains[0], startGains[1], startGains[0] + steps[0], startGains[1] + steps[1]);
+			__m128 increment = _mm_setr_ps(2 * steps[0], 2 * steps[1], 2 * steps[0], 2 * steps[1]);
+			for (; f + 2 <= numFrames; f += 2) {
+				_mm_storeu_ps(dst + 2 * f, _mm_mul_ps(_mm_loadu_ps(src + 2 * f), gain));
+				gain = _mm_add_ps(gain, increment);
+			}
+#elif defined(SAUDIO_MIX_NEON)
+			float initialGains[4] = { startGains[0], startGains[1], startGains[0] + steps[0], startGains[1] + steps[1] };
+			float increments[4] = { 2 * steps[0], 2 * steps[1], 2 * steps[0], 2 * steps[1] };
+			float32x4_t gain = vld1q_f32(initialGains);
+			float32x4_t increment = vld1q_f32(increments);
+			for (; f + 2 <= numFrames; f += 2) {
+				vst1q_f32(dst + 2 * f, vmulq_f32(vld1q_f32(src + 2 * f), gain));
+				gain = vaddq_f32(gain, increment);
+			}
+#endif
+		}
+
+		for (; f < numFrames; ++f) {
+			float t = f * invNumFrames;
+			for (std::size_t c = 0; c < numChannels; ++c) {
+				float gain = startGains[c] + (endGains[c] - startGains[c]) * t;
+				dst[f * numChannels + c] = src[f * numChannels + c] * gain;
+			}
+		}
+	}
+
+
+	void encodeGainRamp(
+		float* dst, const float* src, std::size_t numFrames,
+		std::size_t numInChannels, std::size_t numOutChannels,
+		const float* startGains, const float* endGains
+	) {
+		if (numFrames == 0) {
+			return;
+		}
+
+		float invNumFrames = 1.0f / numFrames;
+		float invNumInChannels = 1.0f / numInChannels;
+
+		for (std::size_t f = 0; f < numFrames; ++f) {
+			const float* frameIn = src + f * numInChannels;
+			float* frameOut = dst + f * numOutChannels;
+
+			float mono = 0.0f;
+			for (std::size_t c = 0; c < numInChannels; ++c) {
+				mono += frameIn[c];
+			}
+			mono *= invNumInChannels;
+
+			// The output channels are processed in groups, the gains of each
+			// group are interpolated in the same registers
+			float t = f * invNumFrames;
+			std::size_t c = 0;
+
+#if defined(SAUDIO_MIX_AVX)
+			__m256 t8 = _mm256_set1_ps(t), mono8 = _mm256_set1_ps(mono);
+			for (; c + 8 <= numOutChannels; c += 8) {
+				__m256 start = _mm256_loadu_ps(startGains + c);
+				__m256 end = _mm256_loadu_ps(endGains + c);
+				__m256 gain = _mm256_add_ps(start, _mm256_mul_ps(_mm256_sub_ps(end, start), t8));
+				_mm256_storeu_ps(frameOut + c, _mm256_mul_ps(gain, mono8));
+			}
+#endif
+#if defined(SAUDIO_MIX_AVX) || defined(SAUDIO_MIX_SSE)
+			__m128 t4 = _mm_set1_ps(t), mono4 = _mm_set1_ps(mono);
+			for (; c + 4 <= numOutChannels; c += 4) {
+				__m128 start = _mm_loadu_ps(startGains + c);
+				__m128 end = _mm_loadu_ps(endGains + c);
+				__m128 gain = _mm_add_ps(start, _mm_mul_ps(_mm_sub_ps(end, start), t4));
+				_mm_storeu_ps(frameOut + c, _mm_mul_ps(gain, mono4));
+			}
+#elif defined(SAUDIO_MIX_NEON)
+			float32x4_t t4 = vdupq_n_f32(t), mono4 = vdupq_n_f32(mono);
+			for (; c + 4 <= numOutChannels; c += 4) {
+				float32x4_t start = vld1q_f32(startGains + c);
+				float32x4_t end = vld1q_f32(endGains + c);
+				float32x4_t gain = vaddq_f32(start, vmulq_f32(vsubq_f32(end, start), t4));
+				vst1q_f32(frameOut + c, vmulq_f32(gain, mono4));
+			}
+#endif
+
+			for (; c < numOutChannels; ++c) {
+				float gain = startGains[c] + (endGains[c] - startGains[c]) * t;
+				frameOut[c] = mono * gain;
+			}
+		}
+	}
+
+
+	void mixMatrix(
+		float* dst, const float* src, std::size_t numFrames,
+		std::size_t numInChannels, std::size_t numOutChannels,
+		const float* matrix
+	) {
+		for (std::size_t f = 0; f < numFrames; ++f) {
+			const float* frameIn = src + f * numInChannels;
+			float* frameOut = dst + f * numOutChannels;
+
+			for (std::size_t o = 0; o < numOutChannels; ++o) {
+				const float* row = matrix + o * numInChannels;
+				float sum = 0.0f;
+				for (std::size_t i = 0; i < numInChannels; ++i) {
+					sum += row[i] * frameIn[i];
+				}
+				frameOut[o] = sum;
+			}
+		}
+	}
+
+}
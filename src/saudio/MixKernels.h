@@ -0,0 +1,78 @@
+#ifndef SAUDIO_MIX_KERNELS_H
+#define SAUDIO_MIX_KERNELS_H
+
+#include <cstddef>
+
+namespace saudio {
+
+	/** Adds the given samples to the destination ones
+	 * (dst[i] += src[i])
+	 *
+	 * @param	dst a pointer to the samples where the result will be stored
+	 * @param	src a pointer to the samples to add
+	 * @param	numSamples the number of samples to add */
+	void mixAdd(float* dst, const float* src, std::size_t numSamples);
+
+
+	/** Multiplies the given interleaved frames by a gain per channel, that
+	 * is interpolated linearly from the start gains to the end ones
+	 * (dst[f][c] = src[f][c] * mix(startGains[c], endGains[c], f / numFrames))
+	 *
+	 * @param	dst a pointer to the frames where the result will be stored
+	 * @param	src a pointer to the frames to multiply
+	 * @param	numFrames the number of frames
+	 * @param	numChannels the number of channels of the frames
+	 * @param	startGains a pointer to the gains of each channel at the
+	 *			first frame
+	 * @param	endGains a pointer to the gains of each channel after the
+	 *			last frame */
+	void applyGainRamp(
+		float* dst, const float* src,
+		std::size_t numFrames, std::size_t numChannels,
+		const float* startGains, const float* endGains
+	);
+
+
+	/** Downmixes the given interleaved frames to mono and multiplies them
+	 * by a gain per output channel, that is interpolated linearly from the
+	 * start gains to the end ones
+	 * (dst[f][c] = mean(src[f]) * mix(startGains[c], endGains[c], f / numFrames))
+	 *
+	 * @param	dst a pointer to the frames where the result will be stored
+	 * @param	src a pointer to the frames to encode
+	 * @param	numFrames the number of frames
+	 * @param	numInChannels the number of channels of the source frames
+	 * @param	numOutChannels the number of channels of the destination
+	 *			frames
+	 * @param	startGains a pointer to the gains of each output channel at
+	 *			the first frame
+	 * @param	endGains a pointer to the gains of each output channel after
+	 *			the last frame */
+	void encodeGainRamp(
+		float* dst, const float* src, std::size_t numFrames,
+		std::size_t numInChannels, std::size_t numOutChannels,
+		const float* startGains, const float* endGains
+	);
+
+
+	/** Multiplies the given interleaved frames by a matrix
+	 * (dst[f][o] = sum(matrix[o][i] * src[f][i]))
+	 *
+	 * @param	dst a pointer to the frames where the result will be stored,
+	 *			they can't overlap with the source ones
+	 * @param	src a pointer to the frames to multiply
+	 * @param	numFrames the number of frames
+	 * @param	numInChannels the number of channels of the source frames
+	 * @param	numOutChannels the number of channels of the destination
+	 *			frames
+	 * @param	matrix a pointer to the matrix, stored by rows with one row
+	 *			per output channel */
+	void mixMatrix(
+		float* dst, const float* src, std::size_t numFrames,
+		std::size_t numInChannels, std::size_t numOutChannels,
+		const float* matrix
+	);
+
+}
+
+#endif		// SAUDIO_MIX_KERNELS_H
@@ -0,0 +1,240 @@
+#include <algorithm>
+#include "NonUniformConvolver.h"
+#include "ConvolutionKernels.h"
+#include "LogWrapper.h"
+
+namespace saudio {
+
+	/** The ratio between the partition sizes of consecutive segments */
+	static constexpr std::size_t kSegmentGrowth = 8;
+
+	/** The maximum partition size, the last segment holds the rest of the
+	 * impulse responses */
+	static constexpr std::size_t kMaxPartitionSize = 1 << 16;
+
+
+	NonUniformConvolver::Segment::Segment(std::size_t offset, std::size_t blockSize, std::size_t numPartitions) :
+		offset(offset), convolver(blockSize, numPartitions), fill(0), dropping(false),
+		inputBlocks{}, numReady(0), numDone(0), outputBlocks{} {}
+
+
+	NonUniformConvolver::NonUniformConvolver(
+		const Context* context,
+		const float* const* impulseResponses, std::size_t numChannels,
+		std::size_t length, std::size_t blockSize
+	) : mContext(context), mBlockSize(blockSize), mNumChannels(numChannels),
+		mInput(blockSize, 0.0f), mOutput(numChannels * blockSize, 0.0f), mBlockOutput(numChannels * blockSize),
+		mPosition(0), mNumBlocks(0), mNumOverruns(0), mSemaphore(), mStop(false)
+	{
+		// The head ends where the first worker segment can start
+		std::size_t partitionSize = blockSize * kSegmentGrowth;
+		std::size_t end = std::min(length, 2 * partitionSize);
+		mHead = std::make_unique<Segment>(0, blockSize, (end + blockSize - 1) / blockSize);
+		mHead->filters.resize(mNumChannels);
+		for (std::size_t c = 0; c < mNumChannels; ++c) {
+			mHead->convolver.computeFilter(impulseResponses[c], end, mHead->filters[c]);
+		}
+
+		for (std::size_t offset = end; offset < length; offset = end) {
+			std::size_t nextPartitionSize = partitionSize * kSegmentGrowth;
+			end = (nextPartitionSize > kMaxPartitionSize)? length : std::min(length, 2 * nextPartitionSize);
+
+			auto segment = std::make_unique<Segment>(offset, partitionSize, (end - offset + partitionSize - 1) / partitionSize);
+			segment->filters.resize(mNumChannels);
+			for (std::size_t c = 0; c < mNumChannels; ++c) {
+				segment->convolver.computeFilter(impulseResponses[c] + offset, end - offset, segment->filters[c]);
+			}
+			segment->input.resize(kNumBlocks * partitionSize, 0.0f);
+			segment->output.resize(kNumBlocks * mNumChannels * partitionSize, 0.0f);
+			mTail.emplace_back(std::move(segment));
+			mSilence.resize(partitionSize, 0.0f);
+
+			partitionSize = nextPartitionSize;
+		}
+
+		if (!mTail.empty()) {
+			if (ma_semaphore_init(0, &mSemaphore) != MA_SUCCESS) {
+				SAUDIO_ERROR_LOG(mContext) << "Failed to create the semaphore, only the first " << end << " samples will be convolved";
+				mTail.clear();
+				return;
+			}
+
+			mWorker = std::thread(&NonUniformConvolver::threadFunction, this);
+		}
+
+		SAUDIO_DEBUG_LOG(mContext) << "Created convolver with " << mHead->convolver.getNumPartitions()
+			<< " head partitions and " << mTail.size() << " tail segments";
+	}
+
+
+	NonUniformConvolver::~NonUniformConvolver()
+	{
+		if (mWorker.joinable()) {
+			mStop = true;
+			ma_semaphore_release(&mSemaphore);
+			mWorker.join();
+			ma_semaphore_uninit(&mSemaphore);
+		}
+	}
+
+
+	std::size_t NonUniformConvolver::getNumChannels() const
+	{
+		return mNumChannels;
+	}
+
+
+	std::size_t NonUniformConvolver::getNumTailSegments() const
+	{
+		return mTail.size();
+	}
+
+
+	void NonUniformConvolver::process(const float* input, float* output, std::size_t numFrames)
+	{
+		while (numFrames > 0) {
+			std::size_t count = std::min(numFrames, mBlockSize - mPosition);
+			std::copy(input, input + count, mInput.begin() + mPosition);
+			std::copy(mOutput.begin() + mNumChannels * mPosition, mOutput.begin() + mNumChannels * (mPosition + count), output);
+
+			mPosition += count;
+			if (mPosition == mBlockSize) {
+				processBlock();
+				mPosition = 0;
+			}
+
+			input += count;
+			output += mNumChannels * count;
+			numFrames -= count;
+		}
+	}
+
+
+	uint64_t NonUniformConvolver::takeNumOverruns()
+	{
+		return mNumOverruns.exchange(0, std::memory_order_relaxed);
+	}
+
+// Private functions
+	void NonUniformConvolver::processBlock()
+	{
+		mHead->convolver.pushBlock(mInput.data());
+		for (std::size_t c = 0; c < mNumChannels; ++c) {
+			mHead->convolver.convolve(mHead->filters[c], &mBlockOutput[c * mBlockSize]);
+		}
+
+		// Pass the block to the worker segments. If the worker is still
+		// convolving the block stored in the slot, the new one is dropped
+		// instead of overwriting it, its output will be counted as an
+		// overrun when it's needed
+		bool notify = false;
+		for (auto& segment : mTail) {
+			std::size_t partitionSize = segment->convolver.getBlockSize();
+			uint64_t block = segment->numReady.load(std::memory_order_relaxed);
+			std::size_t slot = block % kNumBlocks;
+			if (segment->fill == 0) {
+				segment->dropping = (block >= segment->numDone.load(std::memory_order_acquire) + kNumBlocks);
+			}
+			if (!segment->dropping) {
+				std::copy(mInput.begin(), mInput.end(), &segment->input[slot * partitionSize + segment->fill]);
+			}
+
+			segment->fill += mBlockSize;
+			if (segment->fill == partitionSize) {
+				segment->fill = 0;
+				if (!segment->dropping) {
+					segment->inputBlocks[slot].store(block + 1, std::memory_order_release);
+				}
+				segment->numReady.store(block + 1, std::memory_order_release);
+				notify = true;
+			}
+		}
+		if (notify) {
+			ma_semaphore_release(&mSemaphore);
+		}
+
+		// Add the output of the worker segments that overlaps the block
+		uint64_t position = mNumBlocks * mBlockSize;
+		for (auto& segment : mTail) {
+			if (position < segment->offset) {
+				break;
+			}
+
+			std::size_t partitionSize = segment->convolver.getBlockSize();
+			uint64_t block = (position - segment->offset) / partitionSize;
+			std::size_t blockOffset = static_cast<std::size_t>((position - segment->offset) % partitionSize);
+			std::size_t slot = block % kNumBlocks;
+			if (segment->outputBlocks[slot].load(std::memory_order_acquire) == block + 1) {
+				for (std::size_t c = 0; c < mNumChannels; ++c) {
+					const float* segmentOutput = &segment->output[(slot * mNumChannels + c) * partitionSize + blockOffset];
+					multiplyAdd(&mBlockOutput[c * mBlockSize], segmentOutput, 1.0f, mBlockSize);
+				}
+			}
+			else {
+				mNumOverruns.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+		mNumBlocks++;
+
+		for (std::size_t i = 0; i < mBlockSize; ++i) {
+			for (std::size_t c = 0; c < mNumChannels; ++c) {
+				mOutput[i * mNumChannels + c] = mBlockOutput[c * mBlockSize + i];
+			}
+		}
+	}
+
+
+	void NonUniformConvolver::threadFunction()
+	{
+		while (true) {
+			ma_semaphore_wait(&mSemaphore);
+			if (mStop) {
+				break;
+			}
+
+			// The segments with smaller partitions are processed first
+			// because their output is needed sooner
+			for (auto& segment : mTail) {
+				std::size_t partitionSize = segment->convolver.getBlockSize();
+				uint64_t numReady = segment->numReady.load(std::memory_order_acquire);
+				uint64_t numDone = segment->numDone.load(std::memory_order_relaxed);
+
+				// The oldest blocks are skipped when the worker falls
+				// behind, the audio thread counts their missing output.
+				// The convolver gets silence instead of them, so the next
+				// blocks are still convolved with the right partitions
+				if (numReady - numDone > kNumBlocks - 1) {
+					uint64_t numSkipped = numReady - 1 - numDone;
+					if (numSkipped >= segment->convolver.getNumPartitions()) {
+						segment->convolver.reset();
+					}
+					else {
+						for (uint64_t i = 0; i < numSkipped; ++i) {
+							segment->convolver.pushBlock(mSilence.data());
+						}
+					}
+					numDone = numReady - 1;
+				}
+
+				for (; numDone < numReady; ++numDone) {
+					// The slot of a dropped block isn't used by the audio
+					// thread until numDone passes it, so it's cleared in
+					// place
+					std::size_t slot = numDone % kNumBlocks;
+					float* input = &segment->input[slot * partitionSize];
+					if (segment->inputBlocks[slot].load(std::memory_order_acquire) != numDone + 1) {
+						std::fill(input, input + partitionSize, 0.0f);
+					}
+
+					segment->convolver.pushBlock(input);
+					for (std::size_t c = 0; c < mNumChannels; ++c) {
+						segment->convolver.convolve(segment->filters[c], &segment->output[(slot * mNumChannels + c) * partitionSize]);
+					}
+					segment->outputBlocks[slot].store(numDone + 1, std::memory_order_release);
+					segment->numDone.store(numDone + 1, std::memory_order_release);
+				}
+			}
+		}
+	}
+
+}
@@ -0,0 +1,184 @@
+#ifndef SAUDIO_NON_UNIFORM_CONVOLVER_H
+#define SAUDIO_NON_UNIFORM_CONVOLVER_H
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <miniaudio.h>
+#include "PartitionedConvolver.h"
+
+namespace saudio {
+
+	class Context;
+
+
+	/**
+	 * Class NonUniformConvolver, it convolves a mono signal with long
+	 * impulse responses using non-uniformly partitioned convolution. The
+	 * impulse responses are splitted in segments whose partition size
+	 * grows with their offset. The first segment uses small partitions and
+	 * is convolved in the audio thread, so the latency is a single small
+	 * block. The following segments use larger partitions, that are cheaper
+	 * per sample, and they are convolved by a worker thread that has until
+	 * their output is needed to finish them.
+	 *
+	 * @note	a segment with partitions of N samples starts at an offset
+	 *			of 2N samples, so the worker has at least N samples of time
+	 *			for convolving each block
+	 */
+	class NonUniformConvolver
+	{
+	private:	// Nested types
+		/** The number of blocks buffered by each worker segment */
+		static constexpr std::size_t kNumBlocks = 4;
+
+		/** A segment of the impulse responses */
+		struct Segment
+		{
+			/** The offset of the segment in the impulse responses */
+			std::size_t offset;
+
+			/** Convolves the blocks of the segment */
+			PartitionedConvolver convolver;
+
+			/** The partitions of each impulse response */
+			std::vector<PartitionedFilter> filters;
+
+			/** The last input blocks, written by the audio thread */
+			std::vector<float> input;
+
+			/** The number of samples of the input block being filled */
+			std::size_t fill;
+
+			/** If the input block being filled is dropped because the
+			 * worker was still using its slot */
+			bool dropping;
+
+			/** The index plus one of the block stored in each input slot */
+			std::atomic<uint64_t> inputBlocks[kNumBlocks];
+
+			/** The number of input blocks filled or dropped */
+			std::atomic<uint64_t> numReady;
+
+			/** The number of input blocks convolved by the worker */
+			std::atomic<uint64_t> numDone;
+
+			/** The output of the last blocks, with the samples of each
+			 * impulse response one after the other */
+			std::vector<float> output;
+
+			/** The index plus one of the block stored in each output slot,
+			 * 0 if it's empty */
+			std::atomic<uint64_t> outputBlocks[kNumBlocks];
+
+			Segment(std::size_t offset, std::size_t blockSize, std::size_t numPartitions);
+		};
+
+	private:	// Attributes
+		/** The Context used for logging */
+		const Context* mContext;
+
+		/** The number of samples of the blocks convolved in the audio
+		 * thread */
+		std::size_t mBlockSize;
+
+		/** The number of impulse responses */
+		std::size_t mNumChannels;
+
+		/** The segment convolved in the audio thread */
+		std::unique_ptr<Segment> mHead;
+
+		/** The segments convolved by the worker, sorted by offset */
+		std::vector<std::unique_ptr<Segment>> mTail;
+
+		/** The samples of the block being filled */
+		std::vector<float> mInput;
+
+		/** The interleaved frames of the last convolved block */
+		std::vector<float> mOutput;
+
+		/** The output of the impulse responses of the block being
+		 * convolved */
+		std::vector<float> mBlockOutput;
+
+		/** The zero samples pushed to the tail segments instead of the
+		 * blocks skipped by the worker, it has the size of the largest
+		 * partition */
+		std::vector<float> mSilence;
+
+		/** The number of samples of @see mInput */
+		std::size_t mPosition;
+
+		/** The number of blocks convolved in the audio thread */
+		uint64_t mNumBlocks;
+
+		/** The number of tail blocks whose output wasn't ready in time, it's
+		 * only updated by the audio thread */
+		std::atomic<uint64_t> mNumOverruns;
+
+		/** Wakes up the worker when a tail block is ready */
+		ma_semaphore mSemaphore;
+
+		/** If the worker must stop */
+		std::atomic<bool> mStop;
+
+		/** The worker thread, it convolves @see mTail */
+		std::thread mWorker;
+
+	public:		// Functions
+		/** Creates a new NonUniformConvolver
+		 *
+		 * @param	context a pointer to the Context used for logging, it can
+		 *			be nullptr
+		 * @param	impulseResponses the samples of each impulse response
+		 * @param	numChannels the number of impulse responses
+		 * @param	length the number of samples of each impulse response
+		 * @param	blockSize the number of samples of the blocks convolved
+		 *			in the audio thread, it must be a power of two */
+		NonUniformConvolver(
+			const Context* context,
+			const float* const* impulseResponses, std::size_t numChannels,
+			std::size_t length, std::size_t blockSize
+		);
+		NonUniformConvolver(const NonUniformConvolver& other) = delete;
+		NonUniformConvolver(NonUniformConvolver&& other) = delete;
+
+		/** Class destructor */
+		~NonUniformConvolver();
+
+		/** Assignment operator */
+		NonUniformConvolver& operator=(const NonUniformConvolver& other) = delete;
+		NonUniformConvolver& operator=(NonUniformConvolver&& other) = delete;
+
+		/** @return	the number of impulse responses */
+		std::size_t getNumChannels() const;
+
+		/** @return	the number of segments convolved by the worker */
+		std::size_t getNumTailSegments() const;
+
+		/** Convolves the given samples. It must be called from the audio
+		 * thread
+		 *
+		 * @param	input a pointer to the mono samples to convolve
+		 * @param	output a pointer to the array where the interleaved
+		 *			frames with the output of each impulse response will be
+		 *			stored, delayed by the block size
+		 * @param	numFrames the number of samples to convolve */
+		void process(const float* input, float* output, std::size_t numFrames);
+
+		/** @return	the number of tail blocks that the worker didn't finish
+		 *			in time since the last call */
+		uint64_t takeNumOverruns();
+	private:
+		/** Convolves the filled block in the audio thread */
+		void processBlock();
+
+		/** Convolves the ready blocks of the tail segments until
+		 * @see mStop is set */
+		void threadFunction();
+	};
+
+}
+
+#endif		// SAUDIO_NON_UNIFORM_CONVOLVER_H
@@ -0,0 +1,78 @@
+#ifndef SAUDIO_OBJECT_ALLOCATION_H
+#define SAUDIO_OBJECT_ALLOCATION_H
+
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <miniaudio.h>
+#include "saudio/Context.h"
+
+namespace saudio {
+
+	/** A pointer to an object allocated with @see makeObject or
+	 * @see makeObjectWith */
+	template <typename T>
+	using ObjectPtr = std::unique_ptr<T, ObjectDeleter>;
+
+
+	/** Allocates a zero initialized miniaudio object with the Allocator of
+	 * the given Context
+	 *
+	 * @param	context a pointer to the Context used for allocating the
+	 *			object, if it's nullptr the C allocation functions will be
+	 *			used instead
+	 * @param	category the AllocationCategory of the object
+	 * @return	a pointer to the new object, nullptr on failure */
+	template <typename T>
+	ObjectPtr<T> makeObject(
+		const Context* context,
+		AllocationCategory category = AllocationCategory::Object
+	) {
+		static_assert(std::is_trivially_destructible_v<T>, "The objects are released without calling their destructors");
+
+		void* ptr = context? context->allocate(sizeof(T), category) : std::malloc(sizeof(T));
+		T* object = ptr? new (ptr) T() : nullptr;
+		return ObjectPtr<T>(object, ObjectDeleter{ context, category });
+	}
+
+
+	/** Allocates an object with the Allocator of the given Context. Unlike
+	 * @see makeObject its destructor is called when it's released
+	 *
+	 * @param	context a pointer to the Context used for allocating the
+	 *			object, if it's nullptr the C allocation functions will be
+	 *			used instead
+	 * @param	category the AllocationCategory of the object
+	 * @param	construct the function that constructs the object in the
+	 *			memory passed to it and returns a pointer to it, so the
+	 *			caller can use the constructors that it can access
+	 * @return	a pointer to the new object, nullptr on failure */
+	template <typename T, typename F>
+	ObjectPtr<T> makeObjectWith(
+		const Context* context, AllocationCategory category, F&& construct
+	) {
+		ObjectDeleter deleter{ context, category, [](void* ptr) { static_cast<T*>(ptr)->~T(); } };
+
+		void* ptr = context? context->allocate(sizeof(T), category) : std::malloc(sizeof(T));
+		T* object = ptr? construct(ptr) : nullptr;
+		return ObjectPtr<T>(object, deleter);
+	}
+
+
+	/** Returns the miniaudio allocation callbacks of the given Context
+	 *
+	 * @param	context a pointer to the Context, it can be nullptr
+	 * @param	category the AllocationCategory of the callbacks
+	 * @return	a pointer to the callbacks, nullptr if there is no Context
+	 *			so miniaudio uses the C allocation functions */
+	inline const ma_allocation_callbacks* getMAAllocationCallbacks(
+		const Context* context, AllocationCategory category
+	) {
+		return context?
+			static_cast<const ma_allocation_callbacks*>(context->getMAAllocationCallbacks(category)) :
+			nullptr;
+	}
+
+}
+
+#endif		// SAUDIO_OBJECT_ALLOCATION_H
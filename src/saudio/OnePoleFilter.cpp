@@ -0,0 +1,61 @@
+#include <cmath>
+#include <algorithm>
+#include "saudio/OnePoleFilter.h"
+#include "saudio/AudioEngine.h"
+#include "EffectKernels.h"
+
+namespace saudio {
+
+	OnePoleFilter::OnePoleFilter(AudioEngine& engine, Type type, float cutoff) :
+		mSampleRate(static_cast<float>(engine.getSampleRate())), mNumChannels(engine.getChannels()),
+		mType(static_cast<int>(type)), mCutoff(0.0f), mCoefficient(1.0f), mState(mNumChannels, 0.0f)
+	{
+		setCutoff(cutoff);
+	}
+
+
+	OnePoleFilter::Type OnePoleFilter::getType() const
+	{
+		return static_cast<Type>(mType.load(std::memory_order_relaxed));
+	}
+
+
+	OnePoleFilter& OnePoleFilter::setType(Type type)
+	{
+		mType.store(static_cast<int>(type), std::memory_order_relaxed);
+		return *this;
+	}
+
+
+	float OnePoleFilter::getCutoff() const
+	{
+		return mCutoff.load(std::memory_order_relaxed);
+	}
+
+
+	OnePoleFilter& OnePoleFilter::setCutoff(float cutoff)
+	{
+		static constexpr float kPi = 3.14159265358979323846f;
+
+		cutoff = std::clamp(cutoff, 0.0f, 0.49f * mSampleRate);
+		mCutoff.store(cutoff, std::memory_order_relaxed);
+		mCoefficient.store(1.0f - std::exp(-2.0f * kPi * cutoff / mSampleRate), std::memory_order_relaxed);
+		return *this;
+	}
+
+
+	void OnePoleFilter::process(float* frames, std::size_t numFrames, std::size_t numChannels)
+	{
+		if ((numFrames == 0) || (numChannels > mNumChannels)) {
+			return;
+		}
+
+		processOnePole(
+			frames, numFrames, numChannels,
+			mCoefficient.load(std::memory_order_relaxed),
+			static_cast<Type>(mType.load(std::memory_order_relaxed)) == Type::HighPass,
+			mState.data()
+		);
+	}
+
+}
@@ -0,0 +1,242 @@
+#include <algorithm>
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <pthread.h>
+	#include <sched.h>
+#endif
+#include "saudio/RealtimeChecker.h"
+#include "ParallelRenderer.h"
+#include "BatchSpatializer.h"
+#include "SoundScheduler.h"
+#include "MixKernels.h"
+#include "LogWrapper.h"
+
+namespace saudio {
+
+	// Private functions
+	/** Raises the priority of the given worker thread so it isn't
+	 * preempted by the non real-time threads
+	 *
+	 * @param	thread the thread to update
+	 * @return	true if the priority was changed, false otherwise */
+	static bool setRealtimePriority(std::thread& thread)
+	{
+#ifdef _WIN32
+		return SetThreadPriority(thread.native_handle(), THREAD_PRIORITY_TIME_CRITICAL) != 0;
+#else
+		sched_param param = {};
+		param.sched_priority = sched_get_priority_max(SCHED_FIFO) - 1;
+		return pthread_setschedparam(thread.native_handle(), SCHED_FIFO, &param) == 0;
+#endif
+	}
+
+// Public functions
+	ParallelRenderer::ParallelRenderer(
+		const Context* context, ma_engine* engine,
+		std::size_t numLanes, std::size_t numThreads,
+		const BatchSpatializer::Config* spatializerConfig,
+		ma_uint32 listenerIndex
+	) : mContext(context), mNumChannels(ma_engine_get_channels(engine)), mLanes(new Lane[numLanes]), mNumLanes(0),
+		mSemaphore(), mDoneSemaphore(), mStop(false), mNextLane(numLanes), mNumPendingLanes(0), mFrameCount(0),
+		mScheduler(nullptr), mListenerIndex(listenerIndex)
+	{
+		for (std::size_t i = 0; i < numLanes; ++i) {
+			ma_engine_config engineConfig = ma_engine_config_init();
+			engineConfig.pResourceManager = ma_engine_get_resource_manager(engine);
+			engineConfig.pLog = ma_engine_get_log(engine);
+			engineConfig.listenerCount = 1;
+			engineConfig.noDevice = MA_TRUE;
+			engineConfig.channels = mNumChannels;
+			engineConfig.sampleRate = ma_engine_get_sample_rate(engine);
+			if (mContext) {
+				engineConfig.allocationCallbacks = *getMAAllocationCallbacks(mContext, AllocationCategory::Engine);
+			}
+
+			Lane& lane = mLanes[i];
+			lane.engine = makeObject<ma_engine>(mContext, AllocationCategory::Engine);
+			if (ma_engine_init(&engineConfig, lane.engine.get()) != MA_SUCCESS) {
+				SAUDIO_ERROR_LOG(mContext) << "Failed to create the engine of render lane " << i;
+				lane.engine = nullptr;
+				break;
+			}
+
+			if (spatializerConfig) {
+				lane.spatializer = std::make_unique<BatchSpatializer>(mContext, lane.engine.get(), *spatializerConfig);
+			}
+			lane.buffer.resize(kBlockFrames * mNumChannels);
+			++mNumLanes;
+		}
+		mNextLane = mNumLanes;
+
+		if (ma_semaphore_init(0, &mSemaphore) != MA_SUCCESS) {
+			SAUDIO_ERROR_LOG(mContext) << "Failed to create the semaphore, the lanes will be rendered by the audio thread";
+			return;
+		}
+		if (ma_semaphore_init(0, &mDoneSemaphore) != MA_SUCCESS) {
+			SAUDIO_ERROR_LOG(mContext) << "Failed to create the semaphore, the lanes will be rendered by the audio thread";
+			ma_semaphore_uninit(&mSemaphore);
+			return;
+		}
+
+		for (std::size_t i = 0; i < numThreads; ++i) {
+			mThreads.emplace_back(&ParallelRenderer::threadFunction, this);
+			if (!setRealtimePriority(mThreads.back())) {
+				SAUDIO_WARN_LOG(mContext) << "Failed to set the real-time priority of render thread " << i;
+			}
+		}
+
+		SAUDIO_INFO_LOG(mContext) << "Created " << mNumLanes << " render lanes with " << mThreads.size() << " threads";
+	}
+
+
+	ParallelRenderer::~ParallelRenderer()
+	{
+		if (!mThreads.empty()) {
+			mStop = true;
+			for (std::size_t i = 0; i < mThreads.size(); ++i) {
+				ma_semaphore_release(&mSemaphore);
+			}
+			for (std::thread& thread : mThreads) {
+				thread.join();
+			}
+			ma_semaphore_uninit(&mSemaphore);
+			ma_semaphore_uninit(&mDoneSemaphore);
+		}
+
+		for (std::size_t i = 0; i < mNumLanes; ++i) {
+			mLanes[i].spatializer = nullptr;
+			ma_engine_uninit(mLanes[i].engine.get());
+		}
+	}
+
+
+	std::size_t ParallelRenderer::getNumLanes() const
+	{
+		return mNumLanes;
+	}
+
+
+	ma_engine* ParallelRenderer::getLaneEngine(std::size_t lane) const
+	{
+		return mLanes[lane].engine.get();
+	}
+
+
+	ma_engine* ParallelRenderer::selectEngine() const
+	{
+		auto itLane = std::min_element(mLanes.get(), mLanes.get() + mNumLanes, [](const Lane& l1, const Lane& l2) {
+			return l1.numSounds.load(std::memory_order_relaxed) < l2.numSounds.load(std::memory_order_relaxed);
+		});
+		return (itLane != mLanes.get() + mNumLanes)? itLane->engine.get() : nullptr;
+	}
+
+
+	BatchSpatializer* ParallelRenderer::getBatchSpatializer(ma_engine* engine) const
+	{
+		for (std::size_t i = 0; i < mNumLanes; ++i) {
+			if (mLanes[i].engine.get() == engine) {
+				return mLanes[i].spatializer.get();
+			}
+		}
+
+		return nullptr;
+	}
+
+
+	void ParallelRenderer::updateNumSounds(ma_engine* engine, bool added)
+	{
+		for (std::size_t i = 0; i < mNumLanes; ++i) {
+			if (mLanes[i].engine.get() == engine) {
+				if (added) {
+					mLanes[i].numSounds.fetch_add(1, std::memory_order_relaxed);
+				}
+				else {
+					mLanes[i].numSounds.fetch_sub(1, std::memory_order_relaxed);
+				}
+			}
+		}
+	}
+
+
+	void ParallelRenderer::render(float* output, uint64_t frameCount, SoundScheduler* scheduler)
+	{
+		mScheduler = scheduler;
+		while (frameCount > 0) {
+			mFrameCount = static_cast<std::size_t>(std::min<uint64_t>(frameCount, kBlockFrames));
+
+			// Publish the render and wake up the workers, the audio thread
+			// also renders lanes until all of them are claimed
+			mNumPendingLanes.store(mNumLanes, std::memory_order_relaxed);
+			mNextLane.store(0, std::memory_order_release);
+			for (std::size_t i = 0; i < mThreads.size(); ++i) {
+				ma_semaphore_release(&mSemaphore);
+			}
+			renderLanes();
+
+			// The remaining lanes are already being rendered, so the wait is
+			// bounded by the time of a single lane. The audio thread sleeps
+			// instead of spinning in case that their worker is preempted
+			if (!mThreads.empty() && (mNumLanes > 0)) {
+				ma_semaphore_wait(&mDoneSemaphore);
+			}
+
+			// Reduce the lane buffers always in the same order
+			for (std::size_t i = 0; i < mNumLanes; ++i) {
+				mixAdd(output, mLanes[i].buffer.data(), mFrameCount * mNumChannels);
+			}
+
+			output += mFrameCount * mNumChannels;
+			frameCount -= mFrameCount;
+		}
+	}
+
+// Private functions
+	void ParallelRenderer::renderLanes()
+	{
+		std::size_t laneIndex;
+		while ((laneIndex = mNextLane.fetch_add(1, std::memory_order_acq_rel)) < mNumLanes) {
+			Lane& lane = mLanes[laneIndex];
+			if (lane.spatializer) {
+				lane.spatializer->update(mListenerIndex);
+			}
+
+			// The read is splitted only at the seeks and automations of the
+			// Sounds of the lane
+			uint64_t time = ma_engine_get_time_in_pcm_frames(lane.engine.get());
+			for (std::size_t offset = 0; offset < mFrameCount;) {
+				std::size_t count = mFrameCount - offset;
+				if (mScheduler) {
+					count = static_cast<std::size_t>(mScheduler->process(laneIndex + 1, time + offset, count));
+				}
+
+				float* buffer = lane.buffer.data() + offset * mNumChannels;
+				ma_uint64 framesRead = 0;
+				ma_engine_read_pcm_frames(lane.engine.get(), buffer, count, &framesRead);
+				std::fill(buffer + framesRead * mNumChannels, buffer + count * mNumChannels, 0.0f);
+				offset += count;
+			}
+
+			// The thread that finishes the last lane wakes up the audio
+			// thread
+			if ((mNumPendingLanes.fetch_sub(1, std::memory_order_acq_rel) == 1) && !mThreads.empty()) {
+				ma_semaphore_release(&mDoneSemaphore);
+			}
+		}
+	}
+
+
+	void ParallelRenderer::threadFunction()
+	{
+		while (true) {
+			ma_semaphore_wait(&mSemaphore);
+			if (mStop) {
+				break;
+			}
+
+			RealtimeChecker::Scope realtimeScope;
+			renderLanes();
+		}
+	}
+
+}
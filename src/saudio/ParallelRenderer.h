@@ -0,0 +1,175 @@
+#ifndef SAUDIO_PARALLEL_RENDERER_H
+#define SAUDIO_PARALLEL_RENDERER_H
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <miniaudio.h>
+#include "ObjectAllocation.h"
+#include "BatchSpatializer.h"
+
+namespace saudio {
+
+	class SoundScheduler;
+
+
+	/**
+	 * Class ParallelRenderer, it renders the Sounds of an AudioEngine with
+	 * multiple threads. The Sounds are distributed between render lanes,
+	 * each one with its own miniaudio engine that shares the resource
+	 * manager of the AudioEngine. On each render the lanes are claimed
+	 * from a shared counter by the worker threads and by the audio thread,
+	 * so the idle threads take the lanes left by the busy ones. There are
+	 * only a few lanes per thread, so a single counter balances them
+	 * without per thread queues. Each lane is rendered to its own buffer,
+	 * and the buffers are added always in the same order, so the result
+	 * doesn't depend on the thread scheduling.
+	 *
+	 * @note	the lane engines must be read always with the same frame
+	 *			counts than the AudioEngine one to keep their times in sync
+	 */
+	class ParallelRenderer
+	{
+	private:	// Nested types
+		/** Holds a miniaudio engine and its render buffer */
+		struct Lane
+		{
+			/** The miniaudio engine that renders the Sounds of the lane */
+			ObjectPtr<ma_engine> engine;
+
+			/** Spatializes the Sounds of the lane, nullptr if the batch
+			 * spatialization is disabled */
+			std::unique_ptr<BatchSpatializer> spatializer;
+
+			/** The frames rendered by the lane */
+			std::vector<float> buffer;
+
+			/** The number of Sounds of the lane, updated by the threads
+			 * that create and destroy the Sounds */
+			std::atomic<std::size_t> numSounds = 0;
+		};
+
+		/** The maximum number of frames rendered by each lane at once */
+		static constexpr std::size_t kBlockFrames = 1024;
+
+	private:	// Attributes
+		/** The Context used for allocating the engines */
+		const Context* mContext;
+
+		/** The number of channels of the rendered frames */
+		uint32_t mNumChannels;
+
+		/** The render lanes */
+		std::unique_ptr<Lane[]> mLanes;
+
+		/** The number of lanes of @see mLanes that have been created */
+		std::size_t mNumLanes;
+
+		/** The worker threads */
+		std::vector<std::thread> mThreads;
+
+		/** Wakes up the worker threads */
+		ma_semaphore mSemaphore;
+
+		/** Released when all the lanes of the current render have finished,
+		 * the audio thread waits on it */
+		ma_semaphore mDoneSemaphore;
+
+		/** If the worker threads must finish */
+		std::atomic<bool> mStop;
+
+		/** The index of the next lane to render */
+		std::atomic<std::size_t> mNextLane;
+
+		/** The number of lanes of the current render that haven't finished
+		 * yet */
+		std::atomic<std::size_t> mNumPendingLanes;
+
+		/** The number of frames of the current render, published with
+		 * @see mNextLane */
+		std::size_t mFrameCount;
+
+		/** The scheduler of the current render, published with
+		 * @see mNextLane */
+		SoundScheduler* mScheduler;
+
+		/** The index of the listener updated by the lane spatializers */
+		ma_uint32 mListenerIndex;
+
+	public:		// Functions
+		/** Creates a new ParallelRenderer
+		 *
+		 * @param	context a pointer to the Context used for allocating the
+		 *			engines, it can be nullptr
+		 * @param	engine the miniaudio engine of the AudioEngine, the lanes
+		 *			use its resource manager, channels and sample rate
+		 * @param	numLanes the number of render lanes
+		 * @param	numThreads the number of worker threads
+		 * @param	spatializerConfig the parameters of each lane batch
+		 *			spatializer, nullptr to disable the batch spatialization
+		 * @param	listenerIndex the index of the listener of the engines */
+		ParallelRenderer(
+			const Context* context, ma_engine* engine,
+			std::size_t numLanes, std::size_t numThreads,
+			const BatchSpatializer::Config* spatializerConfig,
+			ma_uint32 listenerIndex
+		);
+		ParallelRenderer(const ParallelRenderer& other) = delete;
+		ParallelRenderer(ParallelRenderer&& other) = delete;
+
+		/** Class destructor */
+		~ParallelRenderer();
+
+		/** Assignment operator */
+		ParallelRenderer& operator=(const ParallelRenderer& other) = delete;
+		ParallelRenderer& operator=(ParallelRenderer&& other) = delete;
+
+		/** @return	the number of render lanes */
+		std::size_t getNumLanes() const;
+
+		/** @return	the miniaudio engine of the given lane */
+		ma_engine* getLaneEngine(std::size_t lane) const;
+
+		/** @return	the miniaudio engine of the lane with less Sounds */
+		ma_engine* selectEngine() const;
+
+		/** Returns the batch spatializer of the lane with the given engine
+		 *
+		 * @param	engine the miniaudio engine of the lane
+		 * @return	the spatializer, nullptr if it isn't a lane engine or
+		 *			the batch spatialization is disabled */
+		BatchSpatializer* getBatchSpatializer(ma_engine* engine) const;
+
+		/** Updates the number of Sounds of the lane with the given engine
+		 *
+		 * @param	engine the miniaudio engine of the lane
+		 * @param	added true if a Sound was added to the lane, false if it
+		 *			was removed */
+		void updateNumSounds(ma_engine* engine, bool added);
+
+		/** Renders all the lanes and adds their frames to the given buffer.
+		 * The worker threads are woken once for every @see kBlockFrames.
+		 * It must be called from the audio thread
+		 *
+		 * @param	output a pointer to the buffer where the frames will be
+		 *			added
+		 * @param	frameCount the number of frames to render
+		 * @param	scheduler the SoundScheduler whose seeks and automations
+		 *			are processed while rendering each lane, splitting its
+		 *			read at their frames. The engine of the lane i has the
+		 *			index i + 1 in it, after the AudioEngine one. It must be
+		 *			owned by the audio thread, nullptr for not processing
+		 *			them */
+		void render(float* output, uint64_t frameCount, SoundScheduler* scheduler);
+	private:
+		/** Renders the lanes that haven't been claimed yet */
+		void renderLanes();
+
+		/** The function executed by the worker threads */
+		void threadFunction();
+	};
+
+}
+
+#endif		// SAUDIO_PARALLEL_RENDERER_H
@@ -0,0 +1,91 @@
+#include <algorithm>
+#include "PartitionedConvolver.h"
+#include "ConvolutionKernels.h"
+
+namespace saudio {
+
+	PartitionedConvolver::PartitionedConvolver(std::size_t blockSize, std::size_t numPartitions) :
+		mBlockSize(blockSize), mNumPartitions(std::max<std::size_t>(numPartitions, 1)), mFFT(2 * blockSize),
+		mInput(2 * blockSize, 0.0f),
+		mSpectraRe(mNumPartitions * mFFT.getNumBins(), 0.0f), mSpectraIm(mNumPartitions * mFFT.getNumBins(), 0.0f),
+		mCurrentPartition(0),
+		mAccumulatorRe(mFFT.getNumBins()), mAccumulatorIm(mFFT.getNumBins()),
+		mOutput(2 * blockSize) {}
+
+
+	std::size_t PartitionedConvolver::getBlockSize() const
+	{
+		return mBlockSize;
+	}
+
+
+	std::size_t PartitionedConvolver::getNumPartitions() const
+	{
+		return mNumPartitions;
+	}
+
+
+	void PartitionedConvolver::computeFilter(const float* impulseResponse, std::size_t length, PartitionedFilter& filter)
+	{
+		std::size_t numBins = mFFT.getNumBins();
+		filter.numPartitions = std::min((length + mBlockSize - 1) / mBlockSize, mNumPartitions);
+		filter.re.resize(filter.numPartitions * numBins);
+		filter.im.resize(filter.numPartitions * numBins);
+
+		// Each partition is zero padded to two blocks
+		std::vector<float> padded(2 * mBlockSize);
+		for (std::size_t p = 0; p < filter.numPartitions; ++p) {
+			std::size_t begin = p * mBlockSize, end = std::min(begin + mBlockSize, length);
+			std::fill(padded.begin(), padded.end(), 0.0f);
+			std::copy(impulseResponse + begin, impulseResponse + end, padded.begin());
+			mFFT.forward(padded.data(), &filter.re[p * numBins], &filter.im[p * numBins]);
+		}
+	}
+
+
+	void PartitionedConvolver::pushBlock(const float* input)
+	{
+		std::size_t numBins = mFFT.getNumBins();
+
+		std::copy(mInput.begin() + mBlockSize, mInput.end(), mInput.begin());
+		std::copy(input, input + mBlockSize, mInput.begin() + mBlockSize);
+
+		mCurrentPartition = (mCurrentPartition + 1) % mNumPartitions;
+		mFFT.forward(mInput.data(), &mSpectraRe[mCurrentPartition * numBins], &mSpectraIm[mCurrentPartition * numBins]);
+	}
+
+
+	void PartitionedConvolver::convolve(const PartitionedFilter& filter, float* output)
+	{
+		std::size_t numBins = mFFT.getNumBins();
+		std::size_t numPartitions = std::min(filter.numPartitions, mNumPartitions);
+
+		// Multiply each input block spectrum with the filter partition of
+		// its age
+		std::fill(mAccumulatorRe.begin(), mAccumulatorRe.end(), 0.0f);
+		std::fill(mAccumulatorIm.begin(), mAccumulatorIm.end(), 0.0f);
+		for (std::size_t p = 0; p < numPartitions; ++p) {
+			std::size_t inputPartition = (mCurrentPartition + mNumPartitions - p) % mNumPartitions;
+			complexMultiplyAdd(
+				mAccumulatorRe.data(), mAccumulatorIm.data(),
+				&mSpectraRe[inputPartition * numBins], &mSpectraIm[inputPartition * numBins],
+				&filter.re[p * numBins], &filter.im[p * numBins],
+				numBins
+			);
+		}
+
+		// Overlap-save, only the second half is free of circular aliasing
+		mFFT.inverse(mAccumulatorRe.data(), mAccumulatorIm.data(), mOutput.data());
+		std::copy(mOutput.begin() + mBlockSize, mOutput.end(), output);
+	}
+
+
+	void PartitionedConvolver::reset()
+	{
+		std::fill(mInput.begin(), mInput.end(), 0.0f);
+		std::fill(mSpectraRe.begin(), mSpectraRe.end(), 0.0f);
+		std::fill(mSpectraIm.begin(), mSpectraIm.end(), 0.0f);
+		mCurrentPartition = 0;
+	}
+
+}
@@ -0,0 +1,115 @@
+#ifndef SAUDIO_PARTITIONED_CONVOLVER_H
+#define SAUDIO_PARTITIONED_CONVOLVER_H
+
+#include <vector>
+#include "FFT.h"
+
+namespace saudio {
+
+	/**
+	 * Struct PartitionedFilter, it holds the spectra of the partitions of
+	 * an impulse response, used by @see PartitionedConvolver
+	 */
+	struct PartitionedFilter
+	{
+		/** The number of partitions of the impulse response */
+		std::size_t numPartitions = 0;
+
+		/** The real and imaginary parts of the spectra, stored one
+		 * partition after the other */
+		std::vector<float> re, im;
+	};
+
+
+	/**
+	 * Class PartitionedConvolver, it convolves a signal with impulse
+	 * responses using uniformly partitioned overlap-save convolution. The
+	 * impulse responses are splitted in partitions of the block size whose
+	 * spectra are multiplied with the spectra of the last input blocks,
+	 * that are kept in a frequency domain delay line. The delay line is
+	 * shared by all the filters, so the same input can be convolved with
+	 * multiple impulse responses with a single forward FFT.
+	 *
+	 * @note	the output of each block only depends on the input blocks
+	 *			pushed until it, so the convolution doesn't add latency
+	 *			besides the block size
+	 */
+	class PartitionedConvolver
+	{
+	private:	// Attributes
+		/** The number of samples of each block */
+		std::size_t mBlockSize;
+
+		/** The maximum number of partitions of the filters */
+		std::size_t mNumPartitions;
+
+		/** The FFT of two blocks */
+		FFT mFFT;
+
+		/** The last two input blocks */
+		std::vector<float> mInput;
+
+		/** The frequency domain delay line with the spectra of the last
+		 * @see mNumPartitions input blocks */
+		std::vector<float> mSpectraRe, mSpectraIm;
+
+		/** The partition of the delay line with the last input block */
+		std::size_t mCurrentPartition;
+
+		/** The accumulated spectrum of the output */
+		std::vector<float> mAccumulatorRe, mAccumulatorIm;
+
+		/** The output of the inverse FFT */
+		std::vector<float> mOutput;
+
+	public:		// Functions
+		/** Creates a new PartitionedConvolver
+		 *
+		 * @param	blockSize the number of samples of each block, it must be
+		 *			a power of two greater or equal than 2
+		 * @param	numPartitions the maximum number of partitions of the
+		 *			filters */
+		PartitionedConvolver(std::size_t blockSize, std::size_t numPartitions);
+
+		/** @return	the number of samples of each block */
+		std::size_t getBlockSize() const;
+
+		/** @return	the maximum number of partitions of the filters */
+		std::size_t getNumPartitions() const;
+
+		/** Calculates the partitions of the given impulse response
+		 *
+		 * @param	impulseResponse a pointer to the samples of the impulse
+		 *			response
+		 * @param	length the number of samples of the impulse response,
+		 *			the ones that don't fit in @see getNumPartitions are
+		 *			ignored
+		 * @param	filter the PartitionedFilter where the partitions will
+		 *			be stored
+		 * @note	it must not be called at the same time than the other
+		 *			functions */
+		void computeFilter(const float* impulseResponse, std::size_t length, PartitionedFilter& filter);
+
+		/** Pushes a new block to the convolver
+		 *
+		 * @param	input a pointer to the @see getBlockSize samples of the
+		 *			block */
+		void pushBlock(const float* input);
+
+		/** Convolves the pushed blocks with the given filter
+		 *
+		 * @param	filter the partitions of the impulse response, it must
+		 *			have been created with a convolver with the same block
+		 *			size
+		 * @param	output a pointer to the array where the
+		 *			@see getBlockSize samples of the last block will be
+		 *			stored */
+		void convolve(const PartitionedFilter& filter, float* output);
+
+		/** Clears the pushed blocks */
+		void reset();
+	};
+
+}
+
+#endif		// SAUDIO_PARTITIONED_CONVOLVER_H
@@ -0,0 +1,135 @@
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include "saudio/PeakLimiter.h"
+#include "saudio/AudioEngine.h"
+#include "EffectKernels.h"
+
+namespace saudio {
+
+	/** The maximum number of frames limited at the same time */
+	static constexpr std::size_t kChunkFrames = 256;
+
+
+	PeakLimiter::PeakLimiter(AudioEngine& engine, float lookahead, float thresholdDB, float release) :
+		mSampleRate(static_cast<float>(engine.getSampleRate())), mNumChannels(engine.getChannels()),
+		mLookahead(std::max(static_cast<std::size_t>(std::lround(lookahead * mSampleRate)), std::size_t(1))),
+		mThresholdDB(0.0f), mThreshold(1.0f), mRelease(0.0f), mReleaseCoefficient(1.0f),
+		mDelayLine(mLookahead * mNumChannels, 0.0f), mDelayIndex(0),
+		mMinGains(mLookahead + 1), mMinFrames(mLookahead + 1), mMinFirst(0), mMinCount(0),
+		mFrameNumber(0), mEnvelope(1.0f),
+		mAverageGains(mLookahead, 1.0f), mAverageIndex(0), mAverageSum(static_cast<double>(mLookahead)),
+		mPeaks(kChunkFrames), mGains(kChunkFrames), mDelayedFrames(kChunkFrames * mNumChannels)
+	{
+		setThreshold(thresholdDB);
+		setRelease(release);
+	}
+
+
+	std::size_t PeakLimiter::getLatency() const
+	{
+		return mLookahead;
+	}
+
+
+	float PeakLimiter::getThreshold() const
+	{
+		return mThresholdDB.load(std::memory_order_relaxed);
+	}
+
+
+	PeakLimiter& PeakLimiter::setThreshold(float thresholdDB)
+	{
+		mThresholdDB.store(thresholdDB, std::memory_order_relaxed);
+		mThreshold.store(std::pow(10.0f, thresholdDB / 20.0f), std::memory_order_relaxed);
+		return *this;
+	}
+
+
+	float PeakLimiter::getRelease() const
+	{
+		return mRelease.load(std::memory_order_relaxed);
+	}
+
+
+	PeakLimiter& PeakLimiter::setRelease(float release)
+	{
+		release = std::max(release, 1.0f / mSampleRate);
+		mRelease.store(release, std::memory_order_relaxed);
+		mReleaseCoefficient.store(1.0f - std::exp(-1.0f / (release * mSampleRate)), std::memory_order_relaxed);
+		return *this;
+	}
+
+
+	void PeakLimiter::process(float* frames, std::size_t numFrames, std::size_t numChannels)
+	{
+		if ((numChannels == 0) || (numChannels > mNumChannels)) {
+			return;
+		}
+
+		for (std::size_t offset = 0; offset < numFrames; offset += kChunkFrames) {
+			std::size_t count = std::min(numFrames - offset, kChunkFrames);
+			float* chunk = frames + offset * numChannels;
+
+			computePeaks(chunk, count, numChannels, mPeaks.data());
+			computeGains(count);
+			delayFrames(chunk, count, numChannels);
+			applyFrameGains(chunk, mDelayedFrames.data(), mGains.data(), count, numChannels);
+		}
+	}
+
+// Private functions
+	void PeakLimiter::computeGains(std::size_t numFrames)
+	{
+		const float threshold = mThreshold.load(std::memory_order_relaxed);
+		const float releaseCoefficient = mReleaseCoefficient.load(std::memory_order_relaxed);
+		const std::size_t minCapacity = mMinGains.size();
+
+		for (std::size_t i = 0; i < numFrames; ++i, ++mFrameNumber) {
+			float target = (mPeaks[i] > threshold)? threshold / mPeaks[i] : 1.0f;
+
+			// Sliding minimum over the last mLookahead + 1 frames, the
+			// gains that can't be the minimum anymore are discarded
+			while ((mMinCount > 0) && (mMinFrames[mMinFirst] + mLookahead < mFrameNumber)) {
+				mMinFirst = (mMinFirst + 1 < minCapacity)? mMinFirst + 1 : 0;
+				--mMinCount;
+			}
+			while ((mMinCount > 0) && (mMinGains[(mMinFirst + mMinCount - 1) % minCapacity] >= target)) {
+				--mMinCount;
+			}
+			std::size_t last = (mMinFirst + mMinCount) % minCapacity;
+			mMinGains[last] = target;
+			mMinFrames[last] = mFrameNumber;
+			++mMinCount;
+			float minimum = mMinGains[mMinFirst];
+
+			// Instant attack and one-pole release
+			mEnvelope = (minimum < mEnvelope)? minimum : mEnvelope + releaseCoefficient * (minimum - mEnvelope);
+
+			// Moving average over mLookahead frames, all the averaged gains
+			// are below the target gain of the frame being output
+			mAverageSum += mEnvelope - mAverageGains[mAverageIndex];
+			mAverageGains[mAverageIndex] = mEnvelope;
+			mAverageIndex = (mAverageIndex + 1 < mLookahead)? mAverageIndex + 1 : 0;
+			mGains[i] = std::min(static_cast<float>(mAverageSum / mLookahead), 1.0f);
+		}
+	}
+
+
+	void PeakLimiter::delayFrames(const float* frames, std::size_t numFrames, std::size_t numChannels)
+	{
+		// The delay line is stored with the AudioEngine channels
+		for (std::size_t i = 0; i < numFrames;) {
+			std::size_t count = std::min(numFrames - i, mLookahead - mDelayIndex);
+			for (std::size_t j = 0; j < count; ++j) {
+				float* delayed = mDelayLine.data() + (mDelayIndex + j) * mNumChannels;
+				std::memcpy(mDelayedFrames.data() + (i + j) * numChannels, delayed, numChannels * sizeof(float));
+				std::memcpy(delayed, frames + (i + j) * numChannels, numChannels * sizeof(float));
+			}
+
+			i += count;
+			mDelayIndex = (mDelayIndex + count < mLookahead)? mDelayIndex + count : 0;
+		}
+	}
+
+}
@@ -0,0 +1,183 @@
+#include <new>
+#include <cstring>
+#include <algorithm>
+#include "saudio/PoolAllocator.h"
+
+namespace saudio {
+
+	/** The header stored before the memory of each allocation */
+	struct BlockHeader
+	{
+		/** The index of the next free block, only used while the block is
+		 * free */
+		std::atomic<uint32_t> next;
+
+		/** The index of the block, PoolAllocator::kNullIndex if it was
+		 * allocated by the upstream Allocator */
+		uint32_t index;
+
+		/** The number of bytes requested for the allocation */
+		uint64_t size;
+	};
+
+
+	/** The number of bytes reserved for the header of each allocation, it
+	 * keeps the returned memory 16 bytes aligned */
+	static constexpr std::size_t kHeaderSize = 16;
+	static_assert(sizeof(BlockHeader) <= kHeaderSize, "The BlockHeader doesn't fit in its reserved space");
+
+
+	/** The Allocator used if there isn't any upstream one */
+	static Allocator sCAllocator;
+
+
+	PoolAllocator::PoolAllocator(const Config& config) :
+		mUpstream(config.upstream? config.upstream : &sCAllocator),
+		mBlockStride(0), mBlockCapacity(0), mNumBlocks(0), mBlocks(nullptr),
+		mFreeHead(kNullIndex), mNumUsedBlocks(0), mNumUpstreamAllocations(0)
+	{
+		mBlockCapacity = (config.blockSize + kHeaderSize - 1) / kHeaderSize * kHeaderSize;
+		mBlockStride = mBlockCapacity + kHeaderSize;
+
+		mBlocks = static_cast<unsigned char*>(mUpstream->allocate(config.numBlocks * mBlockStride));
+		if (!mBlocks) {
+			return;
+		}
+
+		mNumBlocks = static_cast<uint32_t>(config.numBlocks);
+		for (uint32_t i = 0; i < mNumBlocks; ++i) {
+			BlockHeader* header = new (getBlock(i)) BlockHeader();
+			header->next.store((i + 1 < mNumBlocks)? i + 1 : kNullIndex, std::memory_order_relaxed);
+			header->index = i;
+			header->size = 0;
+		}
+		mFreeHead.store((mNumBlocks > 0)? 0 : kNullIndex);
+	}
+
+
+	PoolAllocator::~PoolAllocator()
+	{
+		if (mBlocks) {
+			mUpstream->deallocate(mBlocks);
+			mBlocks = nullptr;
+		}
+	}
+
+
+	bool PoolAllocator::good() const
+	{
+		return mBlocks;
+	}
+
+
+	void* PoolAllocator::allocate(std::size_t size)
+	{
+		if (size <= mBlockCapacity) {
+			uint32_t index = popFreeBlock();
+			if (index != kNullIndex) {
+				mNumUsedBlocks.fetch_add(1, std::memory_order_relaxed);
+
+				BlockHeader* header = reinterpret_cast<BlockHeader*>(getBlock(index));
+				header->size = size;
+				return reinterpret_cast<unsigned char*>(header) + kHeaderSize;
+			}
+		}
+
+		void* memory = mUpstream->allocate(size + kHeaderSize);
+		if (!memory) {
+			return nullptr;
+		}
+		mNumUpstreamAllocations.fetch_add(1, std::memory_order_relaxed);
+
+		BlockHeader* header = new (memory) BlockHeader();
+		header->index = kNullIndex;
+		header->size = size;
+		return static_cast<unsigned char*>(memory) + kHeaderSize;
+	}
+
+
+	void* PoolAllocator::reallocate(void* ptr, std::size_t size)
+	{
+		if (!ptr) {
+			return allocate(size);
+		}
+
+		BlockHeader* header = reinterpret_cast<BlockHeader*>(static_cast<unsigned char*>(ptr) - kHeaderSize);
+		if (header->index != kNullIndex) {
+			if (size <= mBlockCapacity) {
+				// It still fits in the same block
+				header->size = size;
+				return ptr;
+			}
+		}
+		else if (size > mBlockCapacity) {
+			void* memory = mUpstream->reallocate(header, size + kHeaderSize);
+			if (!memory) {
+				return nullptr;
+			}
+
+			static_cast<BlockHeader*>(memory)->size = size;
+			return static_cast<unsigned char*>(memory) + kHeaderSize;
+		}
+
+		void* newPtr = allocate(size);
+		if (newPtr) {
+			std::memcpy(newPtr, ptr, std::min<std::size_t>(header->size, size));
+			deallocate(ptr);
+		}
+		return newPtr;
+	}
+
+
+	void PoolAllocator::deallocate(void* ptr)
+	{
+		if (!ptr) {
+			return;
+		}
+
+		BlockHeader* header = reinterpret_cast<BlockHeader*>(static_cast<unsigned char*>(ptr) - kHeaderSize);
+		if (header->index != kNullIndex) {
+			pushFreeBlock(header->index);
+			mNumUsedBlocks.fetch_sub(1, std::memory_order_relaxed);
+		}
+		else {
+			header->~BlockHeader();
+			mUpstream->deallocate(header);
+		}
+	}
+
+// Private functions
+	uint32_t PoolAllocator::popFreeBlock()
+	{
+		uint64_t head = mFreeHead.load(std::memory_order_acquire);
+		while (true) {
+			uint32_t index = static_cast<uint32_t>(head);
+			if (index == kNullIndex) {
+				return kNullIndex;
+			}
+
+			// If another thread pops the block meanwhile the tag of the head
+			// will change and the exchange will fail
+			uint32_t next = reinterpret_cast<BlockHeader*>(getBlock(index))->next.load(std::memory_order_relaxed);
+			uint64_t newHead = (((head >> 32) + 1) << 32) | next;
+			if (mFreeHead.compare_exchange_weak(head, newHead, std::memory_order_acquire, std::memory_order_acquire)) {
+				return index;
+			}
+		}
+	}
+
+
+	void PoolAllocator::pushFreeBlock(uint32_t index)
+	{
+		BlockHeader* header = reinterpret_cast<BlockHeader*>(getBlock(index));
+
+		uint64_t head = mFreeHead.load(std::memory_order_relaxed);
+		uint64_t newHead;
+		do {
+			header->next.store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+			newHead = (((head >> 32) + 1) << 32) | index;
+		}
+		while (!mFreeHead.compare_exchange_weak(head, newHead, std::memory_order_release, std::memory_order_relaxed));
+	}
+
+}
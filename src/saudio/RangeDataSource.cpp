@@ -0,0 +1,137 @@
+#include <algorithm>
+#include <miniaudio.h>
+#include "saudio/RangeDataSource.h"
+#include "saudio/FileDataSource.h"
+#include "saudio/AudioEngine.h"
+#include "LogWrapper.h"
+#include "ObjectAllocation.h"
+
+namespace saudio {
+
+	RangeDataSource::RangeDataSource(
+		AudioEngine& engine, const FileDataSource& source,
+		uint64_t beginFrame, uint64_t endFrame
+	) : IDataSource(), mContext(engine.getContext())
+	{
+		if (!source.good()) {
+			SAUDIO_ERROR_LOG(mContext) << "The FileDataSource isn't valid";
+			return;
+		}
+
+		// The decoded FileDataSources are resource manager data sources, the
+		// copy shares their decoded buffer but has its own cursor and range
+		auto existing = static_cast<const ma_resource_manager_data_source*>(source.getMADataSource());
+		ma_resource_manager* resourceManager = ma_engine_get_resource_manager(engine.getMAEngine());
+
+		mDataSource = makeObject<ma_resource_manager_data_source>(mContext);
+		ma_result result = ma_resource_manager_data_source_init_copy(resourceManager, existing, mDataSource.get());
+		if (result != MA_SUCCESS) {
+			SAUDIO_ERROR_LOG(mContext) << "Failed to reference the FileDataSource buffer, it must be fully decoded";
+			mDataSource = nullptr;
+			return;
+		}
+
+		ma_uint64 length = 0;
+		ma_data_source_get_length_in_pcm_frames(mDataSource.get(), &length);
+		endFrame = std::min<uint64_t>(endFrame, length);
+		if (beginFrame >= endFrame) {
+			SAUDIO_ERROR_LOG(mContext) << "Invalid range [" << beginFrame << ", " << endFrame << ")";
+			uninitInternal();
+			return;
+		}
+
+		result = ma_data_source_set_range_in_pcm_frames(mDataSource.get(), beginFrame, endFrame);
+		if (result != MA_SUCCESS) {
+			SAUDIO_ERROR_LOG(mContext) << "Failed to set the range [" << beginFrame << ", " << endFrame << ")";
+			uninitInternal();
+			return;
+		}
+
+		SAUDIO_DEBUG_LOG(mContext) << "Created RangeDataSource " << mDataSource.get()
+			<< " [" << beginFrame << ", " << endFrame << ")";
+	}
+
+
+	RangeDataSource::RangeDataSource(RangeDataSource&& other) :
+		mDataSource(std::move(other.mDataSource)), mContext(other.mContext) {}
+
+
+	RangeDataSource::~RangeDataSource()
+	{
+		if (mDataSource) {
+			uninitInternal();
+		}
+	}
+
+
+	RangeDataSource& RangeDataSource::operator=(RangeDataSource&& other)
+	{
+		if (mDataSource) {
+			uninitInternal();
+		}
+
+		mDataSource = std::move(other.mDataSource);
+		mContext = other.mContext;
+
+		return *this;
+	}
+
+
+	bool RangeDataSource::good() const
+	{
+		return (mDataSource != nullptr);
+	}
+
+
+	ma_data_source* RangeDataSource::getMADataSource() const
+	{
+		return mDataSource.get();
+	}
+
+
+	void RangeDataSource::getRange(uint64_t& beginFrame, uint64_t& endFrame) const
+	{
+		ma_uint64 begin = 0, end = 0;
+		ma_data_source_get_range_in_pcm_frames(mDataSource.get(), &begin, &end);
+		beginFrame = begin;
+		endFrame = end;
+	}
+
+
+	bool RangeDataSource::setLoopPoints(uint64_t beginFrame, uint64_t endFrame)
+	{
+		uint64_t rangeBegin, rangeEnd;
+		getRange(rangeBegin, rangeEnd);
+		endFrame = std::min<uint64_t>(endFrame, rangeEnd - rangeBegin);
+
+		ma_result result = ma_data_source_set_loop_point_in_pcm_frames(mDataSource.get(), beginFrame, endFrame);
+		if (result != MA_SUCCESS) {
+			SAUDIO_ERROR_LOG(mContext) << "Failed to set the loop points [" << beginFrame << ", " << endFrame << ")";
+			return false;
+		}
+
+		return true;
+	}
+
+
+	bool RangeDataSource::isLooping() const
+	{
+		return ma_data_source_is_looping(mDataSource.get());
+	}
+
+
+	RangeDataSource& RangeDataSource::setLooping(bool looping)
+	{
+		ma_data_source_set_looping(mDataSource.get(), looping);
+		return *this;
+	}
+
+// Private functions
+	void RangeDataSource::uninitInternal()
+	{
+		ma_resource_manager_data_source_uninit(mDataSource.get());
+		SAUDIO_DEBUG_LOG(mContext) << "Deleted RangeDataSource " << mDataSource.get();
+		mDataSource = nullptr;
+	}
+
+}
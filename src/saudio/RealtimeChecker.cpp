@@ -0,0 +1,291 @@
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include "saudio/RealtimeChecker.h"
+
+#if defined(SAUDIO_RT_CHECK) && defined(__linux__) && defined(__GLIBC__)
+	#define SAUDIO_RT_INTERPOSE
+	#include <poll.h>
+	#include <dlfcn.h>
+	#include <unistd.h>
+	#include <pthread.h>
+	#include <execinfo.h>
+	#include <sys/syscall.h>
+
+	// The TLS must not be allocated lazily, it's accessed from malloc
+	#define SAUDIO_RT_THREAD_LOCAL thread_local __attribute__((tls_model("initial-exec")))
+#else
+	#define SAUDIO_RT_THREAD_LOCAL thread_local
+#endif
+
+namespace saudio {
+
+	/** The number of nested real-time Scopes of the current thread */
+	static SAUDIO_RT_THREAD_LOCAL int tRealtimeDepth = 0;
+
+	/** The number of nested AllowScopes of the current thread, it's also
+	 * used while reporting a violation */
+	static SAUDIO_RT_THREAD_LOCAL int tAllowDepth = 0;
+
+	/** The number of violations detected */
+	static std::atomic<uint64_t> sNumViolations = 0;
+
+	/** The default ViolationHandler, it aborts the process */
+	static void abortHandler(const char*)
+	{
+		std::abort();
+	}
+
+	/** The function called on each violation */
+	static std::atomic<RealtimeChecker::ViolationHandler> sViolationHandler = &abortHandler;
+
+
+	RealtimeChecker::Scope::Scope()
+	{
+		++tRealtimeDepth;
+	}
+
+
+	RealtimeChecker::Scope::~Scope()
+	{
+		--tRealtimeDepth;
+	}
+
+
+	RealtimeChecker::AllowScope::AllowScope()
+	{
+		++tAllowDepth;
+	}
+
+
+	RealtimeChecker::AllowScope::~AllowScope()
+	{
+		--tAllowDepth;
+	}
+
+
+	bool RealtimeChecker::isEnabled()
+	{
+#ifdef SAUDIO_RT_INTERPOSE
+		return true;
+#else
+		return false;
+#endif
+	}
+
+
+	bool RealtimeChecker::isInRealtimeScope()
+	{
+		return tRealtimeDepth > 0;
+	}
+
+
+	void RealtimeChecker::setViolationHandler(ViolationHandler handler)
+	{
+		sViolationHandler.store(handler);
+	}
+
+
+	uint64_t RealtimeChecker::getNumViolations()
+	{
+		return sNumViolations.load(std::memory_order_relaxed);
+	}
+
+#ifdef SAUDIO_RT_INTERPOSE
+	/** Writes the given string to stderr without going through the
+	 * intercepted functions
+	 *
+	 * @param	str the string to write */
+	static void writeStderr(const char* str)
+	{
+		syscall(SYS_write, STDERR_FILENO, str, std::strlen(str));
+	}
+
+
+	/** Reports a violation, it prints the backtrace of the current thread
+	 * and calls the ViolationHandler
+	 *
+	 * @param	violation the name of the intercepted function */
+	static void reportViolation(const char* violation)
+	{
+		// The functions called while reporting must not be reported
+		++tAllowDepth;
+
+		sNumViolations.fetch_add(1, std::memory_order_relaxed);
+
+		writeStderr("saudio: real-time violation, ");
+		writeStderr(violation);
+		writeStderr(" called inside the audio callback\n");
+
+		void* frames[64];
+		int numFrames = backtrace(frames, 64);
+		backtrace_symbols_fd(frames, numFrames, STDERR_FILENO);
+
+		RealtimeChecker::ViolationHandler handler = sViolationHandler.load();
+		if (handler) {
+			handler(violation);
+		}
+
+		--tAllowDepth;
+	}
+
+
+	/** Checks if the current thread is inside a real-time Scope, and
+	 * reports the violation if it's the case
+	 *
+	 * @param	violation the name of the intercepted function */
+	static inline void checkRealtime(const char* violation)
+	{
+		if ((tRealtimeDepth > 0) && (tAllowDepth == 0)) {
+			reportViolation(violation);
+		}
+	}
+
+
+	/** Returns the next definition of the given function, the one that we
+	 * are intercepting
+	 *
+	 * @param	cache the variable where the function is cached
+	 * @param	name the name of the function
+	 * @return	a pointer to the function */
+	template <typename F>
+	static F getNext(std::atomic<F>& cache, const char* name)
+	{
+		F ret = cache.load(std::memory_order_relaxed);
+		if (!ret) {
+			// dlsym can allocate memory
+			++tAllowDepth;
+			ret = reinterpret_cast<F>(dlsym(RTLD_NEXT, name));
+			cache.store(ret, std::memory_order_relaxed);
+			--tAllowDepth;
+		}
+		return ret;
+	}
+
+
+	/** Loads the functions used while reporting before any real-time
+	 * Scope, since the first call to backtrace can allocate memory */
+	[[maybe_unused]] static const bool sInitialized = []() {
+		void* frame;
+		backtrace(&frame, 1);
+		return true;
+	}();
+#endif		// SAUDIO_RT_INTERPOSE
+
+}
+
+#ifdef SAUDIO_RT_INTERPOSE
+// The glibc allocation functions, they don't need dlsym, which can
+// allocate memory too
+extern "C" void* __libc_malloc(size_t size) noexcept;
+extern "C" void* __libc_calloc(size_t num, size_t size) noexcept;
+extern "C" void* __libc_realloc(void* ptr, size_t size) noexcept;
+extern "C" void* __libc_memalign(size_t alignment, size_t size) noexcept;
+extern "C" void __libc_free(void* ptr) noexcept;
+
+
+extern "C" void* malloc(size_t size) noexcept
+{
+	saudio::checkRealtime("malloc");
+	return __libc_malloc(size);
+}
+
+
+extern "C" void* calloc(size_t num, size_t size) noexcept
+{
+	saudio::checkRealtime("calloc");
+	return __libc_calloc(num, size);
+}
+
+
+extern "C" void* realloc(void* ptr, size_t size) noexcept
+{
+	saudio::checkRealtime("realloc");
+	return __libc_realloc(ptr, size);
+}
+
+
+extern "C" void* aligned_alloc(size_t alignment, size_t size) noexcept
+{
+	saudio::checkRealtime("aligned_alloc");
+	return __libc_memalign(alignment, size);
+}
+
+
+extern "C" int posix_memalign(void** ptr, size_t alignment, size_t size) noexcept
+{
+	saudio::checkRealtime("posix_memalign");
+	if ((alignment % sizeof(void*) != 0) || (alignment & (alignment - 1))) {
+		return EINVAL;
+	}
+
+	*ptr = __libc_memalign(alignment, size);
+	return *ptr? 0 : ENOMEM;
+}
+
+
+extern "C" void free(void* ptr) noexcept
+{
+	if (ptr) {
+		saudio::checkRealtime("free");
+	}
+	__libc_free(ptr);
+}
+
+
+extern "C" int pthread_mutex_lock(pthread_mutex_t* mutex) noexcept
+{
+	static std::atomic<int (*)(pthread_mutex_t*)> sNext = nullptr;
+	saudio::checkRealtime("pthread_mutex_lock");
+	return saudio::getNext(sNext, "pthread_mutex_lock")(mutex);
+}
+
+
+extern "C" int nanosleep(const struct timespec* duration, struct timespec* remaining)
+{
+	static std::atomic<int (*)(const struct timespec*, struct timespec*)> sNext = nullptr;
+	saudio::checkRealtime("nanosleep");
+	return saudio::getNext(sNext, "nanosleep")(duration, remaining);
+}
+
+
+extern "C" int usleep(useconds_t usec)
+{
+	static std::atomic<int (*)(useconds_t)> sNext = nullptr;
+	saudio::checkRealtime("usleep");
+	return saudio::getNext(sNext, "usleep")(usec);
+}
+
+
+extern "C" unsigned int sleep(unsigned int seconds)
+{
+	static std::atomic<unsigned int (*)(unsigned int)> sNext = nullptr;
+	saudio::checkRealtime("sleep");
+	return saudio::getNext(sNext, "sleep")(seconds);
+}
+
+
+extern "C" ssize_t read(int fd, void* buffer, size_t count)
+{
+	static std::atomic<ssize_t (*)(int, void*, size_t)> sNext = nullptr;
+	saudio::checkRealtime("read");
+	return saudio::getNext(sNext, "read")(fd, buffer, count);
+}
+
+
+extern "C" ssize_t write(int fd, const void* buffer, size_t count)
+{
+	static std::atomic<ssize_t (*)(int, const void*, size_t)> sNext = nullptr;
+	saudio::checkRealtime("write");
+	return saudio::getNext(sNext, "write")(fd, buffer, count);
+}
+
+
+extern "C" int poll(struct pollfd* fds, nfds_t nfds, int timeout)
+{
+	static std::atomic<int (*)(struct pollfd*, nfds_t, int)> sNext = nullptr;
+	saudio::checkRealtime("poll");
+	return saudio::getNext(sNext, "poll")(fds, nfds, timeout);
+}
+#endif		// SAUDIO_RT_INTERPOSE
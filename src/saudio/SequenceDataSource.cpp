@@ -0,0 +1,262 @@
+#include <thread>
+#include <algorithm>
+#include "SequenceDataSource.h"
+
+namespace saudio {
+
+	bool SequenceDataSource::init(ma_data_source* dataSource)
+	{
+		ma_result result = ma_data_source_get_data_format(
+			dataSource, &mFormat, &mChannels, &mSampleRate, mChannelMap, MA_MAX_CHANNELS
+		);
+		if (result != MA_SUCCESS) {
+			return false;
+		}
+
+		mVTable = {
+			&onRead, &onSeek, &onGetDataFormat, &onGetCursor, &onGetLength,
+			nullptr, 0
+		};
+
+		ma_data_source_config baseConfig = ma_data_source_config_init();
+		baseConfig.vtable = &mVTable;
+		if (ma_data_source_init(&baseConfig, &mBase) != MA_SUCCESS) {
+			return false;
+		}
+
+		mCurrent.store(dataSource, std::memory_order_relaxed);
+		mReplacement.store(nullptr, std::memory_order_relaxed);
+		mCurrentLoop = false;
+		mNumPushed.store(0, std::memory_order_relaxed);
+		mNumPopped.store(0, std::memory_order_relaxed);
+		mNumReplacesPushed.store(0, std::memory_order_relaxed);
+		mNumReplacesPopped.store(0, std::memory_order_relaxed);
+		mNumExitLoops.store(0, std::memory_order_relaxed);
+		mNumExitLoopsHandled = 0;
+		mNumCallbacks.store(0, std::memory_order_relaxed);
+		return true;
+	}
+
+
+	void SequenceDataSource::uninit()
+	{
+		ma_data_source_uninit(&mBase);
+	}
+
+
+	ma_data_source* SequenceDataSource::getMADataSource()
+	{
+		return &mBase;
+	}
+
+
+	bool SequenceDataSource::isCompatible(ma_data_source* dataSource) const
+	{
+		ma_format format;
+		ma_uint32 channels, sampleRate;
+		ma_result result = ma_data_source_get_data_format(dataSource, &format, &channels, &sampleRate, nullptr, 0);
+		return (result == MA_SUCCESS)
+			&& (format == mFormat) && (channels == mChannels) && (sampleRate == mSampleRate);
+	}
+
+
+	bool SequenceDataSource::push(ma_data_source* dataSource, bool loop, bool replace)
+	{
+		std::size_t numPushed = mNumPushed.load(std::memory_order_relaxed);
+		std::size_t numPopped = mNumPopped.load(std::memory_order_acquire);
+		if (numPushed - numPopped >= kMaxQueuedSources) {
+			return false;
+		}
+
+		mEntries[numPushed % kMaxQueuedSources] = { dataSource, loop, replace };
+		mNumPushed.store(numPushed + 1, std::memory_order_release);
+		if (replace) {
+			mReplacement.store(dataSource);
+			mNumReplacesPushed.fetch_add(1);
+
+			// The next callbacks will skip the replaced data sources, but
+			// the ones in progress could still be using them
+			while (mNumCallbacks.load() > 0) {
+				std::this_thread::yield();
+			}
+		}
+
+		return true;
+	}
+
+
+	void SequenceDataSource::exitLoop()
+	{
+		mNumExitLoops.fetch_add(1, std::memory_order_relaxed);
+	}
+
+// Private functions
+	void SequenceDataSource::setCurrent(const Entry& entry)
+	{
+		ma_data_source_seek_to_pcm_frame(entry.dataSource, 0);
+		mCurrent.store(entry.dataSource, std::memory_order_release);
+		mCurrentLoop = entry.loop;
+	}
+
+
+	bool SequenceDataSource::popEntry(Entry& entry)
+	{
+		std::size_t numPopped = mNumPopped.load(std::memory_order_relaxed);
+		if (numPopped == mNumPushed.load(std::memory_order_acquire)) {
+			return false;
+		}
+
+		entry = mEntries[numPopped % kMaxQueuedSources];
+		mNumPopped.store(numPopped + 1, std::memory_order_release);
+		if (entry.replace) {
+			mNumReplacesPopped.fetch_add(1);
+		}
+
+		return true;
+	}
+
+
+	void SequenceDataSource::applyReplaces()
+	{
+		// Skip the data sources replaced since the last call
+		Entry entry;
+		bool replaced = false;
+		while (mNumReplacesPopped.load(std::memory_order_relaxed) != mNumReplacesPushed.load()) {
+			if (!popEntry(entry)) {
+				break;
+			}
+			replaced = true;
+		}
+		if (replaced) {
+			setCurrent(entry);
+		}
+	}
+
+
+	ma_result SequenceDataSource::onRead(
+		ma_data_source* pDataSource, void* pFramesOut, ma_uint64 frameCount, ma_uint64* pFramesRead
+	) {
+		auto pThis = static_cast<SequenceDataSource*>(pDataSource);
+		pThis->mNumCallbacks.fetch_add(1);
+		pThis->applyReplaces();
+
+		ma_uint32 frameSize = ma_get_bytes_per_frame(pThis->mFormat, pThis->mChannels);
+		auto output = static_cast<unsigned char*>(pFramesOut);
+		ma_uint64 totalFramesRead = 0;
+		bool rewound = false;
+		while (totalFramesRead < frameCount) {
+			ma_data_source* current = pThis->mCurrent.load(std::memory_order_relaxed);
+			ma_uint64 framesRead = 0;
+			ma_result result = ma_data_source_read_pcm_frames(
+				current, output + totalFramesRead * frameSize, frameCount - totalFramesRead, &framesRead
+			);
+			totalFramesRead += framesRead;
+			if (framesRead > 0) {
+				rewound = false;
+				continue;
+			}
+			if (result != MA_AT_END) {
+				// The data source isn't ready yet (ie. a stream still loading)
+				break;
+			}
+
+			// The current data source ended, switch to the next one in the
+			// same read so there is no gap between them
+			std::size_t numExitLoops = pThis->mNumExitLoops.load(std::memory_order_relaxed);
+			if (pThis->mCurrentLoop && (pThis->mNumExitLoopsHandled == numExitLoops)) {
+				if (rewound) {
+					// The data source is empty, it can't be looped
+					break;
+				}
+				ma_data_source_seek_to_pcm_frame(current, 0);
+				rewound = true;
+			}
+			else {
+				// If there is nothing queued the last data source is kept, so
+				// it can be played again after seeking it
+				pThis->mNumExitLoopsHandled = numExitLoops;
+				pThis->mCurrentLoop = false;
+				Entry entry;
+				if (!pThis->popEntry(entry)) {
+					break;
+				}
+				pThis->setCurrent(entry);
+			}
+		}
+
+		if (pFramesRead) {
+			*pFramesRead = totalFramesRead;
+		}
+
+		pThis->mNumCallbacks.fetch_sub(1, std::memory_order_release);
+		return (totalFramesRead > 0)? MA_SUCCESS : MA_AT_END;
+	}
+
+
+	ma_result SequenceDataSource::onSeek(ma_data_source* pDataSource, ma_uint64 frameIndex)
+	{
+		auto pThis = static_cast<SequenceDataSource*>(pDataSource);
+		pThis->mNumCallbacks.fetch_add(1);
+
+		// miniaudio seeks from the audio thread, a pending replace must be
+		// applied first so the seek doesn't reach the replaced data source
+		pThis->applyReplaces();
+		ma_result result = ma_data_source_seek_to_pcm_frame(pThis->mCurrent.load(std::memory_order_relaxed), frameIndex);
+
+		pThis->mNumCallbacks.fetch_sub(1, std::memory_order_release);
+		return result;
+	}
+
+
+	ma_result SequenceDataSource::onGetDataFormat(
+		ma_data_source* pDataSource, ma_format* pFormat, ma_uint32* pChannels, ma_uint32* pSampleRate,
+		ma_channel* pChannelMap, size_t channelMapCap
+	) {
+		auto pThis = static_cast<SequenceDataSource*>(pDataSource);
+		*pFormat = pThis->mFormat;
+		*pChannels = pThis->mChannels;
+		*pSampleRate = pThis->mSampleRate;
+
+		std::size_t channelMapSize = std::min<std::size_t>(pThis->mChannels, channelMapCap);
+		std::copy(pThis->mChannelMap, pThis->mChannelMap + channelMapSize, pChannelMap);
+
+		return MA_SUCCESS;
+	}
+
+
+	ma_result SequenceDataSource::onGetCursor(ma_data_source* pDataSource, ma_uint64* pCursor)
+	{
+		auto pThis = static_cast<SequenceDataSource*>(pDataSource);
+		pThis->mNumCallbacks.fetch_add(1);
+
+		// It can be called from any thread, so the pending replaces can't
+		// be applied. The replacement will be played from its first frame
+		ma_result result = MA_SUCCESS;
+		if (pThis->mNumReplacesPopped.load() != pThis->mNumReplacesPushed.load()) {
+			*pCursor = 0;
+		}
+		else {
+			result = ma_data_source_get_cursor_in_pcm_frames(pThis->mCurrent.load(), pCursor);
+		}
+
+		pThis->mNumCallbacks.fetch_sub(1, std::memory_order_release);
+		return result;
+	}
+
+
+	ma_result SequenceDataSource::onGetLength(ma_data_source* pDataSource, ma_uint64* pLength)
+	{
+		auto pThis = static_cast<SequenceDataSource*>(pDataSource);
+		pThis->mNumCallbacks.fetch_add(1);
+
+		// It can be called from any thread, so the pending replaces can't
+		// be applied
+		ma_data_source* dataSource = (pThis->mNumReplacesPopped.load() != pThis->mNumReplacesPushed.load())?
+			pThis->mReplacement.load() : pThis->mCurrent.load();
+		ma_result result = ma_data_source_get_length_in_pcm_frames(dataSource, pLength);
+
+		pThis->mNumCallbacks.fetch_sub(1, std::memory_order_release);
+		return result;
+	}
+
+}
@@ -0,0 +1,167 @@
+#ifndef SAUDIO_SEQUENCE_DATA_SOURCE_H
+#define SAUDIO_SEQUENCE_DATA_SOURCE_H
+
+#include <atomic>
+#include <miniaudio.h>
+
+namespace saudio {
+
+	/**
+	 * Class SequenceDataSource, it's the miniaudio data source played by the
+	 * Sounds. It forwards the reads to the current data source and switches
+	 * to the queued ones in the audio thread, so the data sources can be
+	 * replaced or chained without reinitializing the Sound and at a sample
+	 * exact boundary. All the data sources must have the same format.
+	 *
+	 * @note	the queue is single producer single consumer, the queue
+	 *			functions must be called always from the same thread. It's
+	 *			released without calling its destructor, so it can be
+	 *			allocated with @see makeObject, @see uninit must be called
+	 *			instead
+	 */
+	class SequenceDataSource
+	{
+	public:		// Nested types
+		/** The maximum number of data sources waiting in the queue */
+		static constexpr std::size_t kMaxQueuedSources = 16;
+
+	private:
+		/** Holds a data source waiting in the queue */
+		struct Entry
+		{
+			/** The data source to play */
+			ma_data_source* dataSource;
+
+			/** If the data source must be repeated until @see exitLoop is
+			 * called */
+			bool loop;
+
+			/** If the data source must replace the current one and the ones
+			 * queued before it instead of waiting for them to end */
+			bool replace;
+		};
+
+	private:	// Attributes
+		/** The miniaudio data source, it must be the first attribute */
+		ma_data_source_base mBase;
+
+		/** The callbacks of @see mBase */
+		ma_data_source_vtable mVTable;
+
+		/** The format of all the data sources */
+		ma_format mFormat;
+		ma_uint32 mChannels;
+		ma_uint32 mSampleRate;
+		ma_channel mChannelMap[MA_MAX_CHANNELS];
+
+		/** The data source being read, it's only changed by the audio
+		 * thread */
+		std::atomic<ma_data_source*> mCurrent;
+
+		/** The data source of the last replace entry pushed, it's used
+		 * instead of @see mCurrent until the audio thread applies it */
+		std::atomic<ma_data_source*> mReplacement;
+
+		/** If @see mCurrent must be repeated */
+		bool mCurrentLoop;
+
+		/** The ring buffer with the queued data sources */
+		Entry mEntries[kMaxQueuedSources];
+
+		/** The number of entries pushed to and popped from @see mEntries */
+		std::atomic<std::size_t> mNumPushed, mNumPopped;
+
+		/** The number of replace entries pushed to and popped from
+		 * @see mEntries */
+		std::atomic<std::size_t> mNumReplacesPushed;
+		std::atomic<std::size_t> mNumReplacesPopped;
+
+		/** The number of times that @see exitLoop was called and the ones
+		 * handled by the audio thread */
+		std::atomic<std::size_t> mNumExitLoops;
+		std::size_t mNumExitLoopsHandled;
+
+		/** The number of callbacks in progress, so the replaced data
+		 * sources can be released safely */
+		std::atomic<uint32_t> mNumCallbacks;
+
+	public:		// Functions
+		/** Initializes the SequenceDataSource
+		 *
+		 * @param	dataSource the first data source to play, its format will
+		 *			be the one of the SequenceDataSource
+		 * @return	true on success, false otherwise */
+		bool init(ma_data_source* dataSource);
+
+		/** Uninitializes the SequenceDataSource, it must not be in use by
+		 * any Sound */
+		void uninit();
+
+		/** @return	a pointer to the miniaudio data source */
+		ma_data_source* getMADataSource();
+
+		/** Checks if the given data source can be queued
+		 *
+		 * @param	dataSource the data source to check
+		 * @return	true if its format is the same than the
+		 *			SequenceDataSource one, false otherwise */
+		bool isCompatible(ma_data_source* dataSource) const;
+
+		/** Queues the given data source
+		 *
+		 * @param	dataSource the data source to queue, it will be played
+		 *			from its first frame
+		 * @param	loop if the data source must be repeated until
+		 *			@see exitLoop is called
+		 * @param	replace true if the data source must replace the current
+		 *			one and the queued ones, false if it must be played
+		 *			after them
+		 * @return	true on success, false if the queue is full
+		 * @note	if replace is true it waits until the callbacks in
+		 *			progress finish, so after it returns the replaced data
+		 *			sources won't be accessed again and they can be
+		 *			destroyed. The replace is applied at the start of the
+		 *			next read or seek */
+		bool push(ma_data_source* dataSource, bool loop, bool replace);
+
+		/** Makes the current looping data source continue with the next
+		 * queued one when it reaches its end */
+		void exitLoop();
+	private:
+		/** Makes the given data source the current one
+		 *
+		 * @param	entry the Entry with the new data source */
+		void setCurrent(const Entry& entry);
+
+		/** Applies the replace entries pushed since the last call, it must
+		 * be called only from the audio thread */
+		void applyReplaces();
+
+		/** Pops the oldest Entry of the queue
+		 *
+		 * @param	entry a reference to the Entry where the popped one will
+		 *			be stored
+		 * @return	true if there was any Entry queued, false otherwise */
+		bool popEntry(Entry& entry);
+
+		static ma_result onRead(
+			ma_data_source* pDataSource, void* pFramesOut, ma_uint64 frameCount, ma_uint64* pFramesRead
+		);
+		static ma_result onSeek(
+			ma_data_source* pDataSource, ma_uint64 frameIndex
+		);
+		static ma_result onGetDataFormat(
+			ma_data_source* pDataSource, ma_format* pFormat, ma_uint32* pChannels, ma_uint32* pSampleRate,
+			ma_channel* pChannelMap, size_t channelMapCap
+		);
+		static ma_result onGetCursor(
+			ma_data_source* pDataSource, ma_uint64* pCursor
+		);
+		static ma_result onGetLength(
+			ma_data_source* pDataSource, ma_uint64* pLength
+		);
+	};
+
+}
+
+#endif		// SAUDIO_SEQUENCE_DATA_SOURCE_H
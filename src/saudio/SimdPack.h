@@ -0,0 +1,112 @@
+#ifndef SAUDIO_SIMD_PACK_H
+#define SAUDIO_SIMD_PACK_H
+
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
+
+#if defined(__AVX__)
+	#include <immintrin.h>
+	#define SAUDIO_SIMD_AVX
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+	#include <xmmintrin.h>
+	#define SAUDIO_SIMD_SSE
+#elif defined(__aarch64__) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+	#include <arm_neon.h>
+	#define SAUDIO_SIMD_NEON
+#endif
+
+namespace saudio {
+
+	/**
+	 * Struct Pack, it holds a group of floats processed with SIMD
+	 * instructions. The kernel math is written once with its operators
+	 * and compiled for each instruction set
+	 */
+#if defined(SAUDIO_SIMD_AVX)
+	struct Pack
+	{
+		static constexpr std::size_t kSize = 8;
+		__m256 v;
+
+		static Pack load(const float* p) { return { _mm256_loadu_ps(p) }; };
+		static Pack set(float f) { return { _mm256_set1_ps(f) }; };
+		void store(float* p) const { _mm256_storeu_ps(p, v); };
+	};
+
+	inline Pack operator+(Pack a, Pack b) { return { _mm256_add_ps(a.v, b.v) }; }
+	inline Pack operator-(Pack a, Pack b) { return { _mm256_sub_ps(a.v, b.v) }; }
+	inline Pack operator*(Pack a, Pack b) { return { _mm256_mul_ps(a.v, b.v) }; }
+	inline Pack operator/(Pack a, Pack b) { return { _mm256_div_ps(a.v, b.v) }; }
+	inline Pack min(Pack a, Pack b) { return { _mm256_min_ps(a.v, b.v) }; }
+	inline Pack max(Pack a, Pack b) { return { _mm256_max_ps(a.v, b.v) }; }
+	inline Pack sqrt(Pack a) { return { _mm256_sqrt_ps(a.v) }; }
+	inline Pack abs(Pack a) { return { _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v) }; }
+#elif defined(SAUDIO_SIMD_SSE)
+	struct Pack
+	{
+		static constexpr std::size_t kSize = 4;
+		__m128 v;
+
+		static Pack load(const float* p) { return { _mm_loadu_ps(p) }; };
+		static Pack set(float f) { return { _mm_set1_ps(f) }; };
+		void store(float* p) const { _mm_storeu_ps(p, v); };
+	};
+
+	inline Pack operator+(Pack a, Pack b) { return { _mm_add_ps(a.v, b.v) }; }
+	inline Pack operator-(Pack a, Pack b) { return { _mm_sub_ps(a.v, b.v) }; }
+	inline Pack operator*(Pack a, Pack b) { return { _mm_mul_ps(a.v, b.v) }; }
+	inline Pack operator/(Pack a, Pack b) { return { _mm_div_ps(a.v, b.v) }; }
+	inline Pack min(Pack a, Pack b) { return { _mm_min_ps(a.v, b.v) }; }
+	inline Pack max(Pack a, Pack b) { return { _mm_max_ps(a.v, b.v) }; }
+	inline Pack sqrt(Pack a) { return { _mm_sqrt_ps(a.v) }; }
+	inline Pack abs(Pack a) { return { _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v) }; }
+#elif defined(SAUDIO_SIMD_NEON)
+	struct Pack
+	{
+		static constexpr std::size_t kSize = 4;
+		float32x4_t v;
+
+		static Pack load(const float* p) { return { vld1q_f32(p) }; };
+		static Pack set(float f) { return { vdupq_n_f32(f) }; };
+		void store(float* p) const { vst1q_f32(p, v); };
+	};
+
+	inline Pack operator+(Pack a, Pack b) { return { vaddq_f32(a.v, b.v) }; }
+	inline Pack operator-(Pack a, Pack b) { return { vsubq_f32(a.v, b.v) }; }
+	inline Pack operator*(Pack a, Pack b) { return { vmulq_f32(a.v, b.v) }; }
+	inline Pack operator/(Pack a, Pack b) { return { vdivq_f32(a.v, b.v) }; }
+	inline Pack min(Pack a, Pack b) { return { vminq_f32(a.v, b.v) }; }
+	inline Pack max(Pack a, Pack b) { return { vmaxq_f32(a.v, b.v) }; }
+	inline Pack sqrt(Pack a) { return { vsqrtq_f32(a.v) }; }
+	inline Pack abs(Pack a) { return { vabsq_f32(a.v) }; }
+#else
+	struct Pack
+	{
+		static constexpr std::size_t kSize = 1;
+		float v;
+
+		static Pack load(const float* p) { return { *p }; };
+		static Pack set(float f) { return { f }; };
+		void store(float* p) const { *p = v; };
+	};
+
+	inline Pack operator+(Pack a, Pack b) { return { a.v + b.v }; }
+	inline Pack operator-(Pack a, Pack b) { return { a.v - b.v }; }
+	inline Pack operator*(Pack a, Pack b) { return { a.v * b.v }; }
+	inline Pack operator/(Pack a, Pack b) { return { a.v / b.v }; }
+	inline Pack min(Pack a, Pack b) { return { std::min(a.v, b.v) }; }
+	inline Pack max(Pack a, Pack b) { return { std::max(a.v, b.v) }; }
+	inline Pack sqrt(Pack a) { return { std::sqrt(a.v) }; }
+	inline Pack abs(Pack a) { return { std::fabs(a.v) }; }
+#endif
+
+	/** Clamps the given values between lo and hi */
+	inline Pack clamp(Pack a, Pack lo, Pack hi)
+	{
+		return min(max(a, lo), hi);
+	}
+
+}
+
+#endif		// SAUDIO_SIMD_PACK_H
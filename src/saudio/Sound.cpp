@@ -1,29 +1,53 @@
+#include <algorithm>
 #include <miniaudio.h>
+#include "saudio/Bus.h"
 #include "saudio/Sound.h"
 #include "saudio/IDataSource.h"
 #include "saudio/AudioEngine.h"
 #include "LogWrapper.h"
+#include "ObjectAllocation.h"
+#include "SequenceDataSource.h"
+#include "BatchSpatializer.h"
+#include "ParallelRenderer.h"
+#include "SoundScheduler.h"
 
 namespace saudio {
 
-	Sound::Sound(AudioEngine* audioEngine)
+	Sound::Sound(AudioEngine* audioEngine) :
+		mContext(audioEngine? audioEngine->getContext() : nullptr), mAudioEngine(audioEngine)
 	{
 		if (audioEngine) {
-			initInternal(audioEngine->getMAEngine());
+			initInternal(audioEngine->selectSoundEngine());
 		}
 		else {
-			SAUDIO_DEBUG_LOG << "No engine provided, no Sound initialized";
+			SAUDIO_DEBUG_LOG(mContext) << "No engine provided, no Sound initialized";
 		}
 	}
 
 
+	Sound::Sound(Bus& bus) :
+		mContext(bus.mContext), mAudioEngine(bus.mAudioEngine), mBus(&bus)
+	{
+		initInternal(mAudioEngine->getMAEngine());
+	}
+
+
 	Sound::Sound(const Sound& other)
 	{
 		*this = other;
 	}
 
 
-	Sound::Sound(Sound&& other) : mSound(std::move(other.mSound)) {}
+	Sound::Sound(Sound&& other) :
+		mSound(std::move(other.mSound)), mSequence(std::move(other.mSequence)),
+		mContext(other.mContext), mAudioEngine(other.mAudioEngine),
+		mBatchSpatializer(other.mBatchSpatializer), mVoice(other.mVoice), mBus(other.mBus),
+		mEffectBus(std::move(other.mEffectBus)), mEndData(std::move(other.mEndData))
+	{
+		other.mBatchSpatializer = nullptr;
+		other.mVoice = -1;
+		other.mBus = nullptr;
+	}
 
 
 	Sound::~Sound()
@@ -44,7 +68,13 @@ namespace saudio {
 
 		ma_sound* sound = other.mSound.get();
 		ma_engine* engine = ma_sound_get_engine(other.mSound.get());
-		copyInternal(sound, engine);
+		mContext = other.mContext;
+		mAudioEngine = other.mAudioEngine;
+		mBus = other.mBus;
+		mEffectBus = nullptr;
+		if (copyInternal(sound, engine)) {
+			setSpacialization( other.hasSpacialization() );
+		}
 		return *this;
 	}
 
@@ -57,6 +87,17 @@ namespace saudio {
 		}
 
 		mSound = std::move(other.mSound);
+		mSequence = std::move(other.mSequence);
+		mContext = other.mContext;
+		mAudioEngine = other.mAudioEngine;
+		mBatchSpatializer = other.mBatchSpatializer;
+		mVoice = other.mVoice;
+		mBus = other.mBus;
+		mEffectBus = std::move(other.mEffectBus);
+		mEndData = std::move(other.mEndData);
+		other.mBatchSpatializer = nullptr;
+		other.mVoice = -1;
+		other.mBus = nullptr;
 
 		return *this;
 	}
@@ -65,10 +106,14 @@ namespace saudio {
 	Sound Sound::copy(const Sound& other, AudioEngine* audioEngine)
 	{
 		ma_sound* sound = other.mSound.get();
-		ma_engine* engine = audioEngine->getMAEngine();
+		ma_engine* engine = audioEngine->selectSoundEngine();
 
 		Sound ret;
-		ret.copyInternal(sound, engine);
+		ret.mContext = audioEngine->getContext();
+		ret.mAudioEngine = audioEngine;
+		if (ret.copyInternal(sound, engine)) {
+			ret.setSpacialization( other.hasSpacialization() );
+		}
 		return ret;
 	}
 
@@ -79,6 +124,12 @@ namespace saudio {
 	}
 
 
+	Sound::Handle Sound::getHandle() const
+	{
+		return mEndData? mEndData->handle : 0;
+	}
+
+
 	bool Sound::isPlaying() const
 	{
 		return ma_sound_is_playing(mSound.get());
@@ -87,17 +138,78 @@ namespace saudio {
 
 	bool Sound::hasSpacialization() const
 	{
+		if (mBatchSpatializer) {
+			return mBatchSpatializer->isSpatialized(mVoice);
+		}
+
 		return ma_sound_is_spatialization_enabled(mSound.get());
 	}
 
 
 	Sound& Sound::setSpacialization(bool value)
 	{
-		ma_sound_set_spatialization_enabled(mSound.get(), value);
+		if (mBatchSpatializer) {
+			mBatchSpatializer->setSpatialized(mVoice, value);
+		}
+		else {
+			ma_sound_set_spatialization_enabled(mSound.get(), value);
+		}
 		return *this;
 	}
 
 
+	Bus* Sound::getBus() const
+	{
+		return mBus;
+	}
+
+
+	bool Sound::setBus(Bus* bus)
+	{
+		if (!mSound) {
+			return false;
+		}
+		if (bus && (!bus->good() || (bus->mAudioEngine->getMAEngine() != ma_sound_get_engine(mSound.get())))) {
+			SAUDIO_ERROR_LOG(mContext) << "Sound " << mSound.get() << " isn't rendered by the engine of the Bus, it must be created with it";
+			return false;
+		}
+
+		mBus = bus;
+		attachToOutput();
+		return true;
+	}
+
+
+	bool Sound::addEffect(IEffect& effect)
+	{
+		if (!mSound || !mAudioEngine) {
+			return false;
+		}
+
+		if (!mEffectBus) {
+			ma_engine* engine = ma_sound_get_engine(mSound.get());
+			auto effectBus = makeObjectWith<Bus>(mContext, AllocationCategory::Engine, [&](void* ptr) {
+				return new (ptr) Bus(*mAudioEngine, engine);
+			});
+			if (!effectBus || !effectBus->good()) {
+				SAUDIO_ERROR_LOG(mContext) << "Failed to create the effect Bus of Sound " << mSound.get();
+				return false;
+			}
+
+			mEffectBus = std::move(effectBus);
+			attachToOutput();
+		}
+
+		return mEffectBus->addEffect(effect);
+	}
+
+
+	bool Sound::removeEffect(IEffect& effect)
+	{
+		return mEffectBus && mEffectBus->removeEffect(effect);
+	}
+
+
 	glm::vec3 Sound::getPosition() const
 	{
 		ma_vec3f pos = ma_sound_get_position(mSound.get());
@@ -197,15 +309,38 @@ namespace saudio {
 		ma_engine* engine = ma_sound_get_engine(mSound.get());
 		ma_data_source* dataSource = source->getMADataSource();
 
+		// Replace the data source without reinitializing the sound
+		if (mSequence && mSequence->isCompatible(dataSource) && mSequence->push(dataSource, false, true)) {
+			SAUDIO_DEBUG_LOG(mContext) << "Replaced the DataSource of Sound " << mSound.get() << " with " << dataSource;
+			return *this;
+		}
+
 		Sound other;
-		other.mSound = std::make_unique<ma_sound>();
-		ma_result res = ma_sound_init_from_data_source(engine, dataSource, 0, nullptr, other.mSound.get());
+		other.mContext = mContext;
+		other.mAudioEngine = mAudioEngine;
+		other.mBus = mBus;
+		other.mSequence = makeObject<SequenceDataSource>(mContext);
+		if (!other.mSequence || !other.mSequence->init(dataSource)) {
+			SAUDIO_ERROR_LOG(mContext) << "Failed to create the sequence data source";
+			other.mSequence = nullptr;
+			return *this;
+		}
+
+		other.mSound = makeObject<ma_sound>(mContext);
+		ma_result res = ma_sound_init_from_data_source(engine, other.mSequence->getMADataSource(), 0, nullptr, other.mSound.get());
 		if (res != MA_SUCCESS) {
-			SAUDIO_ERROR_LOG << "Failed to create the sound";
+			SAUDIO_ERROR_LOG(mContext) << "Failed to create the sound";
+			other.mSound = nullptr;
+			other.mSequence->uninit();
+			other.mSequence = nullptr;
 			return *this;
 		}
 
-		SAUDIO_DEBUG_LOG << "Created Sound " << other.mSound.get() << " with DataSource " << dataSource;
+		SAUDIO_DEBUG_LOG(mContext) << "Created Sound " << other.mSound.get() << " with DataSource " << dataSource;
+
+		other.mEffectBus = std::move(mEffectBus);
+		other.setEndCallback();
+		other.registerInEngine();
 
 		other.setPosition( getPosition() );
 		other.setOrientation( getOrientation() );
@@ -235,6 +370,36 @@ namespace saudio {
 	}
 
 
+	bool Sound::queueNext(IDataSource* source, bool loop)
+	{
+		if (!mSequence) {
+			SAUDIO_ERROR_LOG(mContext) << "The Sound has no IDataSource binded";
+			return false;
+		}
+
+		ma_data_source* dataSource = source->getMADataSource();
+		if (!mSequence->isCompatible(dataSource)) {
+			SAUDIO_ERROR_LOG(mContext) << "The format of the DataSource " << dataSource << " doesn't match the binded one";
+			return false;
+		}
+
+		if (!mSequence->push(dataSource, loop, false)) {
+			SAUDIO_ERROR_LOG(mContext) << "The DataSource queue of Sound " << mSound.get() << " is full";
+			return false;
+		}
+
+		return true;
+	}
+
+
+	void Sound::exitLoop() const
+	{
+		if (mSequence) {
+			mSequence->exitLoop();
+		}
+	}
+
+
 	void Sound::play() const
 	{
 		ma_sound_start(mSound.get());
@@ -259,47 +424,221 @@ namespace saudio {
 		setToPCMFrame(0);
 	}
 
+
+	bool Sound::playAt(uint64_t engineFrame) const
+	{
+		AudioEngine::ScheduleBatch::Command command;
+		command.type = AudioEngine::ScheduleBatch::Command::Type::Start;
+		command.soundHandle = getHandle();
+		command.frame = engineFrame;
+		return mAudioEngine && mAudioEngine->commit(&command, 1, nullptr, 0);
+	}
+
+
+	bool Sound::stopAt(uint64_t engineFrame) const
+	{
+		AudioEngine::ScheduleBatch::Command command;
+		command.type = AudioEngine::ScheduleBatch::Command::Type::Stop;
+		command.soundHandle = getHandle();
+		command.frame = engineFrame;
+		return mAudioEngine && mAudioEngine->commit(&command, 1, nullptr, 0);
+	}
+
+
+	bool Sound::setToPCMFrameAt(uint64_t engineFrame, uint64_t frame) const
+	{
+		AudioEngine::ScheduleBatch::Command command;
+		command.type = AudioEngine::ScheduleBatch::Command::Type::Seek;
+		command.soundHandle = getHandle();
+		command.frame = engineFrame;
+		command.seekFrame = frame;
+		return mAudioEngine && mAudioEngine->commit(&command, 1, nullptr, 0);
+	}
+
+
+	bool Sound::rampVolume(float volume, uint64_t frameCount) const
+	{
+		AutomationPoint point;
+		point.frame = frameCount;
+		point.value = glm::vec3(volume);
+		return automate(AutomationParameter::Volume, &point, 1);
+	}
+
+
+	bool Sound::rampPitch(float pitch, uint64_t frameCount) const
+	{
+		AutomationPoint point;
+		point.frame = frameCount;
+		point.value = glm::vec3(pitch);
+		return automate(AutomationParameter::Pitch, &point, 1);
+	}
+
+
+	bool Sound::rampPosition(const glm::vec3& position, uint64_t frameCount) const
+	{
+		AutomationPoint point;
+		point.frame = frameCount;
+		point.value = position;
+		return automate(AutomationParameter::Position, &point, 1);
+	}
+
+
+	bool Sound::automate(
+		AutomationParameter parameter,
+		const AutomationPoint* points, std::size_t numPoints,
+		uint64_t engineFrame
+	) const {
+		if (numPoints > kMaxAutomationPoints) {
+			SAUDIO_WARN_LOG(mContext) << "Only the first " << kMaxAutomationPoints << " AutomationPoints will be used";
+			numPoints = kMaxAutomationPoints;
+		}
+
+		AudioEngine::ScheduleBatch::Command command;
+		command.type = AudioEngine::ScheduleBatch::Command::Type::Automate;
+		command.soundHandle = getHandle();
+		command.frame = engineFrame;
+		command.parameter = parameter;
+
+		AudioEngine::ScheduleBatch::AutomationCurve curve;
+		curve.numPoints = numPoints;
+		std::copy(points, points + numPoints, curve.points);
+		return mAudioEngine && mAudioEngine->commit(&command, 1, &curve, 1);
+	}
+
 // Private functions
 	bool Sound::initInternal(ma_engine* engine)
 	{
-		mSound = std::make_unique<ma_sound>();
+		mSound = makeObject<ma_sound>(mContext);
 
 		ma_sound_config soundConfig = {};
 		soundConfig = ma_sound_config_init();
 
 		ma_result res = ma_sound_init_ex(engine, &soundConfig, mSound.get());
 		if (res != MA_SUCCESS) {
-			SAUDIO_ERROR_LOG << "Failed to create the sound";
+			SAUDIO_ERROR_LOG(mContext) << "Failed to create the sound";
 			mSound = nullptr;
 			return false;
 		}
 		ma_sound_stop(mSound.get());
+		setEndCallback();
+		registerInEngine();
 
-		SAUDIO_DEBUG_LOG << "Created Sound " << mSound.get();
+		SAUDIO_DEBUG_LOG(mContext) << "Created Sound " << mSound.get();
 		return true;
 	}
 
 
 	bool Sound::copyInternal(ma_sound* other, ma_engine* engine)
 	{
-		mSound = std::make_unique<ma_sound>();
+		mSound = makeObject<ma_sound>(mContext);
 		ma_result res = ma_sound_init_copy(engine, other, 0, nullptr, mSound.get());
 		if (res != MA_SUCCESS) {
-			SAUDIO_ERROR_LOG << "Failed to create the sound";
+			SAUDIO_ERROR_LOG(mContext) << "Failed to create the sound";
 			mSound = nullptr;
 			return false;
 		}
+		setEndCallback();
+		registerInEngine();
 
-		SAUDIO_DEBUG_LOG << "Created Sound " << mSound.get();
+		SAUDIO_DEBUG_LOG(mContext) << "Created Sound " << mSound.get();
 		return true;
 	}
 
 
+	void Sound::setEndCallback()
+	{
+		if (!mAudioEngine) {
+			return;
+		}
+
+		mEndData = makeObject<EndCallbackData>(mContext);
+		if (!mEndData) {
+			SAUDIO_ERROR_LOG(mContext) << "Failed to allocate the end callback data, no SoundEvents will be generated";
+			return;
+		}
+
+		mEndData->audioEngine = mAudioEngine;
+		mEndData->handle = mAudioEngine->mNextSoundHandle.fetch_add(1, std::memory_order_relaxed);
+		ma_sound_set_end_callback(mSound.get(), &AudioEngine::onMASoundEnd, mEndData.get());
+	}
+
+
+	void Sound::registerInEngine()
+	{
+		if (!mAudioEngine) {
+			return;
+		}
+
+		ma_engine* engine = ma_sound_get_engine(mSound.get());
+		if (mAudioEngine->mRenderer) {
+			mAudioEngine->mRenderer->updateNumSounds(engine, true);
+		}
+
+		if (mEndData && mAudioEngine->mScheduler) {
+			mAudioEngine->mScheduler->addSound(mEndData->handle, mSound.get(), mAudioEngine->getEngineIndex(engine));
+		}
+
+		mBatchSpatializer = mAudioEngine->getBatchSpatializer(engine);
+		if (mBatchSpatializer) {
+			bool spatialized = ma_sound_is_spatialization_enabled(mSound.get());
+			mVoice = mBatchSpatializer->addVoice(mSound.get(), spatialized);
+			if (mVoice < 0) {
+				SAUDIO_WARN_LOG(mContext) << "No free batch voices, Sound " << mSound.get() << " will be spatialized by miniaudio";
+				mBatchSpatializer = nullptr;
+			}
+		}
+
+		if (mBus || mEffectBus) {
+			attachToOutput();
+		}
+	}
+
+
+	void Sound::attachToOutput()
+	{
+		ma_node* output = mBus? static_cast<ma_node*>(mBus->mNode.get()) : nullptr;
+		if (mEffectBus) {
+			mEffectBus->setOutput(mBus);
+			output = static_cast<ma_node*>(mEffectBus->mNode.get());
+		}
+
+		if (mBatchSpatializer) {
+			mBatchSpatializer->setOutput(mVoice, output);
+		}
+		else {
+			ma_engine* engine = ma_sound_get_engine(mSound.get());
+			ma_node_attach_output_bus(mSound.get(), 0, output? output : ma_engine_get_endpoint(engine), 0);
+		}
+	}
+
+
 	void Sound::uninitInternal()
 	{
+		if (mBatchSpatializer) {
+			mBatchSpatializer->removeVoice(mVoice);
+			mBatchSpatializer = nullptr;
+			mVoice = -1;
+		}
+
+		if (mAudioEngine && mAudioEngine->mRenderer) {
+			mAudioEngine->mRenderer->updateNumSounds(ma_sound_get_engine(mSound.get()), false);
+		}
+
+		// The audio thread must not apply the scheduled commands to the
+		// uninitialized sound
+		if (mEndData && mAudioEngine && mAudioEngine->mScheduler) {
+			mAudioEngine->mScheduler->removeSound(mEndData->handle);
+		}
+
 		ma_sound_uninit(mSound.get());
-		SAUDIO_DEBUG_LOG << "Deleted Sound " << mSound.get();
+		SAUDIO_DEBUG_LOG(mContext) << "Deleted Sound " << mSound.get();
 		mSound = nullptr;
+		mEndData = nullptr;
+
+		if (mSequence) {
+			mSequence->uninit();
+			mSequence = nullptr;
+		}
 	}
 
 }
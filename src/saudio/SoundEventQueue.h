@@ -0,0 +1,21 @@
+#ifndef SAUDIO_SOUND_EVENT_QUEUE_H
+#define SAUDIO_SOUND_EVENT_QUEUE_H
+
+#include "saudio/SoundEvent.h"
+#include "MPSCQueue.h"
+
+namespace saudio {
+
+	/**
+	 * Class SoundEventQueue, it's the MPSCQueue where the audio threads
+	 * push the SoundEvents of the AudioEngine
+	 */
+	class SoundEventQueue : public MPSCQueue<SoundEvent>
+	{
+	public:		// Functions
+		using MPSCQueue<SoundEvent>::MPSCQueue;
+	};
+
+}
+
+#endif		// SAUDIO_SOUND_EVENT_QUEUE_H
@@ -0,0 +1,337 @@
+#include <thread>
+#include <algorithm>
+#include <miniaudio.h>
+#include "SoundScheduler.h"
+
+namespace saudio {
+
+	SoundScheduler::SoundScheduler(
+		std::size_t capacity, std::size_t maxAutomations,
+		uint32_t automationBlockSize
+	) : mMask(0), mNumPushed(0), mNumPopped(0), mCurvesMask(0), mNumCurvesPushed(0), mNumCurvesPopped(0),
+		mStateOwner(kOwnerNone), mNumPendingSeeks(0),
+		mAutomations(maxAutomations), mNumAutomations(0),
+		mAutomationBlockSize(std::max<uint64_t>(automationBlockSize, 1))
+	{
+		std::size_t numSlots = 2;
+		while (numSlots < capacity) {
+			numSlots *= 2;
+		}
+
+		mCommands.resize(numSlots);
+		mMask = numSlots - 1;
+
+		std::size_t numCurveSlots = 2;
+		while (numCurveSlots < maxAutomations) {
+			numCurveSlots *= 2;
+		}
+
+		mCurves.resize(numCurveSlots);
+		mCurvesMask = numCurveSlots - 1;
+	}
+
+
+	bool SoundScheduler::push(
+		const Command* commands, std::size_t count,
+		const AutomationCurve* curves, std::size_t numCurves
+	) {
+		std::lock_guard lock(mProducerMutex);
+
+		std::size_t numPushed = mNumPushed.load(std::memory_order_relaxed);
+		std::size_t numPopped = mNumPopped.load(std::memory_order_acquire);
+		std::size_t numCurvesPushed = mNumCurvesPushed.load(std::memory_order_relaxed);
+		std::size_t numCurvesPopped = mNumCurvesPopped.load(std::memory_order_acquire);
+		if ((count > mCommands.size() - (numPushed - numPopped))
+			|| (numCurves > mCurves.size() - (numCurvesPushed - numCurvesPopped))
+		) {
+			return false;
+		}
+
+		// The sounds are resolved with the producer mutex locked, so they
+		// can't be removed until the commands are published
+		for (std::size_t i = 0; i < count; ++i) {
+			Command& command = mCommands[(numPushed + i) & mMask];
+			command = commands[i];
+			auto it = mSounds.find(command.soundHandle);
+			command.sound = (it != mSounds.end())? it->second.first : nullptr;
+			command.engineIndex = (it != mSounds.end())? it->second.second : 0;
+		}
+		for (std::size_t i = 0; i < numCurves; ++i) {
+			mCurves[(numCurvesPushed + i) & mCurvesMask] = curves[i];
+		}
+
+		// All the commands are published at once, the curves are visible
+		// after acquiring the commands
+		mNumCurvesPushed.store(numCurvesPushed + numCurves, std::memory_order_relaxed);
+		mNumPushed.store(numPushed + count, std::memory_order_release);
+		return true;
+	}
+
+
+	void SoundScheduler::addSound(uint64_t handle, ma_sound* sound, std::size_t engineIndex)
+	{
+		std::lock_guard lock(mProducerMutex);
+		mSounds[handle] = { sound, engineIndex };
+	}
+
+
+	void SoundScheduler::removeSound(uint64_t handle)
+	{
+		std::lock_guard lock(mProducerMutex);
+
+		auto itSound = mSounds.find(handle);
+		if (itSound == mSounds.end()) {
+			return;
+		}
+
+		ma_sound* sound = itSound->second.first;
+		mSounds.erase(itSound);
+
+		// Wait until the audio thread finishes its current block
+		int owner = kOwnerNone;
+		while (!mStateOwner.compare_exchange_weak(owner, kOwnerCanceller, std::memory_order_acquire)) {
+			owner = kOwnerNone;
+			std::this_thread::yield();
+		}
+
+		// The commands in the ring buffer are disabled, since only the
+		// audio thread can pop them
+		std::size_t numPopped = mNumPopped.load(std::memory_order_relaxed);
+		std::size_t numPushed = mNumPushed.load(std::memory_order_relaxed);
+		for (; numPopped != numPushed; ++numPopped) {
+			Command& command = mCommands[numPopped & mMask];
+			if (command.sound == sound) {
+				command.sound = nullptr;
+			}
+		}
+
+		// The seeks and automations are marked like the applied ones
+		for (std::size_t i = 0; i < mNumPendingSeeks; ++i) {
+			if (mPendingSeeks[i].sound == sound) {
+				mPendingSeeks[i].sound = nullptr;
+			}
+		}
+		for (std::size_t i = 0; i < mNumAutomations; ++i) {
+			if (mAutomations[i].command.sound == sound) {
+				mAutomations[i].command.sound = nullptr;
+			}
+		}
+
+		mStateOwner.store(kOwnerNone, std::memory_order_release);
+	}
+
+
+	bool SoundScheduler::beginBlock()
+	{
+		int owner = kOwnerNone;
+		return mStateOwner.compare_exchange_strong(owner, kOwnerAudioThread, std::memory_order_acquire);
+	}
+
+
+	void SoundScheduler::endBlock()
+	{
+		mStateOwner.store(kOwnerNone, std::memory_order_release);
+	}
+
+
+	void SoundScheduler::update(uint64_t time)
+	{
+		// Remove the seeks and automations marked in the previous blocks
+		Command* seeksEnd = std::remove_if(mPendingSeeks, mPendingSeeks + mNumPendingSeeks, [](const Command& command) {
+			return !command.sound;
+		});
+		mNumPendingSeeks = seeksEnd - mPendingSeeks;
+
+		for (std::size_t i = 0; i < mNumAutomations;) {
+			if (!mAutomations[i].command.sound) {
+				std::swap(mAutomations[i], mAutomations[--mNumAutomations]);
+			}
+			else {
+				++i;
+			}
+		}
+
+		std::size_t numPopped = mNumPopped.load(std::memory_order_relaxed);
+		std::size_t numPushed = mNumPushed.load(std::memory_order_acquire);
+		std::size_t numCurvesPopped = mNumCurvesPopped.load(std::memory_order_relaxed);
+		for (; numPopped != numPushed; ++numPopped) {
+			const Command& command = mCommands[numPopped & mMask];
+			if (command.type == Command::Type::Automate) {
+				// The curves of the cancelled commands are also popped
+				const AutomationCurve& curve = mCurves[numCurvesPopped++ & mCurvesMask];
+				if (command.sound) {
+					addAutomation(command, curve);
+				}
+			}
+			else if (!command.sound) {
+				// Cancelled command
+				continue;
+			}
+			else if ((command.type != Command::Type::Seek) || (command.frame <= time)) {
+				apply(command);
+			}
+			else if (mNumPendingSeeks < kMaxPendingSeeks) {
+				// Insert the seek keeping them sorted by frame
+				Command* seeksEnd = mPendingSeeks + mNumPendingSeeks;
+				Command* it = std::upper_bound(mPendingSeeks, seeksEnd, command, [](const Command& lhs, const Command& rhs) {
+					return lhs.frame < rhs.frame;
+				});
+				std::move_backward(it, seeksEnd, seeksEnd + 1);
+				*it = command;
+				++mNumPendingSeeks;
+			}
+			else {
+				// There is no space left, the seek is applied now
+				apply(command);
+			}
+		}
+
+		mNumCurvesPopped.store(numCurvesPopped, std::memory_order_release);
+		mNumPopped.store(numPopped, std::memory_order_release);
+	}
+
+
+	uint64_t SoundScheduler::process(std::size_t engineIndex, uint64_t time, uint64_t frameCount)
+	{
+		// The applied seeks and the finished automations are only marked,
+		// since the ones of other engines can be processed at the same time.
+		// The engine index is checked first, so the other entries aren't
+		// read
+		for (std::size_t i = 0; i < mNumPendingSeeks; ++i) {
+			Command& seek = mPendingSeeks[i];
+			if ((seek.engineIndex != engineIndex) || !seek.sound) {
+				continue;
+			}
+
+			if (seek.frame <= time) {
+				apply(seek);
+				seek.sound = nullptr;
+			}
+			else {
+				frameCount = std::min(frameCount, seek.frame - time);
+			}
+		}
+
+		for (std::size_t i = 0; i < mNumAutomations; ++i) {
+			Automation& automation = mAutomations[i];
+			if ((automation.command.engineIndex != engineIndex) || !automation.command.sound) {
+				continue;
+			}
+
+			if (automation.command.frame > time) {
+				frameCount = std::min(frameCount, automation.command.frame - time);
+			}
+			else if (evaluate(automation, time)) {
+				automation.command.sound = nullptr;
+			}
+			else {
+				frameCount = std::min(frameCount, mAutomationBlockSize);
+			}
+		}
+
+		return frameCount;
+	}
+
+// Private functions
+	void SoundScheduler::addAutomation(const Command& command, const AutomationCurve& curve)
+	{
+		auto itEnd = mAutomations.begin() + mNumAutomations;
+		auto it = std::find_if(mAutomations.begin(), itEnd, [&](const Automation& automation) {
+			return (automation.command.sound == command.sound)
+				&& (automation.command.parameter == command.parameter);
+		});
+		if (it == itEnd) {
+			if (mNumAutomations == mAutomations.size()) {
+				return;
+			}
+			++mNumAutomations;
+		}
+
+		it->command = command;
+		it->curve = curve;
+		it->started = false;
+		it->startValue = glm::vec3(0.0f);
+	}
+
+
+	bool SoundScheduler::evaluate(Automation& automation, uint64_t time)
+	{
+		const Command& command = automation.command;
+		if (!automation.started) {
+			automation.startValue = getValue(command.sound, command.parameter);
+			automation.started = true;
+		}
+
+		// Find the segment of the curve of the current frame and interpolate
+		// its values
+		uint64_t frame = time - command.frame;
+		uint64_t previousFrame = 0;
+		glm::vec3 previousValue = automation.startValue;
+		const AutomationCurve& curve = automation.curve;
+		for (std::size_t i = 0; i < curve.numPoints; ++i) {
+			const AutomationPoint& point = curve.points[i];
+			if (frame < point.frame) {
+				float weight = static_cast<float>(frame - previousFrame) / (point.frame - previousFrame);
+				setValue(command.sound, command.parameter, glm::mix(previousValue, point.value, weight));
+				return false;
+			}
+
+			previousFrame = point.frame;
+			previousValue = point.value;
+		}
+
+		setValue(command.sound, command.parameter, previousValue);
+		return true;
+	}
+
+
+	glm::vec3 SoundScheduler::getValue(ma_sound* sound, AutomationParameter parameter)
+	{
+		switch (parameter) {
+			case AutomationParameter::Volume:
+				return glm::vec3(ma_sound_get_volume(sound));
+			case AutomationParameter::Pitch:
+				return glm::vec3(ma_sound_get_pitch(sound));
+			default: {
+				ma_vec3f position = ma_sound_get_position(sound);
+				return { position.x, position.y, position.z };
+			}
+		}
+	}
+
+
+	void SoundScheduler::setValue(ma_sound* sound, AutomationParameter parameter, const glm::vec3& value)
+	{
+		switch (parameter) {
+			case AutomationParameter::Volume:
+				ma_sound_set_volume(sound, value.x);
+				break;
+			case AutomationParameter::Pitch:
+				ma_sound_set_pitch(sound, value.x);
+				break;
+			default:
+				ma_sound_set_position(sound, value.x, value.y, value.z);
+				break;
+		}
+	}
+
+
+	void SoundScheduler::apply(const Command& command)
+	{
+		switch (command.type) {
+			case Command::Type::Start:
+				ma_sound_set_start_time_in_pcm_frames(command.sound, command.frame);
+				ma_sound_start(command.sound);
+				break;
+			case Command::Type::Stop:
+				ma_sound_set_stop_time_in_pcm_frames(command.sound, command.frame);
+				break;
+			case Command::Type::Seek:
+				ma_sound_seek_to_pcm_frame(command.sound, command.seekFrame);
+				break;
+			default:
+				break;
+		}
+	}
+
+}
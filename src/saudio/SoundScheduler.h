@@ -0,0 +1,241 @@
+#ifndef SAUDIO_SOUND_SCHEDULER_H
+#define SAUDIO_SOUND_SCHEDULER_H
+
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <unordered_map>
+#include "saudio/AudioEngine.h"
+
+namespace saudio {
+
+	/**
+	 * Class SoundScheduler, it passes the scheduled Sound commands from the
+	 * thread that commits them to the audio thread, and applies them at
+	 * their exact frame. The start and stop commands are passed to
+	 * miniaudio, which applies them at the right offset inside the block
+	 * being rendered. The seeks are kept until the Engine reaches their
+	 * frame, and the automations are evaluated every few frames, so the
+	 * Engine read must be splitted at them. The seeks and automations are
+	 * processed separately for each miniaudio engine, so the engines can
+	 * be rendered by different threads in the same block.
+	 *
+	 * @note	the commands are stored in a single consumer ring buffer, so
+	 *			each batch is seen by the audio thread completely or not at
+	 *			all. The producers are serialized with a mutex. The sounds
+	 *			must be registered with @see addSound for resolving the
+	 *			handles of their commands, and removed with
+	 *			@see removeSound before destroying them
+	 */
+	class SoundScheduler
+	{
+	private:	// Nested types
+		using Command = AudioEngine::ScheduleBatch::Command;
+		using AutomationCurve = AudioEngine::ScheduleBatch::AutomationCurve;
+
+		/** The maximum number of seeks waiting for their frame */
+		static constexpr std::size_t kMaxPendingSeeks = 64;
+
+		/** The threads that can own the state read by the audio thread
+		 * (@see mStateOwner) */
+		static constexpr int kOwnerNone = 0;
+		static constexpr int kOwnerAudioThread = 1;
+		static constexpr int kOwnerCanceller = 2;
+
+		/** Holds the state of an automation */
+		struct Automation
+		{
+			/** The Automate command of the automation */
+			Command command;
+
+			/** The curve followed by the parameter */
+			AutomationCurve curve;
+
+			/** If the automation has reached its start frame */
+			bool started;
+
+			/** The value of the parameter at the start frame */
+			glm::vec3 startValue;
+		};
+
+	private:	// Attributes
+		/** The ring buffer with the committed commands */
+		std::vector<Command> mCommands;
+
+		/** The number of slots of @see mCommands minus one */
+		std::size_t mMask;
+
+		/** The number of commands pushed to and popped from
+		 * @see mCommands */
+		std::atomic<std::size_t> mNumPushed, mNumPopped;
+
+		/** The ring buffer with the curves of the committed Automate
+		 * commands, in the same order than the commands */
+		std::vector<AutomationCurve> mCurves;
+
+		/** The number of slots of @see mCurves minus one */
+		std::size_t mCurvesMask;
+
+		/** The number of curves pushed to and popped from @see mCurves.
+		 * The curves are published with @see mNumPushed */
+		std::atomic<std::size_t> mNumCurvesPushed, mNumCurvesPopped;
+
+		/** Serializes the threads that push and cancel commands */
+		std::mutex mProducerMutex;
+
+		/** The registered sounds and the indices of their engines by their
+		 * handles, used for resolving the sounds of the pushed commands.
+		 * Guarded by @see mProducerMutex */
+		std::unordered_map<uint64_t, std::pair<ma_sound*, std::size_t>> mSounds;
+
+		/** The thread that is using the commands, pending seeks and
+		 * automations. The audio thread takes it at the start of each
+		 * block, and @see removeSound takes it for removing the commands
+		 * of a sound */
+		std::atomic<int> mStateOwner;
+
+		/** The seeks waiting for their frame. The applied ones are
+		 * marked clearing their sound, and removed in the next
+		 * @see update. Only used by the threads that own the state */
+		Command mPendingSeeks[kMaxPendingSeeks];
+		std::size_t mNumPendingSeeks;
+
+		/** The automations waiting for their frame or running. The
+		 * finished ones are marked like the applied seeks. Only used by
+		 * the threads that own the state */
+		std::vector<Automation> mAutomations;
+		std::size_t mNumAutomations;
+
+		/** The number of frames between each evaluation of the
+		 * automations */
+		uint64_t mAutomationBlockSize;
+
+	public:		// Functions
+		/** Creates a new SoundScheduler
+		 *
+		 * @param	capacity the maximum number of commands waiting to be
+		 *			read by the audio thread, it will be rounded up to a
+		 *			power of two
+		 * @param	maxAutomations the maximum number of automations
+		 *			running at the same time, it's also the number of
+		 *			automation curves waiting to be read, rounded up to a
+		 *			power of two
+		 * @param	automationBlockSize the number of frames between each
+		 *			evaluation of the automations */
+		SoundScheduler(
+			std::size_t capacity, std::size_t maxAutomations,
+			uint32_t automationBlockSize
+		);
+
+		/** Pushes the given commands to the audio thread atomically. It can
+		 * be called from any thread, the pushes are serialized. The sounds
+		 * of the commands are resolved from their handles, the commands of
+		 * the sounds that aren't registered are ignored
+		 *
+		 * @param	commands a pointer to the commands to push
+		 * @param	count the number of commands
+		 * @param	curves a pointer to the curves of the Automate commands
+		 * @param	numCurves the number of curves, it must be the number of
+		 *			Automate commands
+		 * @return	true if the commands were pushed, false if there isn't
+		 *			enough space for all of them */
+		bool push(
+			const Command* commands, std::size_t count,
+			const AutomationCurve* curves, std::size_t numCurves
+		);
+
+		/** Registers the given sound, so the commands with its handle
+		 * can be pushed
+		 *
+		 * @param	handle the handle of the sound
+		 * @param	sound a pointer to the sound
+		 * @param	engineIndex the index of the miniaudio engine that
+		 *			renders the sound, used in @see process */
+		void addSound(uint64_t handle, ma_sound* sound, std::size_t engineIndex);
+
+		/** Unregisters the sound with the given handle and removes all its
+		 * commands, so it can be destroyed. If the audio thread is
+		 * processing the commands, it waits until it releases them
+		 *
+		 * @param	handle the handle of the sound to remove */
+		void removeSound(uint64_t handle);
+
+		/** Takes the ownership of the commands for the audio thread. It
+		 * must be called from the audio thread before @see update and
+		 * @see process
+		 *
+		 * @return	true if the commands can be processed, false if they are
+		 *			being cancelled, so they must be deferred and the call
+		 *			retried after rendering at most
+		 *			@see getAutomationBlockSize frames */
+		bool beginBlock();
+
+		/** Releases the ownership of the commands taken with
+		 * @see beginBlock */
+		void endBlock();
+
+		/** Removes the finished seeks and automations and reads the
+		 * committed commands, applying the start and stop ones and storing
+		 * the seeks and automations. It must be called from the audio
+		 * thread before rendering
+		 *
+		 * @param	time the current time of the Engine in PCM frames */
+		void update(uint64_t time);
+
+		/** Applies the pending seeks whose frame has been reached and
+		 * evaluates the automations of the sounds of the given engine. It
+		 * must be called from the audio thread, or from a thread that
+		 * renders an engine while the audio thread owns the state. The
+		 * calls for different engines can run at the same time
+		 *
+		 * @param	engineIndex the index of the miniaudio engine
+		 * @param	time the current time of the engine in PCM frames
+		 * @param	frameCount the number of frames left to render
+		 * @return	the number of frames that can be rendered until the next
+		 *			pending seek or automation evaluation */
+		uint64_t process(std::size_t engineIndex, uint64_t time, uint64_t frameCount);
+
+		/** @return	the number of frames between each evaluation of the
+		 *			automations */
+		uint64_t getAutomationBlockSize() const
+		{ return mAutomationBlockSize; };
+	private:
+		/** Adds the given Automate command to @see mAutomations, replacing
+		 * the automation of the same parameter
+		 *
+		 * @param	command the Automate command
+		 * @param	curve the curve of the command */
+		void addAutomation(const Command& command, const AutomationCurve& curve);
+
+		/** Evaluates the given automation and updates its parameter
+		 *
+		 * @param	automation the Automation to evaluate
+		 * @param	time the current time of the Engine in PCM frames
+		 * @return	true if the automation has finished, false otherwise */
+		static bool evaluate(Automation& automation, uint64_t time);
+
+		/** Returns the current value of the given parameter
+		 *
+		 * @param	sound the sound that holds the parameter
+		 * @param	parameter the parameter
+		 * @return	the value of the parameter */
+		static glm::vec3 getValue(ma_sound* sound, AutomationParameter parameter);
+
+		/** Sets the value of the given parameter
+		 *
+		 * @param	sound the sound that holds the parameter
+		 * @param	parameter the parameter
+		 * @param	value the new value of the parameter */
+		static void setValue(
+			ma_sound* sound, AutomationParameter parameter, const glm::vec3& value
+		);
+
+		/** Applies the given command
+		 *
+		 * @param	command the command to apply */
+		static void apply(const Command& command);
+	};
+
+}
+
+#endif		// SAUDIO_SOUND_SCHEDULER_H
@@ -0,0 +1,242 @@
+#include <cmath>
+#include <algorithm>
+#include "SpatializerKernels.h"
+#include "SimdPack.h"
+
+namespace saudio {
+
+	static_assert(kSpatialBatchSize % Pack::kSize == 0, "The batch size must be a multiple of the Pack size");
+
+
+	/** Returns the gain of a cone
+	 *
+	 * @param	cosAngle the cosine of the angle between the cone direction
+	 *			and the target
+	 * @param	innerCos the cosine of the half angle of the inner cone
+	 * @param	outerCos the cosine of the half angle of the outer cone
+	 * @param	outerGain the gain outside the outer cone
+	 * @return	1 inside the inner cone, outerGain outside the outer one and
+	 *			the interpolation of both values between them */
+	inline Pack coneGain(Pack cosAngle, Pack innerCos, Pack outerCos, Pack outerGain)
+	{
+		Pack one = Pack::set(1.0f), zero = Pack::set(0.0f), epsilon = Pack::set(1e-6f);
+		Pack t = clamp((cosAngle - outerCos) / max(innerCos - outerCos, epsilon), zero, one);
+		return outerGain + (one - outerGain) * t;
+	}
+
+
+	/** Holds the listener parameters broadcasted to all the lanes */
+	struct ListenerPack
+	{
+		Pack px, py, pz, rx, ry, rz, ux, uy, uz, fx, fy, fz;
+		Pack innerCos, outerCos, outerGain;
+
+		ListenerPack(const SpatialListener& listener) :
+			px(Pack::set(listener.position[0])), py(Pack::set(listener.position[1])), pz(Pack::set(listener.position[2])),
+			rx(Pack::set(listener.right[0])), ry(Pack::set(listener.right[1])), rz(Pack::set(listener.right[2])),
+			ux(Pack::set(listener.up[0])), uy(Pack::set(listener.up[1])), uz(Pack::set(listener.up[2])),
+			fx(Pack::set(listener.forward[0])), fy(Pack::set(listener.forward[1])), fz(Pack::set(listener.forward[2])),
+			innerCos(Pack::set(listener.coneInnerCos)), outerCos(Pack::set(listener.coneOuterCos)),
+			outerGain(Pack::set(listener.coneOuterGain)) {};
+	};
+
+
+	/** Calculates the gain and the direction in listener space of a group
+	 * of voices
+	 *
+	 * @param	listener the listener parameters
+	 * @param	voices the voice parameters
+	 * @param	i the index of the first voice of the group
+	 * @param	gain the distance and cone gain of the voices
+	 * @param	dx the right component of the voice directions
+	 * @param	dy the up component of the voice directions
+	 * @param	dz the forward component of the voice directions */
+	inline void evaluateVoices(
+		const ListenerPack& listener, const SpatialVoices& voices, std::size_t i,
+		Pack& gain, Pack& dx, Pack& dy, Pack& dz
+	) {
+		const Pack zero = Pack::set(0.0f), one = Pack::set(1.0f), epsilon = Pack::set(1e-6f);
+
+		// Direction from the listener to the voice
+		Pack vx = Pack::load(voices.positionX + i) - listener.px;
+		Pack vy = Pack::load(voices.positionY + i) - listener.py;
+		Pack vz = Pack::load(voices.positionZ + i) - listener.pz;
+		Pack distance = sqrt(vx * vx + vy * vy + vz * vz);
+		Pack invDistance = one / max(distance, epsilon);
+		vx = vx * invDistance;
+		vy = vy * invDistance;
+		vz = vz * invDistance;
+
+		// Distance attenuation, both models are evaluated and the one of
+		// each voice is selected with the weights
+		Pack minDistance = Pack::load(voices.minDistance + i);
+		Pack maxDistance = max(Pack::load(voices.maxDistance + i), minDistance);
+		Pack clampedDistance = clamp(distance, minDistance, maxDistance);
+		Pack rolloffDistance = Pack::load(voices.rolloff + i) * (clampedDistance - minDistance);
+		Pack inverse = minDistance / max(minDistance + rolloffDistance, epsilon);
+		Pack linear = one - rolloffDistance / max(maxDistance - minDistance, epsilon);
+		Pack inverseWeight = Pack::load(voices.inverseWeight + i);
+		Pack linearWeight = Pack::load(voices.linearWeight + i);
+		Pack attenuation = inverseWeight * inverse + linearWeight * linear
+			+ (one - inverseWeight - linearWeight) * Pack::load(voices.fixedAttenuation + i);
+
+		// The voice cone points to its direction, the listener one to its
+		// forward vector
+		Pack voiceCos = zero - (vx * Pack::load(voices.directionX + i) + vy * Pack::load(voices.directionY + i) + vz * Pack::load(voices.directionZ + i));
+		Pack voiceCone = coneGain(
+			voiceCos, Pack::load(voices.coneInnerCos + i), Pack::load(voices.coneOuterCos + i), Pack::load(voices.coneOuterGain + i)
+		);
+		Pack listenerCos = vx * listener.fx + vy * listener.fy + vz * listener.fz;
+		Pack listenerCone = coneGain(listenerCos, listener.innerCos, listener.outerCos, listener.outerGain);
+
+		gain = clamp(attenuation * voiceCone * listenerCone, Pack::load(voices.minGain + i), Pack::load(voices.maxGain + i));
+
+		// Direction of the voice in listener space
+		dx = vx * listener.rx + vy * listener.ry + vz * listener.rz;
+		dy = vx * listener.ux + vy * listener.uy + vz * listener.uz;
+		dz = listenerCos;
+	}
+
+
+	void computeSpatialGains(
+		const SpatialListener& listener, const SpatialVoices& voices,
+		std::size_t numVoices,
+		const float* channelDirections, std::size_t numChannels,
+		float* gains, std::size_t stride
+	) {
+		const Pack zero = Pack::set(0.0f), one = Pack::set(1.0f), half = Pack::set(0.5f), epsilon = Pack::set(1e-6f);
+		const ListenerPack listenerPack(listener);
+
+		for (std::size_t i = 0; i < numVoices; i += Pack::kSize) {
+			Pack gain, dx, dy, dz;
+			evaluateVoices(listenerPack, voices, i, gain, dx, dy, dz);
+
+			// Panning gains, each channel gets more signal the closer its
+			// direction is to the voice one. They are normalized to keep the
+			// power constant
+			Pack power = zero;
+			for (std::size_t c = 0; c < numChannels; ++c) {
+				const float* channelDirection = channelDirections + 3 * c;
+				Pack cosChannel = dx * Pack::set(channelDirection[0]) + dy * Pack::set(channelDirection[1]) + dz * Pack::set(channelDirection[2]);
+				Pack channelGain = half * (one + cosChannel);
+				power = power + channelGain * channelGain;
+				channelGain.store(gains + c * stride + i);
+			}
+
+			// The not spatialized voices are passed through with unity gain
+			Pack spatialized = Pack::load(voices.spatialized + i);
+			Pack scale = gain / sqrt(max(power, epsilon));
+			for (std::size_t c = 0; c < numChannels; ++c) {
+				Pack channelGain = Pack::load(gains + c * stride + i) * scale;
+				channelGain = spatialized * channelGain + (one - spatialized);
+				channelGain.store(gains + c * stride + i);
+			}
+		}
+	}
+
+
+	void computeVoiceGains(
+		const SpatialListener& listener, const SpatialVoices& voices,
+		std::size_t numVoices,
+		float* gains, float* directions, std::size_t stride
+	) {
+		const Pack one = Pack::set(1.0f);
+		const ListenerPack listenerPack(listener);
+
+		for (std::size_t i = 0; i < numVoices; i += Pack::kSize) {
+			Pack gain, dx, dy, dz;
+			evaluateVoices(listenerPack, voices, i, gain, dx, dy, dz);
+
+			// The not spatialized voices are passed through with unity gain
+			Pack spatialized = Pack::load(voices.spatialized + i);
+			(spatialized * gain + (one - spatialized)).store(gains + i);
+			dx.store(directions + i);
+			dy.store(directions + stride + i);
+			dz.store(directions + 2 * stride + i);
+		}
+	}
+
+
+	/** @return	the given value in all the lanes of T */
+	template <typename T> T splat(float f);
+	template <> inline float splat<float>(float f) { return f; }
+	template <> inline Pack splat<Pack>(float f) { return Pack::set(f); }
+
+
+	/** Evaluates the SN3D real spherical harmonics in ACN order
+	 *
+	 * @param	order the ambisonic order, from 1 to
+	 *			@see kMaxAmbisonicOrder
+	 * @param	x the front component of the unit direction
+	 * @param	y the left component of the unit direction
+	 * @param	z the up component of the unit direction
+	 * @param	output the array where the (order + 1)^2 coefficients will
+	 *			be stored */
+	template <typename T>
+	inline void evaluateHarmonics(std::size_t order, T x, T y, T z, T* output)
+	{
+		const T one = splat<T>(1.0f);
+		output[0] = one;
+		output[1] = y;
+		output[2] = z;
+		output[3] = x;
+		if (order < 2) {
+			return;
+		}
+
+		const T sqrt3 = splat<T>(1.7320508f), half = splat<T>(0.5f), three = splat<T>(3.0f);
+		T xx = x * x, yy = y * y, zz = z * z;
+		output[4] = sqrt3 * x * y;
+		output[5] = sqrt3 * y * z;
+		output[6] = half * (three * zz - one);
+		output[7] = sqrt3 * x * z;
+		output[8] = half * sqrt3 * (xx - yy);
+		if (order < 3) {
+			return;
+		}
+
+		const T c9 = splat<T>(0.7905694f), c10 = splat<T>(3.8729833f), c11 = splat<T>(0.6123724f), five = splat<T>(5.0f);
+		output[9] = c9 * y * (three * xx - yy);
+		output[10] = c10 * x * y * z;
+		output[11] = c11 * y * (five * zz - one);
+		output[12] = half * z * (five * zz - three);
+		output[13] = c11 * x * (five * zz - one);
+		output[14] = half * c10 * z * (xx - yy);
+		output[15] = c9 * x * (xx - three * yy);
+	}
+
+
+	void evaluateAmbisonics(std::size_t order, const float* direction, float* coefficients)
+	{
+		// Listener space (x right, y up, z forward) to ambisonic space
+		// (x front, y left, z up)
+		evaluateHarmonics<float>(order, direction[2], -direction[0], direction[1], coefficients);
+	}
+
+
+	void computeAmbisonicGains(
+		const SpatialListener& listener, const SpatialVoices& voices,
+		std::size_t numVoices, std::size_t order,
+		float* gains, std::size_t stride
+	) {
+		const Pack zero = Pack::set(0.0f), one = Pack::set(1.0f);
+		const ListenerPack listenerPack(listener);
+		const std::size_t numChannels = (order + 1) * (order + 1);
+
+		for (std::size_t i = 0; i < numVoices; i += Pack::kSize) {
+			Pack gain, dx, dy, dz;
+			evaluateVoices(listenerPack, voices, i, gain, dx, dy, dz);
+
+			Pack harmonics[(kMaxAmbisonicOrder + 1) * (kMaxAmbisonicOrder + 1)];
+			evaluateHarmonics<Pack>(order, dz, zero - dx, dy, harmonics);
+
+			// The not spatialized voices are encoded omnidirectionally
+			Pack spatialized = Pack::load(voices.spatialized + i);
+			(spatialized * gain + (one - spatialized)).store(gains + i);
+			for (std::size_t c = 1; c < numChannels; ++c) {
+				(spatialized * gain * harmonics[c]).store(gains + c * stride + i);
+			}
+		}
+	}
+
+}
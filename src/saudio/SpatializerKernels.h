@@ -0,0 +1,148 @@
+#ifndef SAUDIO_SPATIALIZER_KERNELS_H
+#define SAUDIO_SPATIALIZER_KERNELS_H
+
+#include <cstddef>
+
+namespace saudio {
+
+	/** The parameters of the listener used by @see computeSpatialGains */
+	struct SpatialListener
+	{
+		/** The position of the listener */
+		float position[3];
+
+		/** The right, up and forward unit vectors of the listener */
+		float right[3], up[3], forward[3];
+
+		/** The cosines of the half angles of the listener cone and the gain
+		 * used outside the outer one */
+		float coneInnerCos, coneOuterCos, coneOuterGain;
+	};
+
+
+	/** The parameters of the voices used by @see computeSpatialGains,
+	 * stored as a structure of arrays. The arrays must have space for
+	 * the number of voices rounded up to @see kSpatialBatchSize */
+	struct SpatialVoices
+	{
+		/** The positions and the forward directions of the voices */
+		float* positionX; float* positionY; float* positionZ;
+		float* directionX; float* directionY; float* directionZ;
+
+		/** The parameters of the distance attenuation */
+		float* minDistance; float* maxDistance; float* rolloff;
+
+		/** 1 if the voice uses the inverse or the linear distance
+		 * attenuation, 0 otherwise. If both are 0
+		 * @see fixedAttenuation is used instead */
+		float* inverseWeight; float* linearWeight;
+
+		/** The distance attenuation of the voices that don't use the
+		 * inverse or the linear models */
+		float* fixedAttenuation;
+
+		/** The gain limits of the voices */
+		float* minGain; float* maxGain;
+
+		/** The cosines of the half angles of the voice cones and the gain
+		 * used outside the outer one */
+		float* coneInnerCos; float* coneOuterCos; float* coneOuterGain;
+
+		/** 1 if the voice is spatialized, 0 if it must be passed through */
+		float* spatialized;
+	};
+
+
+	/** The number of voices processed at the same time, the arrays must be
+	 * padded to a multiple of it */
+	static constexpr std::size_t kSpatialBatchSize = 8;
+
+
+	/** The maximum order of the ambisonic encoding */
+	static constexpr std::size_t kMaxAmbisonicOrder = 3;
+
+
+	/** Computes the output channel gains of the given voices. It calculates
+	 * the distance attenuation, the voice and listener cone gains and the
+	 * panning gains of multiple voices at the same time with SIMD
+	 * instructions
+	 *
+	 * @param	listener the parameters of the listener
+	 * @param	voices the parameters of the voices
+	 * @param	numVoices the number of voices
+	 * @param	channelDirections the unit vectors of each output channel
+	 *			in listener space (x right, y up, z forward), 3 floats per
+	 *			channel
+	 * @param	numChannels the number of output channels
+	 * @param	gains a pointer to the array where the gains will be
+	 *			stored. The gains of the channel c are stored starting at
+	 *			c * stride
+	 * @param	stride the number of gains of each channel, it must be a
+	 *			multiple of @see kSpatialBatchSize */
+	void computeSpatialGains(
+		const SpatialListener& listener, const SpatialVoices& voices,
+		std::size_t numVoices,
+		const float* channelDirections, std::size_t numChannels,
+		float* gains, std::size_t stride
+	);
+
+
+	/** Computes the gains and the directions of the given voices. It
+	 * calculates the distance attenuation, the voice and listener cone
+	 * gains and the voice directions in listener space of multiple voices
+	 * at the same time with SIMD instructions
+	 *
+	 * @param	listener the parameters of the listener
+	 * @param	voices the parameters of the voices
+	 * @param	numVoices the number of voices
+	 * @param	gains a pointer to the array where the gains will be
+	 *			stored, the not spatialized voices have unity gain
+	 * @param	directions a pointer to the array where the unit directions
+	 *			in listener space (x right, y up, z forward) will be stored.
+	 *			The component c of the directions is stored starting at
+	 *			c * stride
+	 * @param	stride the number of voices of each direction component, it
+	 *			must be a multiple of @see kSpatialBatchSize */
+	void computeVoiceGains(
+		const SpatialListener& listener, const SpatialVoices& voices,
+		std::size_t numVoices,
+		float* gains, float* directions, std::size_t stride
+	);
+
+
+	/** Evaluates the ambisonic encoding coefficients of the given direction.
+	 * The channels are ordered with ACN and normalized with SN3D
+	 *
+	 * @param	order the ambisonic order, from 1 to
+	 *			@see kMaxAmbisonicOrder
+	 * @param	direction the unit direction in listener space (x right,
+	 *			y up, z forward)
+	 * @param	coefficients a pointer to the array where the
+	 *			(order + 1)^2 coefficients will be stored */
+	void evaluateAmbisonics(std::size_t order, const float* direction, float* coefficients);
+
+
+	/** Computes the ambisonic encoding gains of the given voices. It
+	 * calculates the distance attenuation, the voice and listener cone
+	 * gains and the spherical harmonics of the voice directions of multiple
+	 * voices at the same time with SIMD instructions
+	 *
+	 * @param	listener the parameters of the listener
+	 * @param	voices the parameters of the voices
+	 * @param	numVoices the number of voices
+	 * @param	order the ambisonic order, from 1 to
+	 *			@see kMaxAmbisonicOrder
+	 * @param	gains a pointer to the array where the gains will be
+	 *			stored. The gains of the ambisonic channel c (in ACN order)
+	 *			are stored starting at c * stride
+	 * @param	stride the number of gains of each channel, it must be a
+	 *			multiple of @see kSpatialBatchSize */
+	void computeAmbisonicGains(
+		const SpatialListener& listener, const SpatialVoices& voices,
+		std::size_t numVoices, std::size_t order,
+		float* gains, std::size_t stride
+	);
+
+}
+
+#endif		// SAUDIO_SPATIALIZER_KERNELS_H
@@ -1,83 +1,89 @@
 #include <mutex>
+#include <atomic>
+#include <vector>
 #include <cstring>
 #include <algorithm>
 #include <miniaudio.h>
 #include "saudio/StreamDataSource.h"
 #include "saudio/Context.h"
 #include "saudio/MAWrapper.h"
+#include "FormatKernels.h"
 #include "LogWrapper.h"
 
 namespace saudio {
 
+	/** The maximum number of frames converted at the same time by
+	 * @see StreamDataSource::onNewSamples */
+	static constexpr std::size_t kConversionFrames = 256;
+
+
+	/**
+	 * Class CircularBuffer, a single producer single consumer ring buffer. The
+	 * producer and the consumer can access to it concurrently without locks
+	 */
 	class StreamDataSource::CircularBuffer
 	{
 	private:
 		std::vector<unsigned char> mData;
-		std::size_t mFirstByte = 0, mNumBytes = 0;
 
-	public:
-		CircularBuffer(std::size_t bufferSize = 0) : mData(bufferSize) {};
+		/** The total number of bytes read and written. The first one is only
+		 * updated by the consumer, and the second one by the producer */
+		std::atomic<std::size_t> mBytesRead = 0, mBytesWritten = 0;
 
-		bool empty() const
+	public:
+		/** Clears the buffer and changes its size. It can't be used
+		 * concurrently with the read and write functions */
+		void reset(std::size_t bufferSize)
 		{
-			return (mNumBytes == 0);
+			mData.assign(bufferSize, 0);
+			mBytesRead = 0;
+			mBytesWritten = 0;
 		};
 
-		bool full() const
+		bool empty() const
 		{
-			return (mNumBytes == mData.size());
+			return (mBytesRead.load(std::memory_order_relaxed) == mBytesWritten.load(std::memory_order_acquire));
 		};
 
 		std::size_t read(unsigned char* data, std::size_t size)
 		{
-			std::size_t bytesRead = 0;
-			std::size_t rSize = std::min(size, mNumBytes);
-
-			// Copy the last part of the circular buffer
-			if (mData.size() - mFirstByte < rSize) {
-				std::size_t bytesToCopy = mData.size() - mFirstByte;
-				std::memcpy(data, &mData[mFirstByte], bytesToCopy);
-
-				bytesRead += bytesToCopy;
-				mNumBytes -= bytesToCopy;
-				mFirstByte = 0;
+			if (mData.empty()) {
+				return 0;
 			}
 
-			// Copy the first part of the circular buffer
-			std::size_t bytesToCopy = rSize - bytesRead;
-			std::memcpy(data + bytesRead, &mData[mFirstByte], bytesToCopy);
+			std::size_t bytesRead = mBytesRead.load(std::memory_order_relaxed);
+			std::size_t bytesWritten = mBytesWritten.load(std::memory_order_acquire);
+			std::size_t rSize = std::min(size, bytesWritten - bytesRead);
 
-			bytesRead += bytesToCopy;
-			mNumBytes -= bytesToCopy;
-			mFirstByte = (mFirstByte + bytesToCopy) % mData.size();
+			// Copy the last part of the circular buffer and then the first one
+			std::size_t firstByte = bytesRead % mData.size();
+			std::size_t bytesToCopy = std::min(rSize, mData.size() - firstByte);
+			std::memcpy(data, &mData[firstByte], bytesToCopy);
+			std::memcpy(data + bytesToCopy, mData.data(), rSize - bytesToCopy);
 
-			return bytesRead;
+			mBytesRead.store(bytesRead + rSize, std::memory_order_release);
+			return rSize;
 		};
 
 		std::size_t write(const unsigned char* data, std::size_t size)
 		{
-			std::size_t bytesWritten = 0;
-			std::size_t wSize = std::min(size, mData.size() - mNumBytes);
-
-			// Copy to the last part of the circular buffer
-			std::size_t mNextByte = (mFirstByte + mNumBytes) % mData.size();
-			if (mFirstByte < mNextByte) {
-				std::size_t bytesToCopy = std::min(mData.size() - mNextByte, wSize);
-				std::memcpy(&mData[mNextByte], data, bytesToCopy);
-
-				bytesWritten += bytesToCopy;
-				mNumBytes += bytesToCopy;
-				mNextByte = (mFirstByte + mNumBytes) % mData.size();
+			if (mData.empty()) {
+				return 0;
 			}
 
-			// Copy to the first part of the circular buffer
-			std::size_t bytesToCopy = wSize - bytesWritten;
-			std::memcpy(&mData[mNextByte], data + bytesWritten, bytesToCopy);
+			std::size_t bytesRead = mBytesRead.load(std::memory_order_acquire);
+			std::size_t bytesWritten = mBytesWritten.load(std::memory_order_relaxed);
+			std::size_t wSize = std::min(size, mData.size() - (bytesWritten - bytesRead));
 
-			bytesWritten += bytesToCopy;
-			mNumBytes += bytesToCopy;
+			// Copy to the last part of the circular buffer and then to the
+			// first one
+			std::size_t nextByte = bytesWritten % mData.size();
+			std::size_t bytesToCopy = std::min(wSize, mData.size() - nextByte);
+			std::memcpy(&mData[nextByte], data, bytesToCopy);
+			std::memcpy(mData.data(), data + bytesToCopy, wSize - bytesToCopy);
 
-			return bytesWritten;
+			mBytesWritten.store(bytesWritten + wSize, std::memory_order_release);
+			return wSize;
 		};
 	};
 
@@ -87,13 +93,22 @@ namespace saudio {
 		ma_data_source_base base;
 		ma_data_source_vtable vTable;
 
+		/** Serializes the changes of the format, the audio thread doesn't
+		 * use it */
 		std::mutex mutex;
 
-		ma_format format;
-		uint32_t sampleRate;
-		uint32_t numChannels;
+		ma_format format = ma_format_unknown;
+		uint32_t sampleRate = 0;
+		uint32_t numChannels = 0;
 		std::vector<ma_channel> channels;
 
+		/** The format of the samples added to the data source, @see format
+		 * is f32 if they are converted when added */
+		Format inputFormat = Format::Unknown;
+		std::size_t inputSampleSize = 0;
+		bool convertOnWrite = false;
+		std::vector<float> conversionBuffer;
+
 		std::size_t numSamples = 0;
 		std::size_t sampleSize = 0;
 		CircularBuffer buffer;
@@ -107,6 +122,10 @@ namespace saudio {
 		MaDataSource& operator=(const MaDataSource& other) = delete;
 		MaDataSource& operator=(MaDataSource&& other) = delete;
 
+		/** Updates the stored format and clears the ring buffer with the
+		 * current format parameters */
+		void resetBuffer();
+
 		static ma_result onRead(
 			ma_data_source* pDataSource, void* pFramesOut, ma_uint64 frameCount, ma_uint64* pFramesRead
 		);
@@ -140,11 +159,11 @@ namespace saudio {
 
 		ma_result result = ma_data_source_init(&baseConfig, &base);
 		if (result != MA_SUCCESS) {
-			SAUDIO_ERROR_LOG << "Failed to initialize the DataSource";
+			SAUDIO_ERROR_LOG(Context::getDefault()) << "Failed to initialize the DataSource";
 			return;
 		}
 
-		SAUDIO_DEBUG_LOG << "Created the base data source " << &base;
+		SAUDIO_DEBUG_LOG(Context::getDefault()) << "Created the base data source " << &base;
 	}
 
 
@@ -154,14 +173,24 @@ namespace saudio {
 	}
 
 
+	void StreamDataSource::MaDataSource::resetBuffer()
+	{
+		bool convert = convertOnWrite && (inputFormat != Format::Unknown);
+		format = convert? ma_format_f32 : toMAFormat(inputFormat);
+		inputSampleSize = bytesPerMAFormat(inputFormat);
+		sampleSize = convert? sizeof(float) : inputSampleSize;
+
+		buffer.reset(numSamples * numChannels * sampleSize);
+		conversionBuffer.assign(convert? kConversionFrames * numChannels : 0, 0.0f);
+	}
+
+
 	ma_result StreamDataSource::MaDataSource::onRead(
 		ma_data_source* pDataSource, void* pFramesOut, ma_uint64 frameCount, ma_uint64* pFramesRead
 	) {
 		if (!pDataSource) { return MA_ERROR; }
 
 		auto pThis = static_cast<MaDataSource*>(pDataSource);
-		std::unique_lock lock(pThis->mutex);
-
 		std::size_t bytesToRead = frameCount * pThis->numChannels * pThis->sampleSize;
 
 		if (pThis->buffer.empty()) {
@@ -191,8 +220,6 @@ namespace saudio {
 		if (!pDataSource) { return MA_ERROR; }
 
 		auto pThis = static_cast<MaDataSource*>(pDataSource);
-		std::unique_lock lock(pThis->mutex);
-
 		*pFormat = pThis->format;
 		*pSampleRate = pThis->sampleRate;
 		*pChannels = static_cast<ma_uint32>(pThis->channels.size());
@@ -223,7 +250,7 @@ namespace saudio {
 	StreamDataSource::StreamDataSource(std::size_t bufferedSamples) : IDataSource()
 	{
 		if (bufferedSamples < 2) {
-			SAUDIO_ERROR_LOG << "The number of bufferedSamples must be at least 2";
+			SAUDIO_ERROR_LOG(Context::getDefault()) << "The number of bufferedSamples must be at least 2";
 			return;
 		}
 
@@ -264,16 +291,20 @@ namespace saudio {
 	{
 		std::unique_lock lock(mMaDataSource->mutex);
 
-		mMaDataSource->format = toMAFormat(format);
-		mMaDataSource->sampleSize = bytesPerMAFormat(format);
-
-		std::size_t bufferSize = mMaDataSource->numSamples * mMaDataSource->numChannels * mMaDataSource->sampleSize;
-		mMaDataSource->buffer = CircularBuffer(bufferSize);
+		mMaDataSource->inputFormat = format;
+		mMaDataSource->resetBuffer();
 
 		return *this;
 	}
 
 
+	Format StreamDataSource::getFormat() const
+	{
+		std::unique_lock lock(mMaDataSource->mutex);
+		return mMaDataSource->inputFormat;
+	}
+
+
 	StreamDataSource& StreamDataSource::setSampleRate(uint32_t sampleRate)
 	{
 		std::unique_lock lock(mMaDataSource->mutex);
@@ -282,23 +313,36 @@ namespace saudio {
 	}
 
 
+	uint32_t StreamDataSource::getSampleRate() const
+	{
+		std::unique_lock lock(mMaDataSource->mutex);
+		return mMaDataSource->sampleRate;
+	}
+
+
 	StreamDataSource& StreamDataSource::setNumChannels(int numChannels)
 	{
 		std::unique_lock lock(mMaDataSource->mutex);
 
 		mMaDataSource->numChannels = static_cast<uint32_t>(numChannels);
-
-		std::size_t bufferSize = mMaDataSource->numSamples * mMaDataSource->numChannels * mMaDataSource->sampleSize;
-		mMaDataSource->buffer = CircularBuffer(bufferSize);
+		mMaDataSource->resetBuffer();
 
 		return *this;
 	}
 
 
+	int StreamDataSource::getNumChannels() const
+	{
+		std::unique_lock lock(mMaDataSource->mutex);
+		return static_cast<int>(mMaDataSource->numChannels);
+	}
+
+
 	StreamDataSource& StreamDataSource::setChannels(const Channel* channels, std::size_t channelCount)
 	{
 		std::unique_lock lock(mMaDataSource->mutex);
 
+		mMaDataSource->channels.clear();
 		mMaDataSource->channels.reserve(channelCount);
 		for (std::size_t i = 0; i < channelCount; ++i) {
 			mMaDataSource->channels.push_back( toMAChannel(channels[i]) );
@@ -308,12 +352,40 @@ namespace saudio {
 	}
 
 
-	StreamDataSource& StreamDataSource::onNewSamples(const unsigned char* data, std::size_t numSamples)
+	StreamDataSource& StreamDataSource::setConvertOnWrite(bool convert)
 	{
 		std::unique_lock lock(mMaDataSource->mutex);
 
-		std::size_t bytesToWrite = numSamples * mMaDataSource->numChannels * mMaDataSource->sampleSize;
-		mMaDataSource->buffer.write(reinterpret_cast<const unsigned char*>(data), bytesToWrite);
+		mMaDataSource->convertOnWrite = convert;
+		mMaDataSource->resetBuffer();
+
+		return *this;
+	}
+
+
+	StreamDataSource& StreamDataSource::onNewSamples(const unsigned char* data, std::size_t numSamples)
+	{
+		std::vector<float>& conversionBuffer = mMaDataSource->conversionBuffer;
+		if (conversionBuffer.empty()) {
+			std::size_t bytesToWrite = numSamples * mMaDataSource->numChannels * mMaDataSource->sampleSize;
+			mMaDataSource->buffer.write(reinterpret_cast<const unsigned char*>(data), bytesToWrite);
+			return *this;
+		}
+
+		// Convert the samples in chunks that fit in the conversion buffer
+		std::size_t inputFrameSize = mMaDataSource->numChannels * mMaDataSource->inputSampleSize;
+		for (std::size_t offset = 0; offset < numSamples; offset += kConversionFrames) {
+			std::size_t count = std::min(numSamples - offset, kConversionFrames);
+			std::size_t chunkSamples = count * mMaDataSource->numChannels;
+			convertToF32(conversionBuffer.data(), data + offset * inputFrameSize, mMaDataSource->inputFormat, chunkSamples);
+
+			std::size_t bytesToWrite = chunkSamples * sizeof(float);
+			const unsigned char* bytes = reinterpret_cast<const unsigned char*>(conversionBuffer.data());
+			if (mMaDataSource->buffer.write(bytes, bytesToWrite) < bytesToWrite) {
+				// The ring buffer is full, the remaining samples are discarded
+				break;
+			}
+		}
 
 		return *this;
 	}
@@ -129,10 +129,17 @@ int main()
 				if ((option >= 0) && (option < static_cast<int>(infos.size()))) {
 					auto device2 = std::make_unique<saudio::Device>(infos[option], audioDeviceConfig);
 					if (!device2->good()) {
-						std::cerr << "Failed to set the audio Device" << std::endl;
+						std::cerr << "Failed to create the audio Device" << std::endl;
 						stop = true;
 					}
-					// TODO: update audio engine
+					else {
+						if (audioEngine->setDevice(*device2)) {
+							device = std::move(device2);
+						}
+						else {
+							std::cerr << "Failed to set the audio Device, keeping the old one" << std::endl;
+						}
+					}
 				}
 				else {
 					std::cerr << "Invalid device" << std::endl;
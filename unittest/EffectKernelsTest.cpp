@@ -0,0 +1,190 @@
+#include "EffectKernels.h"
+#include "UnitTest.h"
+
+static constexpr std::size_t kChannelCounts[] = { 1, 2, 3, 4, 8, 9 };
+static constexpr std::size_t kChunkSizes[] = { 250, 3, 264 };
+
+
+/** Filters the given frames with a cascade of biquad stages one sample
+ * at a time */
+static void referenceBiquads(
+	float* frames, std::size_t numFrames, std::size_t numChannels,
+	const saudio::BiquadCoefficients* stages, std::size_t numStages, float* state
+) {
+	for (std::size_t f = 0; f < numFrames; ++f) {
+		for (std::size_t c = 0; c < numChannels; ++c) {
+			float x = frames[f * numChannels + c];
+			for (std::size_t s = 0; s < numStages; ++s) {
+				float& z1 = state[(2 * s) * numChannels + c];
+				float& z2 = state[(2 * s + 1) * numChannels + c];
+				float y = stages[s].b0 * x + z1;
+				z1 = stages[s].b1 * x - stages[s].a1 * y + z2;
+				z2 = stages[s].b2 * x - stages[s].a2 * y;
+				x = y;
+			}
+			frames[f * numChannels + c] = x;
+		}
+	}
+}
+
+
+/** Filters the given frames with a one-pole filter one sample at a time */
+static void referenceOnePole(
+	float* frames, std::size_t numFrames, std::size_t numChannels,
+	float coefficient, bool highPass, float* state
+) {
+	for (std::size_t f = 0; f < numFrames; ++f) {
+		for (std::size_t c = 0; c < numChannels; ++c) {
+			float& sample = frames[f * numChannels + c];
+			state[c] += coefficient * (sample - state[c]);
+			sample = highPass? sample - state[c] : state[c];
+		}
+	}
+}
+
+
+/** Delays the given frames one sample at a time */
+static void referenceDelay(
+	float* frames, std::size_t numFrames, std::size_t numChannels,
+	float* buffer, std::size_t bufferFrames, std::size_t& writeIndex,
+	const saudio::DelayParameters& parameters
+) {
+	for (std::size_t f = 0; f < numFrames; ++f) {
+		float delay = std::fmax(parameters.startDelay + (parameters.endDelay - parameters.startDelay) * f / numFrames, 1.0f);
+		float wetGain = parameters.startWetGain + (parameters.endWetGain - parameters.startWetGain) * f / numFrames;
+		float dryGain = parameters.startDryGain + (parameters.endDryGain - parameters.startDryGain) * f / numFrames;
+
+		float readPosition = static_cast<float>(writeIndex) - delay;
+		if (readPosition < 0.0f) {
+			readPosition += bufferFrames;
+		}
+		std::size_t i0 = static_cast<std::size_t>(readPosition);
+		std::size_t i1 = (i0 + 1) % bufferFrames;
+		float t = readPosition - i0;
+
+		for (std::size_t c = 0; c < numChannels; ++c) {
+			float x = frames[f * numChannels + c];
+			float y = buffer[i0 * numChannels + c] + (buffer[i1 * numChannels + c] - buffer[i0 * numChannels + c]) * t;
+			buffer[writeIndex * numChannels + c] = x + parameters.feedback * y;
+			frames[f * numChannels + c] = dryGain * x + wetGain * y;
+		}
+
+		writeIndex = (writeIndex + 1) % bufferFrames;
+	}
+}
+
+
+/** @return	the coefficients of a lowpass biquad stage */
+static saudio::BiquadCoefficients lowPass(float frequency, float q)
+{
+	const float pi = 3.14159265f;
+	float w0 = 2.0f * pi * frequency / 48000.0f;
+	float alpha = std::sin(w0) / (2.0f * q), cosW0 = std::cos(w0), a0 = 1.0f + alpha;
+
+	saudio::BiquadCoefficients ret;
+	ret.b0 = 0.5f * (1.0f - cosW0) / a0;
+	ret.b1 = (1.0f - cosW0) / a0;
+	ret.b2 = ret.b0;
+	ret.a1 = -2.0f * cosW0 / a0;
+	ret.a2 = (1.0f - alpha) / a0;
+	return ret;
+}
+
+
+/** Checks that the biquad kernel matches the scalar filter for all the
+ * channel counts, with the frames split in several calls */
+static void testBiquads()
+{
+	const saudio::BiquadCoefficients stages[] = { lowPass(200.0f, 0.707f), lowPass(5000.0f, 2.0f), lowPass(12000.0f, 0.5f) };
+	const std::size_t numStages = 3;
+
+	for (std::size_t numChannels : kChannelCounts) {
+		std::vector<float> state(2 * numStages * numChannels, 0.0f), expectedState = state;
+		float maxError = 0.0f;
+
+		for (std::size_t numFrames : kChunkSizes) {
+			std::vector<float> frames = randomSamples(numFrames * numChannels, static_cast<unsigned int>(numFrames + numChannels));
+			std::vector<float> expected = frames;
+			saudio::processBiquads(frames.data(), numFrames, numChannels, stages, numStages, state.data());
+			referenceBiquads(expected.data(), numFrames, numChannels, stages, numStages, expectedState.data());
+			maxError = std::fmax(maxError, maxDifference(expected.data(), frames.data(), frames.size()));
+		}
+
+		CHECK(maxError < 1e-4f);
+		CHECK(maxDifference(expectedState.data(), state.data(), state.size()) < 1e-4f);
+	}
+}
+
+
+/** Checks that the one-pole kernel matches the scalar filter for all the
+ * channel counts, with both outputs */
+static void testOnePole()
+{
+	for (bool highPass : { false, true }) {
+		for (std::size_t numChannels : kChannelCounts) {
+			std::vector<float> state(numChannels, 0.0f), expectedState = state;
+			float maxError = 0.0f;
+
+			for (std::size_t numFrames : kChunkSizes) {
+				std::vector<float> frames = randomSamples(numFrames * numChannels, static_cast<unsigned int>(numFrames * numChannels));
+				std::vector<float> expected = frames;
+				saudio::processOnePole(frames.data(), numFrames, numChannels, 0.05f, highPass, state.data());
+				referenceOnePole(expected.data(), numFrames, numChannels, 0.05f, highPass, expectedState.data());
+				maxError = std::fmax(maxError, maxDifference(expected.data(), frames.data(), frames.size()));
+			}
+
+			CHECK(maxError < 1e-5f);
+			CHECK(maxDifference(expectedState.data(), state.data(), state.size()) < 1e-5f);
+		}
+	}
+}
+
+
+/** Checks that the delay kernel matches the scalar delay line with
+ * constant and with changing parameters, short and long delays and a
+ * delay line that wraps around several times */
+static void testDelay()
+{
+	const std::size_t bufferFrames = 131;
+	const float delays[][2] = { { 1.0f, 1.0f }, { 1.5f, 1.5f }, { 3.25f, 3.25f }, { 40.0f, 40.0f }, { 129.5f, 129.5f }, { 20.0f, 60.5f } };
+
+	for (std::size_t numChannels : kChannelCounts) {
+		for (const auto& delay : delays) {
+			std::vector<float> buffer(bufferFrames * numChannels, 0.0f), expectedBuffer = buffer;
+			std::size_t writeIndex = 0, expectedWriteIndex = 0;
+			float maxError = 0.0f;
+
+			for (int i = 0; i < 4; ++i) {
+				for (std::size_t numFrames : kChunkSizes) {
+					saudio::DelayParameters parameters;
+					parameters.startDelay = delay[0];
+					parameters.endDelay = delay[1];
+					parameters.feedback = 0.5f;
+					parameters.startWetGain = 0.7f;
+					parameters.endWetGain = (delay[0] == delay[1])? 0.7f : 0.2f;
+					parameters.startDryGain = 1.0f;
+					parameters.endDryGain = (delay[0] == delay[1])? 1.0f : 0.5f;
+
+					std::vector<float> frames = randomSamples(numFrames * numChannels, static_cast<unsigned int>(i + numFrames));
+					std::vector<float> expected = frames;
+					saudio::processDelay(frames.data(), numFrames, numChannels, buffer.data(), bufferFrames, writeIndex, parameters);
+					referenceDelay(expected.data(), numFrames, numChannels, expectedBuffer.data(), bufferFrames, expectedWriteIndex, parameters);
+					maxError = std::fmax(maxError, maxDifference(expected.data(), frames.data(), frames.size()));
+				}
+			}
+
+			CHECK(maxError < 1e-4f);
+			CHECK(writeIndex == expectedWriteIndex);
+		}
+	}
+}
+
+
+int main()
+{
+	testBiquads();
+	testOnePole();
+	testDelay();
+
+	return finishTests("EffectKernelsTest");
+}
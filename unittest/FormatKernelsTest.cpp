@@ -0,0 +1,153 @@
+#include "FormatKernels.h"
+#include "UnitTest.h"
+
+
+/** Checks that every u8 and s16 sample survives a conversion to f32 and
+ * back, and a subset of the s24 ones */
+static void testIntegerRoundTrip()
+{
+	std::vector<unsigned char> u8(256), u8Result(256);
+	std::vector<float> u8Samples(256);
+	for (std::size_t i = 0; i < u8.size(); ++i) {
+		u8[i] = static_cast<unsigned char>(i);
+	}
+	CHECK(saudio::convertToF32(u8Samples.data(), u8.data(), saudio::Format::u8, u8.size()));
+	CHECK(saudio::convertFromF32(u8Result.data(), saudio::Format::u8, u8Samples.data(), u8.size(), nullptr));
+	CHECK(u8 == u8Result);
+
+	std::vector<int16_t> s16(65536), s16Result(65536);
+	std::vector<float> s16Samples(65536);
+	for (std::size_t i = 0; i < s16.size(); ++i) {
+		s16[i] = static_cast<int16_t>(static_cast<int>(i) - 32768);
+	}
+	CHECK(saudio::convertToF32(s16Samples.data(), s16.data(), saudio::Format::s16, s16.size()));
+	CHECK(saudio::convertFromF32(s16Result.data(), saudio::Format::s16, s16Samples.data(), s16.size(), nullptr));
+	CHECK(s16 == s16Result);
+
+	// Odd strides so the low bytes change too, and the extremes
+	std::vector<int32_t> s24Values;
+	for (int32_t value = -8388608; value < 8388608; value += 4099) {
+		s24Values.push_back(value);
+	}
+	s24Values.push_back(8388607);
+
+	std::vector<unsigned char> s24(3 * s24Values.size()), s24Result(s24.size());
+	for (std::size_t i = 0; i < s24Values.size(); ++i) {
+		uint32_t value = static_cast<uint32_t>(s24Values[i]);
+		s24[3 * i + 0] = static_cast<unsigned char>(value);
+		s24[3 * i + 1] = static_cast<unsigned char>(value >> 8);
+		s24[3 * i + 2] = static_cast<unsigned char>(value >> 16);
+	}
+	std::vector<float> s24Samples(s24Values.size());
+	CHECK(saudio::convertToF32(s24Samples.data(), s24.data(), saudio::Format::s24, s24Values.size()));
+	CHECK(saudio::convertFromF32(s24Result.data(), saudio::Format::s24, s24Samples.data(), s24Values.size(), nullptr));
+	CHECK(s24 == s24Result);
+}
+
+
+/** Checks that the f32 samples with up to 24 significant bits survive a
+ * conversion to s32 and back, s32 has more precision than f32 so it
+ * can't be checked in the other direction */
+static void testS32RoundTrip()
+{
+	std::vector<float> samples = randomSamples(1001, 1), result(samples.size());
+	for (float& sample : samples) {
+		sample = std::round(sample * 8388608.0f) / 8388608.0f;
+	}
+	samples[0] = -1.0f;
+
+	std::vector<int32_t> s32(samples.size());
+	CHECK(saudio::convertFromF32(s32.data(), saudio::Format::s32, samples.data(), samples.size(), nullptr));
+	CHECK(saudio::convertToF32(result.data(), s32.data(), saudio::Format::s32, s32.size()));
+	CHECK(maxDifference(samples.data(), result.data(), samples.size()) == 0.0f);
+}
+
+
+/** Checks that the full scale and the samples out of range are clipped
+ * to the largest integer samples */
+static void testClipping()
+{
+	const float fullScale[] = { 1.0f, -1.0f, 2.0f, -2.0f };
+
+	unsigned char u8[4];
+	CHECK(saudio::convertFromF32(u8, saudio::Format::u8, fullScale, 4, nullptr));
+	CHECK((u8[0] == 255) && (u8[1] == 0) && (u8[2] == 255) && (u8[3] == 0));
+
+	int16_t s16[4];
+	CHECK(saudio::convertFromF32(s16, saudio::Format::s16, fullScale, 4, nullptr));
+	CHECK((s16[0] == 32767) && (s16[1] == -32768) && (s16[2] == 32767) && (s16[3] == -32768));
+
+	unsigned char s24[12];
+	CHECK(saudio::convertFromF32(s24, saudio::Format::s24, fullScale, 4, nullptr));
+	CHECK((s24[0] == 0xFF) && (s24[1] == 0xFF) && (s24[2] == 0x7F));
+	CHECK((s24[3] == 0x00) && (s24[4] == 0x00) && (s24[5] == 0x80));
+
+	int32_t s32[4];
+	CHECK(saudio::convertFromF32(s32, saudio::Format::s32, fullScale, 4, nullptr));
+	CHECK((s32[0] == 2147483520) && (s32[1] == INT32_MIN) && (s32[2] == 2147483520) && (s32[3] == INT32_MIN));
+
+	// The same checks with enough samples for the SIMD paths
+	std::vector<float> samples(67);
+	for (std::size_t i = 0; i < samples.size(); ++i) {
+		samples[i] = fullScale[i % 4];
+	}
+	std::vector<int16_t> s16Result(samples.size());
+	CHECK(saudio::convertFromF32(s16Result.data(), saudio::Format::s16, samples.data(), samples.size(), nullptr));
+	bool clipped = true;
+	for (std::size_t i = 0; i < samples.size(); ++i) {
+		clipped &= (s16Result[i] == ((samples[i] > 0.0f)? 32767 : -32768));
+	}
+	CHECK(clipped);
+}
+
+
+/** Checks that the dithered samples are within 1 LSB of the rounded ones,
+ * and that the dither doesn't bias them */
+static void testDither()
+{
+	const std::size_t numSamples = 100003;
+	const float value = 1000.3f / 32768.0f;
+	std::vector<float> samples(numSamples, value);
+
+	saudio::DitherState dither;
+	std::vector<int16_t> s16(numSamples);
+	CHECK(saudio::convertFromF32(s16.data(), saudio::Format::s16, samples.data(), numSamples, &dither));
+
+	bool inRange = true, changed = false;
+	double sum = 0.0;
+	for (int16_t sample : s16) {
+		inRange &= (sample >= 999) && (sample <= 1002);
+		changed |= (sample != 1000);
+		sum += sample;
+	}
+	CHECK(inRange);
+	CHECK(changed);
+	CHECK(std::fabs(sum / numSamples - 1000.3) < 0.01);
+
+	// The dither state continues between calls
+	std::vector<int16_t> next(numSamples);
+	CHECK(saudio::convertFromF32(next.data(), saudio::Format::s16, samples.data(), numSamples, &dither));
+	CHECK(next != s16);
+}
+
+
+/** Checks that the unknown formats are rejected */
+static void testUnknownFormat()
+{
+	float samples[4] = {};
+	unsigned char bytes[16] = {};
+	CHECK(!saudio::convertToF32(samples, bytes, saudio::Format::Unknown, 4));
+	CHECK(!saudio::convertFromF32(bytes, saudio::Format::Unknown, samples, 4, nullptr));
+}
+
+
+int main()
+{
+	testIntegerRoundTrip();
+	testS32RoundTrip();
+	testClipping();
+	testDither();
+	testUnknownFormat();
+
+	return finishTests("FormatKernelsTest");
+}
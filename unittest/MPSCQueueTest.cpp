@@ -0,0 +1,83 @@
+#include <thread>
+#include "MPSCQueue.h"
+#include "UnitTest.h"
+
+/** Checks that the queue keeps the order and counts the dropped pushes
+ * while its positions wrap around its slots */
+static void testWraparound()
+{
+	saudio::MPSCQueue<int> queue(4);
+
+	// Fill and drain it more times than its number of slots
+	int next = 0, expected = 0;
+	for (int round = 0; round < 10; ++round) {
+		while (queue.push(next)) {
+			++next;
+		}
+
+		int value = -1;
+		while (queue.pop(value)) {
+			CHECK(value == expected);
+			++expected;
+		}
+	}
+
+	CHECK(next == expected);
+	CHECK(next == 40);
+	CHECK(queue.takeNumDropped() == 10);
+	CHECK(queue.takeNumDropped() == 0);
+}
+
+
+/** Checks that the values of multiple producers arrive in the order each
+ * one pushed them */
+static void testMultipleProducers()
+{
+	static constexpr int kNumProducers = 4, kNumValues = 10000;
+	saudio::MPSCQueue<int> queue(64);
+
+	std::vector<std::thread> producers;
+	for (int i = 0; i < kNumProducers; ++i) {
+		producers.emplace_back([&queue, i]() {
+			for (int j = 0; j < kNumValues;) {
+				if (queue.push(i * kNumValues + j)) {
+					++j;
+				}
+				else {
+					std::this_thread::yield();
+				}
+			}
+		});
+	}
+
+	std::vector<int> lastValues(kNumProducers, -1);
+	int numPopped = 0;
+	bool ordered = true;
+	while (numPopped < kNumProducers * kNumValues) {
+		int value;
+		if (queue.pop(value)) {
+			int producer = value / kNumValues;
+			ordered &= (value % kNumValues == lastValues[producer] + 1);
+			lastValues[producer] = value % kNumValues;
+			++numPopped;
+		}
+		else {
+			std::this_thread::yield();
+		}
+	}
+
+	for (std::thread& producer : producers) {
+		producer.join();
+	}
+
+	CHECK(ordered);
+}
+
+
+int main()
+{
+	testWraparound();
+	testMultipleProducers();
+
+	return finishTests("MPSCQueueTest");
+}
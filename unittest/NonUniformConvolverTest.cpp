@@ -0,0 +1,88 @@
+#include <thread>
+#include <chrono>
+#include "NonUniformConvolver.h"
+#include "UnitTest.h"
+
+static constexpr std::size_t kBlockSize = 64;
+static constexpr std::size_t kNumChannels = 2;
+static constexpr int kMaxAttempts = 3;
+
+
+/** Checks that the output of the head and tail segments matches the
+ * direct convolution of each impulse response. The blocks are processed
+ * with a delay so the worker has time to convolve the tail, if it still
+ * has overruns the comparison is retried */
+static void testDirectConvolution()
+{
+	const std::size_t length = 3000, numFrames = 8192;
+	std::vector<float> impulseResponses[kNumChannels] = { randomSamples(length, 1), randomSamples(length, 2) };
+	const float* irs[kNumChannels] = { impulseResponses[0].data(), impulseResponses[1].data() };
+	std::vector<float> input = randomSamples(numFrames, 3);
+
+	std::vector<float> expected(kNumChannels * numFrames, 0.0f);
+	for (std::size_t i = kBlockSize; i < numFrames; ++i) {
+		for (std::size_t c = 0; c < kNumChannels; ++c) {
+			float& sample = expected[i * kNumChannels + c];
+			for (std::size_t j = 0; (j < length) && (j <= i - kBlockSize); ++j) {
+				sample += impulseResponses[c][j] * input[i - kBlockSize - j];
+			}
+		}
+	}
+
+	for (int attempt = 0; attempt < kMaxAttempts; ++attempt) {
+		saudio::NonUniformConvolver convolver(nullptr, irs, kNumChannels, length, kBlockSize);
+		CHECK(convolver.getNumChannels() == kNumChannels);
+		CHECK(convolver.getNumTailSegments() > 0);
+
+		// Odd sized chunks, so the blocks are filled in several calls
+		std::vector<float> output(kNumChannels * numFrames);
+		for (std::size_t i = 0; i < numFrames;) {
+			std::size_t count = std::min<std::size_t>(numFrames - i, 37);
+			convolver.process(input.data() + i, output.data() + kNumChannels * i, count);
+			i += count;
+			std::this_thread::sleep_for(std::chrono::microseconds(100));
+		}
+
+		if (convolver.takeNumOverruns() == 0) {
+			CHECK(maxDifference(expected.data(), output.data(), output.size()) < 1e-3f);
+			return;
+		}
+	}
+
+	std::cout << "testDirectConvolution: the worker didn't finish in time, the output wasn't checked" << std::endl;
+}
+
+
+/** Checks that an impulse response that fits in the head segment is
+ * convolved without worker */
+static void testHeadOnly()
+{
+	const std::size_t length = 100, numFrames = 1024;
+	std::vector<float> impulseResponse = randomSamples(length, 4);
+	const float* irs[1] = { impulseResponse.data() };
+	std::vector<float> input = randomSamples(numFrames, 5);
+
+	saudio::NonUniformConvolver convolver(nullptr, irs, 1, length, kBlockSize);
+	CHECK(convolver.getNumTailSegments() == 0);
+
+	std::vector<float> output(numFrames);
+	convolver.process(input.data(), output.data(), numFrames);
+	CHECK(convolver.takeNumOverruns() == 0);
+
+	std::vector<float> expected(numFrames, 0.0f);
+	for (std::size_t i = kBlockSize; i < numFrames; ++i) {
+		for (std::size_t j = 0; (j < length) && (j <= i - kBlockSize); ++j) {
+			expected[i] += impulseResponse[j] * input[i - kBlockSize - j];
+		}
+	}
+	CHECK(maxDifference(expected.data(), output.data(), numFrames) < 1e-4f);
+}
+
+
+int main()
+{
+	testHeadOnly();
+	testDirectConvolution();
+
+	return finishTests("NonUniformConvolverTest");
+}
@@ -0,0 +1,119 @@
+#include <complex>
+#include "FFT.h"
+#include "PartitionedConvolver.h"
+#include "UnitTest.h"
+
+
+/** Convolves the given input with the given impulse response directly */
+static std::vector<float> convolveDirect(const std::vector<float>& input, const std::vector<float>& impulseResponse)
+{
+	std::vector<float> output(input.size(), 0.0f);
+	for (std::size_t i = 0; i < input.size(); ++i) {
+		for (std::size_t j = 0; (j < impulseResponse.size()) && (j <= i); ++j) {
+			output[i] += impulseResponse[j] * input[i - j];
+		}
+	}
+	return output;
+}
+
+
+/** Checks that the spectrum of the FFT matches the discrete Fourier
+ * transform calculated directly */
+static void testFFTSpectrum()
+{
+	saudio::FFT fft(64);
+	std::vector<float> input = randomSamples(fft.getSize(), 1);
+	std::vector<float> re(fft.getNumBins()), im(fft.getNumBins());
+	fft.forward(input.data(), re.data(), im.data());
+
+	CHECK(fft.getNumBins() == fft.getSize() / 2 + 1);
+
+	const double pi = 3.14159265358979323846;
+	float maxError = 0.0f;
+	for (std::size_t k = 0; k < fft.getNumBins(); ++k) {
+		std::complex<double> expected = 0.0;
+		for (std::size_t n = 0; n < fft.getSize(); ++n) {
+			expected += static_cast<double>(input[n]) * std::polar(1.0, -2.0 * pi * k * n / fft.getSize());
+		}
+		maxError = std::max(maxError, static_cast<float>(std::abs(expected - std::complex<double>(re[k], im[k]))));
+	}
+	CHECK(maxError < 1e-4f);
+}
+
+
+/** Checks that inverse(forward(x)) = x for all the supported sizes */
+static void testFFTRoundTrip()
+{
+	for (std::size_t size = 4; size <= 4096; size *= 2) {
+		saudio::FFT fft(size);
+		std::vector<float> input = randomSamples(size, static_cast<unsigned int>(size)), output(size);
+		std::vector<float> re(fft.getNumBins()), im(fft.getNumBins());
+
+		fft.forward(input.data(), re.data(), im.data());
+		fft.inverse(re.data(), im.data(), output.data());
+		CHECK(maxDifference(input.data(), output.data(), size) < 1e-5f);
+	}
+}
+
+
+/** Checks that the partitioned convolution matches the direct one, with
+ * an impulse response that doesn't fill its last partition */
+static void testPartitionedConvolution()
+{
+	const std::size_t blockSize = 64, numPartitions = 4, numBlocks = 16;
+	std::vector<float> impulseResponse = randomSamples(3 * blockSize + 17, 2);
+	std::vector<float> input = randomSamples(numBlocks * blockSize, 3);
+
+	saudio::PartitionedConvolver convolver(blockSize, numPartitions);
+	saudio::PartitionedFilter filter;
+	convolver.computeFilter(impulseResponse.data(), impulseResponse.size(), filter);
+
+	std::vector<float> output(input.size());
+	for (std::size_t i = 0; i < numBlocks; ++i) {
+		convolver.pushBlock(input.data() + i * blockSize);
+		convolver.convolve(filter, output.data() + i * blockSize);
+	}
+
+	std::vector<float> expected = convolveDirect(input, impulseResponse);
+	CHECK(maxDifference(expected.data(), output.data(), output.size()) < 1e-4f);
+}
+
+
+/** Checks that the samples of the impulse response that don't fit in the
+ * partitions are ignored, and that reset clears the pushed blocks */
+static void testTruncationAndReset()
+{
+	const std::size_t blockSize = 32, numPartitions = 2, numBlocks = 8;
+	std::vector<float> impulseResponse = randomSamples(5 * blockSize, 4);
+	std::vector<float> input = randomSamples(numBlocks * blockSize, 5);
+
+	saudio::PartitionedConvolver convolver(blockSize, numPartitions);
+	saudio::PartitionedFilter filter;
+	convolver.computeFilter(impulseResponse.data(), impulseResponse.size(), filter);
+
+	std::vector<float> noise = randomSamples(blockSize, 6), discarded(blockSize);
+	convolver.pushBlock(noise.data());
+	convolver.convolve(filter, discarded.data());
+	convolver.reset();
+
+	std::vector<float> output(input.size());
+	for (std::size_t i = 0; i < numBlocks; ++i) {
+		convolver.pushBlock(input.data() + i * blockSize);
+		convolver.convolve(filter, output.data() + i * blockSize);
+	}
+
+	impulseResponse.resize(numPartitions * blockSize);
+	std::vector<float> expected = convolveDirect(input, impulseResponse);
+	CHECK(maxDifference(expected.data(), output.data(), output.size()) < 1e-4f);
+}
+
+
+int main()
+{
+	testFFTSpectrum();
+	testFFTRoundTrip();
+	testPartitionedConvolution();
+	testTruncationAndReset();
+
+	return finishTests("PartitionedConvolverTest");
+}
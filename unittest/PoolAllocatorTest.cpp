@@ -0,0 +1,111 @@
+#include <saudio/PoolAllocator.h>
+#include "UnitTest.h"
+
+/** Counts the allocations forwarded to it */
+class CountingAllocator : public saudio::Allocator
+{
+public:		// Attributes
+	std::size_t numAllocations = 0;
+	std::size_t numDeallocations = 0;
+
+public:		// Functions
+	virtual void* allocate(std::size_t size) override
+	{ ++numAllocations; return std::malloc(size); };
+	virtual void deallocate(void* ptr) override
+	{ ++numDeallocations; std::free(ptr); };
+};
+
+
+/** Checks that the PoolAllocator forwards the allocations to the upstream
+ * Allocator once it's exhausted and reuses the freed blocks */
+static void testExhaustionAndReuse()
+{
+	CountingAllocator upstream;
+	saudio::PoolAllocator::Config config;
+	config.blockSize = 64;
+	config.numBlocks = 4;
+	config.upstream = &upstream;
+
+	{
+		saudio::PoolAllocator allocator(config);
+		CHECK(allocator.good());
+		CHECK(upstream.numAllocations == 1);
+
+		std::vector<void*> blocks;
+		for (std::size_t i = 0; i < config.numBlocks; ++i) {
+			blocks.push_back(allocator.allocate(config.blockSize));
+			CHECK(blocks.back() != nullptr);
+		}
+		CHECK(allocator.getNumUsedBlocks() == config.numBlocks);
+		CHECK(allocator.getNumUpstreamAllocations() == 0);
+
+		// The pool is exhausted, so the next one goes to the upstream Allocator
+		void* forwarded = allocator.allocate(config.blockSize);
+		CHECK(forwarded != nullptr);
+		CHECK(allocator.getNumUpstreamAllocations() == 1);
+		CHECK(upstream.numAllocations == 2);
+		allocator.deallocate(forwarded);
+		CHECK(upstream.numDeallocations == 1);
+
+		// The bigger allocations always go to the upstream Allocator
+		void* big = allocator.allocate(config.blockSize + 1);
+		CHECK(big != nullptr);
+		CHECK(allocator.getNumUpstreamAllocations() == 2);
+		allocator.deallocate(big);
+
+		// The freed blocks are reused
+		void* freed = blocks.back();
+		blocks.pop_back();
+		allocator.deallocate(freed);
+		CHECK(allocator.getNumUsedBlocks() == config.numBlocks - 1);
+		blocks.push_back(allocator.allocate(config.blockSize));
+		CHECK(blocks.back() == freed);
+		CHECK(allocator.getNumUpstreamAllocations() == 2);
+
+		for (void* block : blocks) {
+			allocator.deallocate(block);
+		}
+		CHECK(allocator.getNumUsedBlocks() == 0);
+	}
+
+	CHECK(upstream.numAllocations == upstream.numDeallocations);
+}
+
+
+/** Checks that the reallocations keep the data of the blocks */
+static void testReallocate()
+{
+	saudio::PoolAllocator::Config config;
+	config.blockSize = 64;
+	config.numBlocks = 2;
+	saudio::PoolAllocator allocator(config);
+
+	auto data = static_cast<unsigned char*>(allocator.allocate(16));
+	for (unsigned char i = 0; i < 16; ++i) {
+		data[i] = i;
+	}
+
+	// It still fits in the same block
+	CHECK(allocator.reallocate(data, 32) == data);
+
+	// It must be moved to the upstream Allocator
+	data = static_cast<unsigned char*>(allocator.reallocate(data, 256));
+	CHECK(data != nullptr);
+	CHECK(allocator.getNumUsedBlocks() == 0);
+	bool same = true;
+	for (unsigned char i = 0; i < 16; ++i) {
+		same &= (data[i] == i);
+	}
+	CHECK(same);
+
+	allocator.deallocate(data);
+}
+
+
+int main()
+{
+	testExhaustionAndReuse();
+	testReallocate();
+
+	return finishTests("PoolAllocatorTest");
+}
@@ -0,0 +1,78 @@
+#include <saudio/Context.h>
+#include <saudio/AudioEngine.h>
+#include <saudio/Sound.h>
+#include <saudio/FileDataSource.h>
+#include "UnitTest.h"
+
+static constexpr uint32_t kSampleRate = 48000;
+static constexpr unsigned int kPeriodFrames = 256;
+
+
+/** Checks that an AudioEngine without Sounds renders silence and advances
+ * its time by the rendered frames */
+static void testSilence(saudio::Context& context)
+{
+	saudio::AudioEngine::Config config;
+	config.outputSampleRate = kSampleRate;
+	saudio::AudioEngine engine(context, config);
+	CHECK(engine.good());
+	CHECK(engine.getChannels() == 2);
+	CHECK(engine.getSampleRate() == kSampleRate);
+
+	std::vector<float> output(2 * kPeriodFrames, 1.0f);
+	for (int i = 0; i < 4; ++i) {
+		CHECK(engine.render(output.data(), kPeriodFrames) == kPeriodFrames);
+		CHECK(maxDifference(output.data(), std::vector<float>(output.size(), 0.0f).data(), output.size()) == 0.0f);
+	}
+	CHECK(engine.getTimeInPCMFrames() == 4 * kPeriodFrames);
+}
+
+
+/** Checks that a not spatialized Sound is rendered unchanged and followed
+ * by silence when it ends */
+static void testSoundOutput(saudio::Context& context)
+{
+	const std::size_t numFrames = 3 * kPeriodFrames + 17;
+	std::vector<float> samples = randomSamples(2 * numFrames, 1);
+	for (float& sample : samples) {
+		sample *= 0.5f;
+	}
+	CHECK(writeWavFile("RenderTest.wav", samples, 2, kSampleRate));
+
+	saudio::AudioEngine::Config config;
+	config.outputSampleRate = kSampleRate;
+	saudio::AudioEngine engine(context, config);
+	saudio::FileDataSource source(engine, "RenderTest.wav");
+	CHECK(source.good());
+
+	saudio::Sound sound(&engine);
+	sound.bind(&source);
+	sound.setSpacialization(false);
+	sound.play();
+
+	std::vector<float> output(2 * 5 * kPeriodFrames);
+	for (unsigned int i = 0; i < 5; ++i) {
+		CHECK(engine.render(output.data() + 2 * i * kPeriodFrames, kPeriodFrames) == kPeriodFrames);
+	}
+
+	CHECK(maxDifference(output.data(), samples.data(), samples.size()) < 1e-6f);
+	std::vector<float> silence(output.size() - samples.size(), 0.0f);
+	CHECK(maxDifference(output.data() + samples.size(), silence.data(), silence.size()) == 0.0f);
+
+	std::remove("RenderTest.wav");
+}
+
+
+int main()
+{
+	saudio::Context::Config contextConfig;
+	contextConfig.backends = { saudio::Context::Backend::Null };
+	contextConfig.logLevel = saudio::LogLevel::Error;
+	saudio::Context context(contextConfig);
+	CHECK(context.good());
+
+	testSilence(context);
+	testSoundOutput(context);
+
+	return finishTests("RenderTest");
+}
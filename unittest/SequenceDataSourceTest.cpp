@@ -0,0 +1,121 @@
+#include <memory>
+#include <miniaudio.h>
+#include "SequenceDataSource.h"
+#include "UnitTest.h"
+
+/** Holds an in memory data source with the frames firstValue,
+ * firstValue + 1... */
+struct RampSource
+{
+	std::vector<float> frames;
+	ma_audio_buffer buffer;
+
+	RampSource(std::size_t numFrames, float firstValue) : frames(numFrames)
+	{
+		for (std::size_t i = 0; i < numFrames; ++i) {
+			frames[i] = firstValue + i;
+		}
+
+		ma_audio_buffer_config config = ma_audio_buffer_config_init(ma_format_f32, 1, numFrames, frames.data(), nullptr);
+		config.sampleRate = 48000;
+		ma_audio_buffer_init(&config, &buffer);
+	};
+
+	~RampSource()
+	{ ma_audio_buffer_uninit(&buffer); };
+};
+
+
+/** Reads the given number of frames from the given data source
+ *
+ * @return	the frames read */
+static std::vector<float> read(ma_data_source* dataSource, std::size_t numFrames)
+{
+	std::vector<float> frames(numFrames);
+	ma_uint64 framesRead = 0;
+	ma_data_source_read_pcm_frames(dataSource, frames.data(), numFrames, &framesRead);
+	frames.resize(framesRead);
+	return frames;
+}
+
+
+/** @return	true if the given frames are a ramp starting at firstValue */
+static bool isRamp(const std::vector<float>& frames, float firstValue)
+{
+	for (std::size_t i = 0; i < frames.size(); ++i) {
+		if (frames[i] != firstValue + i) {
+			return false;
+		}
+	}
+	return true;
+}
+
+
+/** Checks that a replaced data source isn't accessed by the seeks, cursor
+ * and length queries made before the next read */
+static void testReplaceAndSeek()
+{
+	auto first = std::make_unique<RampSource>(100, 0.0f);
+	RampSource second(50, 1000.0f);
+
+	saudio::SequenceDataSource sequence;
+	CHECK(sequence.init(&first->buffer));
+	ma_data_source* dataSource = sequence.getMADataSource();
+
+	std::vector<float> frames = read(dataSource, 10);
+	CHECK((frames.size() == 10) && isRamp(frames, 0.0f));
+
+	// After the push the first data source can be destroyed
+	CHECK(sequence.isCompatible(&second.buffer));
+	CHECK(sequence.push(&second.buffer, false, true));
+	first = nullptr;
+
+	ma_uint64 cursor = 1, length = 0;
+	CHECK(ma_data_source_get_cursor_in_pcm_frames(dataSource, &cursor) == MA_SUCCESS);
+	CHECK(cursor == 0);
+	CHECK(ma_data_source_get_length_in_pcm_frames(dataSource, &length) == MA_SUCCESS);
+	CHECK(length == 50);
+
+	// The seek is applied to the replacement
+	CHECK(ma_data_source_seek_to_pcm_frame(dataSource, 5) == MA_SUCCESS);
+	frames = read(dataSource, 10);
+	CHECK((frames.size() == 10) && isRamp(frames, 1005.0f));
+
+	CHECK(ma_data_source_get_cursor_in_pcm_frames(dataSource, &cursor) == MA_SUCCESS);
+	CHECK(cursor == 15);
+
+	sequence.uninit();
+}
+
+
+/** Checks that the queued data sources are played without gaps and that a
+ * replace discards them */
+static void testQueue()
+{
+	RampSource first(20, 0.0f), second(20, 20.0f), third(20, 500.0f), fourth(20, 600.0f);
+
+	saudio::SequenceDataSource sequence;
+	CHECK(sequence.init(&first.buffer));
+	ma_data_source* dataSource = sequence.getMADataSource();
+
+	CHECK(sequence.push(&second.buffer, false, false));
+	std::vector<float> frames = read(dataSource, 30);
+	CHECK((frames.size() == 30) && isRamp(frames, 0.0f));
+
+	// The replace discards the third one
+	CHECK(sequence.push(&third.buffer, false, false));
+	CHECK(sequence.push(&fourth.buffer, false, true));
+	frames = read(dataSource, 30);
+	CHECK((frames.size() == 20) && isRamp(frames, 600.0f));
+
+	sequence.uninit();
+}
+
+
+int main()
+{
+	testReplaceAndSeek();
+	testQueue();
+
+	return finishTests("SequenceDataSourceTest");
+}
@@ -0,0 +1,143 @@
+#include <saudio/Context.h>
+#include <saudio/AudioEngine.h>
+#include <saudio/Sound.h>
+#include <saudio/FileDataSource.h>
+#include "UnitTest.h"
+
+static constexpr uint32_t kSampleRate = 48000;
+static constexpr unsigned int kPeriodFrames = 256;
+static constexpr unsigned int kNumPeriods = 6;
+static constexpr std::size_t kNumFrames = 4 * kPeriodFrames + 17;
+
+
+/** Renders kNumPeriods periods of the given AudioEngine */
+static std::vector<float> renderPeriods(saudio::AudioEngine& engine)
+{
+	std::vector<float> output(2 * kNumPeriods * kPeriodFrames);
+	for (unsigned int i = 0; i < kNumPeriods; ++i) {
+		CHECK(engine.render(output.data() + 2 * i * kPeriodFrames, kPeriodFrames) == kPeriodFrames);
+	}
+	return output;
+}
+
+
+/** Checks that the given stereo frames of the output are silent */
+static bool isSilent(const std::vector<float>& output, std::size_t firstFrame, std::size_t lastFrame)
+{
+	std::vector<float> silence(2 * (lastFrame - firstFrame), 0.0f);
+	return maxDifference(output.data() + 2 * firstFrame, silence.data(), silence.size()) == 0.0f;
+}
+
+
+/** Checks that a Sound starts at the exact frame of its play command */
+static void testPlay(saudio::Context& context, const std::vector<float>& samples, std::size_t numRenderThreads)
+{
+	const uint64_t startFrame = 300;
+
+	saudio::AudioEngine::Config config;
+	config.outputSampleRate = kSampleRate;
+	config.numRenderThreads = numRenderThreads;
+	saudio::AudioEngine engine(context, config);
+	saudio::FileDataSource source(engine, "SoundSchedulerTest.wav");
+	CHECK(source.good());
+
+	saudio::Sound sound(&engine);
+	sound.bind(&source);
+	sound.setSpacialization(false);
+
+	saudio::AudioEngine::ScheduleBatch batch;
+	batch.play(sound, startFrame);
+	CHECK(engine.commit(batch));
+
+	std::vector<float> output = renderPeriods(engine);
+	CHECK(isSilent(output, 0, startFrame));
+	CHECK(maxDifference(output.data() + 2 * startFrame, samples.data(), samples.size()) < 1e-6f);
+	CHECK(isSilent(output, startFrame + kNumFrames, kNumPeriods * kPeriodFrames));
+}
+
+
+/** Checks that a Sound stops and moves at the exact frames of its
+ * commands, even if they are inside a rendered period */
+static void testStopAndSeek(saudio::Context& context, const std::vector<float>& samples, std::size_t numRenderThreads)
+{
+	const uint64_t seekFrame = 500, seekTarget = 100, stopFrame = 1100;
+
+	saudio::AudioEngine::Config config;
+	config.outputSampleRate = kSampleRate;
+	config.numRenderThreads = numRenderThreads;
+	saudio::AudioEngine engine(context, config);
+	saudio::FileDataSource source(engine, "SoundSchedulerTest.wav");
+	CHECK(source.good());
+
+	saudio::Sound sound(&engine);
+	sound.bind(&source);
+	sound.setSpacialization(false);
+
+	saudio::AudioEngine::ScheduleBatch batch;
+	batch.play(sound, 0)
+		.setToPCMFrame(sound, seekFrame, seekTarget)
+		.stop(sound, stopFrame);
+	CHECK(engine.commit(batch));
+
+	std::vector<float> output = renderPeriods(engine);
+	CHECK(maxDifference(output.data(), samples.data(), 2 * seekFrame) < 1e-6f);
+	CHECK(maxDifference(output.data() + 2 * seekFrame, samples.data() + 2 * seekTarget, 2 * (stopFrame - seekFrame)) < 1e-6f);
+	CHECK(isSilent(output, stopFrame, kNumPeriods * kPeriodFrames));
+}
+
+
+/** Checks that the commands of a batch whose Sound has been destroyed
+ * before committing it are ignored */
+static void testDestroyedSound(saudio::Context& context)
+{
+	saudio::AudioEngine::Config config;
+	config.outputSampleRate = kSampleRate;
+	saudio::AudioEngine engine(context, config);
+	saudio::FileDataSource source(engine, "SoundSchedulerTest.wav");
+	CHECK(source.good());
+
+	saudio::AudioEngine::ScheduleBatch batch;
+	{
+		saudio::Sound sound(&engine);
+		sound.bind(&source);
+		sound.setSpacialization(false);
+
+		saudio::AutomationPoint point;
+		point.frame = kPeriodFrames;
+		point.value = glm::vec3(0.0f);
+		batch.play(sound, 10)
+			.setToPCMFrame(sound, 20, 0)
+			.automate(sound, saudio::AutomationParameter::Volume, 30, &point, 1);
+	}
+	CHECK(engine.commit(batch));
+
+	std::vector<float> output = renderPeriods(engine);
+	CHECK(isSilent(output, 0, kNumPeriods * kPeriodFrames));
+}
+
+
+int main()
+{
+	saudio::Context::Config contextConfig;
+	contextConfig.backends = { saudio::Context::Backend::Null };
+	contextConfig.logLevel = saudio::LogLevel::Error;
+	saudio::Context context(contextConfig);
+	CHECK(context.good());
+
+	std::vector<float> samples = randomSamples(2 * kNumFrames, 2);
+	for (float& sample : samples) {
+		sample *= 0.5f;
+	}
+	CHECK(writeWavFile("SoundSchedulerTest.wav", samples, 2, kSampleRate));
+
+	// The Sounds of the parallel render lanes are processed apart from
+	// the ones of the main engine
+	for (std::size_t numRenderThreads : { 0, 2 }) {
+		testPlay(context, samples, numRenderThreads);
+		testStopAndSeek(context, samples, numRenderThreads);
+	}
+	testDestroyedSound(context);
+
+	std::remove("SoundSchedulerTest.wav");
+	return finishTests("SoundSchedulerTest");
+}
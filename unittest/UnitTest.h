@@ -0,0 +1,114 @@
+#ifndef UNIT_TEST_H
+#define UNIT_TEST_H
+
+#include <cmath>
+#include <random>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+/** The number of failed checks of the test program */
+inline int gNumFailures = 0;
+
+
+/** Reports the given check as failed if the condition is false */
+#define CHECK(condition)														\
+	if (!(condition)) {															\
+		std::cerr << __FILE__ << ":" << __LINE__ << " failed: " #condition << std::endl;	\
+		++gNumFailures;															\
+	}
+
+
+/** @return	a vector with the given number of random samples in the range
+ *			[-1, 1], always the same for the same seed */
+inline std::vector<float> randomSamples(std::size_t numSamples, unsigned int seed)
+{
+	std::mt19937 engine(seed);
+	std::vector<float> samples(numSamples);
+	for (float& sample : samples) {
+		sample = 2.0f * static_cast<float>(engine()) / static_cast<float>(engine.max()) - 1.0f;
+	}
+	return samples;
+}
+
+
+/** @return	the maximum absolute difference between the given arrays */
+inline float maxDifference(const float* a, const float* b, std::size_t count)
+{
+	float maxError = 0.0f;
+	for (std::size_t i = 0; i < count; ++i) {
+		maxError = std::fmax(maxError, std::fabs(a[i] - b[i]));
+	}
+	return maxError;
+}
+
+
+/** Writes the given interleaved samples to a 32 bit float WAV file
+ *
+ * @param	path the path of the file
+ * @param	samples the interleaved samples to write
+ * @param	numChannels the number of channels of the samples
+ * @param	sampleRate the sample rate of the samples
+ * @return	true on success, false otherwise */
+inline bool writeWavFile(
+	const char* path, const std::vector<float>& samples,
+	uint16_t numChannels, uint32_t sampleRate
+) {
+	std::FILE* file = std::fopen(path, "wb");
+	if (!file) {
+		return false;
+	}
+
+	auto write32 = [&](uint32_t value) {
+		unsigned char bytes[4] = {
+			static_cast<unsigned char>(value), static_cast<unsigned char>(value >> 8),
+			static_cast<unsigned char>(value >> 16), static_cast<unsigned char>(value >> 24)
+		};
+		std::fwrite(bytes, 1, 4, file);
+	};
+	auto write16 = [&](uint16_t value) {
+		unsigned char bytes[2] = { static_cast<unsigned char>(value), static_cast<unsigned char>(value >> 8) };
+		std::fwrite(bytes, 1, 2, file);
+	};
+
+	uint32_t dataSize = static_cast<uint32_t>(samples.size() * sizeof(float));
+	std::fwrite("RIFF", 1, 4, file);
+	write32(36 + dataSize);
+	std::fwrite("WAVEfmt ", 1, 8, file);
+	write32(16);
+	write16(3);		// IEEE float
+	write16(numChannels);
+	write32(sampleRate);
+	write32(sampleRate * numChannels * sizeof(float));
+	write16(static_cast<uint16_t>(numChannels * sizeof(float)));
+	write16(32);
+	std::fwrite("data", 1, 4, file);
+	write32(dataSize);
+	for (float sample : samples) {
+		uint32_t value;
+		std::memcpy(&value, &sample, sizeof(float));
+		write32(value);
+	}
+
+	return std::fclose(file) == 0;
+}
+
+
+/** Prints the result of the test program
+ *
+ * @param	name the name of the test program
+ * @return	the exit code of the test program */
+inline int finishTests(const char* name)
+{
+	if (gNumFailures > 0) {
+		std::cerr << name << ": " << gNumFailures << " checks failed" << std::endl;
+		return 1;
+	}
+
+	std::cout << name << ": all the checks passed" << std::endl;
+	return 0;
+}
+
+#endif		// UNIT_TEST_H